@@ -20,74 +20,620 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 
-#include "signal_io/signal_io.h"
+#include "signal_io_interface.h"
 
 #include "threads/threads.h"
 #include "threads/semaphores.h"
 #include "threads/khash.h"
 
+#include "signal_kernels.h"
+#include "signal_recorder.h"
+#include "signal_expressions.h"
+#include "signal_mailbox.h"
+
 //#include "debug/async_debug.h"
 
 #include <NIDAQmx.h>
 
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+#ifdef _WIN32
+  #include <windows.h>
+#else
+  #include <time.h>
+#endif
+
 #define DEBUG_MESSAGE_LENGTH 256
+#define CHANNEL_NAME_MAX_LENGTH 256
+#define TASK_NAME_MAX_LENGTH 256
+
+const size_t AQUISITION_BUFFER_LENGTH = KERNEL_BLOCK_LENGTH;
+const size_t AQUISITION_BUFFER_MAX_LENGTH = 1000;
+const size_t ADAPTIVE_BLOCK_SHRINK_DELAY = 8;
+const size_t HISTORY_BLOCKS_NUMBER = 1024;
+// Sample history holds this many blocks of the max (adaptive) length, for readers safety margins to hold in any mode
+const size_t HISTORY_MAX_BLOCKS_NUMBER = 64;
+
+const size_t CLOCK_FIT_BLOCKS_NUMBER = 64;
+const size_t READ_TIMES_CHUNK_LENGTH = 64;
+
+const size_t RESAMPLER_PHASES_NUMBER = 64;
+const size_t RESAMPLER_TAPS_NUMBER = 16;
+
+const size_t RECORDER_FRAMES_NUMBER = 16384;
+const size_t RECORDER_MARKERS_NUMBER = 1024;
+
+const size_t FEATURE_WINDOWS_NUMBER = 1024;
+
+const size_t ENSEMBLES_MAX_NUMBER = 8;
+const size_t ENSEMBLE_PENDING_SWEEPS_NUMBER = 64;
 
-const size_t AQUISITION_BUFFER_LENGTH = 10;
-const size_t SIGNAL_INPUT_CHANNEL_MAX_USES = 5;
+const size_t OUTPUT_COMMANDS_NUMBER = 256;
+// Knots pending over the max output delay, at 1 kHz commands, plus the ones around the interpolated segment
+const size_t OUTPUT_KNOTS_NUMBER = 1000 + KERNEL_KNOTS_NUMBER;
+const size_t OUTPUT_LEAD_BLOCKS_NUMBER = 4;
+const double OUTPUT_BLOCK_DURATION = 0.001;
+const double OUTPUT_DELAY_MAX = 1.0;
+const double OUTPUT_UPDATE_RATE_DEFAULT = 1000.0;
+const double COUNTER_DUTY_CYCLE_MIN = 0.0001;
+
+const size_t EDGES_NUMBER = 1024;
+const double EDGES_WAIT_TIMEOUT = 0.1;
+
+const size_t INTERLOCKS_MAX_NUMBER = 16;
+const double INTERLOCK_SYNC_INTERVAL = 0.001;
+
+const size_t READER_DEADLINES_MAX_NUMBER = 16;
+const double READER_PERIOD_TOLERANCE = 1.5;
+
+const double VERSION_SYNC_INTERVAL = 0.001;
+
+const size_t OUTPUT_GROUP_MARGIN_BLOCKS = 2;
+const double OUTPUT_GROUP_ARM_TIMEOUT = 1.0;
+
+#define CHANNEL_INACTIVE UINT64_MAX
 
 const bool READ = true;
 const bool WRITE = false;
 
+// Task lifecycle: acquisition thread is only started once, and then paused/resumed (with the driver task kept committed)
+enum { TASK_STOPPED, TASK_RUNNING, TASK_PAUSED, TASK_ENDING };
+
+// Client settings are handed to aquisition/generation threads by version counters: threads take their own copies of them 
+// whenever the published version changes, and acknowledge the copied version afterwards (see PublishVersion/SyncVersion)
+typedef struct _SignalIOVersionData
+{
+  atomic_uint published;
+  atomic_uint acknowledged;
+}
+SignalIOVersion;
+
 typedef struct _SignalIOTaskData
 {
+  long int taskID;
+  char name[ TASK_NAME_MAX_LENGTH ];
   TaskHandle handle;
   Thread threadID;
-  volatile bool isRunning;
+  atomic_int state;
+  Semaphore resumeLock;
+  atomic_uint eventsMask;
+  Semaphore eventsLock;
+  atomic_bool isStarted;
+  atomic_bool isProcessing;
+  bool isResuming;
+  atomic_ullong resumeRequestTime;
+  atomic_ullong resumeLatency;
+  atomic_ullong maxResumeLatency;
   bool mode;
-  unsigned int* channelUsesList;
+  atomic_uint* channelUsesList;
+  SignalIOVersion channelsVersion;
+  unsigned int* readChannelsList;
+  uInt32 readChannelsNumber;
+  TransposeFramesFunction TransposeBlock;
+  CalibrateFramesFunction CalibrateBlock;
+  _Atomic( struct _SignalIOFilterSettingsData* ) filterSettings;
+  Semaphore filtersLock;
+  SignalIOVersion filtersVersion;
+  double* readThresholdsList;
+  size_t readFilterLength;
+  double* filterFramesList;
+  size_t filterFramesNumber;
+  _Atomic( struct _SignalIOFeatureTermsData* ) featureTerms;
+  SignalIOVersion featuresVersion;
+  size_t readFeatureWindowLength;
+  size_t readFeatureIncrement;
+  double readFeatureThreshold;
+  double* featureTermsList;
+  double* featureSumsList;
+  double* featureLastFramesList;
+  size_t featureTermsIndex;
+  uint64_t featureFramesCount;
+  double* featureWindowsList;
+  atomic_ullong featureWindowsCount;
+  uint64_t tareChannelsMask;
+  size_t tareSamplesNumber;
+  atomic_bool isTaring;
+  SignalIOVersion tareVersion;
+  bool isReadTaring;
+  size_t taredSamplesNumber;
+  double* tareSumsList;
+  double* channelOffsetsList;
+  double* readOffsetsList;
+  bool hasReadOffsets;
+  struct _SignalIOEnsembleData** ensemblesList;
+  size_t ensemblesNumber;
+  Semaphore ensemblesLock;
+  SignalIOVersion ensemblesVersion;
+  struct _SignalIOEnsembleData** readEnsemblesList;
+  size_t readEnsemblesNumber;
+  atomic_uint triggersCount;
+  struct _SignalIOInterlockData** interlocksList;
+  size_t interlocksNumber;
+  Semaphore interlocksLock;
+  SignalIOVersion interlocksVersion;
+  struct _SignalIOInterlockData* readInterlocksList;
+  size_t readInterlocksNumber;
+  atomic_uint interlocksCount;
+  atomic_ullong interlockTripTime;
+  bool isInterlocked;
+  bool isTripPending;
+  atomic_ullong interlockLatency;
+  atomic_ullong maxInterlockLatency;
+  char** channelNamesList;
+  char* readChannelsString;
   Semaphore* channelLocksList;
   uInt32 channelsNumber;
+  uInt32 deviceChannelsNumber;
+  bool isChangeDetection;
+  uInt8* linesList;
+  int8_t* lineLevelsList;
+  unsigned int edgeChannelsVersion;
+  double lastDetectionTime;
+  double detectionTime;
+  uint64_t detectionSamplesStart;
+  uint64_t detectionSamplesEnd;
+  SignalIOEdge* edgesList;
+  atomic_ullong edgesCount;
+  struct _SignalIOReaderDeadlineData* readerDeadlinesList;
+  SignalExpression* virtualChannelsList;
+  unsigned int* readVirtualChannelsList;
+  size_t readVirtualChannelsNumber;
   float64* samplesList;
+  double* historySamplesList;
+  size_t historyLength;
+  atomic_ullong* channelStartsList;
+  atomic_ullong samplesCount;
+  SignalIOBlockData* blocksList;
+  atomic_ullong blocksCount;
+  atomic_ullong runStartBlock;
+  float64 samplingRate;
+  atomic_size_t maxBlockLength;
+  size_t blockLength;
+  size_t shrinkBlocksCount;
   double* channelValuesList;
+  double* safeValuesList;
+  bool isCounterOutput;
+  double updateRate;
+  double watchdogTimeout;
+  SignalIOVersion pacingVersion;
+  double readUpdateRate;
+  double readWatchdogTimeout;
+  double lastUpdateTime;
+  atomic_ullong lastWriteTime;
+  bool isWatchdogTripped;
+  double* commandsTable;
+  atomic_ullong* commandSequencesList;
+  atomic_ullong commandsCount;
+  uint64_t readCommandsCount;
+  atomic_int outputInterpolation;
+  double outputDelay;
+  SignalIOVersion interpolationVersion;
+  int readOutputInterpolation;
+  double readOutputDelay;
+  _Atomic( double ) appliedOutputDelay;
+  _Atomic( double ) commitCommandTime;
+  double* groupValuesList;
+  atomic_ullong groupSequence;
+  atomic_ullong appliedGroupSequence;
+  double* knotTimesList;
+  double* knotsTable;
+  double* outputWeightsTable;
+  _Atomic( struct _SignalIOWaveformData* ) pendingWaveform;
+  struct _SignalIOWaveformData* waveform;
+  bool isRegenerating;
+  size_t knotsStart;
+  size_t knotsNumber;
+  size_t outputBlockLength;
+  double outputStartTime;
+  atomic_ullong outputSamplesCount;
+  struct _SignalIOGroupData* outputGroup;
+  _Atomic( SignalMailbox ) mailbox;
+  double* mailboxValuesList;
+  uint64_t* mailboxSequencesList;
+  double* mergedValuesList;
+  atomic_bool isOutputEnabled;
+  atomic_bool isOutputDirty;
+  bool isFaulted;
+  SignalRecorder recorder;
+  Thread dumpThreadID;
+  Semaphore dumpLock;
+  atomic_bool isDumping;
+  SignalRecording* dumpSnapshot;
+  uint64_t dumpSamplesEnd, dumpFramesEnd, dumpMarkersEnd;
+  char dumpFilePath[ RECORDER_NAME_MAX_LENGTH ];
+  struct _SignalIOTaskData* parentTask;
+  unsigned int* viewChannelsList;
+  size_t viewsCount;
+  bool isLoadedByView;
 }
 SignalIOTaskData;
 
 typedef SignalIOTaskData* SignalIOTask;  
 
+typedef struct _SignalIOWaveformData
+{
+  size_t periodLength;
+  double samplesTable[];
+}
+SignalIOWaveformData;
+
+// Filter settings, replaced as a whole by clients (so that the aquisition thread never copies partially updated ones), and freed once replaced
+typedef struct _SignalIOFilterSettingsData
+{
+  size_t windowLength;
+  double thresholdsList[];
+}
+SignalIOFilterSettingsData;
+
+// Feature settings and terms ring, allocated by the client for the aquisition thread (that should not allocate memory), and freed once replaced
+typedef struct _SignalIOFeatureTermsData
+{
+  size_t windowLength;
+  size_t increment;
+  double threshold;
+  double termsTable[];
+}
+SignalIOFeatureTermsData;
+
+// Deadline slots live in the (physical) task, so that its aquisition thread could check them with no reader lifetime issues. Times in microseconds
+typedef struct _SignalIOReaderDeadlineData
+{
+  atomic_bool isUsed;
+  atomic_ullong expectedPeriod;
+  atomic_ullong maxDataAge;
+  atomic_ullong lastReadTime;
+  atomic_bool isLate;
+}
+SignalIOReaderDeadlineData;
+
+typedef SignalIOReaderDeadlineData* SignalIOReaderDeadline;
+
+typedef struct _SignalIOReaderData
+{
+  SignalIOTask task;
+  unsigned int* channelsList;
+  size_t channelsNumber;
+  double outputRate;
+  double samplesStep;
+  uint64_t outputCursor;
+  double* filterTable;
+  double* windowTable;
+  uint64_t markersCursor;
+  unsigned int policy;
+  atomic_ullong samplesCursor;
+  atomic_ullong droppedSamplesCount;
+  _Atomic(SignalIOReaderDeadline) deadline;
+  double lastReadTime;
+  atomic_ullong readsCount;
+  atomic_ullong lateReadsCount;
+  atomic_ullong maxReadInterval;
+  atomic_ullong maxDataAge;
+  atomic_ullong readIntervalsHistogram[ SIGNAL_IO_READER_HISTOGRAM_BINS ];
+  atomic_ullong dataAgesHistogram[ SIGNAL_IO_READER_HISTOGRAM_BINS ];
+}
+SignalIOReaderData;
+
+typedef SignalIOReaderData* SignalIOReader;
+
+// Trigger settings are replaced as a whole, so that the aquisition thread never sees them half changed
+typedef struct _SignalIOTriggerData
+{
+  SignalIOReader reader;
+  SignalIOTask task;
+  int source;
+  unsigned int channel;
+  double level;
+  uint64_t startCursor;
+}
+SignalIOTriggerData;
+
+typedef SignalIOTriggerData* SignalIOTrigger;
+
+typedef struct _SignalIOEnsembleData
+{
+  SignalIOReader reader;
+  _Atomic( struct _SignalIOTriggerData* ) trigger;
+  struct _SignalIOTriggerData* readTrigger;
+  double lastTriggerValue;
+  uint64_t triggerCursor;
+  size_t preSamplesNumber;
+  size_t sweepLength;
+  uint64_t* pendingTriggersList;
+  size_t pendingTriggersStart;
+  size_t pendingTriggersNumber;
+  double* sweepTable;
+  double* meansTable;
+  double* deviationsTable;
+  size_t sweepsCount;
+  atomic_uint sequence;
+}
+SignalIOEnsembleData;
+
+typedef SignalIOEnsembleData* SignalIOEnsemble;
+
+typedef struct _SignalIOInterlockData
+{
+  SignalIOReader reader;
+  unsigned int channel;
+  SignalIOTask outputTask;
+  int condition;
+  double threshold;
+}
+SignalIOInterlockData;
+
+typedef SignalIOInterlockData* SignalIOInterlock;
+
+typedef struct _SignalIOGroupData
+{
+  SignalIOTask* tasksList;
+  size_t tasksNumber;
+  char** clockSourcesList;
+}
+SignalIOGroupData;
+
+typedef SignalIOGroupData* SignalIOGroup;
+
 KHASH_MAP_INIT_INT( TaskInt, SignalIOTask )
 static khash_t( TaskInt )* tasksList = NULL;
 
+KHASH_MAP_INIT_INT( ReaderInt, SignalIOReader )
+static khash_t( ReaderInt )* readersList = NULL;
+static int lastReaderKey = 0;
+
+KHASH_MAP_INIT_INT( EnsembleInt, SignalIOEnsemble )
+static khash_t( EnsembleInt )* ensemblesList = NULL;
+static int lastEnsembleKey = 0;
+
+KHASH_MAP_INIT_INT( InterlockInt, SignalIOInterlock )
+static khash_t( InterlockInt )* interlocksList = NULL;
+static int lastInterlockKey = 0;
+
+KHASH_MAP_INIT_INT( GroupInt, SignalIOGroup )
+static khash_t( GroupInt )* groupsList = NULL;
+static int lastGroupKey = 0;
+
 DECLARE_MODULE_INTERFACE( SIGNAL_IO_INTERFACE ) 
+DECLARE_MODULE_INTERFACE( SIGNAL_IO_INTERFACE_V2 ) 
+
+// Optional features, only exposed through the version 2 functions table
+static bool SetAdaptiveInput( long int, size_t );
+static size_t GetInputBlockLength( long int, double* );
+static double GetResumeLatency( long int, double* );
+static size_t ReadAll( long int, double* );
+static size_t ReadAtTime( long int, const unsigned int*, size_t, const double*, size_t, int, double* );
+static long int AcquireResampledInput( long int, double );
+static size_t ReadResampled( long int, size_t, double*, double* );
+static void ReleaseResampledInput( long int );
+static bool DumpRecording( long int, const char* );
+static size_t ReadMarkers( long int, uint64_t*, SignalIOMarker*, size_t );
+static bool SetInputFilter( long int, unsigned int, size_t, double );
+static bool SetEMGFeatures( long int, double, double, double );
+static size_t ReadEMGFeatures( long int, uint64_t*, double*, double*, size_t );
+static long int AcquireEnsembleAverage( long int, const unsigned int*, size_t, double, double );
+static bool SetEnsembleTrigger( long int, int, long int, unsigned int, double );
+static size_t ReadEnsembleAverage( long int, double*, double* );
+static void ReleaseEnsembleAverage( long int );
+static bool Tare( long int, uint64_t, double );
+static unsigned int WaitEvents( long int, bool );
+static size_t ReadEdges( long int, uint64_t*, SignalIOEdge*, size_t );
+static long int AddInterlock( long int, unsigned int, int, double, long int );
+static void RemoveInterlock( long int );
+static double GetInterlockLatency( long int, double* );
+static bool SetOutputInterpolation( long int, int, double );
+static bool SetOutputPacing( long int, double, double );
+static bool SetOutputWaveform( long int, const double*, size_t );
+static bool OpenOutputMailbox( long int );
+static long int CreateOutputGroup( const long int*, size_t );
+static bool CommitOutputGroup( long int, const double* );
+static void ReleaseOutputGroup( long int );
 
 static void* AsyncReadBuffer( void* );
 static void* AsyncWriteBuffer( void* );
+static void* AsyncDumpRecording( void* );
 
 static SignalIOTask LoadTaskData( const char* );
+static bool LoadVirtualChannels( SignalIOTask, const char* );
+static void LoadCounterChannels( SignalIOTask );
+static SignalIOTask LoadViewData( const char* );
 static void UnloadTaskData( SignalIOTask );
 
+static SignalIOTask GetTask( long int );
+static SignalIOTask GetTaskChannel( long int, unsigned int* );
+static SignalIOTask MapTaskChannel( SignalIOTask, unsigned int* );
+
+static SignalIOReader LoadReaderData( SignalIOTask, const unsigned int*, size_t, double );
+static size_t ReadReaderSamples( SignalIOReader, double*, double* );
+static void UpdateReaderTiming( SignalIOReader, size_t, double );
+static void CheckReaderDeadlines( SignalIOTask );
+static size_t GetHistogramBin( uint64_t );
+static void UnloadReaderData( SignalIOReader );
+static void UnloadGroupData( SignalIOGroup );
+
+static size_t ReadChannel( SignalIOTask, unsigned int, double*, double* );
+static bool AcquireInput( SignalIOTask, unsigned int );
+static void ReleaseInput( SignalIOTask, unsigned int );
+static bool WriteChannel( SignalIOTask, unsigned int, double );
+static bool AcquireOutput( SignalIOTask, unsigned int );
+static void ReleaseOutput( SignalIOTask, unsigned int );
+
+static SignalIOTaskHandle Task_Open( const char* );
+static void Task_Close( SignalIOTaskHandle );
+static size_t Task_GetMaxInputSamplesNumber( SignalIOTaskHandle );
+static SignalIOReaderHandle Task_AcquireReader( SignalIOTaskHandle, unsigned int, unsigned int );
+static bool Task_AcquireOutputChannel( SignalIOTaskHandle, unsigned int );
+static bool Task_Write( SignalIOTaskHandle, unsigned int, double );
+static void Task_ReleaseOutputChannel( SignalIOTaskHandle, unsigned int );
+static size_t Reader_Read( SignalIOReaderHandle, double*, double* );
+static void Reader_Release( SignalIOReaderHandle );
+static bool Task_Mark( SignalIOTaskHandle, unsigned int, double );
+static size_t Reader_ReadMarkers( SignalIOReaderHandle, SignalIOMarker*, size_t );
+static bool Reader_GetStatus( SignalIOReaderHandle, uint64_t*, uint64_t* );
+static bool Reader_SetDeadline( SignalIOReaderHandle, double, double );
+static bool Reader_GetTiming( SignalIOReaderHandle, SignalIOReaderTiming* );
+static long int Task_GetID( SignalIOTaskHandle );
+
+static const SignalIOInterfaceV2 INTERFACE_V2 = { SIGNAL_IO_INTERFACE_VERSION, sizeof(SignalIOInterfaceV2),
+                                                  SIGNAL_IO_CAP_BLOCK_READ | SIGNAL_IO_CAP_TIMESTAMPS | SIGNAL_IO_CAP_RESAMPLING | SIGNAL_IO_CAP_TIME_QUERY 
+                                                  | SIGNAL_IO_CAP_VIEWS | SIGNAL_IO_CAP_ADAPTIVE_BLOCKS | SIGNAL_IO_CAP_RECORDER | SIGNAL_IO_CAP_MARKERS 
+                                                  | SIGNAL_IO_CAP_FILTERS | SIGNAL_IO_CAP_EMG_FEATURES | SIGNAL_IO_CAP_ENSEMBLES | SIGNAL_IO_CAP_TARE | SIGNAL_IO_CAP_VIRTUAL_CHANNELS 
+                                                  | SIGNAL_IO_CAP_INTERPOLATION | SIGNAL_IO_CAP_REGENERATION | SIGNAL_IO_CAP_COUNTER_OUTPUTS 
+                                                  | SIGNAL_IO_CAP_WATCHDOG | SIGNAL_IO_CAP_CHANGE_DETECTION | SIGNAL_IO_CAP_INTERLOCKS 
+                                                  | SIGNAL_IO_CAP_OUTPUT_GROUPS | SIGNAL_IO_CAP_MAILBOX | SIGNAL_IO_CAP_READER_POLICIES 
+                                                  | SIGNAL_IO_CAP_READER_DEADLINES | SIGNAL_IO_CAP_PAUSE,
+                                                  Task_Open, Task_Close, Task_GetMaxInputSamplesNumber, Task_AcquireReader, Reader_Read, Reader_Release,
+                                                  Task_AcquireOutputChannel, Task_Write, Task_ReleaseOutputChannel, Task_Mark, Reader_ReadMarkers,
+                                                  Reader_GetStatus, Reader_SetDeadline, Reader_GetTiming, Task_GetID, 
+                                                  SetAdaptiveInput, GetInputBlockLength, GetResumeLatency, ReadAll, ReadAtTime, 
+                                                  AcquireResampledInput, ReadResampled, ReleaseResampledInput, DumpRecording, ReadMarkers, 
+                                                  SetInputFilter, SetEMGFeatures, ReadEMGFeatures, 
+                                                  AcquireEnsembleAverage, SetEnsembleTrigger, ReadEnsembleAverage, ReleaseEnsembleAverage, 
+                                                  Tare, WaitEvents, ReadEdges, AddInterlock, RemoveInterlock, GetInterlockLatency, 
+                                                  SetOutputInterpolation, SetOutputPacing, SetOutputWaveform, OpenOutputMailbox, 
+                                                  CreateOutputGroup, CommitOutputGroup, ReleaseOutputGroup };
+
 static bool CheckTask( SignalIOTask );
+static bool HasTaskUses( SignalIOTask );
+static bool HasChannelUses( SignalIOTask );
+static bool WaitTaskIdle( SignalIOTask );
+static void WaitGroupArmed( SignalIOTask );
+static bool LinkGroupTiming( SignalIOGroup );
+static void UnlinkGroupTiming( SignalIOGroup, size_t );
+static void PushOutputCommand( SignalIOTask, double, const double* );
+static void ApplyGroupFrame( SignalIOTask );
+static void MergeMailbox( SignalIOTask, SignalMailbox );
+static void ApplyMailboxValues( SignalIOTask, double*, size_t );
+static void ResumeTask( SignalIOTask );
+static bool SyncTaskState( SignalIOTask );
+static void InitVersion( SignalIOVersion* );
+static unsigned int PublishVersion( SignalIOVersion* );
+static bool SyncVersion( SignalIOVersion*, void (*)( SignalIOTask ), SignalIOTask );
+static void WaitVersion( SignalIOTask, SignalIOVersion*, unsigned int );
+static void UpdateResumeLatency( SignalIOTask );
+static void UpdateReadChannels( SignalIOTask );
+static bool IsVirtualOperand( SignalIOTask, unsigned int );
+static void EvaluateVirtualChannels( SignalIOTask, size_t, size_t, size_t );
+static void UpdateReadFilters( SignalIOTask );
+static void FilterReadFrames( SignalIOTask, size_t );
+static int ReadLineSamples( SignalIOTask, int32* );
+static void DetectEdges( SignalIOTask, size_t );
+static void UpdateReadInterlocks( SignalIOTask );
+static void EvaluateInterlocks( SignalIOTask, uint64_t, size_t );
+static void TripInterlock( SignalIOTask, SignalIOTask, uint64_t );
+static void UpdateInterlockState( SignalIOTask );
+static void MeasureInterlockLatency( SignalIOTask );
+static void UpdateReadFeatures( SignalIOTask );
+static void UpdateReadTare( SignalIOTask );
+static void StartReadTare( SignalIOTask );
+static void CalibrateReadFrames( SignalIOTask, size_t );
+static void SignalTaskEvents( SignalIOTask, unsigned int );
+static void AccumulateFeatures( SignalIOTask, uint64_t, size_t );
+static void PublishFeatures( SignalIOTask, uint64_t );
+static void UpdateReadEnsembles( SignalIOTask );
+static void ProcessEnsembles( SignalIOTask );
+static void DetectTriggers( SignalIOTask, SignalIOEnsemble );
+static void AddTrigger( SignalIOEnsemble, uint64_t );
+static void UnloadEnsembleData( SignalIOEnsemble );
+static void UnloadTriggerData( SignalIOTrigger );
+static SignalIOEnsemble GetEnsemble( long int );
+static void PublishBlock( SignalIOTask, size_t );
+static size_t AdaptBlockLength( SignalIOTask );
+
+static double GetMonotonicTime( void );
+static double GetSampleTime( SignalIOTask, double );
+static double GetDetectionTime( SignalIOTask, uint64_t );
+static double GetClockOffset( SignalIOTask );
+static bool CopyHistorySamples( SignalIOTask, unsigned int, uint64_t, size_t, double* );
+
+static bool DumpTaskRecording( SignalIOTask, const char*, const char* );
+static bool MarkTask( SignalIOTask, unsigned int, double );
+static size_t ReadTaskMarkers( SignalIOTask, uint64_t*, SignalIOMarker*, size_t );
+static void UpdateFaultState( SignalIOTask, bool );
+
+static void PrepareOutputBuffer( SignalIOTask );
+static int WriteInterpolatedBlock( SignalIOTask );
+static int UpdateOutputWaveform( SignalIOTask );
+static bool IsWaveformActive( SignalIOTask );
+static bool IsOutputActive( SignalIOTask );
+static int WriteOnDemandValues( SignalIOTask );
+static int WriteCounterValues( SignalIOTask, const double* );
+static void UpdateWatchdog( SignalIOTask );
+static void WaitTime( double );
+static void UpdateWritePacing( SignalIOTask );
+static void UpdateWriteInterpolation( SignalIOTask );
+static void ReadOutputCommands( SignalIOTask );
+static void AddOutputKnot( SignalIOTask, double, const double* );
+static void GetOutputWeights( SignalIOTask, double, const double**, double* );
 
-long int InitDevice( const char* taskName )
+long int InitDevice( const char* taskConfig )
 {
   if( tasksList == NULL ) tasksList = kh_init( TaskInt );
   
+  if( Kernels.DotProduct == NULL ) Kernels_Bind( -1 );
+  
+  // Views over a loaded task are configured as "[<view name>=]<task name>:<channel>,<channel>,..."
+  // Named views are keyed only by their name, so that they could be later retrieved with it
+  // Input tasks may define virtual channels as "<task name>|<expression>|<expression>|...", when first loaded
+  bool isView = ( strchr( taskConfig, ':' ) != NULL );
+  char taskName[ TASK_NAME_MAX_LENGTH ];
+  size_t taskNameLength = isView ? strcspn( taskConfig, "=:" ) : strcspn( taskConfig, "|" );
+  if( isView && taskConfig[ taskNameLength ] != '=' ) taskNameLength = strlen( taskConfig );
+  snprintf( taskName, TASK_NAME_MAX_LENGTH, "%.*s", (int) taskNameLength, taskConfig );
+  
   int taskKey = (int) kh_str_hash_func( taskName );
   
-  int insertionStatus;
-  khint_t newTaskIndex = kh_put( TaskInt, tasksList, taskKey, &insertionStatus );
-  if( insertionStatus > 0 )
+  khint_t newTaskIndex = kh_get( TaskInt, tasksList, taskKey );
+  if( newTaskIndex == kh_end( tasksList ) )
   {
-    kh_value( tasksList, newTaskIndex ) = LoadTaskData( taskName );
-    if( kh_value( tasksList, newTaskIndex ) == NULL )
+    // Views may load their physical task first, so the new entry is only inserted afterwards
+    SignalIOTask newTask = isView ? LoadViewData( taskConfig ) : LoadTaskData( taskConfig );
+    if( newTask == NULL )
     {
-      //DEBUG_PRINT( "loading task %s failed", taskName );
-      EndDevice( taskKey ); 
+      //DEBUG_PRINT( "loading task %s failed", taskConfig );
       return -1;
     }
+    
+    int insertionStatus;
+    newTaskIndex = kh_put( TaskInt, tasksList, taskKey, &insertionStatus );
+    kh_value( tasksList, newTaskIndex ) = newTask;
+    newTask->taskID = taskKey;
         
     //DEBUG_PRINT( "new key %d inserted (iterator: %u - total: %u)", kh_key( tasksList, newTaskIndex ), newTaskIndex, kh_size( tasksList ) );
   }
-  //else if( insertionStatus == 0 ) { DEBUG_PRINT( "task key %d already exists (iterator %u)", taskKey, newTaskIndex ); }
+  else
+  {
+    // Views and tasks share the same names space: a view named after a loaded task (or the opposite) is rejected
+    SignalIOTask existingTask = kh_value( tasksList, newTaskIndex );
+    if( isView != ( existingTask->parentTask != NULL ) )
+    {
+      //DEBUG_PRINT( "name %s already taken by another task or view", taskName );
+      return -1;
+    }
+    // Tasks loaded along with some view are no longer ended with them once the client also loads them
+    existingTask->isLoadedByView = false;
+    //DEBUG_PRINT( "task key %d already exists (iterator %u)", taskKey, newTaskIndex );
+  }
   
   return (long int) kh_key( tasksList, newTaskIndex );
 }
@@ -99,13 +645,24 @@ void EndDevice( long int taskID )
   
   SignalIOTask task = kh_value( tasksList, taskIndex );
   
-  if( CheckTask( task ) ) return;
+  // Tasks could only be unloaded once no views, interlock rules, ensemble triggers or output groups refer to them
+  if( task->viewsCount > 0 || atomic_load( &(task->interlocksCount) ) > 0 || atomic_load( &(task->triggersCount) ) > 0 ) return;
+  if( task->outputGroup != NULL ) return;
+  
+  if( task->parentTask == NULL )
+  {
+    if( CheckTask( task ) ) return;
+  }
+  
+  SignalIOTask parentTask = task->parentTask;
   
   UnloadTaskData( task );
   
-  kh_del( TaskInt, tasksList, (khint_t) taskID );
+  kh_del( TaskInt, tasksList, taskIndex );
   
-  if( kh_size( tasksList ) == 0 )
+  // Physical tasks loaded along with a view are ended with the last view over them
+  if( parentTask != NULL && parentTask->isLoadedByView && parentTask->viewsCount == 0 ) EndDevice( parentTask->taskID );
+  else if( kh_size( tasksList ) == 0 )
   {
     kh_destroy( TaskInt, tasksList );
     tasksList = NULL;
@@ -114,7 +671,16 @@ void EndDevice( long int taskID )
 
 void Reset( long int taskID )
 {
-  return;
+  SignalIOTask task = GetTask( taskID );
+  if( task == NULL ) return;
+  if( task->parentTask != NULL ) task = task->parentTask;
+  
+  // Interlock trips are latched until cleared here (tripping again if the rule condition still holds)
+  if( task->mode == WRITE && atomic_exchange( &(task->interlockTripTime), 0 ) != 0 )
+  {
+    atomic_store( &(task->isOutputDirty), true );
+    if( task->resumeLock != NULL ) Sem_SetCount( task->resumeLock, 1 );
+  }
 }
 
 bool HasError( long int taskID )
@@ -124,256 +690,3309 @@ bool HasError( long int taskID )
 
 size_t GetMaxInputSamplesNumber( long int taskID )
 {
-  khint_t taskIndex = kh_get( TaskInt, tasksList, (khint_t) taskID );
-  if( taskIndex == kh_end( tasksList ) ) return 0;
-  
-  SignalIOTask task = kh_value( tasksList, taskIndex );
-  
-  if( task->mode == WRITE ) return 0;
+  SignalIOTask task = GetTask( taskID );
+  if( task == NULL ) return 0;
   
-  return AQUISITION_BUFFER_LENGTH;
+  return Task_GetMaxInputSamplesNumber( task );
 }
 
-size_t Read( long int taskID, unsigned int channel, double* channelSamplesList )
+bool SetAdaptiveInput( long int taskID, size_t maxBlockLength )
 {
-  khint_t taskIndex = kh_get( TaskInt, tasksList, (khint_t) taskID );
-  if( taskIndex == kh_end( tasksList ) ) return 0;
+  SignalIOTask task = GetTask( taskID );
+  if( task == NULL ) return false;
+  if( task->parentTask != NULL ) task = task->parentTask;
   
-  SignalIOTask task = kh_value( tasksList, taskIndex );
+  if( task->mode == WRITE ) return false;
+  
+  if( maxBlockLength > AQUISITION_BUFFER_MAX_LENGTH || task->samplingRate <= 0.0 ) return false;
   
-  if( channel >= task->channelsNumber ) return 0;
+  atomic_store( &(task->maxBlockLength), maxBlockLength );
   
-  if( !task->isRunning ) return 0;
+  return true;
+}
+
+size_t GetInputBlockLength( long int taskID, double* ref_averageLength )
+{
+  SignalIOTask task = GetTask( taskID );
+  if( task == NULL ) return 0;
+  if( task->parentTask != NULL ) task = task->parentTask;
   
   if( task->mode == WRITE ) return 0;
   
-  //Sem_Decrement( task->channelLocksList[ channel ] );
+  uint64_t blocksCount = atomic_load( &(task->blocksCount) );
+  if( blocksCount == 0 ) return 0;
   
-  size_t channelAcquiredSamplesCount = (size_t) task->channelValuesList[ channel ];
-  memcpy( channelSamplesList, task->samplesList + channel * channelAcquiredSamplesCount, channelAcquiredSamplesCount * sizeof(double) );
+  if( ref_averageLength != NULL )
+  {
+    uint64_t firstBlock = ( blocksCount > CLOCK_FIT_BLOCKS_NUMBER ) ? blocksCount - CLOCK_FIT_BLOCKS_NUMBER : 0;
+    size_t samplesNumber = 0;
+    for( uint64_t blockIndex = firstBlock; blockIndex < blocksCount; blockIndex++ )
+      samplesNumber += task->blocksList[ blockIndex % HISTORY_BLOCKS_NUMBER ].samplesNumber;
+    *ref_averageLength = (double) samplesNumber / ( blocksCount - firstBlock );
+  }
   
-  return channelAcquiredSamplesCount;
+  return task->blocksList[ ( blocksCount - 1 ) % HISTORY_BLOCKS_NUMBER ].samplesNumber;
 }
 
-bool CheckInputChannel( long int taskID, unsigned int channel )
+double GetResumeLatency( long int taskID, double* ref_maxLatency )
 {
-  khint_t taskIndex = kh_get( TaskInt, tasksList, (khint_t) taskID );
-  if( taskIndex == kh_end( tasksList ) ) return false;
-  
-  SignalIOTask task = kh_value( tasksList, taskIndex );
+  SignalIOTask task = GetTask( taskID );
+  if( task == NULL ) return 0.0;
+  if( task->parentTask != NULL ) task = task->parentTask;
   
-  if( task->mode == WRITE ) return false;
-  
-  if( channel > task->channelsNumber ) return false;
+  if( ref_maxLatency != NULL ) *ref_maxLatency = atomic_load( &(task->maxResumeLatency) ) / 1e6;
   
-  if( task->channelUsesList[ channel ] >= SIGNAL_INPUT_CHANNEL_MAX_USES ) return false;
-  
-  task->channelUsesList[ channel ]++;
+  return atomic_load( &(task->resumeLatency) ) / 1e6;
+}
+
+double GetInterlockLatency( long int taskID, double* ref_maxLatency )
+{
+  SignalIOTask task = GetTask( taskID );
+  if( task == NULL ) return 0.0;
+  if( task->parentTask != NULL ) task = task->parentTask;
   
-  if( !task->isRunning ) task->threadID = Thread_Start( AsyncReadBuffer, task, THREAD_JOINABLE );
+  if( ref_maxLatency != NULL ) *ref_maxLatency = atomic_load( &(task->maxInterlockLatency) ) / 1e6;
   
-  return true;
+  return atomic_load( &(task->interlockLatency) ) / 1e6;
 }
 
-bool Write( long int taskID, unsigned int channel, double value )
+long int AddInterlock( long int inputTaskID, unsigned int inputChannel, int condition, double threshold, long int outputTaskID )
 {
-  khint_t taskIndex = kh_get( TaskInt, tasksList, (khint_t) taskID );
-  if( taskIndex == kh_end( tasksList ) ) return false;
+  SignalIOTask inputTask = GetTask( inputTaskID );
+  SignalIOTask outputTask = GetTask( outputTaskID );
+  if( inputTask == NULL || outputTask == NULL ) return -1;
+  if( outputTask->parentTask != NULL ) outputTask = outputTask->parentTask;
   
-  SignalIOTask task = kh_value( tasksList, taskIndex );
+  if( outputTask->mode == READ ) return -1;
+  if( condition != SIGNAL_IO_INTERLOCK_ABOVE && condition != SIGNAL_IO_INTERLOCK_BELOW ) return -1;
   
-  if( !task->isRunning ) return false;
+  // Monitored channel is kept in aquisition while the rule exists
+  SignalIOInterlock newInterlock = (SignalIOInterlock) calloc( 1, sizeof(SignalIOInterlockData) );
+  newInterlock->reader = LoadReaderData( inputTask, &inputChannel, 1, 0.0 );
+  if( newInterlock->reader == NULL )
+  {
+    free( newInterlock );
+    return -1;
+  }
+  newInterlock->channel = newInterlock->reader->channelsList[ 0 ];
+  newInterlock->outputTask = outputTask;
+  newInterlock->condition = condition;
+  newInterlock->threshold = threshold;
   
-  if( task->mode == READ ) return false;
+  // Rules lists are only locked among client threads: aquisition threads take copies of them, on version changes
+  inputTask = newInterlock->reader->task;
+  Sem_Decrement( inputTask->interlocksLock );
+  size_t interlocksNumber = inputTask->interlocksNumber;
+  if( interlocksNumber < INTERLOCKS_MAX_NUMBER )
+  {
+    inputTask->interlocksList[ inputTask->interlocksNumber++ ] = newInterlock;
+    atomic_fetch_add( &(outputTask->interlocksCount), 1 );
+    PublishVersion( &(inputTask->interlocksVersion) );
+  }
+  Sem_Increment( inputTask->interlocksLock );
+  if( interlocksNumber >= INTERLOCKS_MAX_NUMBER )
+  {
+    UnloadReaderData( newInterlock->reader );
+    free( newInterlock );
+    return -1;
+  }
   
-  if( channel > task->channelsNumber ) return false;
+  if( interlocksList == NULL ) interlocksList = kh_init( InterlockInt );
+  int insertionStatus;
+  khint_t newInterlockIndex = kh_put( InterlockInt, interlocksList, ++lastInterlockKey, &insertionStatus );
+  kh_value( interlocksList, newInterlockIndex ) = newInterlock;
   
-  //Sem_Decrement( task->channelLocksList[ 0 ] );
+  return (long int) kh_key( interlocksList, newInterlockIndex );
+}
+
+void RemoveInterlock( long int interlockID )
+{
+  if( interlocksList == NULL ) return;
+  khint_t interlockIndex = kh_get( InterlockInt, interlocksList, (khint_t) interlockID );
+  if( interlockIndex == kh_end( interlocksList ) ) return;
   
-  task->channelValuesList[ channel ] = value;
+  SignalIOInterlock interlock = kh_value( interlocksList, interlockIndex );
+  SignalIOTask inputTask = interlock->reader->task;
   
-  //Sem_SetCount( task->channelLocksList[ 0 ], 1 );
+  Sem_Decrement( inputTask->interlocksLock );
+  for( size_t ruleIndex = 0; ruleIndex < inputTask->interlocksNumber; ruleIndex++ )
+  {
+    if( inputTask->interlocksList[ ruleIndex ] == interlock )
+    {
+      inputTask->interlocksList[ ruleIndex ] = inputTask->interlocksList[ --inputTask->interlocksNumber ];
+      break;
+    }
+  }
+  unsigned int interlocksVersion = PublishVersion( &(inputTask->interlocksVersion) );
+  Sem_Increment( inputTask->interlocksLock );
   
-  return true;
+  // Rule is only freed (and its output task released) once the aquisition thread no longer uses its copy of it.
+  // Threads being paused still evaluate the copy until they stop processing, so the task state is not enough here
+  WaitVersion( inputTask, &(inputTask->interlocksVersion), interlocksVersion );
+  
+  atomic_fetch_sub( &(interlock->outputTask->interlocksCount), 1 );
+  UnloadReaderData( interlock->reader );
+  free( interlock );
+  
+  kh_del( InterlockInt, interlocksList, interlockIndex );
+  if( kh_size( interlocksList ) == 0 )
+  {
+    kh_destroy( InterlockInt, interlocksList );
+    interlocksList = NULL;
+  }
 }
 
-bool AcquireOutputChannel( long int taskID, unsigned int channel )
+bool SetInputFilter( long int taskID, unsigned int channel, size_t windowLength, double threshold )
 {
-  khint_t taskIndex = kh_get( TaskInt, tasksList, (khint_t) taskID );
-  if( taskIndex == kh_end( tasksList ) ) return false;
+  SignalIOTask task = GetTaskChannel( taskID, &channel );
+  if( task == NULL ) return false;
   
-  //DEBUG_PRINT( "aquiring channel %u from task %d", channel, taskID );
+  if( task->mode == WRITE ) return false;
   
-  SignalIOTask task = kh_value( tasksList, taskIndex );
+  // Virtual channels are computed from already filtered device channels
+  if( channel >= task->deviceChannelsNumber ) return false;
   
-  if( task->mode == READ ) return false;
+  if( windowLength > 0 && ( windowLength < 3 || windowLength > KERNEL_FILTER_MAX_WINDOW || windowLength % 2 == 0 ) ) return false;
+  if( threshold < 0.0 ) return false;
   
-  if( channel > task->channelsNumber ) return false;
+  // Settings are only locked among client threads: the aquisition thread takes a copy of the published ones, on version changes
+  Sem_Decrement( task->filtersLock );
+  SignalIOFilterSettingsData* filterSettings = atomic_load( &(task->filterSettings) );
   
-  if( task->channelUsesList[ channel ] == 1 ) return false;
+  // Filtered channels are processed together, so they have to share the same window length
+  size_t filteredChannelsNumber = 0;
+  for( unsigned int filteredChannel = 0; filteredChannel < task->channelsNumber; filteredChannel++ )
+  {
+    if( filteredChannel != channel && isfinite( filterSettings->thresholdsList[ filteredChannel ] ) ) filteredChannelsNumber++;
+  }
+  if( windowLength > 0 && filteredChannelsNumber > 0 && windowLength != filterSettings->windowLength )
+  {
+    Sem_Increment( task->filtersLock );
+    return false;
+  }
   
-  task->channelUsesList[ channel ] = 1;
+  SignalIOFilterSettingsData* newFilterSettings = (SignalIOFilterSettingsData*) malloc( sizeof(SignalIOFilterSettingsData) + task->channelsNumber * sizeof(double) );
+  memcpy( newFilterSettings->thresholdsList, filterSettings->thresholdsList, task->channelsNumber * sizeof(double) );
+  newFilterSettings->thresholdsList[ channel ] = ( windowLength > 0 ) ? threshold * KERNEL_HAMPEL_MAD_SCALE : INFINITY;
+  if( windowLength > 0 ) newFilterSettings->windowLength = windowLength;
+  else newFilterSettings->windowLength = ( filteredChannelsNumber > 0 ) ? filterSettings->windowLength : 0;
+  atomic_store( &(task->filterSettings), newFilterSettings );
+  unsigned int filtersVersion = PublishVersion( &(task->filtersVersion) );
+  Sem_Increment( task->filtersLock );
   
-  if( !task->isRunning ) task->threadID = Thread_Start( AsyncWriteBuffer, task, THREAD_JOINABLE );
+  // Replaced settings are only freed once the aquisition thread no longer copies from them
+  WaitVersion( task, &(task->filtersVersion), filtersVersion );
+  free( filterSettings );
   
   return true;
 }
 
-void ReleaseOutputChannel( long int taskID, unsigned int channel )
+bool SetEMGFeatures( long int taskID, double windowDuration, double incrementDuration, double threshold )
 {
-  khint_t taskIndex = kh_get( TaskInt, tasksList, (khint_t) taskID );
-  if( taskIndex == kh_end( tasksList ) ) return;
+  SignalIOTask task = GetTask( taskID );
+  if( task == NULL ) return false;
+  if( task->parentTask != NULL ) task = task->parentTask;
   
-  SignalIOTask task = kh_value( tasksList, taskIndex );
+  if( task->mode == WRITE || task->samplingRate <= 0.0 ) return false;
   
-  if( !task->isRunning ) return;
+  size_t windowLength = (size_t) round( windowDuration * task->samplingRate );
+  size_t increment = (size_t) round( incrementDuration * task->samplingRate );
+  if( windowDuration > 0.0 && ( windowLength < 2 || windowLength > task->historyLength || increment == 0 ) ) return false;
   
-  if( channel > task->channelsNumber ) return;
+  SignalIOFeatureTermsData* newFeatureTerms = NULL;
+  if( windowDuration > 0.0 )
+  {
+    newFeatureTerms = (SignalIOFeatureTermsData*) malloc( sizeof(SignalIOFeatureTermsData) + windowLength * KERNEL_TERMS_NUMBER * task->channelsNumber * sizeof(double) );
+    newFeatureTerms->windowLength = windowLength;
+    newFeatureTerms->increment = increment;
+    newFeatureTerms->threshold = threshold;
+  }
   
-  task->channelUsesList[ channel ] = 0;
+  // Settings are published whole with their terms ring, and the replaced one is only freed once the aquisition thread switched to the new one
+  SignalIOFeatureTermsData* oldFeatureTerms = atomic_exchange( &(task->featureTerms), newFeatureTerms );
+  WaitVersion( task, &(task->featuresVersion), PublishVersion( &(task->featuresVersion) ) );
+  if( oldFeatureTerms != NULL ) free( oldFeatureTerms );
   
-  (void) CheckTask( task );
+  return true;
 }
 
-
-
-static void* AsyncReadBuffer( void* callbackData )
+size_t ReadEMGFeatures( long int taskID, uint64_t* ref_cursor, double* featuresTable, double* timestampsList, size_t maxWindowsNumber )
 {
-  SignalIOTask task = (SignalIOTask) callbackData;
-  
-  int32 aquiredSamplesCount;
+  SignalIOTask task = GetTask( taskID );
+  if( task == NULL || ref_cursor == NULL ) return 0;
+  SignalIOTask physicalTask = ( task->parentTask != NULL ) ? task->parentTask : task;
   
-  task->isRunning = true;
+  if( physicalTask->mode == WRITE ) return 0;
   
-  //DEBUG_PRINT( "initializing read thread %lx", THREAD_ID );
+  // Slot of the oldest stored window is the next one to be overwritten, so it is skipped too
+  uint64_t windowsCount = atomic_load( &(physicalTask->featureWindowsCount) );
+  if( *ref_cursor > windowsCount || windowsCount - *ref_cursor >= FEATURE_WINDOWS_NUMBER )
+    *ref_cursor = ( windowsCount >= FEATURE_WINDOWS_NUMBER ) ? windowsCount - FEATURE_WINDOWS_NUMBER + 1 : 0;
   
-  while( task->isRunning )
+  // Windows are stored with all physical channels features, from which the (view) task ones are taken
+  size_t windowStride = 1 + physicalTask->channelsNumber * SIGNAL_IO_EMG_FEATURES_NUMBER;
+  size_t windowsNumber = 0;
+  while( *ref_cursor < windowsCount && windowsNumber < maxWindowsNumber )
   {
-    int errorCode = DAQmxReadAnalogF64( task->handle, AQUISITION_BUFFER_LENGTH, DAQmx_Val_WaitInfinitely, DAQmx_Val_GroupByChannel, 
-                                        task->samplesList, task->channelsNumber * AQUISITION_BUFFER_LENGTH, &aquiredSamplesCount, NULL );
-
-    if( errorCode < 0 )
-    {
-      static char errorMessage[ DEBUG_MESSAGE_LENGTH ];
-      DAQmxGetErrorString( errorCode, errorMessage, DEBUG_MESSAGE_LENGTH );
-    }
-    else
+    const double* window = physicalTask->featureWindowsList + ( *ref_cursor % FEATURE_WINDOWS_NUMBER ) * windowStride;
+    double* featuresList = featuresTable + windowsNumber * task->channelsNumber * SIGNAL_IO_EMG_FEATURES_NUMBER;
+    for( unsigned int channel = 0; channel < task->channelsNumber; channel++ )
     {
-      for( unsigned int channel = 0; channel < task->channelsNumber; channel++ )
-      {
-        task->channelValuesList[ channel ] = (double) aquiredSamplesCount;
-        
-        //Sem_SetCount( task->channelLocksList[ channel ], task->channelUsesList[ channel ] );
-      }
+      unsigned int physicalChannel = ( task->parentTask != NULL ) ? task->viewChannelsList[ channel ] : channel;
+      memcpy( featuresList + channel * SIGNAL_IO_EMG_FEATURES_NUMBER, window + 1 + physicalChannel * SIGNAL_IO_EMG_FEATURES_NUMBER, 
+              SIGNAL_IO_EMG_FEATURES_NUMBER * sizeof(double) );
     }
+    if( timestampsList != NULL ) timestampsList[ windowsNumber ] = window[ 0 ];
+    // Windows whose slot could have been reused while copying them are dropped
+    atomic_thread_fence( memory_order_acquire );
+    if( atomic_load( &(physicalTask->featureWindowsCount) ) - *ref_cursor < FEATURE_WINDOWS_NUMBER ) windowsNumber++;
+    (*ref_cursor)++;
   }
   
-  //DEBUG_PRINT( "ending aquisition thread %x", THREAD_ID );
-  
-  return NULL;
+  return windowsNumber;
 }
 
-static void* AsyncWriteBuffer( void* callbackData )
+size_t ReadEdges( long int taskID, uint64_t* ref_cursor, SignalIOEdge* edgesList, size_t maxEdgesNumber )
 {
-  SignalIOTask task = (SignalIOTask) callbackData;
+  SignalIOTask task = GetTask( taskID );
+  if( task == NULL || ref_cursor == NULL ) return 0;
+  SignalIOTask physicalTask = ( task->parentTask != NULL ) ? task->parentTask : task;
   
-  int32 writtenSamplesCount;
+  if( !physicalTask->isChangeDetection ) return 0;
   
-  task->isRunning = true;
+  // Slot of the oldest stored edge is the next one to be overwritten, so it is skipped too
+  uint64_t edgesCount = atomic_load( &(physicalTask->edgesCount) );
+  if( *ref_cursor > edgesCount || edgesCount - *ref_cursor >= EDGES_NUMBER )
+    *ref_cursor = ( edgesCount >= EDGES_NUMBER ) ? edgesCount - EDGES_NUMBER + 1 : 0;
   
-  while( task->isRunning )
+  size_t edgesNumber = 0;
+  while( *ref_cursor < edgesCount && edgesNumber < maxEdgesNumber )
   {
-    //Sem_Decrement( task->channelLocksList[ 0 ] );
-    
-    int errorCode = DAQmxWriteAnalogF64( task->handle, 1, 0, 0.1, DAQmx_Val_GroupByChannel, task->channelValuesList, &writtenSamplesCount, NULL );
-    if( errorCode < 0 )
+    SignalIOEdge edge = physicalTask->edgesList[ *ref_cursor % EDGES_NUMBER ];
+    // Edges whose slot could have been reused while copying them are dropped
+    atomic_thread_fence( memory_order_acquire );
+    bool isValid = ( atomic_load( &(physicalTask->edgesCount) ) - *ref_cursor < EDGES_NUMBER );
+    (*ref_cursor)++;
+    if( !isValid ) continue;
+    // Edges of physical channels are reported with (view) task indexes, if present there
+    if( task->parentTask != NULL )
     {
-      static char errorMessage[ DEBUG_MESSAGE_LENGTH ];
-      DAQmxGetErrorString( errorCode, errorMessage, DEBUG_MESSAGE_LENGTH );
-      //DEBUG_PRINT( "error aquiring analog signal: %s", errorMessage );
+      unsigned int viewChannel = 0;
+      while( viewChannel < task->channelsNumber && task->viewChannelsList[ viewChannel ] != edge.channel ) viewChannel++;
+      if( viewChannel == task->channelsNumber ) continue;
+      edge.channel = viewChannel;
     }
-    
-    //Sem_SetCount( task->channelLocksList[ 0 ], 1 );
+    edgesList[ edgesNumber++ ] = edge;
   }
   
-  return NULL;
+  return edgesNumber;
 }
 
-bool CheckTask( SignalIOTask task )
+bool Tare( long int taskID, uint64_t channelMask, double duration )
 {
-  bool isStillUsed = false;
-  if( task->channelUsesList != NULL )
+  SignalIOTask task = GetTask( taskID );
+  if( task == NULL ) return false;
+  SignalIOTask physicalTask = ( task->parentTask != NULL ) ? task->parentTask : task;
+  
+  if( physicalTask->mode == WRITE || physicalTask->samplingRate <= 0.0 || duration <= 0.0 ) return false;
+  
+  // Channel bits are taken from the (view) task, and converted to physical channels ones
+  uint64_t tareChannelsMask = 0;
+  for( unsigned int channel = 0; channel < task->channelsNumber && channel < 64; channel++ )
   {
-    for( size_t channel = 0; channel < task->channelsNumber; channel++ )
-    {
-      if( task->channelUsesList[ channel ] > 0 )
-      {
-        isStillUsed = true;
-        break;
-      }
-    }
+    if( !( channelMask & ( (uint64_t) 1 << channel ) ) ) continue;
+    unsigned int physicalChannel = channel;
+    if( MapTaskChannel( task, &physicalChannel ) == NULL || physicalChannel >= physicalTask->deviceChannelsNumber || physicalChannel >= 64 ) return false;
+    tareChannelsMask |= ( (uint64_t) 1 << physicalChannel );
   }
+  if( tareChannelsMask == 0 ) return false;
   
-  if( !isStillUsed )
+  bool isTaring = false;
+  if( !atomic_compare_exchange_strong( &(physicalTask->isTaring), &isTaring, true ) ) return false;
+  
+  // Tared channels are kept in aquisition until their offsets are estimated
+  for( unsigned int channel = 0; channel < physicalTask->channelsNumber && channel < 64; channel++ )
   {
-    task->isRunning = false;
-    if( task->threadID != THREAD_INVALID_HANDLE ) Thread_WaitExit( task->threadID, 5000 );
+    if( tareChannelsMask & ( (uint64_t) 1 << channel ) ) (void) AcquireInput( physicalTask, channel );
   }
   
-  return isStillUsed;
+  physicalTask->tareChannelsMask = tareChannelsMask;
+  physicalTask->tareSamplesNumber = (size_t) fmax( round( duration * physicalTask->samplingRate ), 1.0 );
+  
+  PublishVersion( &(physicalTask->tareVersion) );
+  
+  return true;
 }
 
-SignalIOTask LoadTaskData( const char* taskName )
+unsigned int WaitEvents( long int taskID, bool isBlocking )
 {
-  bool loadError = false;
+  SignalIOTask task = GetTask( taskID );
+  if( task == NULL ) return 0;
+  if( task->parentTask != NULL ) task = task->parentTask;
   
-  SignalIOTask newTask = (SignalIOTask) malloc( sizeof(SignalIOTaskData) );
-  memset( newTask, 0, sizeof(SignalIOTask) );
+  unsigned int events;
+  while( ( events = atomic_exchange( &(task->eventsMask), 0 ) ) == 0 && isBlocking )
+    Sem_Decrement( task->eventsLock );
   
-  if( DAQmxLoadTask( taskName, &(newTask->handle) ) >= 0 )
+  return events;
+}
+
+size_t Read( long int taskID, unsigned int channel, double* channelSamplesList )
+{
+  SignalIOTask task = GetTaskChannel( taskID, &channel );
+  if( task == NULL ) return 0;
+  
+  return ReadChannel( task, channel, channelSamplesList, NULL );
+}
+
+size_t ReadAll( long int taskID, double* samplesTable )
+{
+  SignalIOTask task = GetTask( taskID );
+  if( task == NULL ) return 0;
+  
+  if( task->mode == WRITE ) return 0;
+  
+  // Task (and view mapping) resolved once for all channels
+  size_t maxSamplesNumber = Task_GetMaxInputSamplesNumber( task );
+  SignalIOTask physicalTask = ( task->parentTask != NULL ) ? task->parentTask : task;
+  
+  size_t acquiredSamplesCount = 0;
+  for( unsigned int channel = 0; channel < task->channelsNumber; channel++ )
   {
-    if( DAQmxGetTaskAttribute( newTask->handle, DAQmx_Task_NumChans, &(newTask->channelsNumber) ) >= 0 )
-    {
-      //DEBUG_PRINT( "%u signal channels found", newTask->channelsNumber );
+    unsigned int physicalChannel = ( task->parentTask != NULL ) ? task->viewChannelsList[ channel ] : channel;
+    size_t channelAcquiredSamplesCount = ReadChannel( physicalTask, physicalChannel, samplesTable + channel * maxSamplesNumber, NULL );
+    if( channelAcquiredSamplesCount > acquiredSamplesCount ) acquiredSamplesCount = channelAcquiredSamplesCount;
+  }
   
-      newTask->channelUsesList = (unsigned int*) calloc( newTask->channelsNumber, sizeof(unsigned int) );
-      memset( newTask->channelUsesList, 0, newTask->channelsNumber * sizeof(unsigned int) );
-      
-      newTask->samplesList = (float64*) calloc( newTask->channelsNumber * AQUISITION_BUFFER_LENGTH, sizeof(float64) );
-      newTask->channelValuesList = (double*) calloc( newTask->channelsNumber, sizeof(double) );
+  return acquiredSamplesCount;
+}
+
+size_t ReadAtTime( long int taskID, const unsigned int* channelsList, size_t channelsNumber, 
+                   const double* timestampsList, size_t timestampsNumber, int interpolation, double* valuesTable )
+{
+  SignalIOTask task = GetTask( taskID );
+  if( task == NULL ) return 0;
+  SignalIOTask physicalTask = ( task->parentTask != NULL ) ? task->parentTask : task;
+  
+  if( task->mode == WRITE ) return 0;
+  
+  if( atomic_load( &(physicalTask->state) ) != TASK_RUNNING || physicalTask->samplingRate <= 0.0 ) return 0;
   
-      if( DAQmxStartTask( newTask->handle ) >= 0 )
+  // Cubic (Catmull-Rom) interpolation also uses the samples before and after the linear interpolation pair
+  size_t previousSamplesNumber = ( interpolation == SIGNAL_IO_INTERPOLATION_CUBIC ) ? 1 : 0;
+  size_t nextSamplesNumber = ( interpolation == SIGNAL_IO_INTERPOLATION_CUBIC ) ? 2 : 1;
+  
+  // Samples older than a quarter of the history are kept away from the acquisition thread overwrites
+  size_t safetyLength = physicalTask->historyLength / 4;
+  uint64_t samplesCount = atomic_load( &(physicalTask->samplesCount) );
+  double clockOffset = GetClockOffset( physicalTask );
+  
+  // Timestamps are taken in chunks: interpolation weights and first knot sample are computed once per timestamp, and 
+  // then combined with the (contiguous) knot samples of each channel history by dot products
+  size_t knotsNumber = previousSamplesNumber + nextSamplesNumber + 1;
+  double weightsTable[ READ_TIMES_CHUNK_LENGTH * KERNEL_KNOTS_NUMBER ];
+  uint64_t firstKnotsList[ READ_TIMES_CHUNK_LENGTH ];
+  size_t validTimestampsNumber = 0;
+  for( size_t chunkStart = 0; chunkStart < timestampsNumber; chunkStart += READ_TIMES_CHUNK_LENGTH )
+  {
+    size_t chunkLength = timestampsNumber - chunkStart;
+    if( chunkLength > READ_TIMES_CHUNK_LENGTH ) chunkLength = READ_TIMES_CHUNK_LENGTH;
+    
+    for( size_t timestampIndex = 0; timestampIndex < chunkLength; timestampIndex++ )
+    {
+      double position = ( timestampsList[ chunkStart + timestampIndex ] - clockOffset ) * physicalTask->samplingRate;
+      uint64_t positionIndex = ( position > 0.0 ) ? (uint64_t) floor( position ) : 0;
+      double fraction = position - positionIndex;
+      
+      double* weightsList = weightsTable + timestampIndex * KERNEL_KNOTS_NUMBER;
+      if( interpolation == SIGNAL_IO_INTERPOLATION_CUBIC )
       {
-        uInt32 readChannelsNumber;
-        DAQmxGetReadAttribute( newTask->handle, DAQmx_Read_NumChans, &readChannelsNumber );
-        if( readChannelsNumber > 0 ) 
-        {
-          newTask->channelLocksList = (Semaphore*) calloc( newTask->channelsNumber, sizeof(Semaphore) );
-          for( unsigned int channel = 0; channel < newTask->channelsNumber; channel++ )
-            newTask->channelLocksList[ channel ] = Sem_Create( 0, SIGNAL_INPUT_CHANNEL_MAX_USES );
-          
-          newTask->mode = READ;
-        }
-        else 
-        {
-          newTask->channelLocksList = (Semaphore*) calloc( 1, sizeof(Semaphore) );
-          newTask->channelLocksList[ 0 ] = Sem_Create( 0, SIGNAL_INPUT_CHANNEL_MAX_USES );
-          
-          newTask->mode = WRITE;
-        }
-        
-        newTask->isRunning = false;
-        newTask->threadID = THREAD_INVALID_HANDLE;
+        double fraction2 = fraction * fraction, fraction3 = fraction2 * fraction;
+        weightsList[ 0 ] = 0.5 * ( -fraction3 + 2 * fraction2 - fraction );
+        weightsList[ 1 ] = 0.5 * ( 3 * fraction3 - 5 * fraction2 + 2 );
+        weightsList[ 2 ] = 0.5 * ( -3 * fraction3 + 4 * fraction2 + fraction );
+        weightsList[ 3 ] = 0.5 * ( fraction3 - fraction2 );
       }
       else
       {
-        //DEBUG_PRINT( "error starting task %s", taskName );
-        loadError = true;
+        weightsList[ 0 ] = 1.0 - fraction;
+        weightsList[ 1 ] = fraction;
       }
+      
+      bool isValid = ( position >= previousSamplesNumber && positionIndex + nextSamplesNumber < samplesCount 
+                       && positionIndex + physicalTask->historyLength >= samplesCount + safetyLength + previousSamplesNumber );
+      firstKnotsList[ timestampIndex ] = isValid ? positionIndex - previousSamplesNumber : CHANNEL_INACTIVE;
+      if( isValid ) validTimestampsNumber++;
     }
-    else 
+    
+    for( size_t channelIndex = 0; channelIndex < channelsNumber; channelIndex++ )
     {
-      //DEBUG_PRINT( "error getting task %s attribute", taskName );
+      double* valuesList = valuesTable + channelIndex * timestampsNumber + chunkStart;
+      
+      unsigned int channel = channelsList[ channelIndex ];
+      uint64_t channelStart = CHANNEL_INACTIVE;
+      if( channel < task->channelsNumber )
+      {
+        if( task->parentTask != NULL ) channel = task->viewChannelsList[ channel ];
+        channelStart = atomic_load( &(physicalTask->channelStartsList[ channel ]) );
+      }
+      
+      const double* channelHistoryList = physicalTask->historySamplesList + channel * physicalTask->historyLength;
+      for( size_t timestampIndex = 0; timestampIndex < chunkLength; timestampIndex++ )
+      {
+        uint64_t firstKnot = firstKnotsList[ timestampIndex ];
+        const double* weightsList = weightsTable + timestampIndex * KERNEL_KNOTS_NUMBER;
+        size_t historyStart = firstKnot % physicalTask->historyLength;
+        if( firstKnot == CHANNEL_INACTIVE || channelStart == CHANNEL_INACTIVE || firstKnot < channelStart ) 
+          valuesList[ timestampIndex ] = NAN;
+        else if( historyStart + knotsNumber <= physicalTask->historyLength ) 
+          valuesList[ timestampIndex ] = Kernels.DotProduct( weightsList, channelHistoryList + historyStart, knotsNumber );
+        else
+        {
+          // Knots wrapping around the history ring end
+          valuesList[ timestampIndex ] = 0.0;
+          for( size_t knot = 0; knot < knotsNumber; knot++ )
+            valuesList[ timestampIndex ] += weightsList[ knot ] * channelHistoryList[ ( firstKnot + knot ) % physicalTask->historyLength ];
+        }
+      }
+    }
+  }
+  
+  // Too slow query: part of the history could have been overwritten meanwhile
+  if( atomic_load( &(physicalTask->samplesCount) ) - samplesCount > safetyLength ) return 0;
+  
+  return validTimestampsNumber;
+}
+
+bool CheckInputChannel( long int taskID, unsigned int channel )
+{
+  SignalIOTask task = GetTaskChannel( taskID, &channel );
+  if( task == NULL ) return false;
+  
+  return AcquireInput( task, channel );
+}
+
+void ReleaseInputChannel( long int taskID, unsigned int channel )
+{
+  SignalIOTask task = GetTaskChannel( taskID, &channel );
+  if( task == NULL ) return;
+  
+  ReleaseInput( task, channel );
+}
+
+void EnableOutput( long int taskID, bool enable )
+{
+  SignalIOTask task = GetTask( taskID );
+  if( task == NULL ) return;
+  if( task->parentTask != NULL ) task = task->parentTask;
+  
+  if( task->mode == READ ) return;
+  
+  atomic_store( &(task->isOutputEnabled), enable );
+  atomic_store( &(task->isOutputDirty), true );
+  
+  // Output threads idle on regenerated waveforms have to switch to (or from) safe values
+  if( task->resumeLock != NULL ) Sem_SetCount( task->resumeLock, 1 );
+}
+
+bool DumpRecording( long int taskID, const char* filePath )
+{
+  SignalIOTask task = GetTask( taskID );
+  if( task == NULL ) return false;
+  if( task->parentTask != NULL ) task = task->parentTask;
+  
+  return DumpTaskRecording( task, filePath, "dump" );
+}
+
+size_t ReadMarkers( long int taskID, uint64_t* ref_cursor, SignalIOMarker* markersList, size_t maxMarkersNumber )
+{
+  SignalIOTask task = GetTask( taskID );
+  if( task == NULL || ref_cursor == NULL ) return 0;
+  if( task->parentTask != NULL ) task = task->parentTask;
+  
+  return ReadTaskMarkers( task, ref_cursor, markersList, maxMarkersNumber );
+}
+
+bool IsOutputEnabled( long int taskID )
+{
+  SignalIOTask task = GetTask( taskID );
+  if( task == NULL ) return false;
+  if( task->parentTask != NULL ) task = task->parentTask;
+  
+  if( task->mode == READ ) return false;
+  
+  return atomic_load( &(task->isOutputEnabled) );
+}
+
+bool SetOutputInterpolation( long int taskID, int interpolation, double delay )
+{
+  SignalIOTask task = GetTask( taskID );
+  if( task == NULL ) return false;
+  if( task->parentTask != NULL ) task = task->parentTask;
+  
+  if( task->mode == READ || task->samplingRate <= 0.0 ) return false;
+  
+  if( interpolation != SIGNAL_IO_INTERPOLATION_HOLD && interpolation != SIGNAL_IO_INTERPOLATION_LINEAR 
+      && interpolation != SIGNAL_IO_INTERPOLATION_CUBIC ) return false;
+  
+  // Commands could only be interpolated once written to the driver buffer, which is kept ahead of generation
+  double minDelay = OUTPUT_LEAD_BLOCKS_NUMBER * task->outputBlockLength / task->samplingRate;
+  task->outputDelay = fmin( fmax( delay, minDelay ), OUTPUT_DELAY_MAX );
+  atomic_store( &(task->outputInterpolation), interpolation );
+  
+  PublishVersion( &(task->interpolationVersion) );
+  
+  return true;
+}
+
+bool SetOutputPacing( long int taskID, double maxUpdateRate, double watchdogTimeout )
+{
+  SignalIOTask task = GetTask( taskID );
+  if( task == NULL ) return false;
+  if( task->parentTask != NULL ) task = task->parentTask;
+  
+  if( task->mode == READ || maxUpdateRate <= 0.0 ) return false;
+  
+  task->updateRate = maxUpdateRate;
+  task->watchdogTimeout = fmax( watchdogTimeout, 0.0 );
+  // Watchdog period only starts counting from now
+  atomic_store( &(task->lastWriteTime), (unsigned long long) ( GetMonotonicTime() * 1e6 ) );
+  
+  PublishVersion( &(task->pacingVersion) );
+  
+  return true;
+}
+
+bool OpenOutputMailbox( long int taskID )
+{
+  SignalIOTask task = GetTask( taskID );
+  if( task == NULL ) return false;
+  if( task->parentTask != NULL ) task = task->parentTask;
+  
+  if( task->mode == READ ) return false;
+  
+  if( atomic_load( &(task->mailbox) ) != NULL ) return true;
+  
+  // Merge buffers are set before the output thread could see the mailbox
+  if( task->mailboxValuesList == NULL )
+  {
+    task->mailboxValuesList = (double*) calloc( task->channelsNumber, sizeof(double) );
+    for( size_t channel = 0; channel < task->channelsNumber; channel++ )
+      task->mailboxValuesList[ channel ] = NAN;
+    task->mailboxSequencesList = (uint64_t*) calloc( task->channelsNumber, sizeof(uint64_t) );
+    task->mergedValuesList = (double*) calloc( task->channelsNumber, sizeof(double) );
+  }
+  
+  SignalMailbox newMailbox = Mailbox_Open( task->name, task->channelsNumber, true );
+  if( newMailbox == NULL ) return false;
+  
+  SignalMailbox noMailbox = NULL;
+  if( !atomic_compare_exchange_strong( &(task->mailbox), &noMailbox, newMailbox ) ) Mailbox_Close( newMailbox );
+  
+  return true;
+}
+
+long int CreateOutputGroup( const long int* taskIDsList, size_t tasksNumber )
+{
+  if( taskIDsList == NULL || tasksNumber < 2 ) return -1;
+  
+  SignalIOGroup newGroup = (SignalIOGroup) calloc( 1, sizeof(SignalIOGroupData) );
+  newGroup->tasksList = (SignalIOTask*) calloc( tasksNumber, sizeof(SignalIOTask) );
+  newGroup->clockSourcesList = (char**) calloc( tasksNumber, sizeof(char*) );
+  
+  // Members should be distinct clocked output tasks with the same rate, idle while their timing is changed
+  bool isValid = true;
+  for( size_t taskIndex = 0; taskIndex < tasksNumber && isValid; taskIndex++ )
+  {
+    SignalIOTask task = GetTask( taskIDsList[ taskIndex ] );
+    if( task != NULL && task->parentTask != NULL ) task = task->parentTask;
+    isValid = ( task != NULL && task->mode == WRITE && task->samplingRate > 0.0 && task->outputGroup == NULL && WaitTaskIdle( task ) );
+    for( size_t memberIndex = 0; memberIndex < newGroup->tasksNumber && isValid; memberIndex++ )
+      isValid = ( newGroup->tasksList[ memberIndex ] != task && newGroup->tasksList[ memberIndex ]->samplingRate == task->samplingRate );
+    if( isValid ) newGroup->tasksList[ newGroup->tasksNumber++ ] = task;
+  }
+  
+  if( !isValid || !LinkGroupTiming( newGroup ) )
+  {
+    UnloadGroupData( newGroup );
+    return -1;
+  }
+  
+  for( size_t taskIndex = 0; taskIndex < newGroup->tasksNumber; taskIndex++ )
+    newGroup->tasksList[ taskIndex ]->outputGroup = newGroup;
+  
+  if( groupsList == NULL ) groupsList = kh_init( GroupInt );
+  int insertionStatus;
+  khint_t newGroupIndex = kh_put( GroupInt, groupsList, ++lastGroupKey, &insertionStatus );
+  kh_value( groupsList, newGroupIndex ) = newGroup;
+  
+  return (long int) kh_key( groupsList, newGroupIndex );
+}
+
+bool CommitOutputGroup( long int groupID, const double* valuesList )
+{
+  if( groupsList == NULL || valuesList == NULL ) return false;
+  khint_t groupIndex = kh_get( GroupInt, groupsList, (khint_t) groupID );
+  if( groupIndex == kh_end( groupsList ) ) return false;
+  SignalIOGroup group = kh_value( groupsList, groupIndex );
+  
+  // Members share sample clock and start trigger, so the same sample index is the same hardware tick for all of them. 
+  // Frame is applied on the first index that no member has generated yet, and no earlier than its plain Write() commands would
+  uint64_t commitSample = 0;
+  double commitTime = GetMonotonicTime();
+  for( size_t taskIndex = 0; taskIndex < group->tasksNumber; taskIndex++ )
+  {
+    SignalIOTask task = group->tasksList[ taskIndex ];
+    if( atomic_load( &(task->state) ) != TASK_RUNNING || !atomic_load( &(task->isStarted) ) ) return false;
+    uint64_t pendingSample = atomic_load( &(task->outputSamplesCount) ) + OUTPUT_GROUP_MARGIN_BLOCKS * task->outputBlockLength;
+    double delayedSample = ceil( ( commitTime - task->outputStartTime + atomic_load( &(task->appliedOutputDelay) ) ) * task->samplingRate );
+    if( pendingSample > commitSample ) commitSample = pendingSample;
+    if( delayedSample > (double) commitSample ) commitSample = (uint64_t) delayedSample;
+  }
+  
+  // Commands are timed for each member own start time and delay estimates (half a sample early, against rounding).
+  // Plain Write() commands are rejected until then, as they would be merged into the committed (later) knot.
+  // Frames never touch the values Write() callers change: they are published in a sequence locked slot (odd while 
+  // being written), that writers apply to their values before the next change (see ApplyGroupFrame)
+  for( size_t taskIndex = 0; taskIndex < group->tasksNumber; taskIndex++ )
+  {
+    SignalIOTask task = group->tasksList[ taskIndex ];
+    double commandTime = task->outputStartTime + ( commitSample - 0.5 ) / task->samplingRate - atomic_load( &(task->appliedOutputDelay) );
+    uint64_t groupSequence = atomic_load( &(task->groupSequence) ) & ~1ULL;
+    while( !atomic_compare_exchange_weak( &(task->groupSequence), &groupSequence, groupSequence + 1 ) )
+      groupSequence &= ~1ULL;
+    memcpy( task->groupValuesList, valuesList, task->channelsNumber * sizeof(double) );
+    PushOutputCommand( task, commandTime, valuesList );
+    atomic_store( &(task->groupSequence), groupSequence + 2 );
+    valuesList += task->channelsNumber;
+    atomic_store( &(task->isOutputDirty), true );
+    atomic_store( &(task->lastWriteTime), (unsigned long long) ( commitTime * 1e6 ) );
+    atomic_store( &(task->commitCommandTime), commandTime );
+  }
+  
+  return true;
+}
+
+void ReleaseOutputGroup( long int groupID )
+{
+  if( groupsList == NULL ) return;
+  khint_t groupIndex = kh_get( GroupInt, groupsList, (khint_t) groupID );
+  if( groupIndex == kh_end( groupsList ) ) return;
+  SignalIOGroup group = kh_value( groupsList, groupIndex );
+  
+  // Timing could only be restored while no member is running
+  for( size_t taskIndex = 0; taskIndex < group->tasksNumber; taskIndex++ )
+  {
+    if( !WaitTaskIdle( group->tasksList[ taskIndex ] ) ) return;
+  }
+  
+  UnlinkGroupTiming( group, group->tasksNumber );
+  for( size_t taskIndex = 0; taskIndex < group->tasksNumber; taskIndex++ )
+    group->tasksList[ taskIndex ]->outputGroup = NULL;
+  UnloadGroupData( group );
+  
+  kh_del( GroupInt, groupsList, groupIndex );
+  if( kh_size( groupsList ) == 0 )
+  {
+    kh_destroy( GroupInt, groupsList );
+    groupsList = NULL;
+  }
+}
+
+bool SetOutputWaveform( long int taskID, const double* samplesTable, size_t periodLength )
+{
+  SignalIOTask task = GetTask( taskID );
+  if( task == NULL ) return false;
+  if( task->parentTask != NULL ) task = task->parentTask;
+  
+  if( task->mode == READ || task->samplingRate <= 0.0 ) return false;
+  if( periodLength > 0 && ( samplesTable == NULL || periodLength < 2 ) ) return false;
+  
+  // Waveforms are handed to the output thread whole, so that clients never touch the ones being written
+  SignalIOWaveformData* newWaveform = (SignalIOWaveformData*) malloc( sizeof(SignalIOWaveformData) + task->channelsNumber * periodLength * sizeof(double) );
+  newWaveform->periodLength = periodLength;
+  if( periodLength > 0 ) memcpy( newWaveform->samplesTable, samplesTable, task->channelsNumber * periodLength * sizeof(double) );
+  
+  SignalIOWaveformData* lastWaveform = atomic_exchange( &(task->pendingWaveform), newWaveform );
+  if( lastWaveform != NULL ) free( lastWaveform );
+  
+  Sem_SetCount( task->resumeLock, 1 );
+  
+  return true;
+}
+
+bool Write( long int taskID, unsigned int channel, double value )
+{
+  SignalIOTask task = GetTaskChannel( taskID, &channel );
+  if( task == NULL ) return false;
+  
+  return WriteChannel( task, channel, value );
+}
+
+bool AcquireOutputChannel( long int taskID, unsigned int channel )
+{
+  SignalIOTask task = GetTaskChannel( taskID, &channel );
+  if( task == NULL ) return false;
+  
+  //DEBUG_PRINT( "aquiring channel %u from task %d", channel, taskID );
+  
+  return AcquireOutput( task, channel );
+}
+
+void ReleaseOutputChannel( long int taskID, unsigned int channel )
+{
+  SignalIOTask task = GetTaskChannel( taskID, &channel );
+  if( task == NULL ) return;
+  
+  ReleaseOutput( task, channel );
+}
+
+unsigned int GetInterfaceVersion( void )
+{
+  return SIGNAL_IO_INTERFACE_VERSION;
+}
+
+unsigned int GetCapabilities( void )
+{
+  return INTERFACE_V2.capabilities;
+}
+
+const SignalIOInterfaceV2* GetInterfaceV2( void )
+{
+  return &INTERFACE_V2;
+}
+
+
+
+long int AcquireResampledInput( long int taskID, double outputRate )
+{
+  if( readersList == NULL ) readersList = kh_init( ReaderInt );
+  
+  SignalIOTask task = GetTask( taskID );
+  if( task == NULL ) return -1;
+  
+  if( outputRate <= 0.0 ) return -1;
+  
+  SignalIOReader newReader = LoadReaderData( task, NULL, task->channelsNumber, outputRate );
+  if( newReader == NULL ) return -1;
+  
+  // Resampled readers only get grid samples after their acquisition
+  uint64_t samplesCount = atomic_load( &(newReader->task->samplesCount) );
+  newReader->outputCursor = (uint64_t) ceil( samplesCount / newReader->samplesStep );
+  
+  int insertionStatus;
+  khint_t newReaderIndex = kh_put( ReaderInt, readersList, ++lastReaderKey, &insertionStatus );
+  kh_value( readersList, newReaderIndex ) = newReader;
+  
+  return (long int) kh_key( readersList, newReaderIndex );
+}
+
+size_t ReadResampled( long int readerID, size_t samplesNumber, double* samplesTable, double* ref_timestamp )
+{
+  if( readersList == NULL ) return 0;
+  khint_t readerIndex = kh_get( ReaderInt, readersList, (khint_t) readerID );
+  if( readerIndex == kh_end( readersList ) ) return 0;
+  
+  SignalIOReader reader = kh_value( readersList, readerIndex );
+  SignalIOTask task = reader->task;
+  
+  if( atomic_load( &(task->state) ) != TASK_RUNNING || samplesNumber == 0 ) return 0;
+  
+  // Output samples lie on a fixed grid of input sample positions (k * samplesStep), read in order from the reader cursor, 
+  // so that consecutive calls neither overlap nor miss samples. The last one should still have all its filter taps 
+  // (plus one, for phase rounding) available, and the first one all of them still kept in history (older ones are dropped)
+  const size_t HALF_TAPS_NUMBER = RESAMPLER_TAPS_NUMBER / 2;
+  uint64_t samplesCount = atomic_load( &(task->samplesCount) );
+  if( samplesCount < HALF_TAPS_NUMBER + 2 ) return 0;
+  uint64_t lastOutputIndex = (uint64_t) floor( ( samplesCount - HALF_TAPS_NUMBER - 2 ) / reader->samplesStep );
+  
+  // Grid samples with taps before the reader channels activation were never available, and are skipped without counting them as dropped
+  uint64_t channelsStart = 0;
+  for( size_t channelIndex = 0; channelIndex < reader->channelsNumber; channelIndex++ )
+  {
+    uint64_t channelStart = atomic_load( &(task->channelStartsList[ reader->channelsList[ channelIndex ] ]) );
+    if( channelStart == CHANNEL_INACTIVE ) return 0;
+    if( channelStart > channelsStart ) channelsStart = channelStart;
+  }
+  uint64_t startOutputIndex = (uint64_t) ceil( ( channelsStart + HALF_TAPS_NUMBER - 1 ) / reader->samplesStep );
+  if( reader->outputCursor < startOutputIndex ) reader->outputCursor = startOutputIndex;
+  
+  // Margin of a (max length) block, for the samples overwritten while copying
+  uint64_t oldestPosition = HALF_TAPS_NUMBER - 1;
+  if( samplesCount + oldestPosition + AQUISITION_BUFFER_MAX_LENGTH > task->historyLength ) 
+    oldestPosition += samplesCount + AQUISITION_BUFFER_MAX_LENGTH - task->historyLength;
+  uint64_t oldestOutputIndex = (uint64_t) ceil( oldestPosition / reader->samplesStep );
+  if( reader->outputCursor < oldestOutputIndex )
+  {
+    atomic_fetch_add( &(reader->droppedSamplesCount), oldestOutputIndex - reader->outputCursor );
+    reader->outputCursor = oldestOutputIndex;
+  }
+  if( reader->outputCursor > lastOutputIndex ) return 0;
+  
+  // Returned rows keep the requested length, even with fewer samples available
+  size_t rowLength = samplesNumber;
+  uint64_t firstOutputIndex = reader->outputCursor;
+  size_t maxSamplesNumber = (size_t) ( ( task->historyLength - RESAMPLER_TAPS_NUMBER - AQUISITION_BUFFER_MAX_LENGTH ) / reader->samplesStep );
+  if( samplesNumber > maxSamplesNumber ) samplesNumber = maxSamplesNumber;
+  if( lastOutputIndex - firstOutputIndex + 1 < samplesNumber ) samplesNumber = (size_t) ( lastOutputIndex - firstOutputIndex + 1 );
+  if( samplesNumber == 0 ) return 0;
+  lastOutputIndex = firstOutputIndex + samplesNumber - 1;
+  
+  uint64_t firstPosition = (uint64_t) floor( firstOutputIndex * reader->samplesStep );
+  uint64_t windowStart = firstPosition + 1 - HALF_TAPS_NUMBER;
+  size_t windowLength = (size_t) ( floor( lastOutputIndex * reader->samplesStep ) + 2 + HALF_TAPS_NUMBER - windowStart );
+  if( windowLength > task->historyLength ) return 0;
+  
+  for( size_t channelIndex = 0; channelIndex < reader->channelsNumber; channelIndex++ )
+  {
+    double* channelWindowList = reader->windowTable + channelIndex * task->historyLength;
+    if( !CopyHistorySamples( task, reader->channelsList[ channelIndex ], windowStart, windowLength, channelWindowList ) ) return 0;
+  }
+  
+  // Polyphase evaluation: each output sample coefficients row is shared by all channels
+  for( size_t sampleIndex = 0; sampleIndex < samplesNumber; sampleIndex++ )
+  {
+    double position = ( firstOutputIndex + sampleIndex ) * reader->samplesStep;
+    uint64_t positionIndex = (uint64_t) floor( position );
+    size_t phase = (size_t) round( ( position - positionIndex ) * RESAMPLER_PHASES_NUMBER );
+    if( phase == RESAMPLER_PHASES_NUMBER )
+    {
+      positionIndex++;
+      phase = 0;
+    }
+    
+    const double* coefficientsList = reader->filterTable + phase * RESAMPLER_TAPS_NUMBER;
+    size_t windowOffset = (size_t) ( positionIndex + 1 - HALF_TAPS_NUMBER - windowStart );
+    for( size_t channelIndex = 0; channelIndex < reader->channelsNumber; channelIndex++ )
+    {
+      const double* tapsList = reader->windowTable + channelIndex * task->historyLength + windowOffset;
+      samplesTable[ channelIndex * rowLength + sampleIndex ] = Kernels.DotProduct( coefficientsList, tapsList, RESAMPLER_TAPS_NUMBER );
+    }
+  }
+  
+  reader->outputCursor = lastOutputIndex + 1;
+  
+  if( ref_timestamp != NULL ) *ref_timestamp = GetSampleTime( task, lastOutputIndex * reader->samplesStep );
+  
+  return samplesNumber;
+}
+
+long int AcquireEnsembleAverage( long int taskID, const unsigned int* channelsList, size_t channelsNumber, double preTriggerDuration, double postTriggerDuration )
+{
+  SignalIOTask task = GetTask( taskID );
+  if( task == NULL || channelsNumber == 0 ) return -1;
+  SignalIOTask physicalTask = ( task->parentTask != NULL ) ? task->parentTask : task;
+  
+  if( physicalTask->mode == WRITE || physicalTask->samplingRate <= 0.0 ) return -1;
+  
+  size_t preSamplesNumber = (size_t) round( fmax( preTriggerDuration, 0.0 ) * physicalTask->samplingRate );
+  size_t sweepLength = preSamplesNumber + (size_t) round( fmax( postTriggerDuration, 0.0 ) * physicalTask->samplingRate );
+  // Whole sweeps should still be in history when completed
+  if( sweepLength == 0 || sweepLength > physicalTask->historyLength / 2 ) return -1;
+  
+  SignalIOEnsemble newEnsemble = (SignalIOEnsemble) calloc( 1, sizeof(SignalIOEnsembleData) );
+  newEnsemble->reader = LoadReaderData( task, channelsList, channelsNumber, 0.0 );
+  if( newEnsemble->reader == NULL )
+  {
+    UnloadEnsembleData( newEnsemble );
+    return -1;
+  }
+  atomic_init( &(newEnsemble->trigger), NULL );
+  newEnsemble->preSamplesNumber = preSamplesNumber;
+  newEnsemble->sweepLength = sweepLength;
+  // Everything used on accumulation is allocated here
+  newEnsemble->pendingTriggersList = (uint64_t*) calloc( ENSEMBLE_PENDING_SWEEPS_NUMBER, sizeof(uint64_t) );
+  newEnsemble->sweepTable = (double*) calloc( channelsNumber * sweepLength, sizeof(double) );
+  newEnsemble->meansTable = (double*) calloc( channelsNumber * sweepLength, sizeof(double) );
+  newEnsemble->deviationsTable = (double*) calloc( channelsNumber * sweepLength, sizeof(double) );
+  atomic_init( &(newEnsemble->sequence), 0 );
+  
+  // Ensembles lists are only locked among client threads: aquisition threads take copies of them, on version changes
+  Sem_Decrement( physicalTask->ensemblesLock );
+  size_t ensemblesNumber = physicalTask->ensemblesNumber;
+  if( ensemblesNumber < ENSEMBLES_MAX_NUMBER )
+  {
+    physicalTask->ensemblesList[ physicalTask->ensemblesNumber++ ] = newEnsemble;
+    PublishVersion( &(physicalTask->ensemblesVersion) );
+  }
+  Sem_Increment( physicalTask->ensemblesLock );
+  if( ensemblesNumber >= ENSEMBLES_MAX_NUMBER )
+  {
+    UnloadEnsembleData( newEnsemble );
+    return -1;
+  }
+  
+  if( ensemblesList == NULL ) ensemblesList = kh_init( EnsembleInt );
+  int insertionStatus;
+  khint_t newEnsembleIndex = kh_put( EnsembleInt, ensemblesList, ++lastEnsembleKey, &insertionStatus );
+  kh_value( ensemblesList, newEnsembleIndex ) = newEnsemble;
+  
+  return (long int) kh_key( ensemblesList, newEnsembleIndex );
+}
+
+bool SetEnsembleTrigger( long int ensembleID, int triggerSource, long int triggerTaskID, unsigned int triggerChannel, double triggerLevel )
+{
+  SignalIOEnsemble ensemble = GetEnsemble( ensembleID );
+  if( ensemble == NULL ) return false;
+  SignalIOTask task = ensemble->reader->task;
+  
+  SignalIOTask triggerTask = GetTask( triggerTaskID );
+  if( triggerTask == NULL ) return false;
+  
+  SignalIOReader triggerReader = NULL;
+  uint64_t triggerCursor = 0;
+  if( triggerSource == SIGNAL_IO_TRIGGER_INPUT_LEVEL )
+  {
+    // Input triggers come from the same aquisition, so that their samples line up with the averaged ones
+    if( ( ( triggerTask->parentTask != NULL ) ? triggerTask->parentTask : triggerTask ) != task ) return false;
+    triggerReader = LoadReaderData( triggerTask, &triggerChannel, 1, 0.0 );
+    if( triggerReader == NULL ) return false;
+    triggerChannel = triggerReader->channelsList[ 0 ];
+    triggerCursor = atomic_load( &(task->samplesCount) );
+  }
+  else if( triggerSource == SIGNAL_IO_TRIGGER_OUTPUT_LEVEL )
+  {
+    // Output commands are taken from the output task recorded frames
+    triggerTask = MapTaskChannel( triggerTask, &triggerChannel );
+    if( triggerTask == NULL || triggerTask->mode != WRITE || triggerTask->recorder == NULL ) return false;
+    triggerCursor = atomic_load( &(triggerTask->recorder->header->framesCount) );
+  }
+  else if( triggerSource == SIGNAL_IO_TRIGGER_MARKER )
+  {
+    if( triggerTask->parentTask != NULL ) triggerTask = triggerTask->parentTask;
+    if( triggerTask->recorder == NULL ) return false;
+    triggerCursor = atomic_load( &(triggerTask->recorder->header->markersCount) );
+  }
+  else return false;
+  
+  // Trigger task is kept loaded while the ensemble refers to it
+  SignalIOTrigger newTrigger = (SignalIOTrigger) malloc( sizeof(SignalIOTriggerData) );
+  newTrigger->reader = triggerReader;
+  newTrigger->task = triggerTask;
+  newTrigger->source = triggerSource;
+  newTrigger->channel = triggerChannel;
+  newTrigger->level = triggerLevel;
+  newTrigger->startCursor = triggerCursor;
+  atomic_fetch_add( &(triggerTask->triggersCount), 1 );
+  
+  // Previous trigger is only released once the aquisition thread switched to the new one
+  SignalIOTrigger lastTrigger = atomic_exchange( &(ensemble->trigger), newTrigger );
+  WaitVersion( task, &(task->ensemblesVersion), PublishVersion( &(task->ensemblesVersion) ) );
+  UnloadTriggerData( lastTrigger );
+  
+  return true;
+}
+
+size_t ReadEnsembleAverage( long int ensembleID, double* meansTable, double* variancesTable )
+{
+  SignalIOEnsemble ensemble = GetEnsemble( ensembleID );
+  if( ensemble == NULL ) return 0;
+  
+  size_t valuesNumber = ensemble->reader->channelsNumber * ensemble->sweepLength;
+  
+  // Results are copied again if the acquisition thread updated them in the meantime
+  size_t sweepsCount = 0;
+  unsigned int sequence;
+  do
+  {
+    sequence = atomic_load( &(ensemble->sequence) );
+    if( sequence % 2 == 1 ) continue;
+    sweepsCount = ensemble->sweepsCount;
+    if( meansTable != NULL ) memcpy( meansTable, ensemble->meansTable, valuesNumber * sizeof(double) );
+    if( variancesTable != NULL )
+    {
+      for( size_t valueIndex = 0; valueIndex < valuesNumber; valueIndex++ )
+        variancesTable[ valueIndex ] = ( sweepsCount > 1 ) ? ensemble->deviationsTable[ valueIndex ] / ( sweepsCount - 1 ) : 0.0;
+    }
+  }
+  while( sequence % 2 == 1 || atomic_load( &(ensemble->sequence) ) != sequence );
+  
+  return sweepsCount;
+}
+
+void ReleaseEnsembleAverage( long int ensembleID )
+{
+  SignalIOEnsemble ensemble = GetEnsemble( ensembleID );
+  if( ensemble == NULL ) return;
+  SignalIOTask task = ensemble->reader->task;
+  
+  Sem_Decrement( task->ensemblesLock );
+  for( size_t ensembleIndex = 0; ensembleIndex < task->ensemblesNumber; ensembleIndex++ )
+  {
+    if( task->ensemblesList[ ensembleIndex ] == ensemble )
+    {
+      task->ensemblesList[ ensembleIndex ] = task->ensemblesList[ --task->ensemblesNumber ];
+      break;
+    }
+  }
+  unsigned int ensemblesVersion = PublishVersion( &(task->ensemblesVersion) );
+  Sem_Increment( task->ensemblesLock );
+  
+  // Ensemble (with its trigger) is only freed once the aquisition thread no longer accumulates it
+  WaitVersion( task, &(task->ensemblesVersion), ensemblesVersion );
+  UnloadEnsembleData( ensemble );
+  
+  kh_del( EnsembleInt, ensemblesList, kh_get( EnsembleInt, ensemblesList, (khint_t) ensembleID ) );
+  if( kh_size( ensemblesList ) == 0 )
+  {
+    kh_destroy( EnsembleInt, ensemblesList );
+    ensemblesList = NULL;
+  }
+}
+
+void ReleaseResampledInput( long int readerID )
+{
+  if( readersList == NULL ) return;
+  khint_t readerIndex = kh_get( ReaderInt, readersList, (khint_t) readerID );
+  if( readerIndex == kh_end( readersList ) ) return;
+  
+  UnloadReaderData( kh_value( readersList, readerIndex ) );
+  
+  kh_del( ReaderInt, readersList, readerIndex );
+  
+  if( kh_size( readersList ) == 0 )
+  {
+    kh_destroy( ReaderInt, readersList );
+    readersList = NULL;
+  }
+}
+
+
+
+SignalIOTaskHandle Task_Open( const char* taskConfig )
+{
+  return GetTask( InitDevice( taskConfig ) );
+}
+
+long int Task_GetID( SignalIOTaskHandle task )
+{
+  if( task == NULL ) return SIGNAL_IO_TASK_INVALID_ID;
+  
+  return task->taskID;
+}
+
+void Task_Close( SignalIOTaskHandle task )
+{
+  if( task == NULL ) return;
+  
+  EndDevice( task->taskID );
+}
+
+size_t Task_GetMaxInputSamplesNumber( SignalIOTaskHandle task )
+{
+  if( task == NULL ) return 0;
+  if( task->parentTask != NULL ) task = task->parentTask;
+  
+  if( task->mode == WRITE ) return 0;
+  
+  size_t maxBlockLength = atomic_load( &(task->maxBlockLength) );
+  return ( maxBlockLength > 0 ) ? maxBlockLength : AQUISITION_BUFFER_LENGTH;
+}
+
+SignalIOReaderHandle Task_AcquireReader( SignalIOTaskHandle task, unsigned int channel, unsigned int options )
+{
+  if( task == NULL ) return NULL;
+  
+  unsigned int policy = options & SIGNAL_IO_READER_POLICY_MASK;
+  if( policy > SIGNAL_IO_READER_DECIMATE_ON_LAG ) return NULL;
+  
+  SignalIOReader newReader = LoadReaderData( task, &channel, 1, 0.0 );
+  if( newReader == NULL ) return NULL;
+  
+  // Readers only get samples aquired after their acquisition
+  newReader->policy = policy;
+  atomic_store( &(newReader->samplesCursor), atomic_load( &(newReader->task->samplesCount) ) );
+  
+  return newReader;
+}
+
+bool Task_AcquireOutputChannel( SignalIOTaskHandle task, unsigned int channel )
+{
+  task = MapTaskChannel( task, &channel );
+  if( task == NULL ) return false;
+  
+  return AcquireOutput( task, channel );
+}
+
+bool Task_Write( SignalIOTaskHandle task, unsigned int channel, double value )
+{
+  task = MapTaskChannel( task, &channel );
+  if( task == NULL ) return false;
+  
+  return WriteChannel( task, channel, value );
+}
+
+void Task_ReleaseOutputChannel( SignalIOTaskHandle task, unsigned int channel )
+{
+  task = MapTaskChannel( task, &channel );
+  if( task == NULL ) return;
+  
+  ReleaseOutput( task, channel );
+}
+
+size_t Reader_Read( SignalIOReaderHandle reader, double* samplesList, double* ref_timestamp )
+{
+  if( reader == NULL ) return 0;
+  
+  double timestamp = 0.0;
+  size_t samplesNumber = ReadReaderSamples( reader, samplesList, &timestamp );
+  if( samplesNumber > 0 && ref_timestamp != NULL ) *ref_timestamp = timestamp;
+  
+  if( atomic_load( &(reader->deadline) ) != NULL ) UpdateReaderTiming( reader, samplesNumber, timestamp );
+  
+  return samplesNumber;
+}
+
+void Reader_Release( SignalIOReaderHandle reader )
+{
+  Reader_SetDeadline( reader, 0.0, 0.0 );
+  
+  UnloadReaderData( reader );
+}
+
+bool Task_Mark( SignalIOTaskHandle task, unsigned int code, double payload )
+{
+  if( task == NULL ) return false;
+  if( task->parentTask != NULL ) task = task->parentTask;
+  
+  return MarkTask( task, code, payload );
+}
+
+size_t Reader_ReadMarkers( SignalIOReaderHandle reader, SignalIOMarker* markersList, size_t maxMarkersNumber )
+{
+  if( reader == NULL ) return 0;
+  
+  return ReadTaskMarkers( reader->task, &(reader->markersCursor), markersList, maxMarkersNumber );
+}
+
+bool Reader_GetStatus( SignalIOReaderHandle reader, uint64_t* ref_lag, uint64_t* ref_droppedSamplesCount )
+{
+  if( reader == NULL ) return false;
+  
+  uint64_t samplesCount = atomic_load( &(reader->task->samplesCount) );
+  uint64_t samplesCursor = atomic_load( &(reader->samplesCursor) );
+  
+  if( ref_lag != NULL ) *ref_lag = ( samplesCount > samplesCursor ) ? samplesCount - samplesCursor : 0;
+  if( ref_droppedSamplesCount != NULL ) *ref_droppedSamplesCount = atomic_load( &(reader->droppedSamplesCount) );
+  
+  return true;
+}
+
+bool Reader_SetDeadline( SignalIOReaderHandle reader, double expectedPeriod, double maxDataAge )
+{
+  if( reader == NULL ) return false;
+  if( expectedPeriod < 0.0 || maxDataAge < 0.0 ) return false;
+  
+  SignalIOTask task = reader->task;
+  if( task->readerDeadlinesList == NULL ) return false;
+  
+  SignalIOReaderDeadline deadline = atomic_load( &(reader->deadline) );
+  
+  if( expectedPeriod == 0.0 && maxDataAge == 0.0 )
+  {
+    if( deadline == NULL ) return true;
+    atomic_store( &(reader->deadline), NULL );
+    atomic_store( &(deadline->expectedPeriod), 0 );
+    atomic_store( &(deadline->isUsed), false );
+    return true;
+  }
+  
+  if( deadline == NULL )
+  {
+    for( size_t deadlineIndex = 0; deadlineIndex < READER_DEADLINES_MAX_NUMBER; deadlineIndex++ )
+    {
+      bool isUsed = false;
+      if( atomic_compare_exchange_strong( &(task->readerDeadlinesList[ deadlineIndex ].isUsed), &isUsed, true ) )
+      {
+        deadline = &(task->readerDeadlinesList[ deadlineIndex ]);
+        break;
+      }
+    }
+    if( deadline == NULL ) return false;
+    
+    // Statistics restart on each new declaration
+    reader->lastReadTime = 0.0;
+    atomic_store( &(reader->readsCount), 0 );
+    atomic_store( &(reader->lateReadsCount), 0 );
+    atomic_store( &(reader->maxReadInterval), 0 );
+    atomic_store( &(reader->maxDataAge), 0 );
+    for( size_t binIndex = 0; binIndex < SIGNAL_IO_READER_HISTOGRAM_BINS; binIndex++ )
+    {
+      atomic_store( &(reader->readIntervalsHistogram[ binIndex ]), 0 );
+      atomic_store( &(reader->dataAgesHistogram[ binIndex ]), 0 );
+    }
+    atomic_store( &(deadline->lastReadTime), 0 );
+    atomic_store( &(deadline->isLate), false );
+  }
+  
+  atomic_store( &(deadline->maxDataAge), (uint64_t) ( maxDataAge * 1e6 ) );
+  atomic_store( &(deadline->expectedPeriod), (uint64_t) ( expectedPeriod * 1e6 ) );
+  atomic_store( &(reader->deadline), deadline );
+  
+  return true;
+}
+
+bool Reader_GetTiming( SignalIOReaderHandle reader, SignalIOReaderTiming* ref_timing )
+{
+  if( reader == NULL || ref_timing == NULL ) return false;
+  
+  SignalIOReaderDeadline deadline = atomic_load( &(reader->deadline) );
+  if( deadline == NULL ) return false;
+  
+  ref_timing->readsCount = atomic_load( &(reader->readsCount) );
+  ref_timing->lateReadsCount = atomic_load( &(reader->lateReadsCount) );
+  ref_timing->maxReadInterval = atomic_load( &(reader->maxReadInterval) ) / 1e6;
+  ref_timing->maxDataAge = atomic_load( &(reader->maxDataAge) ) / 1e6;
+  ref_timing->isLate = atomic_exchange( &(deadline->isLate), false );
+  for( size_t binIndex = 0; binIndex < SIGNAL_IO_READER_HISTOGRAM_BINS; binIndex++ )
+  {
+    ref_timing->readIntervalsHistogram[ binIndex ] = atomic_load( &(reader->readIntervalsHistogram[ binIndex ]) );
+    ref_timing->dataAgesHistogram[ binIndex ] = atomic_load( &(reader->dataAgesHistogram[ binIndex ]) );
+  }
+  
+  return true;
+}
+
+SignalIOTask GetTask( long int taskID )
+{
+  if( tasksList == NULL ) return NULL;
+  
+  khint_t taskIndex = kh_get( TaskInt, tasksList, (khint_t) taskID );
+  if( taskIndex == kh_end( tasksList ) ) return NULL;
+  
+  return kh_value( tasksList, taskIndex );
+}
+
+SignalIOEnsemble GetEnsemble( long int ensembleID )
+{
+  if( ensemblesList == NULL ) return NULL;
+  
+  khint_t ensembleIndex = kh_get( EnsembleInt, ensemblesList, (khint_t) ensembleID );
+  if( ensembleIndex == kh_end( ensemblesList ) ) return NULL;
+  
+  return kh_value( ensemblesList, ensembleIndex );
+}
+
+SignalIOTask GetTaskChannel( long int taskID, unsigned int* ref_channel )
+{
+  return MapTaskChannel( GetTask( taskID ), ref_channel );
+}
+
+SignalIOTask MapTaskChannel( SignalIOTask task, unsigned int* ref_channel )
+{
+  if( task == NULL ) return NULL;
+  
+  if( *ref_channel >= task->channelsNumber ) return NULL;
+  
+  // Views are served by their physical task, with no extra driver calls
+  if( task->parentTask != NULL )
+  {
+    *ref_channel = task->viewChannelsList[ *ref_channel ];
+    task = task->parentTask;
+  }
+  
+  return task;
+}
+
+size_t ReadChannel( SignalIOTask task, unsigned int channel, double* channelSamplesList, double* ref_timestamp )
+{
+  if( atomic_load( &(task->state) ) != TASK_RUNNING ) return 0;
+  
+  if( task->mode == WRITE ) return 0;
+  
+  //Sem_Decrement( task->channelLocksList[ channel ] );
+  
+  uint64_t blocksCount = atomic_load( &(task->blocksCount) );
+  if( blocksCount == 0 ) return 0;
+  
+  SignalIOBlockData lastBlock = task->blocksList[ ( blocksCount - 1 ) % HISTORY_BLOCKS_NUMBER ];
+  uint64_t channelStart = atomic_load( &(task->channelStartsList[ channel ]) );
+  if( channelStart == CHANNEL_INACTIVE || channelStart >= lastBlock.samplesEnd ) return 0;
+  
+  size_t channelAcquiredSamplesCount = lastBlock.samplesNumber;
+  if( lastBlock.samplesEnd - channelStart < channelAcquiredSamplesCount ) channelAcquiredSamplesCount = lastBlock.samplesEnd - channelStart;
+  
+  if( !CopyHistorySamples( task, channel, lastBlock.samplesEnd - channelAcquiredSamplesCount, channelAcquiredSamplesCount, channelSamplesList ) ) return 0;
+  
+  if( ref_timestamp != NULL ) *ref_timestamp = ( task->samplingRate > 0.0 ) ? GetSampleTime( task, lastBlock.samplesEnd - 1 ) : lastBlock.time;
+  
+  return channelAcquiredSamplesCount;
+}
+
+// Backpressure is handled on the reader side only: aquisition never waits, and slow readers skip, drop or decimate samples by their policy
+size_t ReadReaderSamples( SignalIOReader reader, double* samplesList, double* ref_timestamp )
+{
+  SignalIOTask task = reader->task;
+  unsigned int channel = reader->channelsList[ 0 ];
+  
+  if( atomic_load( &(task->state) ) != TASK_RUNNING ) return 0;
+  
+  uint64_t blocksCount = atomic_load( &(task->blocksCount) );
+  if( blocksCount == 0 ) return 0;
+  
+  SignalIOBlockData lastBlock = task->blocksList[ ( blocksCount - 1 ) % HISTORY_BLOCKS_NUMBER ];
+  uint64_t channelStart = atomic_load( &(task->channelStartsList[ channel ]) );
+  if( channelStart == CHANNEL_INACTIVE ) return 0;
+  
+  uint64_t samplesCursor = atomic_load( &(reader->samplesCursor) );
+  // Samples before channel activation were never available, and are not counted as dropped
+  if( samplesCursor < channelStart ) samplesCursor = channelStart;
+  
+  if( reader->policy == SIGNAL_IO_READER_LATEST )
+  {
+    size_t samplesNumber = ReadChannel( task, channel, samplesList, ref_timestamp );
+    // Whole blocks skipped between calls are dropped (repeated calls over the same block drop nothing)
+    if( samplesNumber > 0 && lastBlock.samplesEnd > samplesCursor )
+    {
+      uint64_t blockStart = lastBlock.samplesEnd - samplesNumber;
+      if( blockStart > samplesCursor ) atomic_fetch_add( &(reader->droppedSamplesCount), blockStart - samplesCursor );
+      atomic_store( &(reader->samplesCursor), lastBlock.samplesEnd );
+    }
+    return samplesNumber;
+  }
+  
+  uint64_t samplesCount = atomic_load( &(task->samplesCount) );
+  // Keep one block of margin from the oldest history sample, as the aquisition thread could be overwriting it
+  size_t maxSamplesNumber = Task_GetMaxInputSamplesNumber( task );
+  size_t safeHistoryLength = task->historyLength - AQUISITION_BUFFER_MAX_LENGTH;
+  if( samplesCount - samplesCursor > safeHistoryLength )
+  {
+    uint64_t oldestSample = samplesCount - safeHistoryLength;
+    atomic_fetch_add( &(reader->droppedSamplesCount), oldestSample - samplesCursor );
+    samplesCursor = oldestSample;
+  }
+  
+  uint64_t lag = samplesCount - samplesCursor;
+  if( lag == 0 ) 
+  {
+    atomic_store( &(reader->samplesCursor), samplesCursor );
+    return 0;
+  }
+  
+  size_t samplesStep = 1;
+  if( reader->policy == SIGNAL_IO_READER_DECIMATE_ON_LAG && lag > maxSamplesNumber ) samplesStep = ( lag + maxSamplesNumber - 1 ) / maxSamplesNumber;
+  
+  size_t samplesNumber = lag / samplesStep;
+  if( samplesNumber > maxSamplesNumber ) samplesNumber = maxSamplesNumber;
+  if( samplesNumber == 0 ) return 0;
+  
+  if( samplesStep == 1 )
+  {
+    if( !CopyHistorySamples( task, channel, samplesCursor, samplesNumber, samplesList ) ) return 0;
+    samplesCursor += samplesNumber;
+  }
+  else
+  {
+    // Anchor the step grid at the newest aquired sample, so that it is always the newest returned one
+    const double* channelHistoryList = task->historySamplesList + channel * task->historyLength;
+    uint64_t firstSample = samplesCount - 1 - ( samplesNumber - 1 ) * samplesStep;
+    for( size_t sampleIndex = 0; sampleIndex < samplesNumber; sampleIndex++ )
+      samplesList[ sampleIndex ] = channelHistoryList[ ( firstSample + sampleIndex * samplesStep ) % task->historyLength ];
+    // Acquisition thread could have overwritten the copied samples meanwhile (dropped on next call)
+    if( atomic_load( &(task->samplesCount) ) - firstSample > safeHistoryLength ) return 0;
+    // Every skipped sample up to the newest one is dropped, including the remainder before the grid start
+    atomic_fetch_add( &(reader->droppedSamplesCount), lag - samplesNumber );
+    samplesCursor = samplesCount;
+  }
+  
+  atomic_store( &(reader->samplesCursor), samplesCursor );
+  
+  if( ref_timestamp != NULL ) *ref_timestamp = ( task->samplingRate > 0.0 ) ? GetSampleTime( task, samplesCursor - 1 ) : lastBlock.time;
+  
+  return samplesNumber;
+}
+
+bool AcquireInput( SignalIOTask task, unsigned int channel )
+{
+  if( task->mode == WRITE ) return false;
+  
+  unsigned int channelUses = atomic_load( &(task->channelUsesList[ channel ]) );
+  do
+  {
+    if( channelUses >= SIGNAL_INPUT_CHANNEL_MAX_USES ) return false;
+  }
+  while( !atomic_compare_exchange_weak( &(task->channelUsesList[ channel ]), &channelUses, channelUses + 1 ) );
+  
+  // Acquisition thread rebuilds its active channels mask on next block (being woken up if idle with no channels to read)
+  if( channelUses == 0 ) 
+  {
+    PublishVersion( &(task->channelsVersion) );
+    Sem_SetCount( task->resumeLock, 1 );
+  }
+  
+  ResumeTask( task );
+  
+  return true;
+}
+
+void ReleaseInput( SignalIOTask task, unsigned int channel )
+{
+  if( task->mode == WRITE ) return;
+  
+  unsigned int channelUses = atomic_load( &(task->channelUsesList[ channel ]) );
+  do
+  {
+    if( channelUses == 0 ) return;
+  }
+  while( !atomic_compare_exchange_weak( &(task->channelUsesList[ channel ]), &channelUses, channelUses - 1 ) );
+  
+  if( channelUses == 1 ) PublishVersion( &(task->channelsVersion) );
+  
+  (void) CheckTask( task );
+}
+
+bool WriteChannel( SignalIOTask task, unsigned int channel, double value )
+{
+  if( atomic_load( &(task->state) ) != TASK_RUNNING ) return false;
+  
+  if( task->mode == READ ) return false;
+  
+  if( task->outputGroup != NULL && GetMonotonicTime() < atomic_load( &(task->commitCommandTime) ) ) return false;
+  
+  //Sem_Decrement( task->channelLocksList[ 0 ] );
+  
+  if( task->outputGroup != NULL ) ApplyGroupFrame( task );
+  
+  task->channelValuesList[ channel ] = value;
+  atomic_store( &(task->isOutputDirty), true );
+  atomic_store( &(task->lastWriteTime), (unsigned long long) ( GetMonotonicTime() * 1e6 ) );
+  
+  if( task->samplingRate > 0.0 ) PushOutputCommand( task, GetMonotonicTime(), task->channelValuesList );
+  
+  //Sem_SetCount( task->channelLocksList[ 0 ], 1 );
+  
+  return true;
+}
+
+// Clocked outputs get timestamped commands (with all given values), appended with no locks from any thread
+void PushOutputCommand( SignalIOTask task, double time, const double* valuesList )
+{
+  uint64_t commandIndex = atomic_fetch_add( &(task->commandsCount), 1 );
+  size_t commandSlot = commandIndex % OUTPUT_COMMANDS_NUMBER;
+  atomic_store( &(task->commandSequencesList[ commandSlot ]), 2 * commandIndex + 1 );
+  double* command = task->commandsTable + commandSlot * ( 1 + task->channelsNumber );
+  command[ 0 ] = time;
+  memcpy( command + 1, valuesList, task->channelsNumber * sizeof(double) );
+  atomic_store( &(task->commandSequencesList[ commandSlot ]), 2 * commandIndex + 2 );
+}
+
+// Copies the last committed group frame to the task values, if not done yet. Applied sequence is odd while copying, 
+// so that concurrent writers wait for the copy instead of having their new values overwritten by it
+void ApplyGroupFrame( SignalIOTask task )
+{
+  uint64_t appliedSequence = atomic_load( &(task->appliedGroupSequence) );
+  while( true )
+  {
+    uint64_t groupSequence = atomic_load( &(task->groupSequence) ) & ~1ULL;
+    if( appliedSequence % 2 == 1 ) appliedSequence = atomic_load( &(task->appliedGroupSequence) );
+    else if( appliedSequence == groupSequence ) return;
+    else if( atomic_compare_exchange_weak( &(task->appliedGroupSequence), &appliedSequence, appliedSequence + 1 ) ) break;
+  }
+  
+  // Frames committed while copying are copied again
+  uint64_t groupSequence;
+  do
+  {
+    while( ( groupSequence = atomic_load( &(task->groupSequence) ) ) % 2 == 1 );
+    memcpy( task->channelValuesList, task->groupValuesList, task->channelsNumber * sizeof(double) );
+    atomic_thread_fence( memory_order_acquire );
+  }
+  while( atomic_load( &(task->groupSequence) ) != groupSequence );
+  
+  atomic_store( &(task->appliedGroupSequence), groupSequence );
+}
+
+// Output group members are resumed and paused together
+bool AcquireOutput( SignalIOTask task, unsigned int channel )
+{
+  if( task->mode == READ ) return false;
+  
+  if( atomic_exchange( &(task->channelUsesList[ channel ]), 1 ) == 1 ) return false;
+  
+  if( task->outputGroup == NULL ) ResumeTask( task );
+  else
+  {
+    for( size_t taskIndex = 0; taskIndex < task->outputGroup->tasksNumber; taskIndex++ )
+      ResumeTask( task->outputGroup->tasksList[ taskIndex ] );
+  }
+  
+  return true;
+}
+
+void ReleaseOutput( SignalIOTask task, unsigned int channel )
+{
+  if( task->mode == READ ) return;
+  
+  if( atomic_exchange( &(task->channelUsesList[ channel ]), 0 ) == 0 ) return;
+  
+  if( task->outputGroup == NULL ) (void) CheckTask( task );
+  else
+  {
+    for( size_t taskIndex = 0; taskIndex < task->outputGroup->tasksNumber; taskIndex++ )
+      (void) CheckTask( task->outputGroup->tasksList[ taskIndex ] );
+  }
+}
+
+static void* AsyncReadBuffer( void* callbackData )
+{
+  SignalIOTask task = (SignalIOTask) callbackData;
+  
+  int32 aquiredSamplesCount;
+  
+  //DEBUG_PRINT( "initializing read thread %lx", THREAD_ID );
+  
+  while( SyncTaskState( task ) )
+  {
+    // Tare requests are checked first, as the channels they acquire are then already visible
+    SyncVersion( &(task->tareVersion), StartReadTare, task );
+    SyncVersion( &(task->channelsVersion), UpdateReadChannels, task );
+    SyncVersion( &(task->filtersVersion), UpdateReadFilters, task );
+    SyncVersion( &(task->featuresVersion), UpdateReadFeatures, task );
+    SyncVersion( &(task->interlocksVersion), UpdateReadInterlocks, task );
+    SyncVersion( &(task->ensemblesVersion), UpdateReadEnsembles, task );
+    
+    // Tasks with no channels left to read (e.g. until the last release pauses them) block until woken by the next channels change
+    if( task->readChannelsNumber == 0 )
+    {
+      atomic_store( &(task->isProcessing), false );
+      Sem_Decrement( task->resumeLock );
+      atomic_store( &(task->isProcessing), true );
+      continue;
+    }
+    
+    int errorCode;
+    if( task->isChangeDetection ) errorCode = ReadLineSamples( task, &aquiredSamplesCount );
+    else
+    {
+      size_t blockLength = AdaptBlockLength( task );
+      errorCode = DAQmxReadAnalogF64( task->handle, blockLength, DAQmx_Val_WaitInfinitely, DAQmx_Val_GroupByScanNumber, 
+                                      task->samplesList, task->readChannelsNumber * blockLength, &aquiredSamplesCount, NULL );
+    }
+
+    if( errorCode < 0 )
+    {
+      static char errorMessage[ DEBUG_MESSAGE_LENGTH ];
+      DAQmxGetErrorString( errorCode, errorMessage, DEBUG_MESSAGE_LENGTH );
+      UpdateFaultState( task, true );
+    }
+    else
+    {
+      UpdateFaultState( task, false );
+      
+      // Change detection reads time out while lines stay still
+      if( aquiredSamplesCount == 0 ) continue;
+      
+      if( ( task->hasReadOffsets || task->isReadTaring ) && aquiredSamplesCount > 0 ) CalibrateReadFrames( task, (size_t) aquiredSamplesCount );
+      
+      if( task->readFilterLength > 0 && aquiredSamplesCount > 0 ) FilterReadFrames( task, (size_t) aquiredSamplesCount );
+      
+      // Only channels with readers are copied out of the (compact) scan frames
+      // History ring wraps around at most once per block (never inside fixed length ones)
+      size_t historyStart = atomic_load( &(task->samplesCount) ) % task->historyLength;
+      size_t firstSamplesNumber = task->historyLength - historyStart;
+      if( firstSamplesNumber > (size_t) aquiredSamplesCount ) firstSamplesNumber = (size_t) aquiredSamplesCount;
+      TransposeFramesFunction TransposeFirstFrames = ( firstSamplesNumber == AQUISITION_BUFFER_LENGTH ) ? task->TransposeBlock : TransposeFrames_Generic;
+      TransposeFirstFrames( task->readChannelsNumber, task->historySamplesList + historyStart, task->readChannelsList, task->historyLength, 
+                            task->samplesList, firstSamplesNumber );
+      TransposeFrames_Generic( task->readChannelsNumber, task->historySamplesList, task->readChannelsList, task->historyLength, 
+                               task->samplesList + firstSamplesNumber * task->readChannelsNumber, aquiredSamplesCount - firstSamplesNumber );
+      
+      if( task->readVirtualChannelsNumber > 0 ) EvaluateVirtualChannels( task, historyStart, firstSamplesNumber, (size_t) aquiredSamplesCount );
+      
+      //Sem_SetCount( task->channelLocksList[ channel ], task->channelUsesList[ channel ] );
+      
+      if( task->isChangeDetection ) DetectEdges( task, (size_t) aquiredSamplesCount );
+      
+      PublishBlock( task, (size_t) aquiredSamplesCount );
+      
+      if( task->readInterlocksNumber > 0 ) EvaluateInterlocks( task, atomic_load( &(task->samplesCount) ) - aquiredSamplesCount, (size_t) aquiredSamplesCount );
+      
+      CheckReaderDeadlines( task );
+      
+      if( task->readFeatureWindowLength > 0 ) AccumulateFeatures( task, atomic_load( &(task->samplesCount) ) - aquiredSamplesCount, (size_t) aquiredSamplesCount );
+      
+      if( task->readEnsemblesNumber > 0 ) ProcessEnsembles( task );
+    }
+  }
+  
+  //DEBUG_PRINT( "ending aquisition thread %x", THREAD_ID );
+  
+  return NULL;
+}
+
+static void* AsyncWriteBuffer( void* callbackData )
+{
+  SignalIOTask task = (SignalIOTask) callbackData;
+  
+  while( SyncTaskState( task ) )
+  {
+    //Sem_Decrement( task->channelLocksList[ 0 ] );
+    
+    SyncVersion( &(task->pacingVersion), UpdateWritePacing, task );
+    
+    if( task->readWatchdogTimeout > 0.0 && !task->isRegenerating ) UpdateWatchdog( task );
+    
+    UpdateInterlockState( task );
+    
+    // Committed group frames are also the base of the (restarted) output buffer and recorded mailbox merges
+    if( task->outputGroup != NULL ) ApplyGroupFrame( task );
+    
+    SignalMailbox mailbox = atomic_load( &(task->mailbox) );
+    if( mailbox != NULL ) MergeMailbox( task, mailbox );
+    
+    int errorCode;
+    if( atomic_load( &(task->pendingWaveform) ) != NULL || task->isRegenerating != IsWaveformActive( task ) ) errorCode = UpdateOutputWaveform( task );
+    else if( task->isRegenerating )
+    {
+      // Device loops the waveform on its own, so the thread just waits for changes
+      Sem_Decrement( task->resumeLock );
+      continue;
+    }
+    else if( task->samplingRate > 0.0 ) errorCode = WriteInterpolatedBlock( task );
+    else errorCode = WriteOnDemandValues( task );
+    // Output group members waiting on a sample clock already stopped by the leader are not faulted
+    if( errorCode < 0 && ( task->outputGroup == NULL || atomic_load( &(task->state) ) == TASK_RUNNING ) )
+    {
+      static char errorMessage[ DEBUG_MESSAGE_LENGTH ];
+      DAQmxGetErrorString( errorCode, errorMessage, DEBUG_MESSAGE_LENGTH );
+      //DEBUG_PRINT( "error aquiring analog signal: %s", errorMessage );
+      UpdateFaultState( task, true );
+    }
+    else if( errorCode >= 0 )
+    {
+      UpdateFaultState( task, false );
+      UpdateResumeLatency( task );
+      // Regenerating tasks are first restarted with safe values
+      if( task->isTripPending && task->isStarted && !task->isRegenerating ) MeasureInterlockLatency( task );
+    }
+    
+    //Sem_SetCount( task->channelLocksList[ 0 ], 1 );
+  }
+  
+  return NULL;
+}
+
+// Pauses task when its last channel user is gone
+bool CheckTask( SignalIOTask task )
+{
+  if( HasTaskUses( task ) ) return true;
+  
+  int state = TASK_RUNNING;
+  if( atomic_compare_exchange_strong( &(task->state), &state, TASK_PAUSED ) )
+  {
+    // Output threads idle on regenerated waveforms (or input ones with no channels to read) only stop the task when woken up
+    Sem_SetCount( task->resumeLock, 1 );
+
+    // Some channel could have been acquired between the uses check and the transition (seeing the task still running)
+    if( HasTaskUses( task ) ) 
+    {
+      ResumeTask( task );
+      return true;
+    }
+  }
+  
+  return false;
+}
+
+bool HasTaskUses( SignalIOTask task )
+{
+  if( task->outputGroup == NULL ) return HasChannelUses( task );
+  
+  for( size_t taskIndex = 0; taskIndex < task->outputGroup->tasksNumber; taskIndex++ )
+  {
+    if( HasChannelUses( task->outputGroup->tasksList[ taskIndex ] ) ) return true;
+  }
+  
+  return false;
+}
+
+bool HasChannelUses( SignalIOTask task )
+{
+  if( task->channelUsesList == NULL ) return false;
+  
+  for( size_t channel = 0; channel < task->channelsNumber; channel++ )
+  {
+    if( atomic_load( &(task->channelUsesList[ channel ]) ) > 0 ) return true;
+  }
+  
+  return false;
+}
+
+// Lifecycle transitions are only made by compare-and-swap, so that concurrent acquisitions start or wake the thread just once
+void ResumeTask( SignalIOTask task )
+{
+  int state = atomic_load( &(task->state) );
+  while( state != TASK_RUNNING && state != TASK_ENDING )
+  {
+    // Request time is already visible to the thread when it sees the new state
+    atomic_store( &(task->resumeRequestTime), (uint64_t) ( GetMonotonicTime() * 1e6 ) );
+    if( atomic_compare_exchange_weak( &(task->state), &state, TASK_RUNNING ) )
+    {
+      if( state == TASK_STOPPED ) 
+      {
+        // Threads failing to start the task stop it and exit, so they only have to be joined before starting a new one
+        if( task->threadID != THREAD_INVALID_HANDLE ) Thread_WaitExit( task->threadID, 5000 );
+        task->threadID = Thread_Start( ( task->mode == READ ) ? AsyncReadBuffer : AsyncWriteBuffer, task, THREAD_JOINABLE );
+      }
+      else Sem_SetCount( task->resumeLock, 1 );
+      return;
+    }
+  }
+}
+
+// Called by the acquisition/generation thread before each block. Paused tasks are stopped back to the committed 
+// state (keeping their driver resources reserved) and the thread blocks, with no CPU use, until the next resume
+bool SyncTaskState( SignalIOTask task )
+{
+  int state = atomic_load( &(task->state) );
+  if( state == TASK_RUNNING && task->isStarted ) return true;
+  
+  // Clients waiting for settings acknowledgements stop waiting while the thread is blocked or gone: it only resumes after copying them again
+  atomic_store( &(task->isProcessing), false );
+  
+  if( state == TASK_PAUSED && task->isStarted )
+  {
+    DAQmxStopTask( task->handle );
+    task->isStarted = false;
+    //DEBUG_PRINT( "task %ld paused", task->taskID );
+  }
+  
+  // Wake ups from stale resumes (already consumed by a running thread) only lead to one more wait
+  while( ( state = atomic_load( &(task->state) ) ) == TASK_PAUSED )
+    Sem_Decrement( task->resumeLock );
+  
+  if( state == TASK_ENDING ) return false;
+  
+  // Buffered outputs could only be started with some data already written
+  if( task->mode == WRITE && task->samplingRate > 0.0 ) PrepareOutputBuffer( task );
+  
+  // Output group leader only generates its sample clock and start trigger once the other members are waiting for them
+  if( task->outputGroup != NULL && task->outputGroup->tasksList[ 0 ] == task ) WaitGroupArmed( task );
+  
+  if( DAQmxStartTask( task->handle ) < 0 )
+  {
+    //DEBUG_PRINT( "error starting task %ld", task->taskID );
+    // Next acquisition may try to start a new thread
+    atomic_compare_exchange_strong( &(task->state), &state, TASK_STOPPED );
+    return false;
+  }
+  
+  // Start time is set first, as clients (output group commits) read it once the task is seen started
+  task->outputStartTime = GetMonotonicTime();
+  task->isStarted = true;
+  task->isResuming = true;
+  atomic_store( &(task->isProcessing), true );
+  // Unclocked outputs are rewritten on (re)start, as they are otherwise only updated on changes
+  if( task->mode == WRITE ) atomic_store( &(task->isOutputDirty), true );
+  
+  // Host times of blocks acquired before a restart no longer fit the sample clock
+  atomic_store( &(task->runStartBlock), atomic_load( &(task->blocksCount) ) );
+  
+  return true;
+}
+
+// Paused tasks keep running until their thread gets to stop them
+bool WaitTaskIdle( SignalIOTask task )
+{
+  while( atomic_load( &(task->state) ) == TASK_PAUSED && atomic_load( &(task->isStarted) ) )
+    WaitTime( VERSION_SYNC_INTERVAL );
+  
+  return ( atomic_load( &(task->state) ) != TASK_RUNNING && !atomic_load( &(task->isStarted) ) );
+}
+
+// Members still stopped (e.g. failing to start) are given up after a timeout, to not block the leader
+void WaitGroupArmed( SignalIOTask task )
+{
+  double timeoutTime = GetMonotonicTime() + OUTPUT_GROUP_ARM_TIMEOUT;
+  for( size_t taskIndex = 1; taskIndex < task->outputGroup->tasksNumber; taskIndex++ )
+  {
+    SignalIOTask memberTask = task->outputGroup->tasksList[ taskIndex ];
+    while( !atomic_load( &(memberTask->isStarted) ) && atomic_load( &(memberTask->state) ) == TASK_RUNNING && GetMonotonicTime() < timeoutTime )
+      WaitTime( INTERLOCK_SYNC_INTERVAL );
+  }
+}
+
+// Other members take their sample clock and start trigger from the first (leader) task device, keeping their previous clock sources
+bool LinkGroupTiming( SignalIOGroup group )
+{
+  char deviceName[ TASK_NAME_MAX_LENGTH ] = "";
+  if( DAQmxGetNthTaskDevice( group->tasksList[ 0 ]->handle, 1, deviceName, TASK_NAME_MAX_LENGTH ) < 0 ) return false;
+  
+  char clockTerminal[ CHANNEL_NAME_MAX_LENGTH ], triggerTerminal[ CHANNEL_NAME_MAX_LENGTH ];
+  snprintf( clockTerminal, CHANNEL_NAME_MAX_LENGTH, "/%s/ao/SampleClock", deviceName );
+  snprintf( triggerTerminal, CHANNEL_NAME_MAX_LENGTH, "/%s/ao/StartTrigger", deviceName );
+  
+  for( size_t taskIndex = 1; taskIndex < group->tasksNumber; taskIndex++ )
+  {
+    TaskHandle memberHandle = group->tasksList[ taskIndex ]->handle;
+    group->clockSourcesList[ taskIndex ] = (char*) calloc( CHANNEL_NAME_MAX_LENGTH, sizeof(char) );
+    if( DAQmxGetSampClkSrc( memberHandle, group->clockSourcesList[ taskIndex ], CHANNEL_NAME_MAX_LENGTH ) < 0
+        || DAQmxSetSampClkSrc( memberHandle, clockTerminal ) < 0 
+        || DAQmxCfgDigEdgeStartTrig( memberHandle, triggerTerminal, DAQmx_Val_Rising ) < 0
+        || DAQmxTaskControl( memberHandle, DAQmx_Val_Task_Commit ) < 0 )
+    {
+      UnlinkGroupTiming( group, taskIndex + 1 );
+      return false;
+    }
+  }
+  
+  return true;
+}
+
+void UnlinkGroupTiming( SignalIOGroup group, size_t tasksNumber )
+{
+  for( size_t taskIndex = 1; taskIndex < tasksNumber; taskIndex++ )
+  {
+    TaskHandle memberHandle = group->tasksList[ taskIndex ]->handle;
+    if( group->clockSourcesList[ taskIndex ] != NULL && group->clockSourcesList[ taskIndex ][ 0 ] != '\0' ) 
+      DAQmxSetSampClkSrc( memberHandle, group->clockSourcesList[ taskIndex ] );
+    DAQmxDisableStartTrig( memberHandle );
+    DAQmxTaskControl( memberHandle, DAQmx_Val_Task_Commit );
+  }
+}
+
+void InitVersion( SignalIOVersion* version )
+{
+  atomic_init( &(version->published), 0 );
+  atomic_init( &(version->acknowledged), 0 );
+}
+
+// Called by clients after changing the settings guarded by given version. Returns the new version, to be waited for if needed
+unsigned int PublishVersion( SignalIOVersion* version )
+{
+  return atomic_fetch_add( &(version->published), 1 ) + 1;
+}
+
+// Called by the task thread: copies the settings (with given update function) if their version changed since the last copy.
+// Versions published while copying are seen (and copied again) on the next call, as only the one read before is acknowledged
+bool SyncVersion( SignalIOVersion* version, void (*UpdateFunction)( SignalIOTask ), SignalIOTask task )
+{
+  unsigned int publishedVersion = atomic_load( &(version->published) );
+  if( publishedVersion == atomic_load_explicit( &(version->acknowledged), memory_order_relaxed ) ) return false;
+  
+  UpdateFunction( task );
+  
+  atomic_store( &(version->acknowledged), publishedVersion );
+  
+  return true;
+}
+
+// Called by clients that have to know when the thread no longer uses settings copied before given version (e.g. to free them)
+void WaitVersion( SignalIOTask task, SignalIOVersion* version, unsigned int publishedVersion )
+{
+  while( (int) ( atomic_load( &(version->acknowledged) ) - publishedVersion ) < 0 && atomic_load( &(task->isProcessing) ) )
+    WaitTime( VERSION_SYNC_INTERVAL );
+}
+
+// Time from (re)acquisition request to the first block processed after it, in microseconds
+void UpdateResumeLatency( SignalIOTask task )
+{
+  if( !task->isResuming ) return;
+  task->isResuming = false;
+  
+  // Concurrent resume requests may have stored a slightly later time
+  uint64_t currentTime = (uint64_t) ( GetMonotonicTime() * 1e6 );
+  uint64_t resumeRequestTime = atomic_load( &(task->resumeRequestTime) );
+  uint64_t resumeLatency = ( currentTime > resumeRequestTime ) ? currentTime - resumeRequestTime : 0;
+  atomic_store( &(task->resumeLatency), resumeLatency );
+  if( resumeLatency > atomic_load( &(task->maxResumeLatency) ) ) atomic_store( &(task->maxResumeLatency), resumeLatency );
+}
+
+// Restrict driver reads (and so scaling/transfer) to the channels that currently have readers
+void UpdateReadChannels( SignalIOTask task )
+{
+  task->readChannelsNumber = 0;
+  task->readChannelsString[ 0 ] = '\0';
+  // Device channels are also read while some active virtual channel depends on them
+  for( unsigned int channel = 0; channel < task->deviceChannelsNumber; channel++ )
+  {
+    if( atomic_load( &(task->channelUsesList[ channel ]) ) > 0 || IsVirtualOperand( task, channel ) )
+    {
+      if( task->readChannelsNumber > 0 ) strcat( task->readChannelsString, "," );
+      strcat( task->readChannelsString, task->channelNamesList[ channel ] );
+      task->readChannelsList[ task->readChannelsNumber++ ] = channel;
+      // Samples of newly activated channels are only valid from the next block on
+      uint64_t channelStart = CHANNEL_INACTIVE;
+      atomic_compare_exchange_strong( &(task->channelStartsList[ channel ]), &channelStart, atomic_load( &(task->samplesCount) ) );
+    }
+    else atomic_store( &(task->channelStartsList[ channel ]), CHANNEL_INACTIVE );
+  }
+  
+  task->readVirtualChannelsNumber = 0;
+  for( unsigned int channel = task->deviceChannelsNumber; channel < task->channelsNumber; channel++ )
+  {
+    if( atomic_load( &(task->channelUsesList[ channel ]) ) > 0 )
+    {
+      task->readVirtualChannelsList[ task->readVirtualChannelsNumber++ ] = channel;
+      uint64_t channelStart = CHANNEL_INACTIVE;
+      atomic_compare_exchange_strong( &(task->channelStartsList[ channel ]), &channelStart, atomic_load( &(task->samplesCount) ) );
+    }
+    else atomic_store( &(task->channelStartsList[ channel ]), CHANNEL_INACTIVE );
+  }
+  
+  if( task->readChannelsNumber > 0 ) DAQmxSetReadChannelsToRead( task->handle, task->readChannelsString );
+  
+  // Scan frames width only changes here, so its specialized block kernels are selected once
+  task->TransposeBlock = Kernels_GetTransposeBlock( task->readChannelsNumber );
+  task->CalibrateBlock = Kernels_GetCalibrateBlock( task->readChannelsNumber );
+  
+  UpdateReadFilters( task );
+  UpdateReadFeatures( task );
+  UpdateReadTare( task );
+}
+
+bool IsVirtualOperand( SignalIOTask task, unsigned int channel )
+{
+  for( unsigned int virtualChannel = task->deviceChannelsNumber; virtualChannel < task->channelsNumber; virtualChannel++ )
+  {
+    if( atomic_load( &(task->channelUsesList[ virtualChannel ]) ) == 0 ) continue;
+    if( Expression_UsesChannel( task->virtualChannelsList + ( virtualChannel - task->deviceChannelsNumber ), channel ) ) return true;
+  }
+  
+  return false;
+}
+
+// Virtual channels are computed from device ones already in history, over the (up to 2) contiguous ranges of the block
+void EvaluateVirtualChannels( SignalIOTask task, size_t historyStart, size_t firstSamplesNumber, size_t samplesNumber )
+{
+  for( size_t virtualIndex = 0; virtualIndex < task->readVirtualChannelsNumber; virtualIndex++ )
+  {
+    unsigned int channel = task->readVirtualChannelsList[ virtualIndex ];
+    const SignalExpression* expression = task->virtualChannelsList + ( channel - task->deviceChannelsNumber );
+    double* channelHistoryList = task->historySamplesList + channel * task->historyLength;
+    Expression_Evaluate( expression, task->historySamplesList, task->historyLength, historyStart, firstSamplesNumber, channelHistoryList + historyStart );
+    Expression_Evaluate( expression, task->historySamplesList, task->historyLength, 0, samplesNumber - firstSamplesNumber, channelHistoryList );
+  }
+}
+
+// Each new tare version is a single request, as the next one is only accepted after its completion
+void StartReadTare( SignalIOTask task )
+{
+  task->isReadTaring = true;
+  UpdateReadTare( task );
+}
+
+void UpdateReadTare( SignalIOTask task )
+{
+  task->hasReadOffsets = false;
+  for( size_t lane = 0; lane < task->readChannelsNumber; lane++ )
+  {
+    task->readOffsetsList[ lane ] = task->channelOffsetsList[ task->readChannelsList[ lane ] ];
+    if( task->readOffsetsList[ lane ] != 0.0 ) task->hasReadOffsets = true;
+  }
+  
+  // Averaging restarts whenever the scan frames layout changes
+  task->taredSamplesNumber = 0;
+  memset( task->tareSumsList, 0, task->channelsNumber * sizeof(double) );
+}
+
+// Bulk calibration of scan frames, before any other processing, so that all readers get the same offset corrected samples
+void CalibrateReadFrames( SignalIOTask task, size_t framesNumber )
+{
+  CalibrateFramesFunction CalibrateFrames = ( framesNumber == AQUISITION_BUFFER_LENGTH ) ? task->CalibrateBlock : Kernels.CalibrateFrames;
+  CalibrateFrames( task->samplesList, task->tareSumsList, task->readOffsetsList, task->readChannelsNumber, framesNumber );
+  
+  if( !task->isReadTaring ) return;
+  
+  task->taredSamplesNumber += framesNumber;
+  if( task->taredSamplesNumber < task->tareSamplesNumber ) return;
+  
+  // New offsets (means of raw samples) apply from the next block on
+  for( size_t lane = 0; lane < task->readChannelsNumber; lane++ )
+  {
+    unsigned int channel = task->readChannelsList[ lane ];
+    if( channel >= 64 || !( task->tareChannelsMask & ( (uint64_t) 1 << channel ) ) ) continue;
+    task->channelOffsetsList[ channel ] = task->tareSumsList[ lane ] / task->taredSamplesNumber;
+    task->readOffsetsList[ lane ] = task->channelOffsetsList[ channel ];
+    task->hasReadOffsets = true;
+  }
+  task->isReadTaring = false;
+  
+  for( unsigned int channel = 0; channel < task->channelsNumber && channel < 64; channel++ )
+  {
+    if( task->tareChannelsMask & ( (uint64_t) 1 << channel ) ) ReleaseInput( task, channel );
+  }
+  
+  atomic_store( &(task->isTaring), false );
+  SignalTaskEvents( task, SIGNAL_IO_EVENT_TARE_DONE );
+}
+
+void SignalTaskEvents( SignalIOTask task, unsigned int events )
+{
+  atomic_fetch_or( &(task->eventsMask), events );
+  Sem_SetCount( task->eventsLock, 1 );
+}
+
+// Filter thresholds follow the scan frames layout of the active channels
+void UpdateReadFilters( SignalIOTask task )
+{
+  SignalIOFilterSettingsData* filterSettings = atomic_load( &(task->filterSettings) );
+  task->readFilterLength = 0;
+  for( size_t lane = 0; lane < task->readChannelsNumber; lane++ )
+  {
+    task->readThresholdsList[ lane ] = filterSettings->thresholdsList[ task->readChannelsList[ lane ] ];
+    if( isfinite( task->readThresholdsList[ lane ] ) ) task->readFilterLength = filterSettings->windowLength;
+  }
+  
+  // Window frames from other layouts are discarded
+  task->filterFramesNumber = 0;
+}
+
+// Feature windows restart (with the client allocated terms ring) after each configuration or active channels change
+void UpdateReadFeatures( SignalIOTask task )
+{
+  // All settings come with their terms ring, so that the ones of different calls are never mixed
+  SignalIOFeatureTermsData* featureTerms = atomic_load( &(task->featureTerms) );
+  size_t windowLength = ( featureTerms != NULL ) ? featureTerms->windowLength : 0;
+  task->featureTermsList = ( featureTerms != NULL ) ? featureTerms->termsTable : NULL;
+  task->readFeatureWindowLength = windowLength;
+  
+  if( windowLength == 0 ) return;
+  
+  task->readFeatureIncrement = featureTerms->increment;
+  task->readFeatureThreshold = featureTerms->threshold;
+  
+  memset( task->featureTermsList, 0, windowLength * KERNEL_TERMS_NUMBER * task->readChannelsNumber * sizeof(double) );
+  memset( task->featureSumsList, 0, KERNEL_TERMS_NUMBER * task->readChannelsNumber * sizeof(double) );
+  task->featureTermsIndex = 0;
+  task->featureFramesCount = 0;
+}
+
+// Running window sums are updated on every frame, and feature windows are published every increment (once the first window is full).
+// Sums are recomputed from the stored terms on each terms ring wrap, so that rounding errors do not build up
+void AccumulateFeatures( SignalIOTask task, uint64_t firstSample, size_t framesNumber )
+{
+  size_t framesWidth = task->readChannelsNumber;
+  size_t windowLength = task->readFeatureWindowLength;
+  
+  if( task->featureFramesCount == 0 )
+  {
+    memcpy( task->featureLastFramesList, task->samplesList, framesWidth * sizeof(double) );
+    memcpy( task->featureLastFramesList + framesWidth, task->samplesList, framesWidth * sizeof(double) );
+  }
+  
+  size_t frame = 0;
+  while( frame < framesNumber )
+  {
+    uint64_t nextWindowEnd = windowLength;
+    if( task->featureFramesCount >= windowLength ) 
+      nextWindowEnd = task->featureFramesCount + task->readFeatureIncrement - ( task->featureFramesCount - windowLength ) % task->readFeatureIncrement;
+    
+    size_t segmentLength = framesNumber - frame;
+    if( segmentLength > windowLength - task->featureTermsIndex ) segmentLength = windowLength - task->featureTermsIndex;
+    if( segmentLength > nextWindowEnd - task->featureFramesCount ) segmentLength = nextWindowEnd - task->featureFramesCount;
+    
+    Kernels.AccumulateTerms( task->featureSumsList, task->featureTermsList + task->featureTermsIndex * KERNEL_TERMS_NUMBER * framesWidth,
+                             task->featureLastFramesList, task->samplesList + frame * framesWidth, framesWidth, segmentLength, 
+                             task->readFeatureThreshold );
+    
+    frame += segmentLength;
+    task->featureFramesCount += segmentLength;
+    task->featureTermsIndex += segmentLength;
+    
+    if( task->featureTermsIndex == windowLength )
+    {
+      task->featureTermsIndex = 0;
+      memset( task->featureSumsList, 0, KERNEL_TERMS_NUMBER * framesWidth * sizeof(double) );
+      for( size_t termsFrame = 0; termsFrame < windowLength; termsFrame++ )
+      {
+        const double* termsList = task->featureTermsList + termsFrame * KERNEL_TERMS_NUMBER * framesWidth;
+        for( size_t termIndex = 0; termIndex < KERNEL_TERMS_NUMBER * framesWidth; termIndex++ )
+          task->featureSumsList[ termIndex ] += termsList[ termIndex ];
+      }
+    }
+    
+    if( task->featureFramesCount == nextWindowEnd ) PublishFeatures( task, firstSample + frame );
+  }
+}
+
+void PublishFeatures( SignalIOTask task, uint64_t samplesEnd )
+{
+  size_t framesWidth = task->readChannelsNumber;
+  double windowLength = (double) task->readFeatureWindowLength;
+  
+  uint64_t windowsCount = atomic_load( &(task->featureWindowsCount) );
+  double* window = task->featureWindowsList + ( windowsCount % FEATURE_WINDOWS_NUMBER ) * ( 1 + task->channelsNumber * SIGNAL_IO_EMG_FEATURES_NUMBER );
+  
+  window[ 0 ] = GetSampleTime( task, samplesEnd - 1 );
+  // Channels with no readers have no features
+  for( size_t featureIndex = 0; featureIndex < task->channelsNumber * SIGNAL_IO_EMG_FEATURES_NUMBER; featureIndex++ )
+    window[ 1 + featureIndex ] = NAN;
+  for( size_t lane = 0; lane < framesWidth; lane++ )
+  {
+    const double* sumsList = task->featureSumsList + lane;
+    double* featuresList = window + 1 + task->readChannelsList[ lane ] * SIGNAL_IO_EMG_FEATURES_NUMBER;
+    featuresList[ SIGNAL_IO_EMG_MAV ] = sumsList[ KERNEL_TERM_ABS * framesWidth ] / windowLength;
+    featuresList[ SIGNAL_IO_EMG_WL ] = sumsList[ KERNEL_TERM_LENGTH * framesWidth ];
+    featuresList[ SIGNAL_IO_EMG_ZC ] = sumsList[ KERNEL_TERM_ZERO_CROSS * framesWidth ];
+    featuresList[ SIGNAL_IO_EMG_SSC ] = sumsList[ KERNEL_TERM_SLOPE_CHANGE * framesWidth ];
+    featuresList[ SIGNAL_IO_EMG_RMS ] = sqrt( fmax( sumsList[ KERNEL_TERM_SQUARE * framesWidth ], 0.0 ) / windowLength );
+  }
+  
+  atomic_store( &(task->featureWindowsCount), windowsCount + 1 );
+}
+
+// Ensembles (with their triggers) stay valid until the acknowledged version changes again. Detection restarts on trigger changes
+void UpdateReadEnsembles( SignalIOTask task )
+{
+  task->readEnsemblesNumber = task->ensemblesNumber;
+  if( task->readEnsemblesNumber > ENSEMBLES_MAX_NUMBER ) task->readEnsemblesNumber = ENSEMBLES_MAX_NUMBER;
+  for( size_t ensembleIndex = 0; ensembleIndex < task->readEnsemblesNumber; ensembleIndex++ )
+  {
+    SignalIOEnsemble ensemble = task->ensemblesList[ ensembleIndex ];
+    task->readEnsemblesList[ ensembleIndex ] = ensemble;
+    
+    SignalIOTrigger trigger = atomic_load( &(ensemble->trigger) );
+    if( trigger == ensemble->readTrigger ) continue;
+    ensemble->readTrigger = trigger;
+    ensemble->lastTriggerValue = NAN;
+    ensemble->triggerCursor = ( trigger != NULL ) ? trigger->startCursor : 0;
+    ensemble->pendingTriggersNumber = 0;
+  }
+}
+
+// Sweeps around detected triggers are accumulated once all of their samples are in history
+void ProcessEnsembles( SignalIOTask task )
+{
+  uint64_t samplesCount = atomic_load( &(task->samplesCount) );
+  
+  for( size_t ensembleIndex = 0; ensembleIndex < task->readEnsemblesNumber; ensembleIndex++ )
+  {
+    SignalIOEnsemble ensemble = task->readEnsemblesList[ ensembleIndex ];
+    SignalIOReader reader = ensemble->reader;
+    
+    DetectTriggers( task, ensemble );
+    
+    while( ensemble->pendingTriggersNumber > 0 )
+    {
+      uint64_t triggerSample = ensemble->pendingTriggersList[ ensemble->pendingTriggersStart ];
+      if( triggerSample + ensemble->sweepLength - ensemble->preSamplesNumber > samplesCount ) break;
+      ensemble->pendingTriggersStart = ( ensemble->pendingTriggersStart + 1 ) % ENSEMBLE_PENDING_SWEEPS_NUMBER;
+      ensemble->pendingTriggersNumber--;
+      
+      // Sweeps starting before the aquisition (or channels activation) are discarded
+      if( triggerSample < ensemble->preSamplesNumber ) continue;
+      bool isSweepComplete = true;
+      for( size_t channelIndex = 0; channelIndex < reader->channelsNumber && isSweepComplete; channelIndex++ )
+      {
+        isSweepComplete = CopyHistorySamples( task, reader->channelsList[ channelIndex ], triggerSample - ensemble->preSamplesNumber, 
+                                              ensemble->sweepLength, ensemble->sweepTable + channelIndex * ensemble->sweepLength );
+      }
+      if( !isSweepComplete ) continue;
+      
+      atomic_fetch_add( &(ensemble->sequence), 1 );
+      ensemble->sweepsCount++;
+      Kernels.UpdateMeans( ensemble->meansTable, ensemble->deviationsTable, ensemble->sweepTable, 
+                           reader->channelsNumber * ensemble->sweepLength, (double) ensemble->sweepsCount );
+      atomic_fetch_add( &(ensemble->sequence), 1 );
+    }
+  }
+}
+
+// Triggers are rising crossings of the trigger level (or markers with the trigger code), converted to sample positions
+void DetectTriggers( SignalIOTask task, SignalIOEnsemble ensemble )
+{
+  SignalIOTrigger trigger = ensemble->readTrigger;
+  if( trigger == NULL ) return;
+  
+  double clockOffset = GetClockOffset( task );
+  
+  if( trigger->source == SIGNAL_IO_TRIGGER_INPUT_LEVEL )
+  {
+    uint64_t samplesCount = atomic_load( &(task->samplesCount) );
+    uint64_t channelStart = atomic_load( &(task->channelStartsList[ trigger->channel ]) );
+    if( channelStart == CHANNEL_INACTIVE ) return;
+    if( ensemble->triggerCursor < channelStart ) ensemble->triggerCursor = channelStart;
+    const double* triggerHistoryList = task->historySamplesList + trigger->channel * task->historyLength;
+    for( ; ensemble->triggerCursor < samplesCount; ensemble->triggerCursor++ )
+    {
+      double triggerValue = triggerHistoryList[ ensemble->triggerCursor % task->historyLength ];
+      if( ensemble->lastTriggerValue < trigger->level && triggerValue >= trigger->level ) AddTrigger( ensemble, ensemble->triggerCursor );
+      ensemble->lastTriggerValue = triggerValue;
+    }
+  }
+  else if( trigger->source == SIGNAL_IO_TRIGGER_OUTPUT_LEVEL )
+  {
+    SignalRecorder recorder = trigger->task->recorder;
+    uint64_t framesCount = atomic_load( &(recorder->header->framesCount) );
+    if( framesCount - ensemble->triggerCursor > recorder->header->framesNumber ) ensemble->triggerCursor = framesCount - recorder->header->framesNumber;
+    for( ; ensemble->triggerCursor < framesCount; ensemble->triggerCursor++ )
+    {
+      const double* frame = recorder->framesList + ( ensemble->triggerCursor % recorder->header->framesNumber ) * recorder->header->framesWidth;
+      double triggerValue = frame[ 1 + trigger->channel ];
+      double triggerPosition = round( ( frame[ 0 ] - clockOffset ) * task->samplingRate );
+      if( ensemble->lastTriggerValue < trigger->level && triggerValue >= trigger->level && triggerPosition >= 0.0 )
+        AddTrigger( ensemble, (uint64_t) triggerPosition );
+      ensemble->lastTriggerValue = triggerValue;
+    }
+  }
+  else if( trigger->source == SIGNAL_IO_TRIGGER_MARKER )
+  {
+    SignalRecorder recorder = trigger->task->recorder;
+    uint64_t markersCount = atomic_load( &(recorder->header->markersCount) );
+    if( markersCount - ensemble->triggerCursor > recorder->header->markersNumber ) ensemble->triggerCursor = markersCount - recorder->header->markersNumber;
+    SignalRecorderMarker marker;
+    for( ; ensemble->triggerCursor < markersCount; ensemble->triggerCursor++ )
+    {
+      int readStatus = Recorder_ReadMarker( recorder, ensemble->triggerCursor, &marker );
+      if( readStatus == 0 ) break;
+      if( readStatus != 1 || marker.code != trigger->channel ) continue;
+      // Markers placed on the averaged task already carry its sample position
+      if( trigger->task == task ) AddTrigger( ensemble, marker.sampleIndex );
+      else if( marker.time >= clockOffset ) AddTrigger( ensemble, (uint64_t) round( ( marker.time - clockOffset ) * task->samplingRate ) );
+    }
+  }
+}
+
+// Triggers beyond the pending sweeps capacity are dropped
+void AddTrigger( SignalIOEnsemble ensemble, uint64_t triggerSample )
+{
+  if( ensemble->pendingTriggersNumber >= ENSEMBLE_PENDING_SWEEPS_NUMBER ) return;
+  
+  size_t triggerIndex = ( ensemble->pendingTriggersStart + ensemble->pendingTriggersNumber ) % ENSEMBLE_PENDING_SWEEPS_NUMBER;
+  ensemble->pendingTriggersList[ triggerIndex ] = triggerSample;
+  ensemble->pendingTriggersNumber++;
+}
+
+// Causal median/Hampel filtering of the acquired scan frames, in place, before they are copied to the channels history
+void FilterReadFrames( SignalIOTask task, size_t framesNumber )
+{
+  size_t framesWidth = task->readChannelsNumber;
+  size_t previousFramesNumber = task->readFilterLength - 1;
+  
+  // Window starts filled with the first acquired frame, after each filters or active channels change
+  if( task->filterFramesNumber < previousFramesNumber )
+  {
+    for( size_t frame = 0; frame < previousFramesNumber; frame++ )
+      memcpy( task->filterFramesList + frame * framesWidth, task->samplesList, framesWidth * sizeof(double) );
+    task->filterFramesNumber = previousFramesNumber;
+  }
+  
+  memcpy( task->filterFramesList + previousFramesNumber * framesWidth, task->samplesList, framesNumber * framesWidth * sizeof(double) );
+  
+  Kernels.FilterFrames( task->samplesList, task->filterFramesList, task->readThresholdsList, framesWidth, task->readFilterLength, framesNumber );
+  
+  // Raw (unfiltered) frames are kept for the next windows
+  memmove( task->filterFramesList, task->filterFramesList + framesNumber * framesWidth, previousFramesNumber * framesWidth * sizeof(double) );
+}
+
+// Change detection tasks only produce samples (line states of read channels) on edges, so reads wait for the first one 
+// for a limited time (for pauses to be handled), and then take any backlog along
+int ReadLineSamples( SignalIOTask task, int32* ref_samplesCount )
+{
+  *ref_samplesCount = 0;
+  
+  // Backlog samples were all detected between the last read and the query
+  double queryTime = GetMonotonicTime();
+  if( task->isResuming ) task->detectionTime = queryTime;
+  
+  uInt32 availableSamplesNumber = 0;
+  if( DAQmxGetReadAvailSampPerChan( task->handle, &availableSamplesNumber ) < 0 ) availableSamplesNumber = 0;
+  if( availableSamplesNumber > AQUISITION_BUFFER_MAX_LENGTH ) availableSamplesNumber = AQUISITION_BUFFER_MAX_LENGTH;
+  
+  int32 samplesNumber = ( availableSamplesNumber > 0 ) ? (int32) availableSamplesNumber : 1;
+  int32 sampleBytesNumber;
+  int errorCode = DAQmxReadDigitalLines( task->handle, samplesNumber, EDGES_WAIT_TIMEOUT, DAQmx_Val_GroupByScanNumber, task->linesList, 
+                                         task->readChannelsNumber * samplesNumber, ref_samplesCount, &sampleBytesNumber, NULL );
+  if( errorCode == DAQmxErrorSamplesNotYetAvailable ) return 0;
+  if( errorCode < 0 ) return errorCode;
+  
+  // A waited for sample is detected just before the read returns
+  task->lastDetectionTime = task->detectionTime;
+  task->detectionTime = ( availableSamplesNumber > 0 ) ? queryTime : GetMonotonicTime();
+  task->detectionSamplesStart = atomic_load( &(task->samplesCount) );
+  task->detectionSamplesEnd = task->detectionSamplesStart + (uint64_t) *ref_samplesCount;
+  
+  for( size_t lineIndex = 0; lineIndex < task->readChannelsNumber * (size_t) *ref_samplesCount; lineIndex++ )
+    task->samplesList[ lineIndex ] = (double) task->linesList[ lineIndex ];
+  
+  return errorCode;
+}
+
+// Edges are timestamped with the change detection sample index and its estimated detection time (see GetDetectionTime). 
+// Line states are unknown after (re)starts or read channels changes, and the first sample then only sets them
+void DetectEdges( SignalIOTask task, size_t framesNumber )
+{
+  unsigned int channelsVersion = atomic_load( &(task->channelsVersion.acknowledged) );
+  if( task->isResuming || task->edgeChannelsVersion != channelsVersion )
+  {
+    memset( task->lineLevelsList, -1, task->deviceChannelsNumber * sizeof(int8_t) );
+    task->edgeChannelsVersion = channelsVersion;
+  }
+  
+  uint64_t firstSample = atomic_load( &(task->samplesCount) );
+  uint64_t firstEdge = atomic_load( &(task->edgesCount) );
+  uint64_t edgesCount = firstEdge;
+  for( size_t frame = 0; frame < framesNumber; frame++ )
+  {
+    const uInt8* linesList = task->linesList + frame * task->readChannelsNumber;
+    for( size_t lineIndex = 0; lineIndex < task->readChannelsNumber; lineIndex++ )
+    {
+      unsigned int channel = task->readChannelsList[ lineIndex ];
+      int8_t level = ( linesList[ lineIndex ] != 0 ) ? 1 : 0;
+      int8_t lastLevel = task->lineLevelsList[ channel ];
+      task->lineLevelsList[ channel ] = level;
+      if( lastLevel < 0 || lastLevel == level ) continue;
+      SignalIOEdge* edge = &(task->edgesList[ edgesCount % EDGES_NUMBER ]);
+      edge->sampleIndex = firstSample + frame;
+      edge->time = GetDetectionTime( task, edge->sampleIndex );
+      edge->channel = channel;
+      edge->isRising = ( level > 0 );
+      // Each edge is published on its own, so that readers never see partially written ones as valid
+      atomic_store( &(task->edgesCount), ++edgesCount );
+    }
+  }
+  
+  // Consumers waiting on task events are only woken up by actual edges
+  if( edgesCount > firstEdge ) SignalTaskEvents( task, SIGNAL_IO_EVENT_EDGES );
+}
+
+
+size_t GetHistogramBin( uint64_t microseconds )
+{
+  size_t binIndex = 0;
+  while( microseconds > 1 && binIndex < SIGNAL_IO_READER_HISTOGRAM_BINS - 1 )
+  {
+    microseconds >>= 1;
+    binIndex++;
+  }
+  
+  return binIndex;
+}
+
+// Runs on the client thread calling Read(), so monitoring costs nothing to readers with no declared deadline
+void UpdateReaderTiming( SignalIOReader reader, size_t samplesNumber, double timestamp )
+{
+  SignalIOReaderDeadline deadline = atomic_load( &(reader->deadline) );
+  if( deadline == NULL ) return;
+  
+  double readTime = GetMonotonicTime();
+  uint64_t expectedPeriod = atomic_load( &(deadline->expectedPeriod) );
+  uint64_t maxDataAge = atomic_load( &(deadline->maxDataAge) );
+  bool isLate = false;
+  
+  if( reader->lastReadTime > 0.0 )
+  {
+    uint64_t readInterval = (uint64_t) ( ( readTime - reader->lastReadTime ) * 1e6 );
+    atomic_fetch_add( &(reader->readIntervalsHistogram[ GetHistogramBin( readInterval ) ]), 1 );
+    if( readInterval > atomic_load( &(reader->maxReadInterval) ) ) atomic_store( &(reader->maxReadInterval), readInterval );
+    if( expectedPeriod > 0 && readInterval > expectedPeriod * READER_PERIOD_TOLERANCE ) isLate = true;
+  }
+  
+  if( samplesNumber > 0 )
+  {
+    uint64_t dataAge = (uint64_t) ( fmax( readTime - timestamp, 0.0 ) * 1e6 );
+    atomic_fetch_add( &(reader->dataAgesHistogram[ GetHistogramBin( dataAge ) ]), 1 );
+    if( dataAge > atomic_load( &(reader->maxDataAge) ) ) atomic_store( &(reader->maxDataAge), dataAge );
+    if( maxDataAge > 0 && dataAge > maxDataAge ) isLate = true;
+  }
+  
+  reader->lastReadTime = readTime;
+  atomic_fetch_add( &(reader->readsCount), 1 );
+  atomic_store( &(deadline->lastReadTime), (uint64_t) ( readTime * 1e6 ) );
+  
+  if( isLate )
+  {
+    atomic_fetch_add( &(reader->lateReadsCount), 1 );
+    if( !atomic_exchange( &(deadline->isLate), true ) ) SignalTaskEvents( reader->task, SIGNAL_IO_EVENT_LATE_READER );
+  }
+}
+
+// Readers that stopped calling Read() are flagged by the aquisition thread, before their next (late) read
+void CheckReaderDeadlines( SignalIOTask task )
+{
+  uint64_t currentTime = 0;
+  for( size_t deadlineIndex = 0; deadlineIndex < READER_DEADLINES_MAX_NUMBER; deadlineIndex++ )
+  {
+    SignalIOReaderDeadline deadline = &(task->readerDeadlinesList[ deadlineIndex ]);
+    if( !atomic_load( &(deadline->isUsed) ) ) continue;
+    
+    uint64_t expectedPeriod = atomic_load( &(deadline->expectedPeriod) );
+    uint64_t lastReadTime = atomic_load( &(deadline->lastReadTime) );
+    if( expectedPeriod == 0 || lastReadTime == 0 || atomic_load( &(deadline->isLate) ) ) continue;
+    
+    if( currentTime == 0 ) currentTime = (uint64_t) ( GetMonotonicTime() * 1e6 );
+    if( currentTime > lastReadTime + expectedPeriod * READER_PERIOD_TOLERANCE )
+    {
+      if( !atomic_exchange( &(deadline->isLate), true ) ) SignalTaskEvents( task, SIGNAL_IO_EVENT_LATE_READER );
+    }
+  }
+}
+
+// Rules (with their output tasks) stay valid until the acknowledged version changes again
+void UpdateReadInterlocks( SignalIOTask task )
+{
+  task->readInterlocksNumber = task->interlocksNumber;
+  if( task->readInterlocksNumber > INTERLOCKS_MAX_NUMBER ) task->readInterlocksNumber = INTERLOCKS_MAX_NUMBER;
+  for( size_t interlockIndex = 0; interlockIndex < task->readInterlocksNumber; interlockIndex++ )
+    task->readInterlocksList[ interlockIndex ] = *(task->interlocksList[ interlockIndex ]);
+}
+
+// Every new sample of the monitored channels is checked, and output tasks trip on the first one meeting some rule condition
+void EvaluateInterlocks( SignalIOTask task, uint64_t firstSample, size_t samplesNumber )
+{
+  for( size_t interlockIndex = 0; interlockIndex < task->readInterlocksNumber; interlockIndex++ )
+  {
+    SignalIOInterlock interlock = &(task->readInterlocksList[ interlockIndex ]);
+    if( atomic_load( &(interlock->outputTask->interlockTripTime) ) != 0 ) continue;
+    
+    unsigned int channel = interlock->channel;
+    uint64_t channelStart = atomic_load( &(task->channelStartsList[ channel ]) );
+    if( channelStart == CHANNEL_INACTIVE ) continue;
+    
+    const double* channelHistoryList = task->historySamplesList + channel * task->historyLength;
+    for( uint64_t sampleIndex = ( channelStart > firstSample ) ? channelStart : firstSample; sampleIndex < firstSample + samplesNumber; sampleIndex++ )
+    {
+      double value = channelHistoryList[ sampleIndex % task->historyLength ];
+      bool isTripped = ( interlock->condition == SIGNAL_IO_INTERLOCK_ABOVE ) ? ( value > interlock->threshold ) : ( value < interlock->threshold );
+      if( isTripped )
+      {
+        TripInterlock( task, interlock->outputTask, sampleIndex );
+        break;
+      }
+    }
+  }
+}
+
+// Trip time is the one of the offending sample (its block time for unclocked tasks), in microseconds (0 while not tripped)
+void TripInterlock( SignalIOTask task, SignalIOTask outputTask, uint64_t sampleIndex )
+{
+  double tripTime = ( task->samplingRate > 0.0 ) ? GetSampleTime( task, sampleIndex ) : GetMonotonicTime();
+  unsigned long long tripTicks = (unsigned long long) fmax( tripTime * 1e6, 1.0 );
+  
+  unsigned long long noTripTicks = 0;
+  if( !atomic_compare_exchange_strong( &(outputTask->interlockTripTime), &noTripTicks, tripTicks ) ) return;
+  
+  // Output threads idle on regenerated waveforms are woken up to stop them
+  atomic_store( &(outputTask->isOutputDirty), true );
+  if( outputTask->resumeLock != NULL ) Sem_SetCount( outputTask->resumeLock, 1 );
+}
+
+
+void PublishBlock( SignalIOTask task, size_t samplesNumber )
+{
+  uint64_t samplesEnd = atomic_load( &(task->samplesCount) ) + samplesNumber;
+  uint64_t blocksCount = atomic_load( &(task->blocksCount) );
+  
+  SignalIOBlockData* block = &(task->blocksList[ blocksCount % HISTORY_BLOCKS_NUMBER ]);
+  block->samplesEnd = samplesEnd;
+  block->samplesNumber = samplesNumber;
+  block->time = GetMonotonicTime();
+  
+  atomic_store( &(task->samplesCount), samplesEnd );
+  atomic_store( &(task->blocksCount), blocksCount + 1 );
+  
+  UpdateResumeLatency( task );
+}
+
+// Adaptive mode reads whatever the driver has available, from the current block length up to the configured max one.
+// Block length grows as soon as driver backlog rises, but only shrinks after it stays low for a few blocks.
+// Readers lag is not considered: aquisition never waits for them, and cursor readers catch up from history by their policies
+size_t AdaptBlockLength( SignalIOTask task )
+{
+  size_t maxBlockLength = atomic_load( &(task->maxBlockLength) );
+  if( maxBlockLength == 0 ) return AQUISITION_BUFFER_LENGTH;
+  
+  if( task->blockLength == 0 || task->blockLength > maxBlockLength ) task->blockLength = maxBlockLength;
+  
+  uInt32 availableSamplesNumber = 0;
+  if( DAQmxGetReadAvailSampPerChan( task->handle, &availableSamplesNumber ) < 0 ) return task->blockLength;
+  
+  if( availableSamplesNumber > 2 * task->blockLength )
+  {
+    task->blockLength = ( 2 * task->blockLength < maxBlockLength ) ? 2 * task->blockLength : maxBlockLength;
+    task->shrinkBlocksCount = 0;
+  }
+  else if( 2 * availableSamplesNumber < task->blockLength )
+  {
+    if( ++task->shrinkBlocksCount >= ADAPTIVE_BLOCK_SHRINK_DELAY )
+    {
+      task->blockLength = ( task->blockLength > 1 ) ? task->blockLength / 2 : 1;
+      task->shrinkBlocksCount = 0;
+    }
+  }
+  else task->shrinkBlocksCount = 0;
+  
+  if( availableSamplesNumber < task->blockLength ) return task->blockLength;
+  
+  return ( availableSamplesNumber < maxBlockLength ) ? availableSamplesNumber : maxBlockLength;
+}
+
+double GetMonotonicTime( void )
+{
+#ifdef _WIN32
+  LARGE_INTEGER ticksCount, ticksFrequency;
+  QueryPerformanceCounter( &ticksCount );
+  QueryPerformanceFrequency( &ticksFrequency );
+  return (double) ticksCount.QuadPart / ticksFrequency.QuadPart;
+#else
+  struct timespec currentTime;
+  clock_gettime( CLOCK_MONOTONIC, &currentTime );
+  return currentTime.tv_sec + currentTime.tv_nsec / 1e9;
+#endif
+}
+
+// Extrapolates from the last block arrival time, taken as the time of its last sample
+double GetSampleTime( SignalIOTask task, double samplePosition )
+{
+  return GetClockOffset( task ) + samplePosition / task->samplingRate;
+}
+
+// Change detection samples have no clock: the ones of the last read are taken as evenly spread over the time
+// since the previous read returned, the newest one being detected at the read (or backlog query) time
+double GetDetectionTime( SignalIOTask task, uint64_t sampleIndex )
+{
+  double samplesNumber = (double) ( task->detectionSamplesEnd - task->detectionSamplesStart );
+  double samplePosition = (double) ( sampleIndex - task->detectionSamplesStart + 1 );
+  return task->lastDetectionTime + ( task->detectionTime - task->lastDetectionTime ) * samplePosition / samplesNumber;
+}
+
+// Sample clock model: a block arrives no earlier than its last sample, so the least delayed of the recent
+// blocks (since the acquisition thread last started) gives the best estimate of the monotonic time of sample 0
+double GetClockOffset( SignalIOTask task )
+{
+  uint64_t blocksCount = atomic_load( &(task->blocksCount) );
+  uint64_t firstBlock = atomic_load( &(task->runStartBlock) );
+  if( blocksCount <= firstBlock ) return 0.0;
+  if( blocksCount - firstBlock > CLOCK_FIT_BLOCKS_NUMBER ) firstBlock = blocksCount - CLOCK_FIT_BLOCKS_NUMBER;
+  
+  double clockOffset = INFINITY;
+  for( uint64_t blockIndex = firstBlock; blockIndex < blocksCount; blockIndex++ )
+  {
+    SignalIOBlockData* block = &(task->blocksList[ blockIndex % HISTORY_BLOCKS_NUMBER ]);
+    double blockClockOffset = block->time - ( block->samplesEnd - 1 ) / task->samplingRate;
+    if( blockClockOffset < clockOffset ) clockOffset = blockClockOffset;
+  }
+  
+  return clockOffset;
+}
+
+// Copies samples [firstSample, firstSample + samplesNumber) of channel history, failing if they are not (or no more) available
+bool CopyHistorySamples( SignalIOTask task, unsigned int channel, uint64_t firstSample, size_t samplesNumber, double* samplesList )
+{
+  uint64_t channelStart = atomic_load( &(task->channelStartsList[ channel ]) );
+  if( channelStart == CHANNEL_INACTIVE || firstSample < channelStart ) return false;
+  
+  uint64_t samplesCount = atomic_load( &(task->samplesCount) );
+  if( firstSample + samplesNumber > samplesCount || samplesCount - firstSample > task->historyLength ) return false;
+  
+  const double* channelHistoryList = task->historySamplesList + channel * task->historyLength;
+  size_t historyPosition = firstSample % task->historyLength;
+  size_t firstSamplesNumber = task->historyLength - historyPosition;
+  if( firstSamplesNumber > samplesNumber ) firstSamplesNumber = samplesNumber;
+  memcpy( samplesList, channelHistoryList + historyPosition, firstSamplesNumber * sizeof(double) );
+  memcpy( samplesList + firstSamplesNumber, channelHistoryList, ( samplesNumber - firstSamplesNumber ) * sizeof(double) );
+  
+  // Acquisition thread could have overwritten the copied samples meanwhile (or be overwriting them, one block ahead)
+  samplesCount = atomic_load( &(task->samplesCount) );
+  return ( samplesCount - firstSample + AQUISITION_BUFFER_MAX_LENGTH <= task->historyLength );
+}
+
+// Requests (also made from acquisition/generation threads, on faults) only keep the current recording position, with no 
+// allocations or copies: the task dump thread takes the region snapshot up to it, and writes it to file (one dump at a time)
+bool DumpTaskRecording( SignalIOTask task, const char* filePath, const char* reason )
+{
+  if( task->recorder == NULL ) return false;
+  
+  bool isDumping = false;
+  if( !atomic_compare_exchange_strong( &(task->isDumping), &isDumping, true ) ) return false;
+  
+  task->dumpSamplesEnd = ( task->mode == READ ) ? atomic_load( &(task->samplesCount) ) : 0;
+  task->dumpFramesEnd = atomic_load( &(task->recorder->header->framesCount) );
+  task->dumpMarkersEnd = atomic_load( &(task->recorder->header->markersCount) );
+  
+  if( filePath != NULL ) snprintf( task->dumpFilePath, RECORDER_NAME_MAX_LENGTH, "%s", filePath );
+  else snprintf( task->dumpFilePath, RECORDER_NAME_MAX_LENGTH, "%s_%s.sigrec", task->name, reason );
+  
+  Sem_SetCount( task->dumpLock, 1 );
+  
+  return true;
+}
+
+static void* AsyncDumpRecording( void* callbackData )
+{
+  SignalIOTask task = (SignalIOTask) callbackData;
+  
+  // Requested dumps are still written when the task is ending
+  do
+  {
+    Sem_Decrement( task->dumpLock );
+    
+    if( atomic_load( &(task->isDumping) ) )
+    {
+      // Crash recovery dumps come with their snapshot, taken before the region reset
+      if( task->dumpSnapshot == NULL )
+      {
+        task->dumpSnapshot = Recorder_TakeSnapshot( task->recorder, AQUISITION_BUFFER_MAX_LENGTH );
+        if( task->dumpSnapshot != NULL ) Recorder_LimitSnapshot( task->dumpSnapshot, task->dumpSamplesEnd, task->dumpFramesEnd, task->dumpMarkersEnd );
+      }
+      if( task->dumpSnapshot == NULL ) { /*DEBUG_PRINT( "error copying recording %s", task->dumpFilePath );*/ }
+      else if( !Recorder_Dump( task->dumpSnapshot, task->dumpFilePath ) ) { /*DEBUG_PRINT( "error writing recording %s", task->dumpFilePath );*/ }
+      
+      Recorder_DiscardSnapshot( task->dumpSnapshot );
+      task->dumpSnapshot = NULL;
+      atomic_store( &(task->isDumping), false );
+    }
+  }
+  while( atomic_load( &(task->state) ) != TASK_ENDING );
+  
+  return NULL;
+}
+
+// Markers are placed on input sample or output frame counts, which are known without waiting for the acquisition thread
+bool MarkTask( SignalIOTask task, unsigned int code, double payload )
+{
+  SignalRecorderMarker marker = { 0, GetMonotonicTime(), code, 0, payload };
+  marker.sampleIndex = ( task->mode == READ ) ? atomic_load( &(task->samplesCount) ) : atomic_load( &(task->recorder->header->framesCount) );
+  
+  Recorder_WriteMarker( task->recorder, &marker );
+  
+  return true;
+}
+
+size_t ReadTaskMarkers( SignalIOTask task, uint64_t* ref_cursor, SignalIOMarker* markersList, size_t maxMarkersNumber )
+{
+  SignalRecorderHeader* recorderHeader = task->recorder->header;
+  
+  uint64_t markersCount = atomic_load( &(recorderHeader->markersCount) );
+  if( *ref_cursor > markersCount || markersCount - *ref_cursor > recorderHeader->markersNumber )
+    *ref_cursor = ( markersCount > recorderHeader->markersNumber ) ? markersCount - recorderHeader->markersNumber : 0;
+  
+  size_t markersNumber = 0;
+  while( *ref_cursor < markersCount && markersNumber < maxMarkersNumber )
+  {
+    SignalRecorderMarker marker;
+    int readStatus = Recorder_ReadMarker( task->recorder, *ref_cursor, &marker );
+    // Following markers wait for the ones still being written, keeping their order
+    if( readStatus == 0 ) break;
+    (*ref_cursor)++;
+    if( readStatus < 0 ) continue;
+    SignalIOMarker* newMarker = &(markersList[ markersNumber++ ]);
+    newMarker->sampleIndex = marker.sampleIndex;
+    newMarker->time = marker.time;
+    newMarker->code = marker.code;
+    newMarker->payload = marker.payload;
+  }
+  
+  return markersNumber;
+}
+
+// Generation (re)starts holding current values, with the driver buffer only OUTPUT_LEAD_BLOCKS_NUMBER blocks long, 
+// so that blocking writes keep the thread that far ahead of the hardware
+void PrepareOutputBuffer( SignalIOTask task )
+{
+  // Regenerated waveforms fill the whole buffer, which the device keeps looping
+  task->isRegenerating = IsWaveformActive( task );
+  if( task->isRegenerating )
+  {
+    int32 writtenSamplesCount;
+    DAQmxSetWriteRegenMode( task->handle, DAQmx_Val_AllowRegen );
+    DAQmxCfgOutputBuffer( task->handle, (uInt32) task->waveform->periodLength );
+    DAQmxWriteAnalogF64( task->handle, task->waveform->periodLength, 0, 1.0, DAQmx_Val_GroupByChannel, 
+                         task->waveform->samplesTable, &writtenSamplesCount, NULL );
+    Recorder_WriteFrame( task->recorder, GetMonotonicTime(), task->waveform->samplesTable );
+    return;
+  }
+  
+  DAQmxSetWriteRegenMode( task->handle, DAQmx_Val_DoNotAllowRegen );
+  
+  task->readCommandsCount = atomic_load( &(task->commandsCount) );
+  task->knotsStart = task->knotsNumber = 0;
+  AddOutputKnot( task, GetMonotonicTime(), task->channelValuesList );
+  
+  DAQmxCfgOutputBuffer( task->handle, (uInt32) ( OUTPUT_LEAD_BLOCKS_NUMBER * task->outputBlockLength ) );
+  
+  const double* outputValuesList = IsOutputActive( task ) ? task->channelValuesList : task->safeValuesList;
+  for( size_t frame = 0; frame < task->outputBlockLength; frame++ )
+    memcpy( task->samplesList + frame * task->channelsNumber, outputValuesList, task->channelsNumber * sizeof(double) );
+  if( IsOutputActive( task ) && atomic_load( &(task->mailbox) ) != NULL ) ApplyMailboxValues( task, task->samplesList, task->outputBlockLength );
+  
+  int32 writtenSamplesCount;
+  task->outputSamplesCount = 0;
+  for( size_t block = 0; block < OUTPUT_LEAD_BLOCKS_NUMBER - 1; block++ )
+  {
+    if( DAQmxWriteAnalogF64( task->handle, task->outputBlockLength, 0, 0.1, DAQmx_Val_GroupByScanNumber, 
+                             task->samplesList, &writtenSamplesCount, NULL ) < 0 ) break;
+    task->outputSamplesCount += writtenSamplesCount;
+  }
+}
+
+bool IsWaveformActive( SignalIOTask task )
+{
+  return ( task->waveform != NULL && task->waveform->periodLength > 0 && atomic_load( &(task->isOutputEnabled) ) && !task->isInterlocked );
+}
+
+bool IsOutputActive( SignalIOTask task )
+{
+  return ( atomic_load( &(task->isOutputEnabled) ) && !task->isWatchdogTripped && !task->isInterlocked );
+}
+
+// Mailbox values are taken once per cycle. Slots being written keep their previous values until the next one
+void MergeMailbox( SignalIOTask task, SignalMailbox mailbox )
+{
+  bool isChanged = false;
+  for( uint32_t channel = 0; channel < task->channelsNumber; channel++ )
+  {
+    double value;
+    uint64_t sequence;
+    int readStatus = Mailbox_Read( mailbox, channel, &value, &sequence );
+    if( readStatus < 0 ) continue;
+    if( readStatus == 0 )
+    {
+      if( !isnan( task->mailboxValuesList[ channel ] ) ) isChanged = true;
+      task->mailboxValuesList[ channel ] = NAN;
+      continue;
+    }
+    if( sequence != task->mailboxSequencesList[ channel ] || isnan( task->mailboxValuesList[ channel ] ) ) isChanged = true;
+    task->mailboxValuesList[ channel ] = value;
+    task->mailboxSequencesList[ channel ] = sequence;
+  }
+  
+  if( !isChanged ) return;
+  
+  // Mailbox commands also keep the watchdog from tripping
+  atomic_store( &(task->isOutputDirty), true );
+  atomic_store( &(task->lastWriteTime), (unsigned long long) ( GetMonotonicTime() * 1e6 ) );
+  
+  // On-demand outputs already record the merged values they write
+  if( task->samplingRate > 0.0 )
+  {
+    memcpy( task->mergedValuesList, task->channelValuesList, task->channelsNumber * sizeof(double) );
+    ApplyMailboxValues( task, task->mergedValuesList, 1 );
+    Recorder_WriteFrame( task->recorder, GetMonotonicTime(), task->mergedValuesList );
+  }
+}
+
+// Channels owned through the mailbox take its last values, over the local commands
+void ApplyMailboxValues( SignalIOTask task, double* framesList, size_t framesNumber )
+{
+  for( size_t channel = 0; channel < task->channelsNumber; channel++ )
+  {
+    double value = task->mailboxValuesList[ channel ];
+    if( isnan( value ) ) continue;
+    for( size_t frame = 0; frame < framesNumber; frame++ )
+      framesList[ frame * task->channelsNumber + channel ] = value;
+  }
+}
+
+// Output thread only switches to (or from) safe values here, once per cycle
+void UpdateInterlockState( SignalIOTask task )
+{
+  bool isTripped = ( atomic_load( &(task->interlockTripTime) ) != 0 );
+  if( isTripped == task->isInterlocked ) return;
+  
+  task->isInterlocked = isTripped;
+  task->isTripPending = isTripped;
+  atomic_store( &(task->isOutputDirty), true );
+}
+
+// Trip latency goes from the offending input sample to the generation of the first safe output one (for clocked outputs) 
+// or to the completion of its on-demand write
+void MeasureInterlockLatency( SignalIOTask task )
+{
+  task->isTripPending = false;
+  
+  double safeTime = GetMonotonicTime();
+  if( task->samplingRate > 0.0 && task->outputSamplesCount >= task->outputBlockLength )
+    safeTime = fmax( safeTime, task->outputStartTime + ( task->outputSamplesCount - task->outputBlockLength ) / task->samplingRate );
+  
+  double tripTime = atomic_load( &(task->interlockTripTime) ) / 1e6;
+  uint64_t interlockLatency = (uint64_t) ( fmax( safeTime - tripTime, 0.0 ) * 1e6 );
+  atomic_store( &(task->interlockLatency), interlockLatency );
+  if( interlockLatency > atomic_load( &(task->maxInterlockLatency) ) ) atomic_store( &(task->maxInterlockLatency), interlockLatency );
+  
+  (void) DumpTaskRecording( task, NULL, "interlock" );
+  SignalTaskEvents( task, SIGNAL_IO_EVENT_INTERLOCK );
+}
+
+// Outputs fall back to safe values while no command was written for longer than the watchdog timeout
+void UpdateWatchdog( SignalIOTask task )
+{
+  double lastWriteTime = atomic_load( &(task->lastWriteTime) ) / 1e6;
+  bool isTripped = ( GetMonotonicTime() - lastWriteTime > task->readWatchdogTimeout );
+  if( isTripped != task->isWatchdogTripped ) atomic_store( &(task->isOutputDirty), true );
+  if( isTripped && !task->isWatchdogTripped )
+  {
+    (void) DumpTaskRecording( task, NULL, "watchdog" );
+    SignalTaskEvents( task, SIGNAL_IO_EVENT_WATCHDOG );
+  }
+  
+  task->isWatchdogTripped = isTripped;
+}
+
+// Unclocked outputs are only updated on changes, at most at the configured rate
+int WriteOnDemandValues( SignalIOTask task )
+{
+  double updateTime = task->lastUpdateTime + 1.0 / task->readUpdateRate;
+  double currentTime = GetMonotonicTime();
+  if( currentTime < updateTime ) WaitTime( updateTime - currentTime );
+  task->lastUpdateTime = GetMonotonicTime();
+  
+  if( !atomic_exchange( &(task->isOutputDirty), false ) ) return 0;
+  
+  const double* outputValuesList = IsOutputActive( task ) ? task->channelValuesList : task->safeValuesList;
+  if( IsOutputActive( task ) && atomic_load( &(task->mailbox) ) != NULL )
+  {
+    memcpy( task->mergedValuesList, task->channelValuesList, task->channelsNumber * sizeof(double) );
+    ApplyMailboxValues( task, task->mergedValuesList, 1 );
+    outputValuesList = task->mergedValuesList;
+  }
+  
+  int32 writtenSamplesCount;
+  int errorCode;
+  if( task->isCounterOutput ) errorCode = WriteCounterValues( task, outputValuesList );
+  else errorCode = DAQmxWriteAnalogF64( task->handle, 1, 0, 0.1, DAQmx_Val_GroupByChannel, outputValuesList, &writtenSamplesCount, NULL );
+  Recorder_WriteFrame( task->recorder, task->lastUpdateTime, outputValuesList );
+  
+  // Failed updates are retried
+  if( errorCode < 0 ) atomic_store( &(task->isOutputDirty), true );
+  
+  return errorCode;
+}
+
+// Counter channels take (duty cycle, frequency) value pairs. Duty cycles are kept inside the (0,1) range pulse trains support, 
+// and non positive frequencies mean the configured (safe) one
+int WriteCounterValues( SignalIOTask task, const double* valuesList )
+{
+  double* frequenciesList = task->samplesList;
+  double* dutyCyclesList = task->samplesList + task->deviceChannelsNumber;
+  for( unsigned int counter = 0; counter < task->deviceChannelsNumber; counter++ )
+  {
+    dutyCyclesList[ counter ] = fmin( fmax( valuesList[ 2 * counter ], COUNTER_DUTY_CYCLE_MIN ), 1.0 - COUNTER_DUTY_CYCLE_MIN );
+    frequenciesList[ counter ] = ( valuesList[ 2 * counter + 1 ] > 0.0 ) ? valuesList[ 2 * counter + 1 ] : task->safeValuesList[ 2 * counter + 1 ];
+  }
+  
+  int32 writtenSamplesCount;
+  return DAQmxWriteCtrFreq( task->handle, 1, 0, 0.1, DAQmx_Val_GroupByChannel, frequenciesList, dutyCyclesList, &writtenSamplesCount, NULL );
+}
+
+void WaitTime( double duration )
+{
+#ifdef _WIN32
+  Sleep( (DWORD) ( duration * 1000.0 ) );
+#else
+  struct timespec delay = { (time_t) duration, (long) ( fmod( duration, 1.0 ) * 1e9 ) };
+  nanosleep( &delay, NULL );
+#endif
+}
+
+void UpdateWritePacing( SignalIOTask task )
+{
+  task->readUpdateRate = task->updateRate;
+  task->readWatchdogTimeout = task->watchdogTimeout;
+}
+
+void UpdateWriteInterpolation( SignalIOTask task )
+{
+  task->readOutputInterpolation = atomic_load( &(task->outputInterpolation) );
+  task->readOutputDelay = task->outputDelay;
+  atomic_store( &(task->appliedOutputDelay), task->readOutputDelay );
+}
+
+// Waveforms of the same period length replace the looped one at a period boundary: with regeneration, writes at the 
+// current position (start of next period) only overwrite samples already generated. Other changes restart generation
+int UpdateOutputWaveform( SignalIOTask task )
+{
+  SignalIOWaveformData* newWaveform = atomic_exchange( &(task->pendingWaveform), NULL );
+  if( newWaveform != NULL )
+  {
+    bool isSamePeriod = ( task->waveform != NULL && task->waveform->periodLength == newWaveform->periodLength );
+    if( task->waveform != NULL ) free( task->waveform );
+    task->waveform = newWaveform;
+    
+    if( isSamePeriod && task->isRegenerating && IsWaveformActive( task ) )
+    {
+      int32 writtenSamplesCount;
+      double periodDuration = task->waveform->periodLength / task->samplingRate;
+      int errorCode = DAQmxWriteAnalogF64( task->handle, task->waveform->periodLength, 0, 2.0 * periodDuration + 1.0, DAQmx_Val_GroupByChannel, 
+                                           task->waveform->samplesTable, &writtenSamplesCount, NULL );
+      Recorder_WriteFrame( task->recorder, GetMonotonicTime(), task->waveform->samplesTable );
+      return errorCode;
+    }
+  }
+  
+  // Next state sync restarts generation, with the buffer configured for the new mode
+  DAQmxStopTask( task->handle );
+  task->isStarted = false;
+  
+  return 0;
+}
+
+// Each output frame is interpolated at its generation time minus the output delay, from commands written before that
+int WriteInterpolatedBlock( SignalIOTask task )
+{
+  SyncVersion( &(task->interpolationVersion), UpdateWriteInterpolation, task );
+  
+  ReadOutputCommands( task );
+  
+  size_t framesWidth = task->channelsNumber;
+  size_t blockLength = task->outputBlockLength;
+  if( IsOutputActive( task ) )
+  {
+    // Frames sharing the same knots (interpolation segment) are computed at once
+    const double* knotFramesList[ KERNEL_KNOTS_NUMBER ] = { NULL };
+    const double* runKnotFramesList[ KERNEL_KNOTS_NUMBER ] = { NULL };
+    size_t runStart = 0;
+    for( size_t frame = 0; frame < blockLength; frame++ )
+    {
+      double frameTime = task->outputStartTime + ( task->outputSamplesCount + frame ) / task->samplingRate - task->readOutputDelay;
+      GetOutputWeights( task, frameTime, knotFramesList, task->outputWeightsTable + frame * KERNEL_KNOTS_NUMBER );
+      if( frame > runStart && memcmp( knotFramesList, runKnotFramesList, sizeof(knotFramesList) ) != 0 )
+      {
+        Kernels.InterpolateFrames( task->samplesList + runStart * framesWidth, runKnotFramesList, 
+                                   task->outputWeightsTable + runStart * KERNEL_KNOTS_NUMBER, framesWidth, frame - runStart );
+        runStart = frame;
+      }
+      memcpy( runKnotFramesList, knotFramesList, sizeof(knotFramesList) );
+    }
+    Kernels.InterpolateFrames( task->samplesList + runStart * framesWidth, runKnotFramesList, 
+                               task->outputWeightsTable + runStart * KERNEL_KNOTS_NUMBER, framesWidth, blockLength - runStart );
+    if( atomic_load( &(task->mailbox) ) != NULL ) ApplyMailboxValues( task, task->samplesList, blockLength );
+  }
+  else
+  {
+    for( size_t frame = 0; frame < blockLength; frame++ )
+      memcpy( task->samplesList + frame * framesWidth, task->safeValuesList, framesWidth * sizeof(double) );
+    if( atomic_exchange( &(task->isOutputDirty), false ) ) Recorder_WriteFrame( task->recorder, GetMonotonicTime(), task->safeValuesList );
+  }
+  
+  int32 writtenSamplesCount = 0;
+  int errorCode = DAQmxWriteAnalogF64( task->handle, blockLength, 0, 1.0, DAQmx_Val_GroupByScanNumber, task->samplesList, &writtenSamplesCount, NULL );
+  task->outputSamplesCount += writtenSamplesCount;
+  
+  return errorCode;
+}
+
+// Commands still being written are left for the next block, and overwritten ones are skipped
+void ReadOutputCommands( SignalIOTask task )
+{
+  uint64_t commandsCount = atomic_load( &(task->commandsCount) );
+  if( commandsCount - task->readCommandsCount > OUTPUT_COMMANDS_NUMBER ) task->readCommandsCount = commandsCount - OUTPUT_COMMANDS_NUMBER;
+  
+  for( ; task->readCommandsCount < commandsCount; task->readCommandsCount++ )
+  {
+    size_t commandSlot = task->readCommandsCount % OUTPUT_COMMANDS_NUMBER;
+    uint64_t sequence = atomic_load( &(task->commandSequencesList[ commandSlot ]) );
+    if( sequence < 2 * task->readCommandsCount + 2 ) break;
+    if( sequence > 2 * task->readCommandsCount + 2 ) continue;
+    
+    const double* command = task->commandsTable + commandSlot * ( 1 + task->channelsNumber );
+    AddOutputKnot( task, command[ 0 ], command + 1 );
+    Recorder_WriteFrame( task->recorder, command[ 0 ], command + 1 );
+  }
+}
+
+// Commands closer than one output sample (e.g. per channel writes of the same control step) update a single knot.
+// Faster commands on long delays are merged as well, so that the knots ring always covers the whole delay
+void AddOutputKnot( SignalIOTask task, double time, const double* valuesList )
+{
+  double knotInterval = fmax( 1.0 / task->samplingRate, task->readOutputDelay / ( OUTPUT_KNOTS_NUMBER - KERNEL_KNOTS_NUMBER ) );
+  size_t knotIndex = ( task->knotsStart + task->knotsNumber - 1 ) % OUTPUT_KNOTS_NUMBER;
+  if( task->knotsNumber == 0 || time - task->knotTimesList[ knotIndex ] >= knotInterval )
+  {
+    if( task->knotsNumber == OUTPUT_KNOTS_NUMBER ) task->knotsStart = ( task->knotsStart + 1 ) % OUTPUT_KNOTS_NUMBER;
+    else task->knotsNumber++;
+    knotIndex = ( task->knotsStart + task->knotsNumber - 1 ) % OUTPUT_KNOTS_NUMBER;
+    task->knotTimesList[ knotIndex ] = time;
+  }
+  
+  memcpy( task->knotsTable + knotIndex * task->channelsNumber, valuesList, task->channelsNumber * sizeof(double) );
+}
+
+// Interpolation segment starts at the last knot not after given time. Outside of known segments, the nearest knot is held
+void GetOutputWeights( SignalIOTask task, double time, const double** knotFramesList, double* weightsList )
+{
+  #define KNOT_TIME( index ) task->knotTimesList[ ( task->knotsStart + (index) ) % OUTPUT_KNOTS_NUMBER ]
+  #define KNOT_FRAME( index ) ( task->knotsTable + ( ( task->knotsStart + (index) ) % OUTPUT_KNOTS_NUMBER ) * task->channelsNumber )
+  
+  // Only the knot preceding the current segment is kept from older ones
+  while( task->knotsNumber >= 3 && KNOT_TIME( 2 ) <= time )
+  {
+    task->knotsStart = ( task->knotsStart + 1 ) % OUTPUT_KNOTS_NUMBER;
+    task->knotsNumber--;
+  }
+  
+  size_t segmentStart = ( task->knotsNumber >= 2 && KNOT_TIME( 1 ) <= time ) ? 1 : 0;
+  knotFramesList[ 1 ] = KNOT_FRAME( segmentStart );
+  
+  bool isSegment = ( segmentStart + 1 < task->knotsNumber && KNOT_TIME( segmentStart ) <= time );
+  if( !isSegment || task->readOutputInterpolation == SIGNAL_IO_INTERPOLATION_HOLD )
+  {
+    knotFramesList[ 0 ] = knotFramesList[ 2 ] = knotFramesList[ 3 ] = knotFramesList[ 1 ];
+    weightsList[ 0 ] = weightsList[ 2 ] = weightsList[ 3 ] = 0.0;
+    weightsList[ 1 ] = 1.0;
+    return;
+  }
+  
+  knotFramesList[ 2 ] = KNOT_FRAME( segmentStart + 1 );
+  double startTime = KNOT_TIME( segmentStart );
+  double endTime = KNOT_TIME( segmentStart + 1 );
+  double segmentLength = endTime - startTime;
+  double u = ( time - startTime ) / segmentLength;
+  
+  if( task->readOutputInterpolation == SIGNAL_IO_INTERPOLATION_LINEAR )
+  {
+    knotFramesList[ 0 ] = knotFramesList[ 1 ];
+    knotFramesList[ 3 ] = knotFramesList[ 2 ];
+    weightsList[ 0 ] = weightsList[ 3 ] = 0.0;
+    weightsList[ 1 ] = 1.0 - u;
+    weightsList[ 2 ] = u;
+    return;
+  }
+  
+  // Cubic Hermite segment, with finite difference slopes (one-sided on the ends of known knots)
+  knotFramesList[ 0 ] = ( segmentStart > 0 ) ? KNOT_FRAME( segmentStart - 1 ) : knotFramesList[ 1 ];
+  double previousTime = ( segmentStart > 0 ) ? KNOT_TIME( segmentStart - 1 ) : startTime;
+  knotFramesList[ 3 ] = ( segmentStart + 2 < task->knotsNumber ) ? KNOT_FRAME( segmentStart + 2 ) : knotFramesList[ 2 ];
+  double nextTime = ( segmentStart + 2 < task->knotsNumber ) ? KNOT_TIME( segmentStart + 2 ) : endTime;
+  
+  double u2 = u * u, u3 = u2 * u;
+  double startSlopeScale = ( 1.0 - 2.0 * u + u2 ) * u * segmentLength / ( endTime - previousTime );
+  double endSlopeScale = ( u3 - u2 ) * segmentLength / ( nextTime - startTime );
+  weightsList[ 0 ] = -startSlopeScale;
+  weightsList[ 1 ] = 2.0 * u3 - 3.0 * u2 + 1.0 - endSlopeScale;
+  weightsList[ 2 ] = -2.0 * u3 + 3.0 * u2 + startSlopeScale;
+  weightsList[ 3 ] = endSlopeScale;
+  
+  #undef KNOT_TIME
+  #undef KNOT_FRAME
+}
+
+// Recent data is dumped on each transition to a driver fault
+void UpdateFaultState( SignalIOTask task, bool isFaulted )
+{
+  if( isFaulted && !task->isFaulted ) (void) DumpTaskRecording( task, NULL, "fault" );
+  
+  task->isFaulted = isFaulted;
+}
+
+SignalIOTask LoadTaskData( const char* taskConfig )
+{
+  bool loadError = false;
+  bool wasRecorderActive = false;
+  
+  char taskName[ TASK_NAME_MAX_LENGTH ];
+  snprintf( taskName, TASK_NAME_MAX_LENGTH, "%.*s", (int) strcspn( taskConfig, "|" ), taskConfig );
+  
+  SignalIOTask newTask = (SignalIOTask) malloc( sizeof(SignalIOTaskData) );
+  memset( newTask, 0, sizeof(SignalIOTaskData) );
+  newTask->threadID = THREAD_INVALID_HANDLE;
+  newTask->dumpThreadID = THREAD_INVALID_HANDLE;
+  snprintf( newTask->name, TASK_NAME_MAX_LENGTH, "%s", taskName );
+  
+  if( DAQmxLoadTask( taskName, &(newTask->handle) ) >= 0 )
+  {
+    if( DAQmxGetTaskAttribute( newTask->handle, DAQmx_Task_NumChans, &(newTask->channelsNumber) ) >= 0 
+        && LoadVirtualChannels( newTask, strchr( taskConfig, '|' ) ) )
+    {
+      //DEBUG_PRINT( "%u signal channels found", newTask->channelsNumber );
+      
+      LoadCounterChannels( newTask );
+  
+      newTask->channelUsesList = (atomic_uint*) calloc( newTask->channelsNumber, sizeof(atomic_uint) );
+      for( unsigned int channel = 0; channel < newTask->channelsNumber; channel++ )
+        atomic_init( &(newTask->channelUsesList[ channel ]), 0 );
+      InitVersion( &(newTask->channelsVersion) );
+      
+      newTask->samplesList = (float64*) calloc( newTask->channelsNumber * AQUISITION_BUFFER_MAX_LENGTH, sizeof(float64) );
+      newTask->channelValuesList = (double*) calloc( newTask->channelsNumber, sizeof(double) );
+      newTask->safeValuesList = (double*) calloc( newTask->channelsNumber, sizeof(double) );
+      atomic_init( &(newTask->isOutputEnabled), true );
+      newTask->updateRate = newTask->readUpdateRate = OUTPUT_UPDATE_RATE_DEFAULT;
+      InitVersion( &(newTask->pacingVersion) );
+      atomic_init( &(newTask->lastWriteTime), 0 );
+      atomic_init( &(newTask->interlocksCount), 0 );
+      atomic_init( &(newTask->triggersCount), 0 );
+      atomic_init( &(newTask->mailbox), NULL );
+      atomic_init( &(newTask->interlockTripTime), 0 );
+      atomic_init( &(newTask->interlockLatency), 0 );
+      atomic_init( &(newTask->maxInterlockLatency), 0 );
+  
+      // Driver resources are reserved once here, so that starting/stopping the task on resumes/pauses is cheap
+      if( DAQmxTaskControl( newTask->handle, DAQmx_Val_Task_Commit ) >= 0 )
+      {
+        uInt32 readChannelsNumber;
+        DAQmxGetReadAttribute( newTask->handle, DAQmx_Read_NumChans, &readChannelsNumber );
+        if( readChannelsNumber > 0 ) 
+        {
+          newTask->channelLocksList = (Semaphore*) calloc( newTask->channelsNumber, sizeof(Semaphore) );
+          for( unsigned int channel = 0; channel < newTask->channelsNumber; channel++ )
+            newTask->channelLocksList[ channel ] = Sem_Create( 0, SIGNAL_INPUT_CHANNEL_MAX_USES );
+          
+          newTask->readChannelsList = (unsigned int*) calloc( newTask->channelsNumber, sizeof(unsigned int) );
+          newTask->channelNamesList = (char**) calloc( newTask->channelsNumber, sizeof(char*) );
+          for( unsigned int channel = 0; channel < newTask->channelsNumber; channel++ )
+          {
+            newTask->channelNamesList[ channel ] = (char*) calloc( CHANNEL_NAME_MAX_LENGTH, sizeof(char) );
+            if( channel < newTask->deviceChannelsNumber )
+              DAQmxGetNthTaskChannel( newTask->handle, channel + 1, newTask->channelNamesList[ channel ], CHANNEL_NAME_MAX_LENGTH );
+          }
+          newTask->readVirtualChannelsList = (unsigned int*) calloc( newTask->channelsNumber, sizeof(unsigned int) );
+          newTask->readChannelsString = (char*) calloc( newTask->channelsNumber * ( CHANNEL_NAME_MAX_LENGTH + 1 ), sizeof(char) );
+          
+          SignalIOFilterSettingsData* filterSettings = (SignalIOFilterSettingsData*) malloc( sizeof(SignalIOFilterSettingsData) + newTask->channelsNumber * sizeof(double) );
+          filterSettings->windowLength = 0;
+          for( unsigned int channel = 0; channel < newTask->channelsNumber; channel++ )
+            filterSettings->thresholdsList[ channel ] = INFINITY;
+          atomic_init( &(newTask->filterSettings), filterSettings );
+          newTask->filtersLock = Sem_Create( 1, 1 );
+          newTask->readThresholdsList = (double*) calloc( newTask->channelsNumber, sizeof(double) );
+          newTask->filterFramesList = (double*) calloc( newTask->channelsNumber * ( KERNEL_FILTER_MAX_WINDOW - 1 + AQUISITION_BUFFER_MAX_LENGTH ), sizeof(double) );
+          InitVersion( &(newTask->filtersVersion) );
+          
+          newTask->featureSumsList = (double*) calloc( KERNEL_TERMS_NUMBER * newTask->channelsNumber, sizeof(double) );
+          newTask->featureLastFramesList = (double*) calloc( 2 * newTask->channelsNumber, sizeof(double) );
+          newTask->featureWindowsList = (double*) calloc( FEATURE_WINDOWS_NUMBER * ( 1 + newTask->channelsNumber * SIGNAL_IO_EMG_FEATURES_NUMBER ), sizeof(double) );
+          InitVersion( &(newTask->featuresVersion) );
+          atomic_init( &(newTask->featureWindowsCount), 0 );
+          
+          newTask->tareSumsList = (double*) calloc( newTask->channelsNumber, sizeof(double) );
+          newTask->channelOffsetsList = (double*) calloc( newTask->channelsNumber, sizeof(double) );
+          newTask->readOffsetsList = (double*) calloc( newTask->channelsNumber, sizeof(double) );
+          atomic_init( &(newTask->isTaring), false );
+          InitVersion( &(newTask->tareVersion) );
+          
+          newTask->ensemblesList = (SignalIOEnsemble*) calloc( ENSEMBLES_MAX_NUMBER, sizeof(SignalIOEnsemble) );
+          newTask->ensemblesLock = Sem_Create( 1, 1 );
+          InitVersion( &(newTask->ensemblesVersion) );
+          newTask->readEnsemblesList = (SignalIOEnsemble*) calloc( ENSEMBLES_MAX_NUMBER, sizeof(SignalIOEnsemble) );
+          
+          newTask->interlocksList = (SignalIOInterlock*) calloc( INTERLOCKS_MAX_NUMBER, sizeof(SignalIOInterlock) );
+          newTask->readInterlocksList = (SignalIOInterlockData*) calloc( INTERLOCKS_MAX_NUMBER, sizeof(SignalIOInterlockData) );
+          newTask->interlocksLock = Sem_Create( 1, 1 );
+          InitVersion( &(newTask->interlocksVersion) );
+          
+          newTask->readerDeadlinesList = (SignalIOReaderDeadlineData*) calloc( READER_DEADLINES_MAX_NUMBER, sizeof(SignalIOReaderDeadlineData) );
+          for( size_t deadlineIndex = 0; deadlineIndex < READER_DEADLINES_MAX_NUMBER; deadlineIndex++ )
+          {
+            atomic_init( &(newTask->readerDeadlinesList[ deadlineIndex ].isUsed), false );
+            atomic_init( &(newTask->readerDeadlinesList[ deadlineIndex ].expectedPeriod), 0 );
+            atomic_init( &(newTask->readerDeadlinesList[ deadlineIndex ].maxDataAge), 0 );
+            atomic_init( &(newTask->readerDeadlinesList[ deadlineIndex ].lastReadTime), 0 );
+            atomic_init( &(newTask->readerDeadlinesList[ deadlineIndex ].isLate), false );
+          }
+          
+          // On-demand tasks have no sample clock, so time conversions are not supported for them
+          if( DAQmxGetSampClkRate( newTask->handle, &(newTask->samplingRate) ) < 0 ) newTask->samplingRate = 0.0;
+          
+          // Change detection (digital input) tasks are not clocked either, and take one line per channel
+          int32 timingType;
+          if( DAQmxGetSampTimingType( newTask->handle, &timingType ) >= 0 && timingType == DAQmx_Val_ChangeDetection )
+          {
+            uInt32 channelBytesNumber = 0;
+            DAQmxGetReadDigitalLinesBytesPerChan( newTask->handle, &channelBytesNumber );
+            if( channelBytesNumber != 1 ) loadError = true;
+            newTask->isChangeDetection = true;
+            newTask->samplingRate = 0.0;
+            newTask->linesList = (uInt8*) calloc( newTask->deviceChannelsNumber * AQUISITION_BUFFER_MAX_LENGTH, sizeof(uInt8) );
+            newTask->lineLevelsList = (int8_t*) calloc( newTask->deviceChannelsNumber, sizeof(int8_t) );
+            newTask->edgesList = (SignalIOEdge*) calloc( EDGES_NUMBER, sizeof(SignalIOEdge) );
+          }
+          atomic_init( &(newTask->edgesCount), 0 );
+          
+          // Sample history lives in the recorder region
+          newTask->historyLength = HISTORY_MAX_BLOCKS_NUMBER * AQUISITION_BUFFER_MAX_LENGTH;
+          newTask->recorder = Recorder_Open( taskName, newTask->channelsNumber, HISTORY_BLOCKS_NUMBER, newTask->historyLength, 0, 
+                                             RECORDER_MARKERS_NUMBER, newTask->samplingRate, &wasRecorderActive );
+          if( newTask->recorder != NULL )
+          {
+            newTask->historySamplesList = newTask->recorder->samplesList;
+            newTask->channelStartsList = newTask->recorder->channelStartsList;
+            newTask->blocksList = newTask->recorder->blocksList;
+          }
+          atomic_init( &(newTask->samplesCount), 0 );
+          atomic_init( &(newTask->blocksCount), 0 );
+          atomic_init( &(newTask->runStartBlock), 0 );
+          atomic_init( &(newTask->maxBlockLength), 0 );
+          
+          newTask->mode = READ;
+        }
+        else 
+        {
+          newTask->channelLocksList = (Semaphore*) calloc( 1, sizeof(Semaphore) );
+          newTask->channelLocksList[ 0 ] = Sem_Create( 0, SIGNAL_INPUT_CHANNEL_MAX_USES );
+          
+          newTask->recorder = Recorder_Open( taskName, newTask->channelsNumber, 0, 0, RECORDER_FRAMES_NUMBER, RECORDER_MARKERS_NUMBER, 0.0, &wasRecorderActive );
+          
+          // Clocked outputs are generated from interpolated commands, never repeating stale buffer contents
+          // (counter pulse trains are always updated on demand)
+          if( DAQmxGetSampClkRate( newTask->handle, &(newTask->samplingRate) ) < 0 || newTask->isCounterOutput ) newTask->samplingRate = 0.0;
+          if( newTask->samplingRate > 0.0 )
+          {
+            newTask->outputBlockLength = (size_t) fmin( fmax( round( OUTPUT_BLOCK_DURATION * newTask->samplingRate ), 1.0 ), AQUISITION_BUFFER_MAX_LENGTH );
+            newTask->commandsTable = (double*) calloc( OUTPUT_COMMANDS_NUMBER * ( 1 + newTask->channelsNumber ), sizeof(double) );
+            newTask->commandSequencesList = (atomic_ullong*) calloc( OUTPUT_COMMANDS_NUMBER, sizeof(atomic_ullong) );
+            for( size_t commandSlot = 0; commandSlot < OUTPUT_COMMANDS_NUMBER; commandSlot++ )
+              atomic_init( &(newTask->commandSequencesList[ commandSlot ]), 0 );
+            atomic_init( &(newTask->commandsCount), 0 );
+            newTask->knotTimesList = (double*) calloc( OUTPUT_KNOTS_NUMBER, sizeof(double) );
+            newTask->knotsTable = (double*) calloc( OUTPUT_KNOTS_NUMBER * newTask->channelsNumber, sizeof(double) );
+            newTask->outputWeightsTable = (double*) calloc( newTask->outputBlockLength * KERNEL_KNOTS_NUMBER, sizeof(double) );
+            atomic_init( &(newTask->outputInterpolation), SIGNAL_IO_INTERPOLATION_HOLD );
+            newTask->outputDelay = newTask->readOutputDelay = OUTPUT_LEAD_BLOCKS_NUMBER * newTask->outputBlockLength / newTask->samplingRate;
+            atomic_init( &(newTask->appliedOutputDelay), newTask->readOutputDelay );
+            atomic_init( &(newTask->commitCommandTime), 0.0 );
+            newTask->groupValuesList = (double*) calloc( newTask->channelsNumber, sizeof(double) );
+            atomic_init( &(newTask->groupSequence), 0 );
+            atomic_init( &(newTask->appliedGroupSequence), 0 );
+            InitVersion( &(newTask->interpolationVersion) );
+            atomic_init( &(newTask->pendingWaveform), NULL );
+          }
+          
+          newTask->mode = WRITE;
+          
+          // Virtual channels are only computed from inputs
+          if( newTask->virtualChannelsList != NULL ) loadError = true;
+          
+          // Counters start (and are kept safe) with their configured pulse frequency, and minimum duty cycle
+          for( unsigned int counter = 0; counter < newTask->deviceChannelsNumber && newTask->isCounterOutput; counter++ )
+          {
+            char counterName[ CHANNEL_NAME_MAX_LENGTH ] = "";
+            DAQmxGetNthTaskChannel( newTask->handle, counter + 1, counterName, CHANNEL_NAME_MAX_LENGTH );
+            DAQmxGetCOPulseDutyCyc( newTask->handle, counterName, &(newTask->channelValuesList[ 2 * counter ]) );
+            DAQmxGetCOPulseFreq( newTask->handle, counterName, &(newTask->channelValuesList[ 2 * counter + 1 ]) );
+            newTask->safeValuesList[ 2 * counter + 1 ] = newTask->channelValuesList[ 2 * counter + 1 ];
+          }
+        }
+        
+        if( newTask->recorder != NULL )
+        {
+          newTask->dumpLock = Sem_Create( 0, 1 );
+          atomic_init( &(newTask->isDumping), false );
+          // Data left by a crashed session is copied before being overwritten, and written to file by the dump thread
+          if( wasRecorderActive )
+          {
+            newTask->dumpSnapshot = Recorder_TakeSnapshot( newTask->recorder, AQUISITION_BUFFER_MAX_LENGTH );
+            if( newTask->dumpSnapshot != NULL )
+            {
+              snprintf( newTask->dumpFilePath, RECORDER_NAME_MAX_LENGTH, "%s_crash.sigrec", newTask->name );
+              atomic_store( &(newTask->isDumping), true );
+            }
+          }
+          Recorder_Reset( newTask->recorder, CHANNEL_INACTIVE );
+          newTask->dumpThreadID = Thread_Start( AsyncDumpRecording, newTask, THREAD_JOINABLE );
+          if( newTask->dumpSnapshot != NULL ) Sem_SetCount( newTask->dumpLock, 1 );
+        }
+        else loadError = true;
+        
+        atomic_init( &(newTask->state), TASK_STOPPED );
+        newTask->resumeLock = Sem_Create( 0, 1 );
+        atomic_init( &(newTask->eventsMask), 0 );
+        newTask->eventsLock = Sem_Create( 0, 1 );
+        atomic_init( &(newTask->isProcessing), false );
+        atomic_init( &(newTask->resumeRequestTime), 0 );
+        atomic_init( &(newTask->resumeLatency), 0 );
+        atomic_init( &(newTask->maxResumeLatency), 0 );
+      }
+      else
+      {
+        //DEBUG_PRINT( "error committing task %s", taskName );
+        loadError = true;
+      }
+    }
+    else 
+    {
+      //DEBUG_PRINT( "error getting task %s attribute or virtual channels", taskName );
       loadError = true;
     }
   }
@@ -392,27 +4011,307 @@ SignalIOTask LoadTaskData( const char* taskName )
   return newTask;
 }
 
+// Counter output tasks get 2 channels per counter: duty cycle (2 * counter) and frequency (2 * counter + 1)
+void LoadCounterChannels( SignalIOTask task )
+{
+  char channelName[ CHANNEL_NAME_MAX_LENGTH ] = "";
+  int32 channelType = 0;
+  if( DAQmxGetNthTaskChannel( task->handle, 1, channelName, CHANNEL_NAME_MAX_LENGTH ) < 0 ) return;
+  if( DAQmxGetChanType( task->handle, channelName, &channelType ) < 0 || channelType != DAQmx_Val_CO ) return;
+  
+  task->isCounterOutput = true;
+  task->channelsNumber = 2 * task->deviceChannelsNumber;
+}
+
+// Virtual channels get the indexes following the device ones, in definition order
+bool LoadVirtualChannels( SignalIOTask task, const char* virtualConfig )
+{
+  task->deviceChannelsNumber = task->channelsNumber;
+  if( virtualConfig == NULL ) return true;
+  
+  size_t virtualChannelsNumber = 0;
+  for( const char* separator = virtualConfig; *separator != '\0'; separator++ )
+    if( *separator == '|' ) virtualChannelsNumber++;
+  task->virtualChannelsList = (SignalExpression*) calloc( virtualChannelsNumber, sizeof(SignalExpression) );
+  
+  const char* expressionString = virtualConfig + 1;
+  for( size_t virtualIndex = 0; virtualIndex < virtualChannelsNumber; virtualIndex++ )
+  {
+    size_t expressionLength = strcspn( expressionString, "|" );
+    if( !Expression_Compile( expressionString, expressionLength, task->deviceChannelsNumber, task->virtualChannelsList + virtualIndex ) )
+    {
+      //DEBUG_PRINT( "invalid virtual channel expression %.*s", (int) expressionLength, expressionString );
+      return false;
+    }
+    expressionString += expressionLength + 1;
+  }
+  
+  task->channelsNumber += virtualChannelsNumber;
+  
+  return true;
+}
+
+SignalIOTask LoadViewData( const char* viewConfig )
+{
+  const char* channelsConfig = strchr( viewConfig, ':' );
+  const char* taskConfig = strchr( viewConfig, '=' );
+  taskConfig = ( taskConfig != NULL && taskConfig < channelsConfig ) ? taskConfig + 1 : viewConfig;
+  
+  char taskName[ TASK_NAME_MAX_LENGTH ];
+  snprintf( taskName, TASK_NAME_MAX_LENGTH, "%.*s", (int) ( channelsConfig - taskConfig ), taskConfig );
+  
+  // Parents could be other (named) views. Missing ones are loaded here, and ended again if the view turns out invalid 
+  // (or else with the last view over them, see EndDevice)
+  long int parentTaskID = (int) kh_str_hash_func( taskName );
+  bool isParentMissing = ( GetTask( parentTaskID ) == NULL );
+  if( isParentMissing && InitDevice( taskName ) == -1 ) return NULL;
+  
+  SignalIOTask parentTask = GetTask( parentTaskID );
+  if( isParentMissing ) parentTask->isLoadedByView = true;
+  
+  SignalIOTask newView = (SignalIOTask) malloc( sizeof(SignalIOTaskData) );
+  memset( newView, 0, sizeof(SignalIOTaskData) );
+  
+  size_t viewChannelsMaxNumber = 1;
+  for( const char* separator = channelsConfig; *separator != '\0'; separator++ )
+    if( *separator == ',' ) viewChannelsMaxNumber++;
+  newView->viewChannelsList = (unsigned int*) calloc( viewChannelsMaxNumber, sizeof(unsigned int) );
+  
+  const char* channelString = channelsConfig + 1;
+  while( *channelString != '\0' )
+  {
+    char* channelStringEnd;
+    unsigned long channel = strtoul( channelString, &channelStringEnd, 10 );
+    if( channelStringEnd == channelString || channel >= parentTask->channelsNumber )
+    {
+      //DEBUG_PRINT( "invalid channel list %s for view", channelsConfig );
+      UnloadTaskData( newView );
+      if( isParentMissing ) EndDevice( parentTaskID );
+      return NULL;
+    }
+    // Views over views are flattened to their physical task
+    if( parentTask->parentTask != NULL ) channel = parentTask->viewChannelsList[ channel ];
+    newView->viewChannelsList[ newView->channelsNumber++ ] = (unsigned int) channel;
+    channelString = ( *channelStringEnd == ',' ) ? channelStringEnd + 1 : channelStringEnd + strlen( channelStringEnd );
+  }
+  
+  if( parentTask->parentTask != NULL ) parentTask = parentTask->parentTask;
+  
+  newView->parentTask = parentTask;
+  newView->mode = parentTask->mode;
+  newView->threadID = THREAD_INVALID_HANDLE;
+  parentTask->viewsCount++;
+  
+  return newView;
+}
+
+// Readers over the listed (or all, if NULL) task/view channels, resampled when an output rate is given
+SignalIOReader LoadReaderData( SignalIOTask task, const unsigned int* channelsList, size_t channelsNumber, double outputRate )
+{
+  SignalIOTask physicalTask = ( task->parentTask != NULL ) ? task->parentTask : task;
+  
+  if( task->mode == WRITE ) return NULL;
+  
+  if( outputRate > 0.0 && physicalTask->samplingRate <= 0.0 ) return NULL;
+  
+  SignalIOReader newReader = (SignalIOReader) malloc( sizeof(SignalIOReaderData) );
+  memset( newReader, 0, sizeof(SignalIOReaderData) );
+  
+  newReader->task = physicalTask;
+  // Readers only get markers placed after their acquisition
+  newReader->markersCursor = atomic_load( &(physicalTask->recorder->header->markersCount) );
+  
+  newReader->channelsList = (unsigned int*) calloc( channelsNumber, sizeof(unsigned int) );
+  for( size_t channelIndex = 0; channelIndex < channelsNumber; channelIndex++ )
+  {
+    unsigned int channel = ( channelsList != NULL ) ? channelsList[ channelIndex ] : (unsigned int) channelIndex;
+    if( MapTaskChannel( task, &channel ) == NULL || !AcquireInput( physicalTask, channel ) )
+    {
+      UnloadReaderData( newReader );
+      return NULL;
+    }
+    newReader->channelsList[ newReader->channelsNumber++ ] = channel;
+  }
+  
+  if( outputRate <= 0.0 ) return newReader;
+  
+  newReader->outputRate = outputRate;
+  newReader->samplesStep = physicalTask->samplingRate / outputRate;
+  
+  newReader->windowTable = (double*) calloc( newReader->channelsNumber * physicalTask->historyLength, sizeof(double) );
+  
+  // Blackman windowed sinc, with cutoff below the lowest of input and output Nyquist frequencies, sampled at each filter phase
+  const double HALF_TAPS_NUMBER = RESAMPLER_TAPS_NUMBER / 2;
+  double cutoffFrequency = 0.45 * ( ( outputRate < physicalTask->samplingRate ) ? outputRate / physicalTask->samplingRate : 1.0 );
+  newReader->filterTable = (double*) calloc( RESAMPLER_PHASES_NUMBER * RESAMPLER_TAPS_NUMBER, sizeof(double) );
+  for( size_t phase = 0; phase < RESAMPLER_PHASES_NUMBER; phase++ )
+  {
+    double* coefficientsList = newReader->filterTable + phase * RESAMPLER_TAPS_NUMBER;
+    double coefficientsSum = 0.0;
+    for( size_t tapIndex = 0; tapIndex < RESAMPLER_TAPS_NUMBER; tapIndex++ )
+    {
+      double distance = tapIndex - ( HALF_TAPS_NUMBER - 1 ) - (double) phase / RESAMPLER_PHASES_NUMBER;
+      double sincArgument = 2 * M_PI * cutoffFrequency * distance;
+      double sincValue = ( fabs( sincArgument ) > 1e-9 ) ? sin( sincArgument ) / sincArgument : 1.0;
+      double windowValue = 0.42 + 0.5 * cos( M_PI * distance / HALF_TAPS_NUMBER ) + 0.08 * cos( 2 * M_PI * distance / HALF_TAPS_NUMBER );
+      coefficientsList[ tapIndex ] = sincValue * windowValue;
+      coefficientsSum += coefficientsList[ tapIndex ];
+    }
+    // Unity DC gain for every phase
+    for( size_t tapIndex = 0; tapIndex < RESAMPLER_TAPS_NUMBER; tapIndex++ )
+      coefficientsList[ tapIndex ] /= coefficientsSum;
+  }
+  
+  return newReader;
+}
+
+void UnloadGroupData( SignalIOGroup group )
+{
+  if( group == NULL ) return;
+  
+  for( size_t taskIndex = 0; taskIndex < group->tasksNumber; taskIndex++ )
+  {
+    if( group->clockSourcesList[ taskIndex ] != NULL ) free( group->clockSourcesList[ taskIndex ] );
+  }
+  free( group->clockSourcesList );
+  free( group->tasksList );
+  
+  free( group );
+}
+
+void UnloadEnsembleData( SignalIOEnsemble ensemble )
+{
+  if( ensemble == NULL ) return;
+  
+  UnloadReaderData( ensemble->reader );
+  UnloadTriggerData( atomic_load( &(ensemble->trigger) ) );
+  
+  if( ensemble->pendingTriggersList != NULL ) free( ensemble->pendingTriggersList );
+  if( ensemble->sweepTable != NULL ) free( ensemble->sweepTable );
+  if( ensemble->meansTable != NULL ) free( ensemble->meansTable );
+  if( ensemble->deviationsTable != NULL ) free( ensemble->deviationsTable );
+  
+  free( ensemble );
+}
+
+// Also releases the trigger task, that could be unloaded again afterwards
+void UnloadTriggerData( SignalIOTrigger trigger )
+{
+  if( trigger == NULL ) return;
+  
+  UnloadReaderData( trigger->reader );
+  atomic_fetch_sub( &(trigger->task->triggersCount), 1 );
+  
+  free( trigger );
+}
+
+void UnloadReaderData( SignalIOReader reader )
+{
+  if( reader == NULL ) return;
+  
+  for( size_t channelIndex = 0; channelIndex < reader->channelsNumber; channelIndex++ )
+    ReleaseInput( reader->task, reader->channelsList[ channelIndex ] );
+  
+  if( reader->channelsList != NULL ) free( reader->channelsList );
+  if( reader->windowTable != NULL ) free( reader->windowTable );
+  if( reader->filterTable != NULL ) free( reader->filterTable );
+  
+  free( reader );
+}
+
 void UnloadTaskData( SignalIOTask task )
 {
   if( task == NULL ) return;
   
+  if( task->viewChannelsList != NULL )
+  {
+    if( task->parentTask != NULL ) task->parentTask->viewsCount--;
+    free( task->viewChannelsList );
+    free( task );
+    return;
+  }
+  
   //DEBUG_PRINT( "ending task with handle %d", task->handle );
+  
+  // Paused threads (or idle ones, regenerating waveforms) are woken up to exit
+  atomic_store( &(task->state), TASK_ENDING );
+  if( task->resumeLock != NULL ) Sem_SetCount( task->resumeLock, 1 );
+  if( task->threadID != THREAD_INVALID_HANDLE ) Thread_WaitExit( task->threadID, 5000 );
+  if( task->resumeLock != NULL ) Sem_Discard( task->resumeLock );
+  if( task->eventsLock != NULL ) Sem_Discard( task->eventsLock );
+  
+  if( task->dumpThreadID != THREAD_INVALID_HANDLE )
+  {
+    Sem_SetCount( task->dumpLock, 1 );
+    Thread_WaitExit( task->dumpThreadID, 5000 );
+  }
+  if( task->dumpLock != NULL ) Sem_Discard( task->dumpLock );
 
-  if( task->mode == READ )
+  // Locks only exist if loading went as far as committing the task (e.g. not on invalid virtual channel expressions)
+  if( task->channelLocksList != NULL )
   {
-    for( unsigned int channel = 0; channel < task->channelsNumber; channel++ )
-      Sem_Discard( task->channelLocksList[ channel ] );
+    if( task->mode == READ )
+    {
+      for( unsigned int channel = 0; channel < task->channelsNumber; channel++ )
+        Sem_Discard( task->channelLocksList[ channel ] );
+    }
+    else
+      Sem_Discard( task->channelLocksList[ 0 ] );
   }
-  else
-    Sem_Discard( task->channelLocksList[ 0 ] );
 
   DAQmxStopTask( task->handle );
   DAQmxClearTask( task->handle );
 
   if( task->channelUsesList != NULL ) free( task->channelUsesList );
+  if( task->virtualChannelsList != NULL ) free( task->virtualChannelsList );
+  if( task->readVirtualChannelsList != NULL ) free( task->readVirtualChannelsList );
+  
+  if( task->channelNamesList != NULL )
+  {
+    for( unsigned int channel = 0; channel < task->channelsNumber; channel++ )
+      free( task->channelNamesList[ channel ] );
+    free( task->channelNamesList );
+  }
+  if( task->readChannelsList != NULL ) free( task->readChannelsList );
+  if( task->readChannelsString != NULL ) free( task->readChannelsString );
+  if( atomic_load( &(task->filterSettings) ) != NULL ) free( atomic_load( &(task->filterSettings) ) );
+  if( task->filtersLock != NULL ) Sem_Discard( task->filtersLock );
+  if( task->readThresholdsList != NULL ) free( task->readThresholdsList );
+  if( task->filterFramesList != NULL ) free( task->filterFramesList );
+  if( atomic_load( &(task->featureTerms) ) != NULL ) free( atomic_load( &(task->featureTerms) ) );
+  if( task->featureSumsList != NULL ) free( task->featureSumsList );
+  if( task->featureLastFramesList != NULL ) free( task->featureLastFramesList );
+  if( task->featureWindowsList != NULL ) free( task->featureWindowsList );
+  if( task->tareSumsList != NULL ) free( task->tareSumsList );
+  if( task->channelOffsetsList != NULL ) free( task->channelOffsetsList );
+  if( task->readOffsetsList != NULL ) free( task->readOffsetsList );
+  if( task->linesList != NULL ) free( task->linesList );
+  if( task->lineLevelsList != NULL ) free( task->lineLevelsList );
+  if( task->edgesList != NULL ) free( task->edgesList );
+  if( task->ensemblesList != NULL ) free( task->ensemblesList );
+  if( task->readEnsemblesList != NULL ) free( task->readEnsemblesList );
+  if( task->ensemblesLock != NULL ) Sem_Discard( task->ensemblesLock );
+  if( task->interlocksList != NULL ) free( task->interlocksList );
+  if( task->readInterlocksList != NULL ) free( task->readInterlocksList );
+  if( task->interlocksLock != NULL ) Sem_Discard( task->interlocksLock );
+  if( task->readerDeadlinesList != NULL ) free( task->readerDeadlinesList );
 
   if( task->samplesList != NULL ) free( task->samplesList );
+  Recorder_Close( task->recorder );
   if( task->channelValuesList != NULL ) free( task->channelValuesList );
+  if( task->groupValuesList != NULL ) free( task->groupValuesList );
+  if( task->safeValuesList != NULL ) free( task->safeValuesList );
+  if( task->commandsTable != NULL ) free( task->commandsTable );
+  if( task->commandSequencesList != NULL ) free( task->commandSequencesList );
+  if( task->knotTimesList != NULL ) free( task->knotTimesList );
+  if( task->knotsTable != NULL ) free( task->knotsTable );
+  if( task->outputWeightsTable != NULL ) free( task->outputWeightsTable );
+  if( task->waveform != NULL ) free( task->waveform );
+  if( atomic_load( &(task->pendingWaveform) ) != NULL ) free( atomic_load( &(task->pendingWaveform) ) );
+  Mailbox_Close( atomic_load( &(task->mailbox) ) );
+  if( task->mailboxValuesList != NULL ) free( task->mailboxValuesList );
+  if( task->mailboxSequencesList != NULL ) free( task->mailboxSequencesList );
+  if( task->mergedValuesList != NULL ) free( task->mergedValuesList );
   if( task->channelLocksList != NULL ) free ( task->channelLocksList );
   
   free( task );
@@ -0,0 +1,307 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2019 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of Signal-IO-NIDAQmx.                                   //
+//                                                                            //
+//  Signal-IO-NIDAQmx is free software: you can redistribute it and/or modify //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  Signal-IO-NIDAQmx is distributed in the hope that it will be useful,      //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with Signal-IO-NIDAQmx. If not, see <http://www.gnu.org/licenses/>. //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+/// @file signal_expressions.h
+/// @brief Arithmetic expressions over task channels, for virtual channels
+///
+/// Expressions like "([0] - [1]) * 0.5" (with [N] standing for task channel N) are compiled once to stack machine 
+/// instructions, with constant subexpressions folded. Instructions are then run over whole chunks of samples each, 
+/// taking channel operands directly from their history rows, so that every step is a simple (vectorizable) loop
+
+#ifndef SIGNAL_EXPRESSIONS_H
+#define SIGNAL_EXPRESSIONS_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#define EXPRESSION_MAX_INSTRUCTIONS 64    ///< Longest compiled expression
+#define EXPRESSION_STACK_MAX_LENGTH 16    ///< Deepest operands stack (nesting) of expressions
+#define EXPRESSION_CHUNK_LENGTH 64        ///< Samples processed by each instruction at a time
+
+enum { EXPRESSION_PUSH_CHANNEL, EXPRESSION_PUSH_CONSTANT, EXPRESSION_ADD, EXPRESSION_SUBTRACT, EXPRESSION_MULTIPLY, EXPRESSION_DIVIDE, 
+       EXPRESSION_NEGATE };
+
+typedef struct _SignalExpressionInstruction
+{
+  int opcode;
+  unsigned int channel;
+  double constant;
+}
+SignalExpressionInstruction;
+
+typedef struct _SignalExpression
+{
+  SignalExpressionInstruction instructionsList[ EXPRESSION_MAX_INSTRUCTIONS ];
+  size_t instructionsNumber;
+}
+SignalExpression;
+
+typedef struct _SignalExpressionParser
+{
+  const char* text;
+  const char* textEnd;
+  unsigned int channelsNumber;
+  size_t stackLength;
+  bool hasError;
+  SignalExpression* expression;
+}
+SignalExpressionParser;
+
+static void Expression_ParseSum( SignalExpressionParser* );
+
+static void Expression_SkipSpaces( SignalExpressionParser* parser )
+{
+  while( parser->text < parser->textEnd && isspace( (unsigned char) *(parser->text) ) ) parser->text++;
+}
+
+static bool Expression_Accept( SignalExpressionParser* parser, char token )
+{
+  Expression_SkipSpaces( parser );
+  if( parser->text >= parser->textEnd || *(parser->text) != token ) return false;
+  parser->text++;
+  return true;
+}
+
+// Constant operands of operations are folded right away, so that only channel dependent steps are left
+static void Expression_Emit( SignalExpressionParser* parser, int opcode, unsigned int channel, double constant )
+{
+  SignalExpression* expression = parser->expression;
+  SignalExpressionInstruction* instructionsList = expression->instructionsList;
+  size_t instructionsNumber = expression->instructionsNumber;
+  
+  if( opcode == EXPRESSION_NEGATE && instructionsNumber >= 1 && instructionsList[ instructionsNumber - 1 ].opcode == EXPRESSION_PUSH_CONSTANT )
+  {
+    instructionsList[ instructionsNumber - 1 ].constant = -instructionsList[ instructionsNumber - 1 ].constant;
+    return;
+  }
+  
+  if( opcode >= EXPRESSION_ADD && opcode <= EXPRESSION_DIVIDE && instructionsNumber >= 2 
+      && instructionsList[ instructionsNumber - 2 ].opcode == EXPRESSION_PUSH_CONSTANT 
+      && instructionsList[ instructionsNumber - 1 ].opcode == EXPRESSION_PUSH_CONSTANT )
+  {
+    double leftValue = instructionsList[ instructionsNumber - 2 ].constant;
+    double rightValue = instructionsList[ instructionsNumber - 1 ].constant;
+    if( opcode == EXPRESSION_ADD ) leftValue += rightValue;
+    else if( opcode == EXPRESSION_SUBTRACT ) leftValue -= rightValue;
+    else if( opcode == EXPRESSION_MULTIPLY ) leftValue *= rightValue;
+    else leftValue /= rightValue;
+    instructionsList[ instructionsNumber - 2 ].constant = leftValue;
+    expression->instructionsNumber--;
+    parser->stackLength--;
+    return;
+  }
+  
+  if( instructionsNumber >= EXPRESSION_MAX_INSTRUCTIONS )
+  {
+    parser->hasError = true;
+    return;
+  }
+  
+  if( opcode == EXPRESSION_PUSH_CHANNEL || opcode == EXPRESSION_PUSH_CONSTANT )
+  {
+    if( ++(parser->stackLength) > EXPRESSION_STACK_MAX_LENGTH ) parser->hasError = true;
+  }
+  else if( opcode != EXPRESSION_NEGATE ) parser->stackLength--;
+  
+  instructionsList[ instructionsNumber ].opcode = opcode;
+  instructionsList[ instructionsNumber ].channel = channel;
+  instructionsList[ instructionsNumber ].constant = constant;
+  expression->instructionsNumber++;
+}
+
+static void Expression_ParseFactor( SignalExpressionParser* parser )
+{
+  if( parser->hasError ) return;
+  
+  if( Expression_Accept( parser, '-' ) )
+  {
+    Expression_ParseFactor( parser );
+    Expression_Emit( parser, EXPRESSION_NEGATE, 0, 0.0 );
+  }
+  else if( Expression_Accept( parser, '(' ) )
+  {
+    Expression_ParseSum( parser );
+    if( !Expression_Accept( parser, ')' ) ) parser->hasError = true;
+  }
+  else if( Expression_Accept( parser, '[' ) )
+  {
+    char* channelEnd;
+    unsigned long channel = strtoul( parser->text, &channelEnd, 10 );
+    if( channelEnd == parser->text || channelEnd > parser->textEnd || channel >= parser->channelsNumber ) parser->hasError = true;
+    parser->text = channelEnd;
+    if( !Expression_Accept( parser, ']' ) ) parser->hasError = true;
+    Expression_Emit( parser, EXPRESSION_PUSH_CHANNEL, (unsigned int) channel, 0.0 );
+  }
+  else
+  {
+    char* constantEnd;
+    double constant = strtod( parser->text, &constantEnd );
+    if( constantEnd == parser->text || constantEnd > parser->textEnd ) parser->hasError = true;
+    parser->text = constantEnd;
+    Expression_Emit( parser, EXPRESSION_PUSH_CONSTANT, 0, constant );
+  }
+}
+
+static void Expression_ParseProduct( SignalExpressionParser* parser )
+{
+  Expression_ParseFactor( parser );
+  while( !parser->hasError )
+  {
+    if( Expression_Accept( parser, '*' ) ) 
+    {
+      Expression_ParseFactor( parser );
+      Expression_Emit( parser, EXPRESSION_MULTIPLY, 0, 0.0 );
+    }
+    else if( Expression_Accept( parser, '/' ) ) 
+    {
+      Expression_ParseFactor( parser );
+      Expression_Emit( parser, EXPRESSION_DIVIDE, 0, 0.0 );
+    }
+    else break;
+  }
+}
+
+static void Expression_ParseSum( SignalExpressionParser* parser )
+{
+  Expression_ParseProduct( parser );
+  while( !parser->hasError )
+  {
+    if( Expression_Accept( parser, '+' ) ) 
+    {
+      Expression_ParseProduct( parser );
+      Expression_Emit( parser, EXPRESSION_ADD, 0, 0.0 );
+    }
+    else if( Expression_Accept( parser, '-' ) ) 
+    {
+      Expression_ParseProduct( parser );
+      Expression_Emit( parser, EXPRESSION_SUBTRACT, 0, 0.0 );
+    }
+    else break;
+  }
+}
+
+/// Compiles textLength characters of text, referencing channels lower than channelsNumber. Returns false on syntax errors
+static bool Expression_Compile( const char* text, size_t textLength, unsigned int channelsNumber, SignalExpression* ref_expression )
+{
+  ref_expression->instructionsNumber = 0;
+  
+  SignalExpressionParser parser = { text, text + textLength, channelsNumber, 0, false, ref_expression };
+  Expression_ParseSum( &parser );
+  Expression_SkipSpaces( &parser );
+  
+  return ( !parser.hasError && parser.text == parser.textEnd );
+}
+
+/// Checks if given channel is an operand of the expression
+static bool Expression_UsesChannel( const SignalExpression* expression, unsigned int channel )
+{
+  for( size_t instructionIndex = 0; instructionIndex < expression->instructionsNumber; instructionIndex++ )
+  {
+    const SignalExpressionInstruction* instruction = expression->instructionsList + instructionIndex;
+    if( instruction->opcode == EXPRESSION_PUSH_CHANNEL && instruction->channel == channel ) return true;
+  }
+  
+  return false;
+}
+
+// Operands are either constants or (channel or intermediate results) value lists
+#define EXPRESSION_APPLY( OPERATOR ) \
+  if( leftOperand->valuesList == NULL ) \
+    for( size_t index = 0; index < length; index++ ) resultsList[ index ] = leftOperand->constant OPERATOR rightOperand->valuesList[ index ]; \
+  else if( rightOperand->valuesList == NULL ) \
+    for( size_t index = 0; index < length; index++ ) resultsList[ index ] = leftOperand->valuesList[ index ] OPERATOR rightOperand->constant; \
+  else \
+    for( size_t index = 0; index < length; index++ ) resultsList[ index ] = leftOperand->valuesList[ index ] OPERATOR rightOperand->valuesList[ index ];
+
+typedef struct _SignalExpressionOperand
+{
+  const double* valuesList;
+  double constant;
+}
+SignalExpressionOperand;
+
+static void Expression_EvaluateChunk( const SignalExpression* expression, const double* rowsBase, size_t rowsStride, 
+                                      size_t length, double* chunkResultsList )
+{
+  double stackTable[ EXPRESSION_STACK_MAX_LENGTH ][ EXPRESSION_CHUNK_LENGTH ];
+  SignalExpressionOperand operandsList[ EXPRESSION_STACK_MAX_LENGTH ];
+  size_t stackLength = 0;
+  
+  for( size_t instructionIndex = 0; instructionIndex < expression->instructionsNumber; instructionIndex++ )
+  {
+    const SignalExpressionInstruction* instruction = expression->instructionsList + instructionIndex;
+    if( instruction->opcode == EXPRESSION_PUSH_CHANNEL )
+    {
+      operandsList[ stackLength ].valuesList = rowsBase + instruction->channel * rowsStride;
+      stackLength++;
+    }
+    else if( instruction->opcode == EXPRESSION_PUSH_CONSTANT )
+    {
+      operandsList[ stackLength ].valuesList = NULL;
+      operandsList[ stackLength ].constant = instruction->constant;
+      stackLength++;
+    }
+    else if( instruction->opcode == EXPRESSION_NEGATE )
+    {
+      SignalExpressionOperand* operand = operandsList + stackLength - 1;
+      double* resultsList = stackTable[ stackLength - 1 ];
+      for( size_t index = 0; index < length; index++ ) resultsList[ index ] = -operand->valuesList[ index ];
+      operand->valuesList = resultsList;
+    }
+    else
+    {
+      // Results always take the left operand stack position (and buffer)
+      SignalExpressionOperand* leftOperand = operandsList + stackLength - 2;
+      SignalExpressionOperand* rightOperand = operandsList + stackLength - 1;
+      double* resultsList = stackTable[ stackLength - 2 ];
+      if( instruction->opcode == EXPRESSION_ADD ) { EXPRESSION_APPLY( + ) }
+      else if( instruction->opcode == EXPRESSION_SUBTRACT ) { EXPRESSION_APPLY( - ) }
+      else if( instruction->opcode == EXPRESSION_MULTIPLY ) { EXPRESSION_APPLY( * ) }
+      else { EXPRESSION_APPLY( / ) }
+      leftOperand->valuesList = resultsList;
+      stackLength--;
+    }
+  }
+  
+  if( operandsList[ 0 ].valuesList == NULL )
+    for( size_t index = 0; index < length; index++ ) chunkResultsList[ index ] = operandsList[ 0 ].constant;
+  else
+    memcpy( chunkResultsList, operandsList[ 0 ].valuesList, length * sizeof(double) );
+}
+
+/// Evaluates the expression for length samples from position start of channel rows (rowsBase + channel * rowsStride), 
+/// storing them on resultsList (which may be one of the rows, as long as it is not an operand)
+static void Expression_Evaluate( const SignalExpression* expression, const double* rowsBase, size_t rowsStride, 
+                                 size_t start, size_t length, double* resultsList )
+{
+  for( size_t offset = 0; offset < length; offset += EXPRESSION_CHUNK_LENGTH )
+  {
+    size_t chunkLength = ( length - offset < EXPRESSION_CHUNK_LENGTH ) ? length - offset : EXPRESSION_CHUNK_LENGTH;
+    Expression_EvaluateChunk( expression, rowsBase + start + offset, rowsStride, chunkLength, resultsList + offset );
+  }
+}
+
+#endif // SIGNAL_EXPRESSIONS_H
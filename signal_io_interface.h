@@ -29,6 +29,8 @@
 #ifndef SIGNAL_IO_INTERFACE_H
 #define SIGNAL_IO_INTERFACE_H
 
+#include <stdint.h>
+#include <stddef.h>
 #include <math.h>
 #ifndef M_PI
 #define M_PI 3.14159    ///< Defines mathematical Pi value if standard math.h one is not available
@@ -40,95 +42,522 @@
 
 #define SIGNAL_IO_TASK_INVALID_ID -1        ///< Task identifier to be returned on task creation errors
 
-/// Signal input/output interface declaration macro
+#define SIGNAL_IO_READER_LATEST 0x0         ///< Reader gets the last aquired block on each call, skipping older ones (default)
+#define SIGNAL_IO_READER_DROP_OLDEST 0x1    ///< Reader gets all samples since its last call, up to GetMaxInputSamplesNumber() each, dropping the ones overwritten meanwhile
+#define SIGNAL_IO_READER_DECIMATE_ON_LAG 0x2    ///< Like SIGNAL_IO_READER_DROP_OLDEST, but decimating the samples since last call to catch up when they don't fit a single read
+#define SIGNAL_IO_READER_POLICY_MASK 0x3    ///< AcquireReader() options bits holding the backpressure policy
+
+#define SIGNAL_IO_READER_HISTOGRAM_BINS 24  ///< Reader timing histograms bins: bin k counts values in [2^k, 2^(k+1)) microseconds (first and last ones also below/above)
+
+#define SIGNAL_IO_INTERPOLATION_HOLD 0      ///< Last output command held until the next one (zero-order hold)
+#define SIGNAL_IO_INTERPOLATION_LINEAR 1    ///< Linear interpolation between the 2 samples around a given time
+#define SIGNAL_IO_INTERPOLATION_CUBIC 3     ///< Cubic (Catmull-Rom) interpolation between the 4 samples around a given time
+
+#define SIGNAL_IO_INTERFACE_VERSION 3       ///< Current interface version, as returned by GetInterfaceVersion() (functions tables carry their size from version 3 on)
+
+#define SIGNAL_IO_CAP_BLOCK_READ 0x0001     ///< Whole task samples blocks could be read at once (ReadAll)
+#define SIGNAL_IO_CAP_TIMESTAMPS 0x0002     ///< Read samples come with monotonic timestamps
+#define SIGNAL_IO_CAP_ZERO_COPY 0x0004      ///< Read samples could be accessed in place, without copies
+#define SIGNAL_IO_CAP_RESAMPLING 0x0008     ///< Inputs could be read at rates other than the aquisition one
+#define SIGNAL_IO_CAP_TIME_QUERY 0x0010     ///< Inputs could be read at arbitrary times (ReadAtTime)
+#define SIGNAL_IO_CAP_VIEWS 0x0020          ///< Tasks could be split in channel subset views
+#define SIGNAL_IO_CAP_ADAPTIVE_BLOCKS 0x0040    ///< Input blocks length could adapt to driver backlog
+#define SIGNAL_IO_CAP_RECORDER 0x0080       ///< Recent inputs and outputs are kept for dumping on faults or on demand
+#define SIGNAL_IO_CAP_MARKERS 0x0100        ///< Client event markers could be placed on task sample streams
+#define SIGNAL_IO_CAP_FILTERS 0x0200        ///< Input channels could be median/Hampel filtered on aquisition
+#define SIGNAL_IO_CAP_EMG_FEATURES 0x0400   ///< Time-domain EMG features could be computed on aquisition
+#define SIGNAL_IO_CAP_ENSEMBLES 0x0800      ///< Trigger locked input sweeps could be averaged on aquisition
+#define SIGNAL_IO_CAP_TARE 0x1000           ///< Input offsets could be estimated and subtracted on aquisition
+#define SIGNAL_IO_CAP_VIRTUAL_CHANNELS 0x2000   ///< Input channels computed from expressions over device ones could be defined
+#define SIGNAL_IO_CAP_INTERPOLATION 0x4000  ///< Clocked outputs are generated interpolating timestamped commands
+#define SIGNAL_IO_CAP_REGENERATION 0x8000   ///< Clocked outputs could loop a waveform period on the device
+#define SIGNAL_IO_CAP_COUNTER_OUTPUTS 0x10000   ///< Counter (PWM) outputs take duty cycle and frequency channels
+#define SIGNAL_IO_CAP_WATCHDOG 0x20000      ///< Outputs fall back to safe values when commands stop
+#define SIGNAL_IO_CAP_CHANGE_DETECTION 0x40000  ///< Change detection digital inputs deliver timestamped line edges
+#define SIGNAL_IO_CAP_INTERLOCKS 0x80000    ///< Input conditions could force output tasks to safe values on aquisition
+#define SIGNAL_IO_CAP_OUTPUT_GROUPS 0x100000    ///< Clocked output tasks could share sample clock and apply joint command frames on the same tick
+#define SIGNAL_IO_CAP_MAILBOX 0x200000      ///< Output tasks could take commands from other processes through shared memory (signal_mailbox.h)
+#define SIGNAL_IO_CAP_READER_POLICIES 0x400000  ///< Readers could take SIGNAL_IO_READER_* backpressure policies and report lag/drops (GetReaderStatus)
+#define SIGNAL_IO_CAP_READER_DEADLINES 0x800000 ///< Readers could declare their expected read period and get late reads detected (SetReaderDeadline)
+#define SIGNAL_IO_CAP_PAUSE 0x1000000       ///< Idle tasks are paused instead of stopped, and report their resume latency (GetResumeLatency)
+
+#define SIGNAL_IO_EVENT_TARE_DONE 0x01      ///< Tare offsets estimation completed
+#define SIGNAL_IO_EVENT_WATCHDOG 0x02       ///< Output watchdog expired, with safe values written instead of commands
+#define SIGNAL_IO_EVENT_EDGES 0x04          ///< New edges detected on change detection input lines
+#define SIGNAL_IO_EVENT_INTERLOCK 0x08      ///< Output task forced to safe values by an interlock rule (until Reset())
+#define SIGNAL_IO_EVENT_LATE_READER 0x10    ///< Some reader with declared deadline is late (missed its period or consumed too old data)
+
+#define SIGNAL_IO_TRIGGER_INPUT_LEVEL 0     ///< Rising crossings of a level by an input channel (also for digital lines aquired as inputs)
+#define SIGNAL_IO_TRIGGER_OUTPUT_LEVEL 1    ///< Rising crossings of a level by the values written to an output channel
+#define SIGNAL_IO_TRIGGER_MARKER 2          ///< Markers with a given code
+
+#define SIGNAL_IO_INTERLOCK_ABOVE 0         ///< Interlock trips on input samples above the threshold
+#define SIGNAL_IO_INTERLOCK_BELOW 1         ///< Interlock trips on input samples below the threshold (e.g. 0.5 for digital lines going low)
+
+/// Time-domain EMG features, in the order they are stored for each channel (ReadEMGFeatures)
+enum { SIGNAL_IO_EMG_MAV,       ///< Mean absolute value
+       SIGNAL_IO_EMG_WL,        ///< Waveform length (sum of absolute differences)
+       SIGNAL_IO_EMG_ZC,        ///< Zero crossings count
+       SIGNAL_IO_EMG_SSC,       ///< Slope sign changes count
+       SIGNAL_IO_EMG_RMS,       ///< Root mean square
+       SIGNAL_IO_EMG_FEATURES_NUMBER };
+
+typedef struct _SignalIOTaskData* SignalIOTaskHandle;       ///< Opaque reference to plugin task state
+typedef struct _SignalIOReaderData* SignalIOReaderHandle;   ///< Opaque reference to plugin input channel reader state
+
+/// Client event annotation, placed on a task sample stream
+typedef struct _SignalIOMarker
+{
+  uint64_t sampleIndex;     ///< Index of the next input sample (or output frame) of the task when marked
+  double time;              ///< Monotonic time of marking, in seconds
+  unsigned int code;        ///< Client defined event code
+  double payload;           ///< Client defined event value
+}
+SignalIOMarker;
+
+/// Digital line transition, detected by change detection input tasks
+typedef struct _SignalIOEdge
+{
+  uint64_t sampleIndex;     ///< Index of the change detection sample holding the new line state
+  double time;              ///< Estimated monotonic time of the edge detection, in seconds: exact for edges read as they come, 
+                            ///< and interpolated over the interval since the previous driver read for backlogged ones
+  unsigned int channel;     ///< Task channel (line) index
+  bool isRising;            ///< Transition to high (true) or low (false) level
+}
+SignalIOEdge;
+
+/// Read timing statistics of a reader with declared deadline, since the declaration
+typedef struct _SignalIOReaderTiming
+{
+  uint64_t readsCount;          ///< Number of Read() calls
+  uint64_t lateReadsCount;      ///< Number of Read() calls exceeding the expected period or the maximum data age
+  double maxReadInterval;       ///< Longest time between consecutive Read() calls, in seconds
+  double maxDataAge;            ///< Oldest newest-sample age at Read() return, in seconds
+  bool isLate;                  ///< Reader was late (or stalled) since last query (cleared on query)
+  uint64_t readIntervalsHistogram[ SIGNAL_IO_READER_HISTOGRAM_BINS ];   ///< Time between consecutive Read() calls
+  uint64_t dataAgesHistogram[ SIGNAL_IO_READER_HISTOGRAM_BINS ];        ///< Age of the newest sample returned by each Read() call
+}
+SignalIOReaderTiming;
+
+/// Version 2 interface (see SIGNAL_IO_INTERFACE_V2): hot path functions take opaque handles, resolved once, instead of identifiers 
+/// looked up on each call. Optional features are only reached through this table, and may only be used with their SIGNAL_IO_CAP_* flag set.
+/// New entries are only appended: hosts check that the ones they use are inside the plugin table (SIGNAL_IO_V2_HAS), and ignore 
+/// tables of versions below 3 (with no size)
+typedef struct _SignalIOInterfaceV2
+{
+  unsigned int version;                                                                       ///< Implemented interface version
+  size_t size;                                                                                ///< Size of the table implemented by the plugin (sizeof(SignalIOInterfaceV2) at its build)
+  unsigned int capabilities;                                                                  ///< Supported SIGNAL_IO_CAP_* flags
+  SignalIOTaskHandle (*OpenTask)( const char* );                                              ///< Same as InitDevice(), returning task handle (NULL on errors)
+  void (*CloseTask)( SignalIOTaskHandle );                                                    ///< Same as EndDevice()
+  size_t (*GetMaxInputSamplesNumber)( SignalIOTaskHandle );                                   ///< Same as GetMaxInputSamplesNumber()
+  SignalIOReaderHandle (*AcquireReader)( SignalIOTaskHandle, unsigned int, unsigned int );    ///< Adds reader for given channel, with options flags (0 for defaults). Returns NULL on errors
+  size_t (*Read)( SignalIOReaderHandle, double*, double* );                                   ///< Reads reader channel samples (by its policy) and monotonic time of the last one (may be NULL)
+  void (*ReleaseReader)( SignalIOReaderHandle );                                              ///< Removes given reader
+  bool (*AcquireOutputChannel)( SignalIOTaskHandle, unsigned int );                           ///< Same as AcquireOutputChannel()
+  bool (*Write)( SignalIOTaskHandle, unsigned int, double );                                  ///< Same as Write()
+  void (*ReleaseOutputChannel)( SignalIOTaskHandle, unsigned int );                           ///< Same as ReleaseOutputChannel()
+  bool (*Mark)( SignalIOTaskHandle, unsigned int, double );                                   ///< See Mark(). Only with SIGNAL_IO_CAP_MARKERS
+  size_t (*ReadMarkers)( SignalIOReaderHandle, SignalIOMarker*, size_t );                     ///< Reads markers placed since reader acquisition (or its last call), oldest first
+  bool (*GetReaderStatus)( SignalIOReaderHandle, uint64_t*, uint64_t* );                      ///< Gets reader lag and dropped (or decimated away) samples count. Only with SIGNAL_IO_CAP_READER_POLICIES
+  bool (*SetReaderDeadline)( SignalIOReaderHandle, double, double );                          ///< Declares reader expected Read() period and max data age in seconds (0 to skip each, both to stop monitoring). Only with SIGNAL_IO_CAP_READER_DEADLINES
+  bool (*GetReaderTiming)( SignalIOReaderHandle, SignalIOReaderTiming* );                     ///< Gets read timing statistics of a reader with declared deadline. Only with SIGNAL_IO_CAP_READER_DEADLINES
+  long int (*GetTaskID)( SignalIOTaskHandle );                                                ///< Gets task (or view) identifier taken by the setup functions below (SIGNAL_IO_TASK_INVALID_ID on errors)
+  bool (*SetAdaptiveInput)( long int, size_t );                                               ///< See SetAdaptiveInput(). Only with SIGNAL_IO_CAP_ADAPTIVE_BLOCKS
+  size_t (*GetInputBlockLength)( long int, double* );                                         ///< See GetInputBlockLength(). Only with SIGNAL_IO_CAP_ADAPTIVE_BLOCKS
+  double (*GetResumeLatency)( long int, double* );                                            ///< See GetResumeLatency(). Only with SIGNAL_IO_CAP_PAUSE
+  size_t (*ReadAll)( long int, double* );                                                     ///< See ReadAll(). Only with SIGNAL_IO_CAP_BLOCK_READ
+  size_t (*ReadAtTime)( long int, const unsigned int*, size_t, const double*, size_t, int, double* );   ///< See ReadAtTime(). Only with SIGNAL_IO_CAP_TIME_QUERY
+  long int (*AcquireResampledInput)( long int, double );                                      ///< See AcquireResampledInput(). Only with SIGNAL_IO_CAP_RESAMPLING
+  size_t (*ReadResampled)( long int, size_t, double*, double* );                              ///< See ReadResampled(). Only with SIGNAL_IO_CAP_RESAMPLING
+  void (*ReleaseResampledInput)( long int );                                                  ///< See ReleaseResampledInput(). Only with SIGNAL_IO_CAP_RESAMPLING
+  bool (*DumpRecording)( long int, const char* );                                             ///< See DumpRecording(). Only with SIGNAL_IO_CAP_RECORDER
+  size_t (*ReadTaskMarkers)( long int, uint64_t*, SignalIOMarker*, size_t );                  ///< See ReadMarkers() (also for output tasks). Only with SIGNAL_IO_CAP_MARKERS
+  bool (*SetInputFilter)( long int, unsigned int, size_t, double );                           ///< See SetInputFilter(). Only with SIGNAL_IO_CAP_FILTERS
+  bool (*SetEMGFeatures)( long int, double, double, double );                                 ///< See SetEMGFeatures(). Only with SIGNAL_IO_CAP_EMG_FEATURES
+  size_t (*ReadEMGFeatures)( long int, uint64_t*, double*, double*, size_t );                 ///< See ReadEMGFeatures(). Only with SIGNAL_IO_CAP_EMG_FEATURES
+  long int (*AcquireEnsembleAverage)( long int, const unsigned int*, size_t, double, double ); ///< See AcquireEnsembleAverage(). Only with SIGNAL_IO_CAP_ENSEMBLES
+  bool (*SetEnsembleTrigger)( long int, int, long int, unsigned int, double );                ///< See SetEnsembleTrigger(). Only with SIGNAL_IO_CAP_ENSEMBLES
+  size_t (*ReadEnsembleAverage)( long int, double*, double* );                                ///< See ReadEnsembleAverage(). Only with SIGNAL_IO_CAP_ENSEMBLES
+  void (*ReleaseEnsembleAverage)( long int );                                                 ///< See ReleaseEnsembleAverage(). Only with SIGNAL_IO_CAP_ENSEMBLES
+  bool (*Tare)( long int, uint64_t, double );                                                 ///< See Tare(). Only with SIGNAL_IO_CAP_TARE
+  unsigned int (*WaitEvents)( long int, bool );                                               ///< See WaitEvents(). Only with some SIGNAL_IO_CAP_* flag of the SIGNAL_IO_EVENT_* features
+  size_t (*ReadEdges)( long int, uint64_t*, SignalIOEdge*, size_t );                          ///< See ReadEdges(). Only with SIGNAL_IO_CAP_CHANGE_DETECTION
+  long int (*AddInterlock)( long int, unsigned int, int, double, long int );                  ///< See AddInterlock(). Only with SIGNAL_IO_CAP_INTERLOCKS
+  void (*RemoveInterlock)( long int );                                                        ///< See RemoveInterlock(). Only with SIGNAL_IO_CAP_INTERLOCKS
+  double (*GetInterlockLatency)( long int, double* );                                         ///< See GetInterlockLatency(). Only with SIGNAL_IO_CAP_INTERLOCKS
+  bool (*SetOutputInterpolation)( long int, int, double );                                    ///< See SetOutputInterpolation(). Only with SIGNAL_IO_CAP_INTERPOLATION
+  bool (*SetOutputPacing)( long int, double, double );                                        ///< See SetOutputPacing(). Only with SIGNAL_IO_CAP_WATCHDOG
+  bool (*SetOutputWaveform)( long int, const double*, size_t );                               ///< See SetOutputWaveform(). Only with SIGNAL_IO_CAP_REGENERATION
+  bool (*OpenOutputMailbox)( long int );                                                      ///< See OpenOutputMailbox(). Only with SIGNAL_IO_CAP_MAILBOX
+  long int (*CreateOutputGroup)( const long int*, size_t );                                   ///< See CreateOutputGroup(). Only with SIGNAL_IO_CAP_OUTPUT_GROUPS
+  bool (*CommitOutputGroup)( long int, const double* );                                       ///< See CommitOutputGroup(). Only with SIGNAL_IO_CAP_OUTPUT_GROUPS
+  void (*ReleaseOutputGroup)( long int );                                                     ///< See ReleaseOutputGroup(). Only with SIGNAL_IO_CAP_OUTPUT_GROUPS
+}
+SignalIOInterfaceV2;
+
+/// Verifies that given entry is implemented by a plugin functions table (built with a header version including it)
+#define SIGNAL_IO_V2_HAS( table, entry ) ( (table)->version >= 3 && (table)->size >= offsetof( SignalIOInterfaceV2, entry ) + sizeof((table)->entry) )
+
+/// Signal input/output interface declaration macro (version 1 entry points, exported by every plugin)
 #define SIGNAL_IO_INTERFACE( Namespace, INIT_FUNCTION ) \
-        INIT_FUNCTION( int, Namespace, InitTask, const char* ) \
-        INIT_FUNCTION( void, Namespace, EndTask, int ) \
-        INIT_FUNCTION( void, Namespace, Reset, int ) \
-        INIT_FUNCTION( bool, Namespace, HasError, int ) \
-        INIT_FUNCTION( size_t, Namespace, GetMaxInputSamplesNumber, int ) \
-        INIT_FUNCTION( size_t, Namespace, Read, int, unsigned int, double* ) \
-        INIT_FUNCTION( bool, Namespace, AcquireInputChannel, int, unsigned int ) \
-        INIT_FUNCTION( void, Namespace, ReleaseInputChannel, int, unsigned int ) \
-        INIT_FUNCTION( void, Namespace, EnableOutput, int, bool ) \
-        INIT_FUNCTION( bool, Namespace, IsOutputEnabled, int ) \
-        INIT_FUNCTION( bool, Namespace, Write, int, unsigned int, double ) \
-        INIT_FUNCTION( bool, Namespace, AcquireOutputChannel, int, unsigned int ) \
-        INIT_FUNCTION( void, Namespace, ReleaseOutputChannel, int, unsigned int ) 
+        INIT_FUNCTION( long int, Namespace, InitDevice, const char* ) \
+        INIT_FUNCTION( void, Namespace, EndDevice, long int ) \
+        INIT_FUNCTION( void, Namespace, Reset, long int ) \
+        INIT_FUNCTION( bool, Namespace, HasError, long int ) \
+        INIT_FUNCTION( size_t, Namespace, GetMaxInputSamplesNumber, long int ) \
+        INIT_FUNCTION( size_t, Namespace, Read, long int, unsigned int, double* ) \
+        INIT_FUNCTION( bool, Namespace, CheckInputChannel, long int, unsigned int ) \
+        INIT_FUNCTION( void, Namespace, ReleaseInputChannel, long int, unsigned int ) \
+        INIT_FUNCTION( void, Namespace, EnableOutput, long int, bool ) \
+        INIT_FUNCTION( bool, Namespace, IsOutputEnabled, long int ) \
+        INIT_FUNCTION( bool, Namespace, Write, long int, unsigned int, double ) \
+        INIT_FUNCTION( bool, Namespace, AcquireOutputChannel, long int, unsigned int ) \
+        INIT_FUNCTION( void, Namespace, ReleaseOutputChannel, long int, unsigned int ) 
+
+/// Version 2 discovery entry points, declared apart so that hosts could look for them (falling back to version 1 if missing) 
+/// with no change to the entry points required from older plugins
+#define SIGNAL_IO_INTERFACE_V2( Namespace, INIT_FUNCTION ) \
+        INIT_FUNCTION( unsigned int, Namespace, GetInterfaceVersion, void ) \
+        INIT_FUNCTION( unsigned int, Namespace, GetCapabilities, void ) \
+        INIT_FUNCTION( const SignalIOInterfaceV2*, Namespace, GetInterfaceV2, void ) 
 
         
 /// @class SIGNAL_IO_INTERFACE
 /// @brief File/string/stream data input/output methods to be implemented by plugins
 ///    
 /// @memberof SIGNAL_IO_INTERFACE
-/// @fn                                                                             
+/// @fn long int InitDevice( const char* taskConfig )
 /// @brief Creates plugin specific signal input/output task data structure
-/// @param[in] taskConfig implementation specific task configuration string
+/// @param[in] taskConfig implementation specific task configuration string. Views over a task channels subset use "[<view name>=]<task name>:<channel>,<channel>,..." (view names may not match task ones). Input tasks may define virtual channels (indexed after the device ones) with "<task name>|<expression>|...", where expressions combine channels ([N]), numbers, + - * / and parentheses
 /// @return generic identifier to newly created task (SIGNAL_IO_TASK_INVALID_ID on errors)
 ///   
 /// @memberof SIGNAL_IO_INTERFACE
-/// @fn void EndTask( int taskID )
+/// @fn void EndDevice( long int taskID )
 /// @brief Discards given signal input/output task data structure    
 /// @param[in] taskID input/output task identifier
 ///   
 /// @memberof SIGNAL_IO_INTERFACE
-/// @fn bool HasError( int taskID )                                                                                
+/// @fn bool HasError( long int taskID )                                                                                
 /// @brief Verifies occurence of errors on given task
 /// @param[in] taskID input/output task identifier 
 /// @return true on detected error, false otherwise 
 ///   
 /// @memberof SIGNAL_IO_INTERFACE        
-/// @fn void Reset( int taskID )
-/// @brief Resets data and errors for given task
+/// @fn void Reset( long int taskID )
+/// @brief Resets data and errors for given task (clearing interlock trips of output tasks)
 /// @param[in] taskID input/output task identifier
 ///   
 /// @memberof SIGNAL_IO_INTERFACE
-/// @fn size_t GetMaxInputSamplesNumber( int taskID )
-/// @brief Gets number of samples aquired for every given task input channel on each Read() call
+/// @fn size_t GetMaxInputSamplesNumber( long int taskID )
+/// @brief Gets max number of samples returned for every given task input channel by each Read() call
 /// @param[in] taskID input task identifier
-/// @return max read samples number (0 on errors)
+/// @return max read samples number (0 on errors): the fixed block length by default, or the max block length set with 
+/// SetAdaptiveInput() (so buffers sized before enabling adaptive blocks have to be sized again)
+///   
+/// @memberof SignalIOInterfaceV2
+/// @fn bool SetAdaptiveInput( long int taskID, size_t maxBlockLength )
+/// @brief Enables reading all samples available to given task on each aquisition, with block length adapted to driver backlog
+/// @param[in] taskID input task identifier
+/// @param[in] maxBlockLength max samples number aquired per channel at once (0 for fixed length blocks). Should be set before allocating Read() buffers
+/// @return true on successful configuration, false otherwise
+/// @note Block length only follows the driver backlog, not the lag of slow readers: readers needing every sample should use 
+/// SIGNAL_IO_READER_DROP_OLDEST (or SIGNAL_IO_READER_DECIMATE_ON_LAG) policies and check their lag with GetReaderStatus
+///   
+/// @memberof SignalIOInterfaceV2
+/// @fn size_t GetInputBlockLength( long int taskID, double* ref_averageLength )
+/// @brief Gets number of samples per channel of the last block aquired by given task
+/// @param[in] taskID input task identifier
+/// @param[out] ref_averageLength average block length over recent aquisitions (may be NULL)
+/// @return last block samples number (0 on errors)
+///   
+/// @memberof SignalIOInterfaceV2
+/// @fn double GetResumeLatency( long int taskID, double* ref_maxLatency )
+/// @brief Gets time taken by given task to resume processing after its last (re)aquisition, when idle tasks are paused
+/// @param[in] taskID task identifier
+/// @param[out] ref_maxLatency maximum resume latency since task loading, in seconds (may be NULL)
+/// @return last resume latency in seconds (0 if never resumed or on errors)
+///   
+/// @memberof SignalIOInterfaceV2
+/// @fn long int AddInterlock( long int inputTaskID, unsigned int inputChannel, int condition, double threshold, long int outputTaskID )
+/// @brief Adds rule forcing given output task to its safe values, checked on every aquired sample of given input channel (trips are latched until Reset())
+/// @param[in] inputTaskID monitored input task identifier
+/// @param[in] inputChannel monitored input task channel index (kept in aquisition while the rule exists)
+/// @param[in] condition SIGNAL_IO_INTERLOCK_ABOVE or SIGNAL_IO_INTERLOCK_BELOW
+/// @param[in] threshold input value beyond which the rule trips
+/// @param[in] outputTaskID forced output task identifier (not unloaded while rules refer to it)
+/// @return interlock rule identifier (-1 on errors)
+///   
+/// @memberof SignalIOInterfaceV2
+/// @fn void RemoveInterlock( long int interlockID )
+/// @brief Removes given interlock rule (keeping any trip it caused)
+/// @param[in] interlockID interlock rule identifier
+///   
+/// @memberof SignalIOInterfaceV2
+/// @fn double GetInterlockLatency( long int taskID, double* ref_maxLatency )
+/// @brief Gets time from the input sample tripping given output task to the output of its safe values
+/// @param[in] taskID output task identifier
+/// @param[out] ref_maxLatency maximum trip latency since task loading, in seconds (may be NULL)
+/// @return last trip latency in seconds (0 if never tripped or on errors)
+///   
+/// @memberof SignalIOInterfaceV2
+/// @fn bool SetInputFilter( long int taskID, unsigned int channel, size_t windowLength, double threshold )
+/// @brief Sets causal spike removal filter for specified input channel of given task, applied on aquisition
+/// @param[in] taskID input task identifier
+/// @param[in] channel input task channel index
+/// @param[in] windowLength odd number of filter window samples, from 3 to 15 (the same for all filtered channels of a task), or 0 to disable filtering
+/// @param[in] threshold Hampel filter threshold, in (MAD estimated) standard deviations from the window median, or 0 for a running median filter
+/// @return true on successful filter setting, false otherwise
+///   
+/// @memberof SignalIOInterfaceV2
+/// @fn bool SetEMGFeatures( long int taskID, double windowDuration, double incrementDuration, double threshold )
+/// @brief Sets sliding window time-domain EMG features computation for the channels (with readers) of given task
+/// @param[in] taskID input task identifier
+/// @param[in] windowDuration features window duration in seconds (0 to disable computation)
+/// @param[in] incrementDuration time between consecutive windows, in seconds
+/// @param[in] threshold minimum signal difference for zero crossings (and difference product for slope sign changes) to be counted
+/// @return true on successful setting, false otherwise (sample clocked input tasks only)
+///   
+/// @memberof SignalIOInterfaceV2
+/// @fn size_t ReadEMGFeatures( long int taskID, uint64_t* ref_cursor, double* featuresTable, double* timestampsList, size_t maxWindowsNumber )
+/// @brief Reads feature windows computed for given task, starting from caller owned cursor (windows overwritten before being read are skipped)
+/// @param[in] taskID input task identifier
+/// @param[in,out] ref_cursor index of next window to be read (0 for the oldest one available), advanced past returned ones
+/// @param[out] featuresTable array for SIGNAL_IO_EMG_FEATURES_NUMBER features of each task channel (NaN for channels with no readers), for each window
+/// @param[out] timestampsList array for monotonic times of each window last sample (may be NULL)
+/// @param[in] maxWindowsNumber max number of windows to be read
+/// @return number of read windows
+///   
+/// @memberof SignalIOInterfaceV2
+/// @fn size_t ReadEdges( long int taskID, uint64_t* ref_cursor, SignalIOEdge* edgesList, size_t maxEdgesNumber )
+/// @brief Reads line edges detected by given change detection task, starting from caller owned cursor (edges overwritten before being read are skipped)
+/// @param[in] taskID change detection input task identifier (only lines with readers are monitored, see CheckInputChannel())
+/// @param[in,out] ref_cursor index of next edge to be read (0 for the oldest one available), advanced past returned ones
+/// @param[out] edgesList array for read edges, oldest first
+/// @param[in] maxEdgesNumber edges array length
+/// @return number of read edges (new ones raise SIGNAL_IO_EVENT_EDGES)
+///   
+/// @memberof SignalIOInterfaceV2
+/// @fn bool Tare( long int taskID, uint64_t channelMask, double duration )
+/// @brief Starts estimating offsets of given task channels, from their mean over following samples, to be subtracted from all their later samples
+/// @param[in] taskID input task identifier
+/// @param[in] channelMask bit mask of tared channels (first 64 only)
+/// @param[in] duration averaging window duration (in seconds)
+/// @return true if estimation was started, false on errors or if another one is still in progress (completion raises SIGNAL_IO_EVENT_TARE_DONE)
+///   
+/// @memberof SignalIOInterfaceV2
+/// @fn unsigned int WaitEvents( long int taskID, bool isBlocking )
+/// @brief Gets and clears SIGNAL_IO_EVENT_* flags raised for given task since last call
+/// @param[in] taskID task identifier
+/// @param[in] isBlocking wait for some event to be raised, if none is pending
+/// @return raised events flags
 ///   
 /// @memberof SIGNAL_IO_INTERFACE
-/// @fn bool AcquireInputChannel( int taskID, unsigned int channel )
+/// @fn bool CheckInputChannel( long int taskID, unsigned int channel )
 /// @brief Adds new reader for specified input channel of given task
 /// @param[in] taskID input task identifier
 /// @param[in] channel input task channel index
 /// @return true on successful channel aquisition (availability for reading), false otherwise
 ///   
 /// @memberof SIGNAL_IO_INTERFACE
-/// @fn void ReleaseInputChannel( int taskID, unsigned int channel )
+/// @fn void ReleaseInputChannel( long int taskID, unsigned int channel )
 /// @brief Removes reader for specified input channel of given task
 /// @param[in] taskID input task identifier
 /// @param[in] channel input task channel index
 ///   
+/// @memberof SignalIOInterfaceV2
+/// @fn long int AcquireResampledInput( long int taskID, double outputRate )
+/// @brief Adds new reader for all channels of given task (or view), resampled to specified rate
+/// @param[in] taskID input task identifier
+/// @param[in] outputRate reader samples rate (in Hz)
+/// @return generic identifier to newly created reader (SIGNAL_IO_TASK_INVALID_ID on errors)
+///   
+/// @memberof SignalIOInterfaceV2
+/// @fn size_t ReadResampled( long int readerID, size_t samplesNumber, double* samplesTable, double* ref_timestamp )
+/// @brief Reads samples of given reader, taken on a fixed output rate grid, following the ones of its last call (ones no longer kept in history are skipped and counted as dropped, ones from before its channels activation just skipped)
+/// @param[in] readerID resampled input reader identifier
+/// @param[in] samplesNumber max number of samples to be read for each channel
+/// @param[out] samplesTable allocated buffer long enough to hold one samplesNumber samples row per reader channel
+/// @param[out] ref_timestamp monotonic time (in seconds) of last read sample
+/// @return number of samples read per channel, at the start of each row (0 on errors or with no new samples)
+///   
+/// @memberof SignalIOInterfaceV2
+/// @fn void ReleaseResampledInput( long int readerID )
+/// @brief Removes given resampled reader, releasing its task channels
+/// @param[in] readerID resampled input reader identifier
+///   
+/// @memberof SignalIOInterfaceV2
+/// @fn long int AcquireEnsembleAverage( long int taskID, const unsigned int* channelsList, size_t channelsNumber, double preTriggerDuration, double postTriggerDuration )
+/// @brief Starts averaging sweeps of given task input channels around trigger events
+/// @param[in] taskID task identifier
+/// @param[in] channelsList list of averaged channels
+/// @param[in] channelsNumber number of averaged channels
+/// @param[in] preTriggerDuration sweep duration before each trigger (in seconds)
+/// @param[in] postTriggerDuration sweep duration after each trigger (in seconds)
+/// @return ensemble identifier (negative on errors)
+///   
+/// @memberof SignalIOInterfaceV2
+/// @fn bool SetEnsembleTrigger( long int ensembleID, int triggerSource, long int triggerTaskID, unsigned int triggerChannel, double triggerLevel )
+/// @brief Sets events starting new sweeps of given ensemble (SIGNAL_IO_TRIGGER_* sources)
+/// @param[in] ensembleID ensemble identifier
+/// @param[in] triggerSource kind of trigger events
+/// @param[in] triggerTaskID task providing trigger events (not unloaded while the ensemble refers to it)
+/// @param[in] triggerChannel trigger channel (marker code for marker triggers)
+/// @param[in] triggerLevel level crossed (rising) by trigger channel values
+/// @return true on success, false otherwise
+///   
+/// @memberof SignalIOInterfaceV2
+/// @fn size_t ReadEnsembleAverage( long int ensembleID, double* meansTable, double* variancesTable )
+/// @brief Gets current per sample mean and variance of given ensemble sweeps
+/// @param[in] ensembleID ensemble identifier
+/// @param[out] meansTable sweep means table ([channel][sample], may be NULL)
+/// @param[out] variancesTable sweep variances table ([channel][sample], may be NULL)
+/// @return number of averaged sweeps
+///   
+/// @memberof SignalIOInterfaceV2
+/// @fn void ReleaseEnsembleAverage( long int ensembleID )
+/// @brief Stops given ensemble averaging, releasing its task channels
+/// @param[in] ensembleID ensemble identifier
+///   
 /// @memberof SIGNAL_IO_INTERFACE
-/// @fn size_t Read( int taskID, unsigned int channel, double* ref_value )
+/// @fn size_t Read( long int taskID, unsigned int channel, double* ref_value )
 /// @brief Reads samples list from specified channel of given task
 /// @param[in] taskID input task identifier
 /// @param[in] channel input task channel index
 /// @param[out] ref_value allocated buffer long enough to hold the samples number returned by GetMaxInputSamplesNumber()
 /// @return number of samples read (0 on errors)
 ///   
+/// @memberof SignalIOInterfaceV2
+/// @fn size_t ReadAll( long int taskID, double* samplesTable )
+/// @brief Reads samples lists from all channels of given task (or view)
+/// @param[in] taskID input task identifier
+/// @param[out] samplesTable allocated buffer long enough to hold one GetMaxInputSamplesNumber() samples row per task channel
+/// @return max number of samples read per channel (0 on errors)
+///   
+/// @memberof SignalIOInterfaceV2
+/// @fn size_t ReadAtTime( long int taskID, const unsigned int* channelsList, size_t channelsNumber, const double* timestampsList, size_t timestampsNumber, int interpolation, double* valuesTable )
+/// @brief Interpolates recent signal values of given task (or view) channels at given times
+/// @param[in] taskID input task identifier
+/// @param[in] channelsList list of input task channel indexes
+/// @param[in] channelsNumber number of listed channels
+/// @param[in] timestampsList list of monotonic times (in seconds), in the same time base as ReadResampled() timestamps
+/// @param[in] timestampsNumber number of listed times
+/// @param[in] interpolation interpolation method (SIGNAL_IO_INTERPOLATION_LINEAR or SIGNAL_IO_INTERPOLATION_CUBIC)
+/// @param[out] valuesTable allocated buffer long enough to hold one timestampsNumber values row per listed channel (NaN for unavailable values)
+/// @return number of times inside the available samples history (0 on errors)
+///   
 /// @memberof SIGNAL_IO_INTERFACE
-/// @fn void EnableOutput( int taskID, bool enable )
+/// @fn void EnableOutput( long int taskID, bool enable )
 /// @brief Sets signal output operation state for given task
 /// @param[in] taskID output task identifier
 /// @param[in] enable true for enabling output, false for disabling it
 ///   
 /// @memberof SIGNAL_IO_INTERFACE
-/// @fn bool IsOutputEnabled( int taskID )
+/// @fn bool IsOutputEnabled( long int taskID )
 /// @brief Verifies output operation state of given task 
 /// @param[in] taskID output task identifier
 /// @return true if output is enabled, false otherwise
 ///   
+/// @memberof SignalIOInterfaceV2
+/// @fn bool DumpRecording( long int taskID, const char* filePath )
+/// @brief Saves recently aquired inputs (or written outputs) of given task to file, in background
+/// @param[in] taskID task identifier
+/// @param[in] filePath recording file path (NULL for "<task name>_dump.sigrec")
+/// @return true if dump was started, false on errors or with another dump of the same task in progress
+///   
+/// @memberof SignalIOInterfaceV2
+/// @fn bool Mark( SignalIOTaskHandle task, unsigned int code, double payload )
+/// @brief Places event marker at current sample stream position of given task, with no locks (safe to call from any thread)
+/// @param[in] task task handle
+/// @param[in] code client defined event code
+/// @param[in] payload client defined event value
+/// @return true on success, false on errors
+///   
+/// @memberof SignalIOInterfaceV2
+/// @fn size_t ReadMarkers( long int taskID, uint64_t* ref_cursor, SignalIOMarker* markersList, size_t maxMarkersNumber )
+/// @brief Reads markers placed on given task, starting from caller owned cursor (markers overwritten before being read are skipped)
+/// @param[in] taskID task identifier
+/// @param[in,out] ref_cursor index of next marker to be read (0 for the oldest one available), advanced past returned ones
+/// @param[out] markersList array for read markers, oldest first
+/// @param[in] maxMarkersNumber markers array length
+/// @return number of read markers
+///   
+/// @memberof SignalIOInterfaceV2
+/// @fn bool SetOutputInterpolation( long int taskID, int interpolation, double delay )
+/// @brief Sets how clocked (buffered) output tasks generate hardware rate samples from timestamped Write() commands
+/// @param[in] taskID output task identifier
+/// @param[in] interpolation SIGNAL_IO_INTERPOLATION_HOLD (default), SIGNAL_IO_INTERPOLATION_LINEAR or SIGNAL_IO_INTERPOLATION_CUBIC
+/// @param[in] delay time between commands and their generation (in seconds), longer than the commands period for interpolation to apply (limited to 1 second)
+/// @note Up to 1000 commands are interpolated over the delay: faster commands (over 1 kHz at 1 second delay) update the previous knot instead
+/// @return true on success, false on errors or for unclocked tasks
+///   
+/// @memberof SignalIOInterfaceV2
+/// @fn bool SetOutputPacing( long int taskID, double maxUpdateRate, double watchdogTimeout )
+/// @brief Sets max device update rate of unclocked output tasks (updated only on changes), and output watchdog of all output tasks
+/// @param[in] taskID output task identifier
+/// @param[in] maxUpdateRate max number of device updates per second (1000 by default)
+/// @param[in] watchdogTimeout time without Write() commands after which safe values are written (0 to disable, default)
+/// @return true on success, false on errors
+///   
+/// @memberof SignalIOInterfaceV2
+/// @fn bool SetOutputWaveform( long int taskID, const double* samplesTable, size_t periodLength )
+/// @brief Makes clocked output task device loop one waveform period, with no further writes (Write() commands are then ignored)
+/// @param[in] taskID output task identifier
+/// @param[in] samplesTable period samples of each task channel ([channel][sample])
+/// @param[in] periodLength number of samples per period (0 to go back to Write() commands)
+/// @return true on success, false on errors or for unclocked tasks (waveforms with the same period length are swapped on a period boundary)
+///   
+/// @memberof SignalIOInterfaceV2
+/// @fn bool OpenOutputMailbox( long int taskID )
+/// @brief Exposes shared memory command mailbox of given output task (named after it), kept until task unloading
+/// @param[in] taskID output task identifier
+/// @return true if mailbox is available, false on errors
+/// @note Other processes claim channels with priorities and write to them with signal_mailbox.h functions. Owned channels 
+/// values replace the local Write() ones, except while outputs are disabled or tripped, and while regenerating waveforms
+///   
+/// @memberof SignalIOInterfaceV2
+/// @fn long int CreateOutputGroup( const long int* taskIDsList, size_t tasksNumber )
+/// @brief Links clocked output tasks (with the same sampling rate), that then take sample clock and start trigger from the first one, and are resumed and paused together
+/// @param[in] taskIDsList identifiers of member output tasks (not running, and in no other group). Paused ones are waited for to stop generating
+/// @param[in] tasksNumber number of member tasks (at least 2)
+/// @return output group identifier (-1 on errors, e.g. if the devices could not share timing signals)
+///   
+/// @memberof SignalIOInterfaceV2
+/// @fn bool CommitOutputGroup( long int groupID, const double* valuesList )
+/// @brief Sets all channels of all group member tasks at once, applied by all of them on the same sample clock tick
+/// @param[in] groupID output group identifier
+/// @param[in] valuesList values for all channels of each member task, in group order
+/// @return true on success, false on errors or while some member is not running
+/// @note Write() calls to member tasks fail until the committed frame is due, so that they do not change it
+///   
+/// @memberof SignalIOInterfaceV2
+/// @fn void ReleaseOutputGroup( long int groupID )
+/// @brief Unlinks output group tasks, restoring their previous timing (only while none of them is running, waiting for paused ones to stop)
+/// @param[in] groupID output group identifier
+///   
 /// @memberof SIGNAL_IO_INTERFACE
-/// @fn bool Write( int taskID, unsigned int channel, double value )
+/// @fn bool Write( long int taskID, unsigned int channel, double value )
 /// @brief Writes value to specified channel of given task
 /// @param[in] taskID output task identifier
 /// @param[in] channel output task channel index
 /// @param[in] value value to be written
 /// @return true on successful writing, false otherwise
 ///
+/// @memberof SIGNAL_IO_INTERFACE_V2
+/// @fn unsigned int GetInterfaceVersion( void )
+/// @brief Gets implemented interface version, for compatibility checks
+/// @return SIGNAL_IO_INTERFACE_VERSION value the plugin was built with
+///
+/// @memberof SIGNAL_IO_INTERFACE_V2
+/// @fn unsigned int GetCapabilities( void )
+/// @brief Gets optional features supported by the plugin
+/// @return combination of SIGNAL_IO_CAP_* flags
+///
+/// @memberof SIGNAL_IO_INTERFACE_V2
+/// @fn const SignalIOInterfaceV2* GetInterfaceV2( void )
+/// @brief Gets handle based (version 2) functions table
+/// @return pointer to statically allocated functions table
+///
 /// @memberof SIGNAL_IO_INTERFACE
 
 
@@ -0,0 +1,848 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2019 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of Signal-IO-NIDAQmx.                                   //
+//                                                                            //
+//  Signal-IO-NIDAQmx is free software: you can redistribute it and/or modify //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  Signal-IO-NIDAQmx is distributed in the hope that it will be useful,      //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with Signal-IO-NIDAQmx. If not, see <http://www.gnu.org/licenses/>. //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+/// @file signal_kernels.h
+/// @brief Vectorized signal processing kernels
+///
+/// Every kernel has scalar, SSE2, AVX2 and AVX-512 variants, bound once to the best one supported by the running CPU.
+/// Variants perform the same floating point operations in the same order, so that their results are identical
+
+#ifndef SIGNAL_KERNELS_H
+#define SIGNAL_KERNELS_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+  #define SIGNAL_KERNELS_X86
+  #include <immintrin.h>
+  #define KERNEL_TARGET( isa ) __attribute__((target( isa )))
+#elif defined( _MSC_VER ) && ( defined( _M_X64 ) || defined( _M_IX86 ) )
+  #define SIGNAL_KERNELS_X86
+  #include <immintrin.h>
+  #include <intrin.h>
+  #define KERNEL_TARGET( isa )
+#endif
+
+// Fused multiply-adds would round differently from the variants without them
+#if defined( __clang__ )
+  #pragma STDC FP_CONTRACT OFF
+#elif defined( __GNUC__ )
+  #pragma GCC push_options
+  #pragma GCC optimize( "fp-contract=off" )
+#elif defined( _MSC_VER )
+  #pragma fp_contract( off )
+#endif
+
+#define KERNEL_ACCUMULATORS_NUMBER 8    ///< Partial sums kept by reductions, whatever the vector width
+#define KERNEL_BLOCK_LENGTH 10          ///< Default samples block length, with fully unrolled specialized kernels
+#define KERNEL_FILTER_MAX_WINDOW 15     ///< Longest median/Hampel filter window
+#define KERNEL_HAMPEL_MAD_SCALE 1.4826  ///< Median absolute deviation to standard deviation (of normal distributions) factor
+#define KERNEL_KNOTS_NUMBER 4           ///< Knot frames combined by interpolation kernels
+
+/// Per sample terms of the windowed time-domain (EMG) features, summed over windows
+enum { KERNEL_TERM_ABS, KERNEL_TERM_SQUARE, KERNEL_TERM_LENGTH, KERNEL_TERM_ZERO_CROSS, KERNEL_TERM_SLOPE_CHANGE, KERNEL_TERMS_NUMBER };
+
+#if defined( __GNUC__ )
+  #define KERNEL_UNROLL _Pragma( "GCC unroll 16" )
+  #define KERNEL_INLINE inline __attribute__((always_inline))
+#elif defined( _MSC_VER )
+  #define KERNEL_UNROLL
+  #define KERNEL_INLINE __forceinline
+#else
+  #define KERNEL_UNROLL
+  #define KERNEL_INLINE inline
+#endif
+
+/// Kernel variants, from slowest to fastest
+enum { KERNELS_SCALAR, KERNELS_SSE2, KERNELS_AVX2, KERNELS_AVX512, KERNELS_VARIANTS_NUMBER };
+
+typedef struct _SignalKernels
+{
+  int variant;
+  double (*DotProduct)( const double*, const double*, size_t );
+  void (*Deinterleave)( double*, const double*, size_t, size_t );
+  void (*FilterFrames)( double*, const double*, const double*, size_t, size_t, size_t );
+  void (*AccumulateTerms)( double*, double*, double*, const double*, size_t, size_t, double );
+  void (*UpdateMeans)( double*, double*, const double*, size_t, double );
+  void (*CalibrateFrames)( double*, double*, const double*, size_t, size_t );
+  void (*InterpolateFrames)( double*, const double* const*, const double*, size_t, size_t );
+}
+SignalKernels;
+
+static SignalKernels Kernels;
+
+/// Copies scan ordered frames (framesWidth values each) into rows (rowsBase + rowsList[ i ] * rowsStride, for value i of each frame)
+typedef void (*TransposeFramesFunction)( size_t, double*, const unsigned int*, size_t, const double*, size_t );
+/// Subtracts offsets from scan ordered frames, summing their raw values (see CALIBRATE_FRAMES_LANES)
+typedef void (*CalibrateFramesFunction)( double*, double*, const double*, size_t, size_t );
+
+
+// Fixed order reduction shared by all variants: 8 interleaved partial sums, pairwise combined, then the remaining tail
+static inline double ReducePartialSums( const double* partialSumsList, const double* aList, const double* bList, size_t offset, size_t length )
+{
+  double sum = ( ( partialSumsList[ 0 ] + partialSumsList[ 4 ] ) + ( partialSumsList[ 1 ] + partialSumsList[ 5 ] ) )
+               + ( ( partialSumsList[ 2 ] + partialSumsList[ 6 ] ) + ( partialSumsList[ 3 ] + partialSumsList[ 7 ] ) );
+  for( size_t index = offset; index < length; index++ )
+    sum += aList[ index ] * bList[ index ];
+  return sum;
+}
+
+static double DotProduct_Scalar( const double* aList, const double* bList, size_t length )
+{
+  double partialSumsList[ KERNEL_ACCUMULATORS_NUMBER ] = { 0.0 };
+  size_t index = 0;
+  for( ; index + KERNEL_ACCUMULATORS_NUMBER <= length; index += KERNEL_ACCUMULATORS_NUMBER )
+  {
+    for( size_t lane = 0; lane < KERNEL_ACCUMULATORS_NUMBER; lane++ )
+      partialSumsList[ lane ] += aList[ index + lane ] * bList[ index + lane ];
+  }
+  return ReducePartialSums( partialSumsList, aList, bList, index, length );
+}
+
+// Copies every framesStride-th value of scan ordered frames into contiguous row
+static void Deinterleave_Scalar( double* rowList, const double* framesList, size_t framesStride, size_t length )
+{
+  for( size_t index = 0; index < length; index++ )
+    rowList[ index ] = framesList[ index * framesStride ];
+}
+
+// Median/Hampel filter of scan ordered frames, vectorized across frame values (lanes), with one sorting network per window.
+// For each output frame, windowFramesList holds the windowLength input frames ending at the corresponding one.
+// Lane outputs are replaced by their window median when deviating from it more than threshold * MAD (median absolute deviation):
+// lanes with null thresholds are median filtered, and lanes with infinite ones are passed through. 
+// Vector groups with no Hampel lanes skip the deviations network, and the ones with no filtered lanes are just copied.
+// Odd window lengths are turned into constants (FILTER_FRAMES_WINDOWS), so that networks get fully unrolled over registers
+// (other lengths are filtered lane by lane)
+#define SORTING_NETWORK( VECTOR, VALUES, COUNT, MIN, MAX ) \
+  KERNEL_UNROLL \
+  for( size_t round = 0; round < COUNT; round++ ) \
+  { \
+    KERNEL_UNROLL \
+    for( size_t index = round % 2; index + 1 < COUNT; index += 2 ) \
+    { \
+      VECTOR lowerValue = MIN( VALUES[ index ], VALUES[ index + 1 ] ); \
+      VALUES[ index + 1 ] = MAX( VALUES[ index ], VALUES[ index + 1 ] ); \
+      VALUES[ index ] = lowerValue; \
+    } \
+  }
+
+#define FILTER_FRAMES_LANES( VECTOR, WIDTH, LOAD, STORE, MIN, MAX, SUB, MUL, ABS, SELECT_GREATER ) \
+  for( ; lane + WIDTH <= framesWidth; lane += WIDTH ) \
+  { \
+    if( !HasFilteredLanes( thresholdsList + lane, WIDTH ) ) \
+    { \
+      CopyPassedLanes( framesList, windowFramesList, framesWidth, windowLength, length, lane, WIDTH ); \
+      continue; \
+    } \
+    bool hasHampel = HasHampelThresholds( thresholdsList + lane, WIDTH ); \
+    VECTOR valuesList[ KERNEL_FILTER_MAX_WINDOW ]; \
+    VECTOR thresholds = LOAD( thresholdsList + lane ); \
+    for( size_t frame = 0; frame < length; frame++ ) \
+    { \
+      const double* windowList = windowFramesList + frame * framesWidth + lane; \
+      for( size_t index = 0; index < windowLength; index++ ) \
+        valuesList[ index ] = LOAD( windowList + index * framesWidth ); \
+      VECTOR currentValue = valuesList[ windowLength - 1 ]; \
+      SORTING_NETWORK( VECTOR, valuesList, windowLength, MIN, MAX ) \
+      VECTOR median = valuesList[ windowLength / 2 ]; \
+      VECTOR limits = thresholds; \
+      if( hasHampel ) \
+      { \
+        for( size_t index = 0; index < windowLength; index++ ) \
+          valuesList[ index ] = ABS( SUB( valuesList[ index ], median ) ); \
+        SORTING_NETWORK( VECTOR, valuesList, windowLength, MIN, MAX ) \
+        limits = MUL( thresholds, valuesList[ windowLength / 2 ] ); \
+      } \
+      STORE( framesList + frame * framesWidth + lane, SELECT_GREATER( ABS( SUB( currentValue, median ) ), limits, median, currentValue ) ); \
+    } \
+  }
+
+#define FILTER_FRAMES_WINDOWS( LANES_FUNCTION ) \
+  switch( windowLength ) \
+  { \
+    case 3: lane = LANES_FUNCTION( framesList, windowFramesList, thresholdsList, framesWidth, 3, length ); break; \
+    case 5: lane = LANES_FUNCTION( framesList, windowFramesList, thresholdsList, framesWidth, 5, length ); break; \
+    case 7: lane = LANES_FUNCTION( framesList, windowFramesList, thresholdsList, framesWidth, 7, length ); break; \
+    case 9: lane = LANES_FUNCTION( framesList, windowFramesList, thresholdsList, framesWidth, 9, length ); break; \
+    case 11: lane = LANES_FUNCTION( framesList, windowFramesList, thresholdsList, framesWidth, 11, length ); break; \
+    case 13: lane = LANES_FUNCTION( framesList, windowFramesList, thresholdsList, framesWidth, 13, length ); break; \
+    case 15: lane = LANES_FUNCTION( framesList, windowFramesList, thresholdsList, framesWidth, 15, length ); break; \
+  }
+
+static inline bool HasHampelThresholds( const double* thresholdsList, size_t lanesNumber )
+{
+  for( size_t lane = 0; lane < lanesNumber; lane++ )
+    if( thresholdsList[ lane ] > 0.0 && isfinite( thresholdsList[ lane ] ) ) return true;
+  return false;
+}
+
+static inline bool HasFilteredLanes( const double* thresholdsList, size_t lanesNumber )
+{
+  for( size_t lane = 0; lane < lanesNumber; lane++ )
+    if( !isinf( thresholdsList[ lane ] ) ) return true;
+  return false;
+}
+
+// Lanes with infinite thresholds only take the newest frame of each window
+static inline void CopyPassedLanes( double* framesList, const double* windowFramesList, size_t framesWidth, size_t windowLength, 
+                                    size_t length, size_t lane, size_t lanesNumber )
+{
+  for( size_t frame = 0; frame < length; frame++ )
+    memcpy( framesList + frame * framesWidth + lane, windowFramesList + ( frame + windowLength - 1 ) * framesWidth + lane, lanesNumber * sizeof(double) );
+}
+
+#define SCALAR_MIN( a, b ) ( ( (a) < (b) ) ? (a) : (b) )
+#define SCALAR_MAX( a, b ) ( ( (a) > (b) ) ? (a) : (b) )
+
+// Single lanes keep their window sorted from frame to frame (replacing the leaving value by the entering one), 
+// and take the MAD from it by walking outwards from the median, instead of running whole sorting networks
+static void FilterFramesLanes_Scalar( double* framesList, const double* windowFramesList, const double* thresholdsList, 
+                                      size_t framesWidth, size_t windowLength, size_t length, size_t lane )
+{
+  double sortedList[ KERNEL_FILTER_MAX_WINDOW ];
+  size_t middleIndex = windowLength / 2;
+  for( ; lane < framesWidth; lane++ )
+  {
+    double threshold = thresholdsList[ lane ];
+    if( isinf( threshold ) )
+    {
+      CopyPassedLanes( framesList, windowFramesList, framesWidth, windowLength, length, lane, 1 );
+      continue;
+    }
+    
+    const double* windowList = windowFramesList + lane;
+    if( windowLength == 3 )
+    {
+      // Shortest windows take the median and the nearest other value (its deviation is the MAD) straight from min/max
+      for( size_t frame = 0; frame < length; frame++, windowList += framesWidth )
+      {
+        double olderValue = windowList[ 0 ], oldValue = windowList[ framesWidth ], currentValue = windowList[ 2 * framesWidth ];
+        double lowerValue = SCALAR_MIN( olderValue, oldValue ), upperValue = SCALAR_MAX( olderValue, oldValue );
+        double median = SCALAR_MAX( lowerValue, SCALAR_MIN( upperValue, currentValue ) );
+        double limit = threshold;
+        if( threshold > 0.0 ) 
+          limit = threshold * SCALAR_MIN( median - SCALAR_MIN( lowerValue, currentValue ), SCALAR_MAX( upperValue, currentValue ) - median );
+        framesList[ frame * framesWidth + lane ] = ( fabs( currentValue - median ) > limit ) ? median : currentValue;
+      }
+      continue;
+    }
+    
+    size_t sortedNumber = 0;
+    for( size_t frame = 0; frame < length; frame++, windowList += framesWidth )
+    {
+      // Window is sorted again from scratch when the leaving value is not found (unordered NaN values)
+      size_t index = 0;
+      if( sortedNumber > 0 )
+      {
+        double leavingValue = windowList[ -(ptrdiff_t) framesWidth ];
+        while( index < sortedNumber && sortedList[ index ] != leavingValue ) index++;
+        if( index == sortedNumber ) sortedNumber = 0;
+        else
+        {
+          for( sortedNumber--; index < sortedNumber; index++ )
+            sortedList[ index ] = sortedList[ index + 1 ];
+        }
+      }
+      for( size_t windowIndex = ( sortedNumber > 0 ) ? windowLength - 1 : 0; windowIndex < windowLength; windowIndex++ )
+      {
+        double enteringValue = windowList[ windowIndex * framesWidth ];
+        for( index = sortedNumber++; index > 0 && sortedList[ index - 1 ] > enteringValue; index-- )
+          sortedList[ index ] = sortedList[ index - 1 ];
+        sortedList[ index ] = enteringValue;
+      }
+      
+      double median = sortedList[ middleIndex ];
+      double limit = threshold;
+      if( threshold > 0.0 )
+      {
+        // Deviations grow walking away from the median on either side, so the middle one is reached in windowLength / 2 steps
+        double deviation = 0.0;
+        size_t lowerIndex = middleIndex, upperIndex = middleIndex + 1;
+        for( size_t step = 0; step < middleIndex; step++ )
+        {
+          double lowerDeviation = ( lowerIndex > 0 ) ? median - sortedList[ lowerIndex - 1 ] : INFINITY;
+          double upperDeviation = ( upperIndex < windowLength ) ? sortedList[ upperIndex ] - median : INFINITY;
+          if( lowerDeviation <= upperDeviation ) { deviation = lowerDeviation; lowerIndex--; }
+          else { deviation = upperDeviation; upperIndex++; }
+        }
+        limit = threshold * deviation;
+      }
+      double currentValue = windowList[ ( windowLength - 1 ) * framesWidth ];
+      framesList[ frame * framesWidth + lane ] = ( fabs( currentValue - median ) > limit ) ? median : currentValue;
+    }
+  }
+}
+
+static void FilterFrames_Scalar( double* framesList, const double* windowFramesList, const double* thresholdsList, 
+                                 size_t framesWidth, size_t windowLength, size_t length )
+{
+  FilterFramesLanes_Scalar( framesList, windowFramesList, thresholdsList, framesWidth, windowLength, length, 0 );
+}
+
+// Running window sums of feature terms for scan ordered frames, vectorized across frame values (lanes).
+// Terms of each frame (KERNEL_TERMS_NUMBER rows of framesWidth values) replace, in the sums and in termsList, the ones of
+// the frame leaving the window, stored at the same position. lastFramesList holds the 2 frames preceding framesList.
+// Zero crossings and slope sign changes count only with differences (or their products) of at least threshold
+#define ACCUMULATE_TERMS_LANES( VECTOR, WIDTH, LOAD, STORE, SET1, ADD, SUB, MUL, ABS, MASK_LE, MASK_GE, MASK_AND, MASK_ONES ) \
+  for( ; lane + WIDTH <= framesWidth; lane += WIDTH ) \
+  { \
+    const VECTOR thresholds = SET1( threshold ); \
+    const VECTOR zeros = SET1( 0.0 ); \
+    VECTOR sums[ KERNEL_TERMS_NUMBER ], terms[ KERNEL_TERMS_NUMBER ]; \
+    for( size_t term = 0; term < KERNEL_TERMS_NUMBER; term++ ) \
+      sums[ term ] = LOAD( sumsList + term * framesWidth + lane ); \
+    VECTOR lastValue = LOAD( lastFramesList + framesWidth + lane ); \
+    VECTOR secondLastValue = LOAD( lastFramesList + lane ); \
+    for( size_t frame = 0; frame < length; frame++ ) \
+    { \
+      VECTOR value = LOAD( framesList + frame * framesWidth + lane ); \
+      VECTOR difference = SUB( value, lastValue ); \
+      terms[ KERNEL_TERM_ABS ] = ABS( value ); \
+      terms[ KERNEL_TERM_SQUARE ] = MUL( value, value ); \
+      terms[ KERNEL_TERM_LENGTH ] = ABS( difference ); \
+      terms[ KERNEL_TERM_ZERO_CROSS ] = MASK_ONES( MASK_AND( MASK_LE( MUL( value, lastValue ), zeros ), MASK_GE( ABS( difference ), thresholds ) ) ); \
+      terms[ KERNEL_TERM_SLOPE_CHANGE ] = MASK_ONES( MASK_GE( MUL( SUB( lastValue, secondLastValue ), SUB( lastValue, value ) ), thresholds ) ); \
+      double* frameTermsList = termsList + frame * KERNEL_TERMS_NUMBER * framesWidth + lane; \
+      for( size_t term = 0; term < KERNEL_TERMS_NUMBER; term++ ) \
+      { \
+        sums[ term ] = ADD( sums[ term ], SUB( terms[ term ], LOAD( frameTermsList + term * framesWidth ) ) ); \
+        STORE( frameTermsList + term * framesWidth, terms[ term ] ); \
+      } \
+      secondLastValue = lastValue; \
+      lastValue = value; \
+    } \
+    for( size_t term = 0; term < KERNEL_TERMS_NUMBER; term++ ) \
+      STORE( sumsList + term * framesWidth + lane, sums[ term ] ); \
+    STORE( lastFramesList + lane, secondLastValue ); \
+    STORE( lastFramesList + framesWidth + lane, lastValue ); \
+  }
+
+#define SCALAR_LOAD( pointer ) (*(pointer))
+#define SCALAR_STORE( pointer, value ) (*(pointer) = (value))
+#define SCALAR_SET1( value ) (value)
+#define SCALAR_ADD( a, b ) ( (a) + (b) )
+#define SCALAR_SUB( a, b ) ( (a) - (b) )
+#define SCALAR_MUL( a, b ) ( (a) * (b) )
+#define SCALAR_MASK_LE( a, b ) ( (a) <= (b) )
+#define SCALAR_MASK_GE( a, b ) ( (a) >= (b) )
+#define SCALAR_MASK_AND( a, b ) ( (a) && (b) )
+#define SCALAR_MASK_ONES( mask ) ( (mask) ? 1.0 : 0.0 )
+
+static void AccumulateTermsLanes_Scalar( double* sumsList, double* termsList, double* lastFramesList, const double* framesList, 
+                                         size_t framesWidth, size_t length, double threshold, size_t lane )
+{
+  ACCUMULATE_TERMS_LANES( double, 1, SCALAR_LOAD, SCALAR_STORE, SCALAR_SET1, SCALAR_ADD, SCALAR_SUB, SCALAR_MUL, fabs, 
+                          SCALAR_MASK_LE, SCALAR_MASK_GE, SCALAR_MASK_AND, SCALAR_MASK_ONES )
+}
+
+static void AccumulateTerms_Scalar( double* sumsList, double* termsList, double* lastFramesList, const double* framesList, 
+                                    size_t framesWidth, size_t length, double threshold )
+{
+  AccumulateTermsLanes_Scalar( sumsList, termsList, lastFramesList, framesList, framesWidth, length, threshold, 0 );
+}
+
+// Welford running means and squared deviation sums update, with the values of the count-th sequence (sweep)
+static void UpdateMeansTail_Scalar( double* meansList, double* deviationsList, const double* valuesList, size_t length, double count, size_t index )
+{
+  for( ; index < length; index++ )
+  {
+    double delta = valuesList[ index ] - meansList[ index ];
+    meansList[ index ] += delta / count;
+    deviationsList[ index ] += delta * ( valuesList[ index ] - meansList[ index ] );
+  }
+}
+
+static void UpdateMeans_Scalar( double* meansList, double* deviationsList, const double* valuesList, size_t length, double count )
+{
+  UpdateMeansTail_Scalar( meansList, deviationsList, valuesList, length, count, 0 );
+}
+
+#define UPDATE_MEANS_VECTORS( VECTOR, WIDTH, LOAD, STORE, SET1, ADD, SUB, MUL, DIV ) \
+  const VECTOR counts = SET1( count ); \
+  size_t index = 0; \
+  for( ; index + WIDTH <= length; index += WIDTH ) \
+  { \
+    VECTOR values = LOAD( valuesList + index ); \
+    VECTOR means = LOAD( meansList + index ); \
+    VECTOR delta = SUB( values, means ); \
+    means = ADD( means, DIV( delta, counts ) ); \
+    STORE( meansList + index, means ); \
+    STORE( deviationsList + index, ADD( LOAD( deviationsList + index ), MUL( delta, SUB( values, means ) ) ) ); \
+  } \
+  UpdateMeansTail_Scalar( meansList, deviationsList, valuesList, length, count, index );
+
+// Offset subtraction for scan ordered frames, vectorized across frame values (lanes).
+// Raw values are also summed (per lane) into sumsList, for offsets estimation
+#define CALIBRATE_FRAMES_LANES( VECTOR, WIDTH, LOAD, STORE, ADD, SUB ) \
+  for( ; lane + WIDTH <= framesWidth; lane += WIDTH ) \
+  { \
+    const VECTOR offsets = LOAD( offsetsList + lane ); \
+    VECTOR sums = LOAD( sumsList + lane ); \
+    for( size_t frame = 0; frame < length; frame++ ) \
+    { \
+      VECTOR value = LOAD( framesList + frame * framesWidth + lane ); \
+      sums = ADD( sums, value ); \
+      STORE( framesList + frame * framesWidth + lane, SUB( value, offsets ) ); \
+    } \
+    STORE( sumsList + lane, sums ); \
+  }
+
+static void CalibrateFramesLanes_Scalar( double* framesList, double* sumsList, const double* offsetsList, size_t framesWidth, size_t length, size_t lane )
+{
+  CALIBRATE_FRAMES_LANES( double, 1, SCALAR_LOAD, SCALAR_STORE, SCALAR_ADD, SCALAR_SUB )
+}
+
+static void CalibrateFrames_Scalar( double* framesList, double* sumsList, const double* offsetsList, size_t framesWidth, size_t length )
+{
+  CalibrateFramesLanes_Scalar( framesList, sumsList, offsetsList, framesWidth, length, 0 );
+}
+
+// Scan ordered frames as weighted sums of 4 knot frames (KERNEL_KNOTS_NUMBER weights per frame), vectorized across frame values (lanes).
+// Hold, linear and cubic (Hermite) interpolation all reduce to this, with weights depending only on each frame time
+#define INTERPOLATE_FRAMES_LANES( VECTOR, WIDTH, LOAD, STORE, SET1, ADD, MUL ) \
+  for( ; lane + WIDTH <= framesWidth; lane += WIDTH ) \
+  { \
+    VECTOR knots[ KERNEL_KNOTS_NUMBER ]; \
+    for( size_t knot = 0; knot < KERNEL_KNOTS_NUMBER; knot++ ) \
+      knots[ knot ] = LOAD( knotFramesList[ knot ] + lane ); \
+    for( size_t frame = 0; frame < length; frame++ ) \
+    { \
+      const double* frameWeightsList = weightsTable + frame * KERNEL_KNOTS_NUMBER; \
+      VECTOR value = ADD( ADD( MUL( SET1( frameWeightsList[ 0 ] ), knots[ 0 ] ), MUL( SET1( frameWeightsList[ 1 ] ), knots[ 1 ] ) ), \
+                          ADD( MUL( SET1( frameWeightsList[ 2 ] ), knots[ 2 ] ), MUL( SET1( frameWeightsList[ 3 ] ), knots[ 3 ] ) ) ); \
+      STORE( framesList + frame * framesWidth + lane, value ); \
+    } \
+  }
+
+static void InterpolateFramesLanes_Scalar( double* framesList, const double* const* knotFramesList, const double* weightsTable, 
+                                           size_t framesWidth, size_t length, size_t lane )
+{
+  INTERPOLATE_FRAMES_LANES( double, 1, SCALAR_LOAD, SCALAR_STORE, SCALAR_SET1, SCALAR_ADD, SCALAR_MUL )
+}
+
+static void InterpolateFrames_Scalar( double* framesList, const double* const* knotFramesList, const double* weightsTable, 
+                                      size_t framesWidth, size_t length )
+{
+  InterpolateFramesLanes_Scalar( framesList, knotFramesList, weightsTable, framesWidth, length, 0 );
+}
+
+static void TransposeFrames_Generic( size_t framesWidth, double* rowsBase, const unsigned int* rowsList, size_t rowsStride, 
+                                     const double* framesList, size_t length )
+{
+  for( size_t column = 0; column < framesWidth; column++ )
+    Kernels.Deinterleave( rowsBase + rowsList[ column ] * rowsStride, framesList + column, framesWidth, length );
+}
+
+// Specialized block kernels, with frame width and block length known at compile time (fully unrolled), for the most common 
+// channel counts. Only fixed length blocks gain from them (see bench_specialized): other lengths take the generic kernels
+#define TRANSPOSE_FRAMES( FRAMES_WIDTH, LENGTH ) \
+  KERNEL_UNROLL \
+  for( size_t column = 0; column < FRAMES_WIDTH; column++ ) \
+  { \
+    double* rowList = rowsBase + rowsList[ column ] * rowsStride; \
+    KERNEL_UNROLL \
+    for( size_t index = 0; index < LENGTH; index++ ) \
+      rowList[ index ] = framesList[ index * FRAMES_WIDTH + column ]; \
+  }
+
+// Same sums order as the vector kernels (frame by frame for each lane), so that results are identical
+#define CALIBRATE_FRAMES( FRAMES_WIDTH, LENGTH ) \
+  KERNEL_UNROLL \
+  for( size_t lane = 0; lane < FRAMES_WIDTH; lane++ ) \
+  { \
+    double sum = sumsList[ lane ]; \
+    KERNEL_UNROLL \
+    for( size_t frame = 0; frame < LENGTH; frame++ ) \
+    { \
+      sum += framesList[ frame * FRAMES_WIDTH + lane ]; \
+      framesList[ frame * FRAMES_WIDTH + lane ] -= offsetsList[ lane ]; \
+    } \
+    sumsList[ lane ] = sum; \
+  }
+
+#define DEFINE_BLOCK_KERNELS( FRAMES_WIDTH ) \
+  static void TransposeBlock_##FRAMES_WIDTH( size_t framesWidth, double* rowsBase, const unsigned int* rowsList, size_t rowsStride, \
+                                             const double* framesList, size_t length ) \
+  { \
+    (void) framesWidth; (void) length; \
+    TRANSPOSE_FRAMES( FRAMES_WIDTH, KERNEL_BLOCK_LENGTH ) \
+  } \
+  static void CalibrateBlock_##FRAMES_WIDTH( double* framesList, double* sumsList, const double* offsetsList, size_t framesWidth, size_t length ) \
+  { \
+    (void) framesWidth; (void) length; \
+    CALIBRATE_FRAMES( FRAMES_WIDTH, KERNEL_BLOCK_LENGTH ) \
+  }
+
+DEFINE_BLOCK_KERNELS( 1 )
+DEFINE_BLOCK_KERNELS( 2 )
+DEFINE_BLOCK_KERNELS( 4 )
+DEFINE_BLOCK_KERNELS( 6 )
+DEFINE_BLOCK_KERNELS( 8 )
+DEFINE_BLOCK_KERNELS( 16 )
+
+#define CASE_BLOCK_KERNEL( NAME, FRAMES_WIDTH ) case FRAMES_WIDTH: return NAME##_##FRAMES_WIDTH;
+
+/// Gets transpose kernel for KERNEL_BLOCK_LENGTH long blocks of given frame width (generic one if not specialized)
+static TransposeFramesFunction Kernels_GetTransposeBlock( size_t framesWidth )
+{
+  switch( framesWidth )
+  {
+    CASE_BLOCK_KERNEL( TransposeBlock, 1 )
+    CASE_BLOCK_KERNEL( TransposeBlock, 2 )
+    CASE_BLOCK_KERNEL( TransposeBlock, 4 )
+    CASE_BLOCK_KERNEL( TransposeBlock, 6 )
+    CASE_BLOCK_KERNEL( TransposeBlock, 8 )
+    CASE_BLOCK_KERNEL( TransposeBlock, 16 )
+    default: return TransposeFrames_Generic;
+  }
+}
+
+/// Gets calibration kernel for KERNEL_BLOCK_LENGTH long blocks of given frame width. Bound vector kernels are kept for 
+/// the widths they fill without scalar lanes, as they are faster there than the specialized (scalar) ones
+static CalibrateFramesFunction Kernels_GetCalibrateBlock( size_t framesWidth )
+{
+  const size_t VARIANT_LANES_LIST[ KERNELS_VARIANTS_NUMBER ] = { 1, 2, 4, 8 };
+  size_t lanesNumber = VARIANT_LANES_LIST[ Kernels.variant ];
+  if( lanesNumber > 1 && framesWidth % lanesNumber == 0 ) return Kernels.CalibrateFrames;
+  
+  switch( framesWidth )
+  {
+    CASE_BLOCK_KERNEL( CalibrateBlock, 1 )
+    CASE_BLOCK_KERNEL( CalibrateBlock, 2 )
+    CASE_BLOCK_KERNEL( CalibrateBlock, 4 )
+    CASE_BLOCK_KERNEL( CalibrateBlock, 6 )
+    CASE_BLOCK_KERNEL( CalibrateBlock, 8 )
+    CASE_BLOCK_KERNEL( CalibrateBlock, 16 )
+    default: return Kernels.CalibrateFrames;
+  }
+}
+
+#ifdef SIGNAL_KERNELS_X86
+
+KERNEL_TARGET( "sse2" )
+static void Deinterleave_SSE2( double* rowList, const double* framesList, size_t framesStride, size_t length )
+{
+  size_t index = 0;
+  for( ; index + 2 <= length; index += 2 )
+  {
+    __m128d values = _mm_loadh_pd( _mm_load_sd( framesList + index * framesStride ), framesList + ( index + 1 ) * framesStride );
+    _mm_storeu_pd( rowList + index, values );
+  }
+  for( ; index < length; index++ )
+    rowList[ index ] = framesList[ index * framesStride ];
+}
+
+#define SSE2_ABS( value ) _mm_andnot_pd( _mm_set1_pd( -0.0 ), value )
+#define SSE2_SELECT_GREATER( a, b, x, y ) _mm_or_pd( _mm_and_pd( _mm_cmpgt_pd( a, b ), x ), _mm_andnot_pd( _mm_cmpgt_pd( a, b ), y ) )
+
+KERNEL_TARGET( "sse2" )
+static KERNEL_INLINE size_t FilterFramesLanes_SSE2( double* framesList, const double* windowFramesList, const double* thresholdsList, 
+                                                    size_t framesWidth, size_t windowLength, size_t length )
+{
+  size_t lane = 0;
+  FILTER_FRAMES_LANES( __m128d, 2, _mm_loadu_pd, _mm_storeu_pd, _mm_min_pd, _mm_max_pd, _mm_sub_pd, _mm_mul_pd, SSE2_ABS, SSE2_SELECT_GREATER )
+  return lane;
+}
+
+KERNEL_TARGET( "sse2" )
+static void FilterFrames_SSE2( double* framesList, const double* windowFramesList, const double* thresholdsList, 
+                               size_t framesWidth, size_t windowLength, size_t length )
+{
+  size_t lane = 0;
+  FILTER_FRAMES_WINDOWS( FilterFramesLanes_SSE2 )
+  FilterFramesLanes_Scalar( framesList, windowFramesList, thresholdsList, framesWidth, windowLength, length, lane );
+}
+
+#define SSE2_MASK_ONES( mask ) _mm_and_pd( mask, _mm_set1_pd( 1.0 ) )
+
+KERNEL_TARGET( "sse2" )
+static void AccumulateTerms_SSE2( double* sumsList, double* termsList, double* lastFramesList, const double* framesList, 
+                                  size_t framesWidth, size_t length, double threshold )
+{
+  size_t lane = 0;
+  ACCUMULATE_TERMS_LANES( __m128d, 2, _mm_loadu_pd, _mm_storeu_pd, _mm_set1_pd, _mm_add_pd, _mm_sub_pd, _mm_mul_pd, SSE2_ABS, 
+                          _mm_cmple_pd, _mm_cmpge_pd, _mm_and_pd, SSE2_MASK_ONES )
+  AccumulateTermsLanes_Scalar( sumsList, termsList, lastFramesList, framesList, framesWidth, length, threshold, lane );
+}
+
+KERNEL_TARGET( "sse2" )
+static void UpdateMeans_SSE2( double* meansList, double* deviationsList, const double* valuesList, size_t length, double count )
+{
+  UPDATE_MEANS_VECTORS( __m128d, 2, _mm_loadu_pd, _mm_storeu_pd, _mm_set1_pd, _mm_add_pd, _mm_sub_pd, _mm_mul_pd, _mm_div_pd )
+}
+
+KERNEL_TARGET( "sse2" )
+static void CalibrateFrames_SSE2( double* framesList, double* sumsList, const double* offsetsList, size_t framesWidth, size_t length )
+{
+  size_t lane = 0;
+  CALIBRATE_FRAMES_LANES( __m128d, 2, _mm_loadu_pd, _mm_storeu_pd, _mm_add_pd, _mm_sub_pd )
+  CalibrateFramesLanes_Scalar( framesList, sumsList, offsetsList, framesWidth, length, lane );
+}
+
+KERNEL_TARGET( "sse2" )
+static void InterpolateFrames_SSE2( double* framesList, const double* const* knotFramesList, const double* weightsTable, 
+                                    size_t framesWidth, size_t length )
+{
+  size_t lane = 0;
+  INTERPOLATE_FRAMES_LANES( __m128d, 2, _mm_loadu_pd, _mm_storeu_pd, _mm_set1_pd, _mm_add_pd, _mm_mul_pd )
+  InterpolateFramesLanes_Scalar( framesList, knotFramesList, weightsTable, framesWidth, length, lane );
+}
+
+KERNEL_TARGET( "avx2" )
+static double DotProduct_AVX2( const double* aList, const double* bList, size_t length )
+{
+  __m256d partialSums[ 2 ] = { _mm256_setzero_pd(), _mm256_setzero_pd() };
+  size_t index = 0;
+  for( ; index + KERNEL_ACCUMULATORS_NUMBER <= length; index += KERNEL_ACCUMULATORS_NUMBER )
+  {
+    for( size_t vector = 0; vector < 2; vector++ )
+    {
+      // Separate multiply and add (no FMA), to round as the other variants
+      __m256d products = _mm256_mul_pd( _mm256_loadu_pd( aList + index + 4 * vector ), _mm256_loadu_pd( bList + index + 4 * vector ) );
+      partialSums[ vector ] = _mm256_add_pd( partialSums[ vector ], products );
+    }
+  }
+  double partialSumsList[ KERNEL_ACCUMULATORS_NUMBER ];
+  for( size_t vector = 0; vector < 2; vector++ )
+    _mm256_storeu_pd( partialSumsList + 4 * vector, partialSums[ vector ] );
+  return ReducePartialSums( partialSumsList, aList, bList, index, length );
+}
+
+#define AVX2_ABS( value ) _mm256_andnot_pd( _mm256_set1_pd( -0.0 ), value )
+#define AVX2_SELECT_GREATER( a, b, x, y ) _mm256_blendv_pd( y, x, _mm256_cmp_pd( a, b, _CMP_GT_OQ ) )
+
+KERNEL_TARGET( "avx2" )
+static KERNEL_INLINE size_t FilterFramesLanes_AVX2( double* framesList, const double* windowFramesList, const double* thresholdsList, 
+                                                    size_t framesWidth, size_t windowLength, size_t length )
+{
+  size_t lane = 0;
+  FILTER_FRAMES_LANES( __m256d, 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_min_pd, _mm256_max_pd, _mm256_sub_pd, _mm256_mul_pd, 
+                       AVX2_ABS, AVX2_SELECT_GREATER )
+  return lane;
+}
+
+KERNEL_TARGET( "avx2" )
+static void FilterFrames_AVX2( double* framesList, const double* windowFramesList, const double* thresholdsList, 
+                               size_t framesWidth, size_t windowLength, size_t length )
+{
+  size_t lane = 0;
+  FILTER_FRAMES_WINDOWS( FilterFramesLanes_AVX2 )
+  FilterFramesLanes_Scalar( framesList, windowFramesList, thresholdsList, framesWidth, windowLength, length, lane );
+}
+
+#define AVX2_MASK_LE( a, b ) _mm256_cmp_pd( a, b, _CMP_LE_OQ )
+#define AVX2_MASK_GE( a, b ) _mm256_cmp_pd( a, b, _CMP_GE_OQ )
+#define AVX2_MASK_ONES( mask ) _mm256_and_pd( mask, _mm256_set1_pd( 1.0 ) )
+
+KERNEL_TARGET( "avx2" )
+static void AccumulateTerms_AVX2( double* sumsList, double* termsList, double* lastFramesList, const double* framesList, 
+                                  size_t framesWidth, size_t length, double threshold )
+{
+  size_t lane = 0;
+  ACCUMULATE_TERMS_LANES( __m256d, 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_set1_pd, _mm256_add_pd, _mm256_sub_pd, _mm256_mul_pd, 
+                          AVX2_ABS, AVX2_MASK_LE, AVX2_MASK_GE, _mm256_and_pd, AVX2_MASK_ONES )
+  AccumulateTermsLanes_Scalar( sumsList, termsList, lastFramesList, framesList, framesWidth, length, threshold, lane );
+}
+
+KERNEL_TARGET( "avx2" )
+static void UpdateMeans_AVX2( double* meansList, double* deviationsList, const double* valuesList, size_t length, double count )
+{
+  UPDATE_MEANS_VECTORS( __m256d, 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_set1_pd, _mm256_add_pd, _mm256_sub_pd, _mm256_mul_pd, _mm256_div_pd )
+}
+
+KERNEL_TARGET( "avx2" )
+static void CalibrateFrames_AVX2( double* framesList, double* sumsList, const double* offsetsList, size_t framesWidth, size_t length )
+{
+  size_t lane = 0;
+  CALIBRATE_FRAMES_LANES( __m256d, 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_add_pd, _mm256_sub_pd )
+  CalibrateFramesLanes_Scalar( framesList, sumsList, offsetsList, framesWidth, length, lane );
+}
+
+KERNEL_TARGET( "avx2" )
+static void InterpolateFrames_AVX2( double* framesList, const double* const* knotFramesList, const double* weightsTable, 
+                                    size_t framesWidth, size_t length )
+{
+  size_t lane = 0;
+  INTERPOLATE_FRAMES_LANES( __m256d, 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_set1_pd, _mm256_add_pd, _mm256_mul_pd )
+  InterpolateFramesLanes_Scalar( framesList, knotFramesList, weightsTable, framesWidth, length, lane );
+}
+
+KERNEL_TARGET( "avx512f" )
+static double DotProduct_AVX512( const double* aList, const double* bList, size_t length )
+{
+  __m512d partialSums = _mm512_setzero_pd();
+  size_t index = 0;
+  for( ; index + KERNEL_ACCUMULATORS_NUMBER <= length; index += KERNEL_ACCUMULATORS_NUMBER )
+  {
+    __m512d products = _mm512_mul_pd( _mm512_loadu_pd( aList + index ), _mm512_loadu_pd( bList + index ) );
+    partialSums = _mm512_add_pd( partialSums, products );
+  }
+  double partialSumsList[ KERNEL_ACCUMULATORS_NUMBER ];
+  _mm512_storeu_pd( partialSumsList, partialSums );
+  return ReducePartialSums( partialSumsList, aList, bList, index, length );
+}
+
+#define AVX512_SELECT_GREATER( a, b, x, y ) _mm512_mask_blend_pd( _mm512_cmp_pd_mask( a, b, _CMP_GT_OQ ), y, x )
+
+KERNEL_TARGET( "avx512f" )
+static KERNEL_INLINE size_t FilterFramesLanes_AVX512( double* framesList, const double* windowFramesList, const double* thresholdsList, 
+                                                      size_t framesWidth, size_t windowLength, size_t length )
+{
+  size_t lane = 0;
+  FILTER_FRAMES_LANES( __m512d, 8, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_min_pd, _mm512_max_pd, _mm512_sub_pd, _mm512_mul_pd, 
+                       _mm512_abs_pd, AVX512_SELECT_GREATER )
+  return lane;
+}
+
+KERNEL_TARGET( "avx512f" )
+static void FilterFrames_AVX512( double* framesList, const double* windowFramesList, const double* thresholdsList, 
+                                 size_t framesWidth, size_t windowLength, size_t length )
+{
+  size_t lane = 0;
+  FILTER_FRAMES_WINDOWS( FilterFramesLanes_AVX512 )
+  FilterFramesLanes_Scalar( framesList, windowFramesList, thresholdsList, framesWidth, windowLength, length, lane );
+}
+
+#define AVX512_MASK_LE( a, b ) _mm512_cmp_pd_mask( a, b, _CMP_LE_OQ )
+#define AVX512_MASK_GE( a, b ) _mm512_cmp_pd_mask( a, b, _CMP_GE_OQ )
+#define AVX512_MASK_AND( a, b ) (__mmask8) ( (a) & (b) )
+#define AVX512_MASK_ONES( mask ) _mm512_maskz_mov_pd( mask, _mm512_set1_pd( 1.0 ) )
+
+KERNEL_TARGET( "avx512f" )
+static void AccumulateTerms_AVX512( double* sumsList, double* termsList, double* lastFramesList, const double* framesList, 
+                                    size_t framesWidth, size_t length, double threshold )
+{
+  size_t lane = 0;
+  ACCUMULATE_TERMS_LANES( __m512d, 8, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_set1_pd, _mm512_add_pd, _mm512_sub_pd, _mm512_mul_pd, 
+                          _mm512_abs_pd, AVX512_MASK_LE, AVX512_MASK_GE, AVX512_MASK_AND, AVX512_MASK_ONES )
+  AccumulateTermsLanes_Scalar( sumsList, termsList, lastFramesList, framesList, framesWidth, length, threshold, lane );
+}
+
+KERNEL_TARGET( "avx512f" )
+static void UpdateMeans_AVX512( double* meansList, double* deviationsList, const double* valuesList, size_t length, double count )
+{
+  UPDATE_MEANS_VECTORS( __m512d, 8, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_set1_pd, _mm512_add_pd, _mm512_sub_pd, _mm512_mul_pd, _mm512_div_pd )
+}
+
+KERNEL_TARGET( "avx512f" )
+static void CalibrateFrames_AVX512( double* framesList, double* sumsList, const double* offsetsList, size_t framesWidth, size_t length )
+{
+  size_t lane = 0;
+  CALIBRATE_FRAMES_LANES( __m512d, 8, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_add_pd, _mm512_sub_pd )
+  CalibrateFramesLanes_Scalar( framesList, sumsList, offsetsList, framesWidth, length, lane );
+}
+
+KERNEL_TARGET( "avx512f" )
+static void InterpolateFrames_AVX512( double* framesList, const double* const* knotFramesList, const double* weightsTable, 
+                                      size_t framesWidth, size_t length )
+{
+  size_t lane = 0;
+  INTERPOLATE_FRAMES_LANES( __m512d, 8, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_set1_pd, _mm512_add_pd, _mm512_mul_pd )
+  InterpolateFramesLanes_Scalar( framesList, knotFramesList, weightsTable, framesWidth, length, lane );
+}
+
+// Best variant supported by both CPU and operating system (which has to save the wider registers on context switches)
+static int GetCPUKernelsVariant( void )
+{
+#if defined( __GNUC__ )
+  __builtin_cpu_init();
+  if( __builtin_cpu_supports( "avx512f" ) ) return KERNELS_AVX512;
+  if( __builtin_cpu_supports( "avx2" ) ) return KERNELS_AVX2;
+  if( __builtin_cpu_supports( "sse2" ) ) return KERNELS_SSE2;
+#else
+  int cpuInfo[ 4 ];
+  __cpuid( cpuInfo, 1 );
+  bool hasSSE2 = ( cpuInfo[ 3 ] & ( 1 << 26 ) ) != 0;
+  bool hasXSave = ( cpuInfo[ 2 ] & ( 1 << 27 ) ) != 0;
+  unsigned long long enabledStates = hasXSave ? _xgetbv( 0 ) : 0;
+  __cpuidex( cpuInfo, 7, 0 );
+  if( ( cpuInfo[ 1 ] & ( 1 << 16 ) ) && ( enabledStates & 0xE6 ) == 0xE6 ) return KERNELS_AVX512;
+  if( ( cpuInfo[ 1 ] & ( 1 << 5 ) ) && ( enabledStates & 0x6 ) == 0x6 ) return KERNELS_AVX2;
+  if( hasSSE2 ) return KERNELS_SSE2;
+#endif
+  return KERNELS_SCALAR;
+}
+
+#else
+
+static int GetCPUKernelsVariant( void ) { return KERNELS_SCALAR; }
+
+#endif
+
+/// Binds kernel functions to given variant (or the best one available, if not supported). Kernels with no measured gain 
+/// in wider variants (see bench_kernels) keep the narrower ones: scalar dot products for SSE2 (as reductions dominate at 
+/// the resampler taps number), and SSE2 deinterleaving for AVX2 and AVX-512 (gathers are slower than paired loads)
+static void Kernels_Bind( int variant )
+{
+  int cpuVariant = GetCPUKernelsVariant();
+  if( variant < 0 || variant > cpuVariant ) variant = cpuVariant;
+
+  Kernels.variant = KERNELS_SCALAR;
+  Kernels.DotProduct = DotProduct_Scalar;
+  Kernels.Deinterleave = Deinterleave_Scalar;
+  Kernels.FilterFrames = FilterFrames_Scalar;
+  Kernels.AccumulateTerms = AccumulateTerms_Scalar;
+  Kernels.UpdateMeans = UpdateMeans_Scalar;
+  Kernels.CalibrateFrames = CalibrateFrames_Scalar;
+  Kernels.InterpolateFrames = InterpolateFrames_Scalar;
+#ifdef SIGNAL_KERNELS_X86
+  if( variant >= KERNELS_SSE2 )
+  {
+    Kernels.variant = KERNELS_SSE2;
+    Kernels.Deinterleave = Deinterleave_SSE2;
+    Kernels.FilterFrames = FilterFrames_SSE2;
+    Kernels.AccumulateTerms = AccumulateTerms_SSE2;
+    Kernels.UpdateMeans = UpdateMeans_SSE2;
+    Kernels.CalibrateFrames = CalibrateFrames_SSE2;
+    Kernels.InterpolateFrames = InterpolateFrames_SSE2;
+  }
+  if( variant >= KERNELS_AVX2 )
+  {
+    Kernels.variant = KERNELS_AVX2;
+    Kernels.DotProduct = DotProduct_AVX2;
+    Kernels.FilterFrames = FilterFrames_AVX2;
+    Kernels.AccumulateTerms = AccumulateTerms_AVX2;
+    Kernels.UpdateMeans = UpdateMeans_AVX2;
+    Kernels.CalibrateFrames = CalibrateFrames_AVX2;
+    Kernels.InterpolateFrames = InterpolateFrames_AVX2;
+  }
+  if( variant >= KERNELS_AVX512 )
+  {
+    Kernels.variant = KERNELS_AVX512;
+    Kernels.DotProduct = DotProduct_AVX512;
+    Kernels.FilterFrames = FilterFrames_AVX512;
+    Kernels.AccumulateTerms = AccumulateTerms_AVX512;
+    Kernels.UpdateMeans = UpdateMeans_AVX512;
+    Kernels.CalibrateFrames = CalibrateFrames_AVX512;
+    Kernels.InterpolateFrames = InterpolateFrames_AVX512;
+  }
+#endif
+}
+
+#if defined( __GNUC__ ) && !defined( __clang__ )
+  #pragma GCC pop_options
+#endif
+
+#endif // SIGNAL_KERNELS_H
@@ -0,0 +1,256 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2019 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of Signal-IO-NIDAQmx.                                   //
+//                                                                            //
+//  Signal-IO-NIDAQmx is free software: you can redistribute it and/or modify //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  Signal-IO-NIDAQmx is distributed in the hope that it will be useful,      //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with Signal-IO-NIDAQmx. If not, see <http://www.gnu.org/licenses/>. //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+
+/// @file signal_mailbox.h
+/// @brief Shared memory command mailbox of output tasks, for processes other than the one that loaded the plugin
+///
+/// Mailbox regions are named shared memory mappings with one slot per task channel. Client processes (including this header 
+/// only) claim channels with some priority, taking them over from lower priority owners, and then write commands to them 
+/// with plain atomic operations on the mapped region (no system calls). Each slot value is protected by its own sequence 
+/// lock, so that the task output thread, merging owned channels values on every cycle, never blocks or sees torn ones.
+
+#ifndef SIGNAL_MAILBOX_H
+#define SIGNAL_MAILBOX_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#ifdef _WIN32
+  #include <windows.h>
+#else
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+#define MAILBOX_NAME_MAX_LENGTH 256
+#define MAILBOX_MAGIC "SIGIOMBX"
+#define MAILBOX_VERSION 1
+#define MAILBOX_WRITE_ATTEMPTS 16
+
+/// Channel slot. Owner word is ( priority << 32 ) | owner identifier, 0 while not owned. Sequence is odd while value is written
+typedef struct _SignalMailboxSlot
+{
+  atomic_ullong owner;
+  atomic_ullong sequence;
+  double value;
+}
+SignalMailboxSlot;
+
+/// Shared memory region layout: header followed by one slot per task channel
+typedef struct _SignalMailboxHeader
+{
+  char magic[ 8 ];
+  uint32_t version;
+  uint32_t channelsNumber;
+}
+SignalMailboxHeader;
+
+typedef struct _SignalMailboxData
+{
+  SignalMailboxHeader* header;
+  SignalMailboxSlot* slotsList;
+  size_t regionSize;
+  bool isServer;
+  char name[ MAILBOX_NAME_MAX_LENGTH ];
+#ifdef _WIN32
+  HANDLE mapping;
+#endif
+}
+SignalMailboxData;
+
+typedef SignalMailboxData* SignalMailbox;
+
+/// Unmaps mailbox region (removed when closed by the server side)
+static void Mailbox_Close( SignalMailbox mailbox )
+{
+  if( mailbox == NULL ) return;
+  
+#ifdef _WIN32
+  UnmapViewOfFile( mailbox->header );
+  CloseHandle( mailbox->mapping );
+#else
+  munmap( mailbox->header, mailbox->regionSize );
+  if( mailbox->isServer ) shm_unlink( mailbox->name );
+#endif
+  
+  free( mailbox );
+}
+
+/// Maps the mailbox region of given task. The plugin (server) side creates and clears it for the task channels, 
+/// while client processes attach to an existing one (with channelsNumber ignored)
+static SignalMailbox Mailbox_Open( const char* taskName, uint32_t channelsNumber, bool isServer )
+{
+  SignalMailbox newMailbox = (SignalMailbox) calloc( 1, sizeof(SignalMailboxData) );
+  newMailbox->isServer = isServer;
+  size_t regionSize = sizeof(SignalMailboxHeader) + channelsNumber * sizeof(SignalMailboxSlot);
+  
+#ifdef _WIN32
+  snprintf( newMailbox->name, MAILBOX_NAME_MAX_LENGTH, "Local\\SignalIOMailbox_%s", taskName );
+  if( isServer )
+    newMailbox->mapping = CreateFileMappingA( INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, (DWORD) regionSize, newMailbox->name );
+  else
+    newMailbox->mapping = OpenFileMappingA( FILE_MAP_ALL_ACCESS, FALSE, newMailbox->name );
+  if( newMailbox->mapping != NULL )
+  {
+    newMailbox->header = (SignalMailboxHeader*) MapViewOfFile( newMailbox->mapping, FILE_MAP_ALL_ACCESS, 0, 0, isServer ? regionSize : 0 );
+    if( newMailbox->header == NULL ) CloseHandle( newMailbox->mapping );
+  }
+#else
+  snprintf( newMailbox->name, MAILBOX_NAME_MAX_LENGTH, "/SignalIOMailbox_%s", taskName );
+  for( char* nameChar = newMailbox->name + 1; *nameChar != '\0'; nameChar++ )
+    if( *nameChar == '/' ) *nameChar = '_';
+  int regionFile = shm_open( newMailbox->name, isServer ? ( O_RDWR | O_CREAT ) : O_RDWR, S_IRUSR | S_IWUSR );
+  if( regionFile != -1 )
+  {
+    struct stat regionStatus;
+    bool isMapped = false;
+    if( isServer ) isMapped = ( ftruncate( regionFile, 0 ) == 0 && ftruncate( regionFile, regionSize ) == 0 );
+    else if( fstat( regionFile, &regionStatus ) == 0 && (size_t) regionStatus.st_size >= sizeof(SignalMailboxHeader) )
+    {
+      regionSize = (size_t) regionStatus.st_size;
+      isMapped = true;
+    }
+    if( isMapped )
+    {
+      newMailbox->header = (SignalMailboxHeader*) mmap( NULL, regionSize, PROT_READ | PROT_WRITE, MAP_SHARED, regionFile, 0 );
+      if( newMailbox->header == MAP_FAILED ) newMailbox->header = NULL;
+    }
+    close( regionFile );
+  }
+#endif
+  
+  // Commands could only come from other processes through shared memory
+  if( newMailbox->header == NULL )
+  {
+    free( newMailbox );
+    return NULL;
+  }
+  
+  SignalMailboxHeader* header = newMailbox->header;
+  if( isServer )
+  {
+    memset( header, 0, regionSize );
+    memcpy( header->magic, MAILBOX_MAGIC, sizeof(header->magic) );
+    header->version = MAILBOX_VERSION;
+    header->channelsNumber = channelsNumber;
+  }
+  newMailbox->slotsList = (SignalMailboxSlot*) ( header + 1 );
+  
+#ifndef _WIN32
+  newMailbox->regionSize = regionSize;
+  bool isValid = ( regionSize >= sizeof(SignalMailboxHeader) + header->channelsNumber * sizeof(SignalMailboxSlot) );
+#else
+  bool isValid = true;
+#endif
+  if( !isValid || memcmp( header->magic, MAILBOX_MAGIC, sizeof(header->magic) ) != 0 || header->version != MAILBOX_VERSION )
+  {
+    newMailbox->isServer = false;
+    Mailbox_Close( newMailbox );
+    return NULL;
+  }
+  
+  return newMailbox;
+}
+
+/// Takes channel ownership, if it is free, already taken by the same owner or by one with lower priority
+/// @return true if channel is owned by the caller afterwards (keeping the last written value until it writes a new one)
+static bool Mailbox_Claim( SignalMailbox mailbox, uint32_t channel, uint32_t ownerID, uint32_t priority )
+{
+  if( channel >= mailbox->header->channelsNumber || priority == 0 ) return false;
+  
+  SignalMailboxSlot* slot = &(mailbox->slotsList[ channel ]);
+  uint64_t newOwner = ( (uint64_t) priority << 32 ) | ownerID;
+  uint64_t owner = atomic_load( &(slot->owner) );
+  while( owner == 0 || (uint32_t) owner == ownerID || ( owner >> 32 ) < priority )
+  {
+    if( atomic_compare_exchange_weak( &(slot->owner), &owner, newOwner ) ) return true;
+  }
+  
+  return false;
+}
+
+/// Gives channel back to the task own (local) commands, if still owned by the caller
+static void Mailbox_Release( SignalMailbox mailbox, uint32_t channel, uint32_t ownerID )
+{
+  if( channel >= mailbox->header->channelsNumber ) return;
+  
+  SignalMailboxSlot* slot = &(mailbox->slotsList[ channel ]);
+  uint64_t owner = atomic_load( &(slot->owner) );
+  while( owner != 0 && (uint32_t) owner == ownerID )
+  {
+    if( atomic_compare_exchange_weak( &(slot->owner), &owner, 0 ) ) return;
+  }
+}
+
+/// Writes command value to an owned channel. Writers (e.g. an owner being taken over) exclude each other by making the sequence odd
+/// @return true on success, false if channel is not owned by the caller (or stays busy)
+static bool Mailbox_Write( SignalMailbox mailbox, uint32_t channel, uint32_t ownerID, double value )
+{
+  if( channel >= mailbox->header->channelsNumber ) return false;
+  
+  SignalMailboxSlot* slot = &(mailbox->slotsList[ channel ]);
+  for( size_t attempt = 0; attempt < MAILBOX_WRITE_ATTEMPTS; attempt++ )
+  {
+    uint64_t owner = atomic_load( &(slot->owner) );
+    if( owner == 0 || (uint32_t) owner != ownerID ) return false;
+    uint64_t sequence = atomic_load( &(slot->sequence) );
+    if( sequence % 2 == 1 || !atomic_compare_exchange_strong( &(slot->sequence), &sequence, sequence + 1 ) ) continue;
+    atomic_thread_fence( memory_order_release );
+    slot->value = value;
+    atomic_store_explicit( &(slot->sequence), sequence + 2, memory_order_release );
+    return true;
+  }
+  
+  return false;
+}
+
+/// Reads owned channel value, with its sequence (changing on each write)
+/// @return 1 if value was read, 0 if channel is not owned (or not written yet), -1 if it was being written (to be tried again later)
+static int Mailbox_Read( SignalMailbox mailbox, uint32_t channel, double* ref_value, uint64_t* ref_sequence )
+{
+  const SignalMailboxSlot* slot = &(mailbox->slotsList[ channel ]);
+  
+  if( atomic_load_explicit( &(slot->owner), memory_order_relaxed ) == 0 ) return 0;
+  
+  // Channels claimed but not written yet keep their local commands
+  uint64_t sequence = atomic_load_explicit( &(slot->sequence), memory_order_acquire );
+  if( sequence == 0 ) return 0;
+  if( sequence % 2 == 1 ) return -1;
+  
+  double value = slot->value;
+  atomic_thread_fence( memory_order_acquire );
+  if( atomic_load_explicit( &(slot->sequence), memory_order_relaxed ) != sequence ) return -1;
+  
+  *ref_value = value;
+  *ref_sequence = sequence;
+  
+  return 1;
+}
+
+#endif // SIGNAL_MAILBOX_H
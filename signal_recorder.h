@@ -0,0 +1,456 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2019 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of Signal-IO-NIDAQmx.                                   //
+//                                                                            //
+//  Signal-IO-NIDAQmx is free software: you can redistribute it and/or modify //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  Signal-IO-NIDAQmx is distributed in the hope that it will be useful,      //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with Signal-IO-NIDAQmx. If not, see <http://www.gnu.org/licenses/>. //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+/// @file signal_recorder.h
+/// @brief Always-on flight recorder of recent task input blocks and output commands
+///
+/// Recorder regions are named shared memory mappings, holding the task sample history itself, so that recording inputs costs 
+/// nothing beyond acquisition, and recording outputs costs one frame copy. Regions are owned by the process holding their 
+/// (advisory) lock, which the system releases if it crashes: regions left active with no owner are found (and could be dumped) 
+/// when the same task is loaded again, while other processes loading a task in use get a private region instead.
+///
+/// Recordings are dumped to files with the following (native endianness) format:
+///   - one SignalRecordingHeader
+///   - blocksNumber SignalIOBlockData, oldest first
+///   - channelsNumber rows of samplesNumber input values (NaN where channels had no readers)
+///   - framesNumber output frames, oldest first, each one with its time followed by channelsNumber values
+///   - markersNumber SignalRecorderMarker, oldest first
+
+#ifndef SIGNAL_RECORDER_H
+#define SIGNAL_RECORDER_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#ifdef _WIN32
+  #include <windows.h>
+#else
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <sys/file.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+#define RECORDER_NAME_MAX_LENGTH 256
+#define RECORDER_MAGIC "SIGIOREC"
+#define RECORDER_VERSION 2
+
+typedef struct _SignalIOBlockData
+{
+  uint64_t samplesEnd;
+  uint64_t samplesNumber;
+  double time;
+}
+SignalIOBlockData;
+
+/// Client event annotation, placed on the task sample stream
+typedef struct _SignalRecorderMarker
+{
+  uint64_t sampleIndex;
+  double time;
+  uint32_t code;
+  uint32_t reserved;
+  double payload;
+}
+SignalRecorderMarker;
+
+/// Marker ring slots are written in place by any thread: sequence is odd while writing, and 2 * (marker index + 1) when done
+typedef struct _SignalRecorderMarkerSlot
+{
+  atomic_ullong sequence;
+  SignalRecorderMarker marker;
+}
+SignalRecorderMarkerSlot;
+
+/// Shared memory region layout: header, markers ring, blocks ring, channel starts, channel-major samples history, output frames ring
+typedef struct _SignalRecorderHeader
+{
+  char magic[ 8 ];
+  uint32_t version;
+  uint32_t isActive;
+  uint32_t channelsNumber;
+  uint32_t framesWidth;
+  uint64_t blocksNumber;
+  uint64_t historyLength;
+  uint64_t framesNumber;
+  uint64_t markersNumber;
+  double samplingRate;
+  atomic_ullong framesCount;
+  atomic_ullong markersCount;
+}
+SignalRecorderHeader;
+
+typedef struct _SignalRecordingHeader
+{
+  char magic[ 8 ];
+  uint32_t version;
+  uint32_t channelsNumber;
+  double samplingRate;
+  uint64_t firstSample;
+  uint64_t samplesNumber;
+  uint64_t blocksNumber;
+  uint64_t framesNumber;
+  uint64_t markersNumber;
+}
+SignalRecordingHeader;
+
+typedef struct _SignalRecorderData
+{
+  SignalRecorderHeader* header;
+  SignalRecorderMarkerSlot* markersList;
+  SignalIOBlockData* blocksList;
+  atomic_ullong* channelStartsList;
+  double* samplesList;
+  double* framesList;
+  size_t regionSize;
+  char name[ RECORDER_NAME_MAX_LENGTH ];
+#ifdef _WIN32
+  HANDLE mapping;
+#else
+  int regionFile;
+#endif
+}
+SignalRecorderData;
+
+typedef SignalRecorderData* SignalRecorder;
+
+/// Snapshot of a recorder region, with the ranges of samples and frames left consistent by the copy
+typedef struct _SignalRecording
+{
+  SignalRecorderData data;
+  uint64_t samplesStart, samplesEnd;
+  uint64_t framesStart, framesEnd;
+  uint64_t markersStart, markersEnd;
+}
+SignalRecording;
+
+static size_t Recorder_GetRegionSize( uint64_t blocksNumber, uint32_t channelsNumber, uint64_t historyLength, uint64_t framesNumber, 
+                                      uint64_t markersNumber )
+{
+  return sizeof(SignalRecorderHeader) + markersNumber * sizeof(SignalRecorderMarkerSlot) 
+         + blocksNumber * sizeof(SignalIOBlockData) + channelsNumber * sizeof(atomic_ullong) 
+         + channelsNumber * historyLength * sizeof(double) + framesNumber * ( channelsNumber + 1 ) * sizeof(double);
+}
+
+static void Recorder_SetLayout( SignalRecorder recorder )
+{
+  SignalRecorderHeader* header = recorder->header;
+  recorder->markersList = (SignalRecorderMarkerSlot*) ( header + 1 );
+  recorder->blocksList = (SignalIOBlockData*) ( recorder->markersList + header->markersNumber );
+  recorder->channelStartsList = (atomic_ullong*) ( recorder->blocksList + header->blocksNumber );
+  recorder->samplesList = (double*) ( recorder->channelStartsList + header->channelsNumber );
+  recorder->framesList = recorder->samplesList + header->channelsNumber * header->historyLength;
+}
+
+/// Maps (creating it if needed) the named recorder region. Contents of regions still marked active are kept (and reported 
+/// by ref_wasActive), so that data from a crashed session can be dumped before being reinitialized. Regions with a live owner 
+/// are never resized or reset: a private (unnamed) region is used instead
+static SignalRecorder Recorder_Open( const char* name, uint32_t channelsNumber, uint64_t blocksNumber, uint64_t historyLength, 
+                                     uint64_t framesNumber, uint64_t markersNumber, double samplingRate, bool* ref_wasActive )
+{
+  size_t regionSize = Recorder_GetRegionSize( blocksNumber, channelsNumber, historyLength, framesNumber, markersNumber );
+  
+  SignalRecorder newRecorder = (SignalRecorder) calloc( 1, sizeof(SignalRecorderData) );
+  newRecorder->regionSize = regionSize;
+  
+#ifdef _WIN32
+  snprintf( newRecorder->name, RECORDER_NAME_MAX_LENGTH, "Local\\SignalIO_%s", name );
+  newRecorder->mapping = CreateFileMappingA( INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, (DWORD) ( (uint64_t) regionSize >> 32 ), 
+                                             (DWORD) regionSize, newRecorder->name );
+  // Mappings only exist while some (live) process holds them
+  if( newRecorder->mapping != NULL && GetLastError() == ERROR_ALREADY_EXISTS )
+  {
+    CloseHandle( newRecorder->mapping );
+    newRecorder->mapping = NULL;
+  }
+  if( newRecorder->mapping != NULL )
+  {
+    newRecorder->header = (SignalRecorderHeader*) MapViewOfFile( newRecorder->mapping, FILE_MAP_ALL_ACCESS, 0, 0, regionSize );
+    if( newRecorder->header == NULL ) CloseHandle( newRecorder->mapping );
+  }
+#else
+  snprintf( newRecorder->name, RECORDER_NAME_MAX_LENGTH, "/SignalIO_%s", name );
+  for( char* nameChar = newRecorder->name + 1; *nameChar != '\0'; nameChar++ )
+    if( *nameChar == '/' ) *nameChar = '_';
+  int regionFile = shm_open( newRecorder->name, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR );
+  // Region lock is kept (with its file open) until the recorder is closed
+  if( regionFile != -1 && flock( regionFile, LOCK_EX | LOCK_NB ) == 0 )
+  {
+    struct stat regionStatus;
+    // Regions with a different layout (size) from a previous session are not reused
+    if( fstat( regionFile, &regionStatus ) == 0 && (size_t) regionStatus.st_size != regionSize ) (void) ftruncate( regionFile, 0 );
+    if( ftruncate( regionFile, regionSize ) == 0 )
+    {
+      newRecorder->header = (SignalRecorderHeader*) mmap( NULL, regionSize, PROT_READ | PROT_WRITE, MAP_SHARED, regionFile, 0 );
+      if( newRecorder->header == MAP_FAILED ) newRecorder->header = NULL;
+    }
+  }
+  if( newRecorder->header != NULL ) newRecorder->regionFile = regionFile;
+  else if( regionFile != -1 ) close( regionFile );
+#endif
+  
+  // Recording still works without shared memory, only not surviving crashes
+  if( newRecorder->header == NULL )
+  {
+    newRecorder->name[ 0 ] = '\0';
+    newRecorder->header = (SignalRecorderHeader*) calloc( 1, regionSize );
+    if( newRecorder->header == NULL )
+    {
+      free( newRecorder );
+      return NULL;
+    }
+  }
+  
+  SignalRecorderHeader* header = newRecorder->header;
+  *ref_wasActive = ( memcmp( header->magic, RECORDER_MAGIC, sizeof(header->magic) ) == 0 && header->version == RECORDER_VERSION 
+                     && header->isActive && header->channelsNumber == channelsNumber && header->blocksNumber == blocksNumber
+                     && header->historyLength == historyLength && header->framesNumber == framesNumber 
+                     && header->markersNumber == markersNumber );
+  if( !(*ref_wasActive) )
+  {
+    memcpy( header->magic, RECORDER_MAGIC, sizeof(header->magic) );
+    header->version = RECORDER_VERSION;
+    header->channelsNumber = channelsNumber;
+    header->framesWidth = channelsNumber + 1;
+    header->blocksNumber = blocksNumber;
+    header->historyLength = historyLength;
+    header->framesNumber = framesNumber;
+    header->markersNumber = markersNumber;
+    header->samplingRate = samplingRate;
+    atomic_init( &(header->framesCount), 0 );
+    atomic_init( &(header->markersCount), 0 );
+  }
+  
+  Recorder_SetLayout( newRecorder );
+  
+  return newRecorder;
+}
+
+/// Clears region contents for a new session (after any previous one was dumped), marking it active
+static void Recorder_Reset( SignalRecorder recorder, uint64_t inactiveStart )
+{
+  SignalRecorderHeader* header = recorder->header;
+  memset( recorder->markersList, 0, header->markersNumber * sizeof(SignalRecorderMarkerSlot) );
+  atomic_init( &(header->markersCount), 0 );
+  memset( recorder->blocksList, 0, header->blocksNumber * sizeof(SignalIOBlockData) );
+  for( size_t channel = 0; channel < header->channelsNumber; channel++ )
+    atomic_init( &(recorder->channelStartsList[ channel ]), inactiveStart );
+  atomic_init( &(header->framesCount), 0 );
+  header->isActive = 1;
+}
+
+/// Cleanly closed regions are marked inactive and removed
+static void Recorder_Close( SignalRecorder recorder )
+{
+  if( recorder == NULL ) return;
+  
+  recorder->header->isActive = 0;
+  if( recorder->name[ 0 ] == '\0' ) free( recorder->header );
+  else
+  {
+#ifdef _WIN32
+    UnmapViewOfFile( recorder->header );
+    CloseHandle( recorder->mapping );
+#else
+    munmap( recorder->header, recorder->regionSize );
+    shm_unlink( recorder->name );
+    close( recorder->regionFile );
+#endif
+  }
+  
+  free( recorder );
+}
+
+static uint64_t Recorder_GetSamplesEnd( SignalRecorder recorder )
+{
+  uint64_t samplesEnd = 0;
+  for( size_t blockIndex = 0; blockIndex < recorder->header->blocksNumber; blockIndex++ )
+    if( recorder->blocksList[ blockIndex ].samplesEnd > samplesEnd ) samplesEnd = recorder->blocksList[ blockIndex ].samplesEnd;
+  return samplesEnd;
+}
+
+/// Records one output frame (the only recording cost on the output path)
+static void Recorder_WriteFrame( SignalRecorder recorder, double time, const double* valuesList )
+{
+  SignalRecorderHeader* header = recorder->header;
+  if( header->framesNumber == 0 ) return;
+  
+  uint64_t framesCount = atomic_load_explicit( &(header->framesCount), memory_order_relaxed );
+  double* frame = recorder->framesList + ( framesCount % header->framesNumber ) * header->framesWidth;
+  frame[ 0 ] = time;
+  memcpy( frame + 1, valuesList, header->channelsNumber * sizeof(double) );
+  atomic_store_explicit( &(header->framesCount), framesCount + 1, memory_order_release );
+}
+
+/// Appends marker to the ring with no locks (overwriting the oldest one), from any thread
+static void Recorder_WriteMarker( SignalRecorder recorder, const SignalRecorderMarker* marker )
+{
+  SignalRecorderHeader* header = recorder->header;
+  
+  uint64_t markerIndex = atomic_fetch_add_explicit( &(header->markersCount), 1, memory_order_relaxed );
+  SignalRecorderMarkerSlot* slot = &(recorder->markersList[ markerIndex % header->markersNumber ]);
+  atomic_store_explicit( &(slot->sequence), 2 * markerIndex + 1, memory_order_relaxed );
+  atomic_thread_fence( memory_order_release );
+  slot->marker = *marker;
+  atomic_store_explicit( &(slot->sequence), 2 * markerIndex + 2, memory_order_release );
+}
+
+/// Gets marker of given index from the ring
+/// @return 1 if marker was read, 0 if it is not (completely) written yet, -1 if it was already overwritten
+static int Recorder_ReadMarker( SignalRecorder recorder, uint64_t markerIndex, SignalRecorderMarker* ref_marker )
+{
+  const SignalRecorderMarkerSlot* slot = &(recorder->markersList[ markerIndex % recorder->header->markersNumber ]);
+  
+  uint64_t sequence = atomic_load_explicit( &(slot->sequence), memory_order_acquire );
+  if( sequence < 2 * markerIndex + 2 ) return 0;
+  if( sequence > 2 * markerIndex + 2 ) return -1;
+  
+  *ref_marker = slot->marker;
+  atomic_thread_fence( memory_order_acquire );
+  
+  return ( atomic_load_explicit( &(slot->sequence), memory_order_relaxed ) == sequence ) ? 1 : -1;
+}
+
+/// Copies the region while it may still be written. Only the data that could not have been overwritten during the copy is kept,
+/// given that the writer may have up to samplesMargin samples (and one frame) beyond the published ones in progress
+static SignalRecording* Recorder_TakeSnapshot( SignalRecorder recorder, uint64_t samplesMargin )
+{
+  SignalRecording* snapshot = (SignalRecording*) calloc( 1, sizeof(SignalRecording) );
+  snapshot->data.regionSize = recorder->regionSize;
+  snapshot->data.header = (SignalRecorderHeader*) malloc( recorder->regionSize );
+  if( snapshot->data.header == NULL )
+  {
+    free( snapshot );
+    return NULL;
+  }
+  
+  SignalRecorderHeader* header = recorder->header;
+  uint64_t samplesEnd = Recorder_GetSamplesEnd( recorder );
+  uint64_t framesEnd = atomic_load_explicit( &(header->framesCount), memory_order_acquire );
+  uint64_t markersEnd = atomic_load_explicit( &(header->markersCount), memory_order_acquire );
+  memcpy( snapshot->data.header, header, recorder->regionSize );
+  uint64_t lastSamplesEnd = Recorder_GetSamplesEnd( recorder );
+  uint64_t lastFramesEnd = atomic_load_explicit( &(header->framesCount), memory_order_acquire );
+  
+  Recorder_SetLayout( &(snapshot->data) );
+  
+  snapshot->samplesEnd = samplesEnd;
+  lastSamplesEnd += samplesMargin;
+  snapshot->samplesStart = ( lastSamplesEnd > header->historyLength ) ? lastSamplesEnd - header->historyLength : 0;
+  if( snapshot->samplesStart > snapshot->samplesEnd ) snapshot->samplesStart = snapshot->samplesEnd;
+  snapshot->framesEnd = framesEnd;
+  lastFramesEnd += 1;
+  snapshot->framesStart = ( lastFramesEnd > header->framesNumber ) ? lastFramesEnd - header->framesNumber : 0;
+  if( snapshot->framesStart > snapshot->framesEnd ) snapshot->framesStart = snapshot->framesEnd;
+  // Each marker slot tells by itself whether it was overwritten
+  snapshot->markersEnd = markersEnd;
+  snapshot->markersStart = ( markersEnd > header->markersNumber ) ? markersEnd - header->markersNumber : 0;
+  
+  return snapshot;
+}
+
+/// Leaves out of the snapshot data recorded after given (published) counts, e.g. the ones at the time a dump was requested
+static void Recorder_LimitSnapshot( SignalRecording* snapshot, uint64_t samplesEnd, uint64_t framesEnd, uint64_t markersEnd )
+{
+  if( snapshot->samplesEnd > samplesEnd ) snapshot->samplesEnd = samplesEnd;
+  if( snapshot->samplesStart > snapshot->samplesEnd ) snapshot->samplesStart = snapshot->samplesEnd;
+  if( snapshot->framesEnd > framesEnd ) snapshot->framesEnd = framesEnd;
+  if( snapshot->framesStart > snapshot->framesEnd ) snapshot->framesStart = snapshot->framesEnd;
+  if( snapshot->markersEnd > markersEnd ) snapshot->markersEnd = markersEnd;
+  if( snapshot->markersStart > snapshot->markersEnd ) snapshot->markersStart = snapshot->markersEnd;
+}
+
+static void Recorder_DiscardSnapshot( SignalRecording* snapshot )
+{
+  if( snapshot == NULL ) return;
+  
+  free( snapshot->data.header );
+  free( snapshot );
+}
+
+/// Writes snapshot contents, in chronological order, to a recording file
+static bool Recorder_Dump( SignalRecording* snapshot, const char* filePath )
+{
+  FILE* recordingFile = fopen( filePath, "wb" );
+  if( recordingFile == NULL ) return false;
+  
+  SignalRecorder recorder = &(snapshot->data);
+  SignalRecorderHeader* header = recorder->header;
+  
+  SignalRecordingHeader recordingHeader = { RECORDER_MAGIC, RECORDER_VERSION, header->channelsNumber, header->samplingRate, 
+                                            snapshot->samplesStart, snapshot->samplesEnd - snapshot->samplesStart, 0, 
+                                            snapshot->framesEnd - snapshot->framesStart, 0 };
+  // Blocks with all of their samples kept
+  uint64_t firstBlock = header->blocksNumber;
+  for( uint64_t blockIndex = 0; blockIndex < header->blocksNumber; blockIndex++ )
+  {
+    const SignalIOBlockData* block = &(recorder->blocksList[ blockIndex ]);
+    if( block->samplesNumber == 0 || block->samplesEnd > snapshot->samplesEnd ) continue;
+    if( block->samplesEnd - block->samplesNumber < snapshot->samplesStart ) continue;
+    recordingHeader.blocksNumber++;
+    if( firstBlock == header->blocksNumber || block->samplesEnd < recorder->blocksList[ firstBlock ].samplesEnd ) firstBlock = blockIndex;
+  }
+  
+  SignalRecorderMarker marker;
+  for( uint64_t markerIndex = snapshot->markersStart; markerIndex < snapshot->markersEnd; markerIndex++ )
+    if( Recorder_ReadMarker( recorder, markerIndex, &marker ) == 1 ) recordingHeader.markersNumber++;
+  
+  bool writeError = ( fwrite( &recordingHeader, sizeof(SignalRecordingHeader), 1, recordingFile ) != 1 );
+  
+  for( uint64_t blockIndex = 0; blockIndex < recordingHeader.blocksNumber && !writeError; blockIndex++ )
+    writeError = ( fwrite( &(recorder->blocksList[ ( firstBlock + blockIndex ) % header->blocksNumber ]), sizeof(SignalIOBlockData), 1, recordingFile ) != 1 );
+  
+  for( size_t channel = 0; channel < header->channelsNumber && !writeError; channel++ )
+  {
+    const double* channelSamplesList = recorder->samplesList + channel * header->historyLength;
+    uint64_t channelStart = atomic_load( &(recorder->channelStartsList[ channel ]) );
+    for( uint64_t sampleIndex = snapshot->samplesStart; sampleIndex < snapshot->samplesEnd && !writeError; sampleIndex++ )
+    {
+      double sample = ( sampleIndex >= channelStart ) ? channelSamplesList[ sampleIndex % header->historyLength ] : NAN;
+      writeError = ( fwrite( &sample, sizeof(double), 1, recordingFile ) != 1 );
+    }
+  }
+  
+  for( uint64_t frameIndex = snapshot->framesStart; frameIndex < snapshot->framesEnd && !writeError; frameIndex++ )
+  {
+    const double* frame = recorder->framesList + ( frameIndex % header->framesNumber ) * header->framesWidth;
+    writeError = ( fwrite( frame, sizeof(double), header->framesWidth, recordingFile ) != header->framesWidth );
+  }
+  
+  for( uint64_t markerIndex = snapshot->markersStart; markerIndex < snapshot->markersEnd && !writeError; markerIndex++ )
+  {
+    if( Recorder_ReadMarker( recorder, markerIndex, &marker ) != 1 ) continue;
+    writeError = ( fwrite( &marker, sizeof(SignalRecorderMarker), 1, recordingFile ) != 1 );
+  }
+  
+  fclose( recordingFile );
+  
+  return !writeError;
+}
+
+#endif // SIGNAL_RECORDER_H
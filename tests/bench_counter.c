@@ -0,0 +1,141 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2019 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of Signal-IO-NIDAQmx.                                   //
+//                                                                            //
+//  Signal-IO-NIDAQmx is free software: you can redistribute it and/or modify //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  Signal-IO-NIDAQmx is distributed in the hope that it will be useful,      //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with Signal-IO-NIDAQmx. If not, see <http://www.gnu.org/licenses/>. //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+
+// Per update cost of counter (PWM) outputs against analog ones on the simulated driver: driver write calls alone,
+// plugin conversions included (called from here, with no output thread running), and full Write() to driver round trips
+
+#include "../ni_daqmx.c"
+
+#include "daqmx_simulator.h"
+#include "test_utils.h"
+
+#define COUNTERS_NUMBER 4
+#define ROUND_TRIPS_NUMBER 2000
+#define WAIT_TIMEOUT 2.0
+
+typedef struct _BenchmarkData
+{
+  SignalIOTask task;
+  double valuesList[ 2 * COUNTERS_NUMBER ];
+}
+BenchmarkData;
+
+static void RunWriteCtrFreq( void* data, size_t iterationsNumber )
+{
+  BenchmarkData* bench = (BenchmarkData*) data;
+  double frequenciesList[ COUNTERS_NUMBER ], dutyCyclesList[ COUNTERS_NUMBER ];
+  int32 writtenSamplesCount;
+  for( size_t iteration = 0; iteration < iterationsNumber; iteration++ )
+  {
+    for( size_t counter = 0; counter < COUNTERS_NUMBER; counter++ )
+    {
+      dutyCyclesList[ counter ] = bench->valuesList[ 2 * counter ];
+      frequenciesList[ counter ] = bench->valuesList[ 2 * counter + 1 ];
+    }
+    DAQmxWriteCtrFreq( bench->task->handle, 1, 0, 0.1, DAQmx_Val_GroupByChannel, frequenciesList, dutyCyclesList, &writtenSamplesCount, NULL );
+  }
+}
+
+static void RunWriteCounterValues( void* data, size_t iterationsNumber )
+{
+  BenchmarkData* bench = (BenchmarkData*) data;
+  for( size_t iteration = 0; iteration < iterationsNumber; iteration++ )
+    WriteCounterValues( bench->task, bench->valuesList );
+}
+
+static void RunWriteAnalogF64( void* data, size_t iterationsNumber )
+{
+  BenchmarkData* bench = (BenchmarkData*) data;
+  int32 writtenSamplesCount;
+  for( size_t iteration = 0; iteration < iterationsNumber; iteration++ )
+    DAQmxWriteAnalogF64( bench->task->handle, 1, 0, 0.1, DAQmx_Val_GroupByChannel, bench->valuesList, &writtenSamplesCount, NULL );
+}
+
+// Time from Write() to the value reaching the driver, with the output thread paced well above the round trip rate
+static double GetRoundTripTime( long int taskID, const char* simTaskName )
+{
+  if( !AcquireOutputChannel( taskID, 0 ) ) return 0.0;
+  SetOutputPacing( taskID, 1e5, 0.0 );
+  
+  double totalTime = 0.0;
+  size_t updatesNumber = 0;
+  for( size_t update = 0; update < ROUND_TRIPS_NUMBER; update++ )
+  {
+    uint64_t updatesCount = SimDAQmx_GetUpdatesCount( simTaskName );
+    double startTime = Test_GetTime();
+    if( !Write( taskID, 0, ( update % 2 == 0 ) ? 0.25 : 0.75 ) ) 
+    {
+      Test_Sleep( 0.001 );
+      continue;
+    }
+    while( SimDAQmx_GetUpdatesCount( simTaskName ) == updatesCount && Test_GetTime() < startTime + WAIT_TIMEOUT )
+      Test_Sleep( 0.0 );
+    totalTime += Test_GetTime() - startTime;
+    updatesNumber++;
+  }
+  
+  ReleaseOutputChannel( taskID, 0 );
+  
+  return ( updatesNumber > 0 ) ? totalTime / updatesNumber * 1e6 : 0.0;
+}
+
+int main( int argc, char* argv[] )
+{
+  SimDAQmx_AddTask( "SimPWM", SIM_TASK_COUNTER_OUTPUT, COUNTERS_NUMBER, 0.0 );
+  SimDAQmx_AddTask( "SimAO", SIM_TASK_ANALOG_OUTPUT, 2 * COUNTERS_NUMBER, 0.0 );
+  
+  long int counterTaskID = InitDevice( "SimPWM" );
+  long int analogTaskID = InitDevice( "SimAO" );
+  if( counterTaskID == SIGNAL_IO_TASK_INVALID_ID || analogTaskID == SIGNAL_IO_TASK_INVALID_ID )
+  {
+    fprintf( stderr, "bench_counter: simulated tasks not loaded\n" );
+    return 1;
+  }
+  
+  static BenchmarkData counterBench, analogBench;
+  counterBench.task = GetTask( counterTaskID );
+  analogBench.task = GetTask( analogTaskID );
+  for( size_t counter = 0; counter < COUNTERS_NUMBER; counter++ )
+  {
+    counterBench.valuesList[ 2 * counter ] = analogBench.valuesList[ 2 * counter ] = 0.1 * ( counter + 1 );
+    counterBench.valuesList[ 2 * counter + 1 ] = analogBench.valuesList[ 2 * counter + 1 ] = 1000.0 * ( counter + 1 );
+  }
+  
+  printf( "ns per update (%d counters, %d analog channels)\n", COUNTERS_NUMBER, 2 * COUNTERS_NUMBER );
+  double driverTime = Benchmark_GetCallTime( RunWriteCtrFreq, &counterBench );
+  printf( "%-40s%10.1f\n", "DAQmxWriteCtrFreq", driverTime );
+  double pluginTime = Benchmark_GetCallTime( RunWriteCounterValues, &counterBench );
+  printf( "%-40s%10.1f (%+.1f over driver)\n", "WriteCounterValues", pluginTime, pluginTime - driverTime );
+  printf( "%-40s%10.1f\n", "DAQmxWriteAnalogF64", Benchmark_GetCallTime( RunWriteAnalogF64, &analogBench ) );
+  
+  printf( "us per Write() to driver round trip\n" );
+  printf( "%-40s%10.1f\n", "counter output", GetRoundTripTime( counterTaskID, "SimPWM" ) );
+  printf( "%-40s%10.1f\n", "analog output", GetRoundTripTime( analogTaskID, "SimAO" ) );
+  
+  EndDevice( counterTaskID );
+  EndDevice( analogTaskID );
+  SimDAQmx_RemoveTasks();
+  
+  return 0;
+}
@@ -0,0 +1,102 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2019 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of Signal-IO-NIDAQmx.                                   //
+//                                                                            //
+//  Signal-IO-NIDAQmx is free software: you can redistribute it and/or modify //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  Signal-IO-NIDAQmx is distributed in the hope that it will be useful,      //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with Signal-IO-NIDAQmx. If not, see <http://www.gnu.org/licenses/>. //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+// Median/Hampel filter kernels against the naive filter (per channel insertion sorts), per filtered frame, 
+// for usual channel counts and window lengths
+
+#include "signal_kernels.h"
+
+#include "reference_kernels.h"
+#include "test_utils.h"
+
+#define MAX_WIDTH 16
+#define BENCH_LENGTH KERNEL_BLOCK_LENGTH
+
+static const char* VARIANT_NAMES[ KERNELS_VARIANTS_NUMBER ] = { "scalar", "SSE2", "AVX2", "AVX-512" };
+
+typedef struct _BenchmarkData
+{
+  void (*FilterFrames)( double*, const double*, const double*, size_t, size_t, size_t );
+  size_t framesWidth;
+  size_t windowLength;
+  double thresholdsList[ MAX_WIDTH ];
+  double windowFramesList[ ( BENCH_LENGTH + KERNEL_FILTER_MAX_WINDOW ) * MAX_WIDTH ];
+  double framesList[ BENCH_LENGTH * MAX_WIDTH ];
+}
+BenchmarkData;
+
+static void RunFilterFrames( void* data, size_t iterationsNumber )
+{
+  BenchmarkData* bench = (BenchmarkData*) data;
+  for( size_t iteration = 0; iteration < iterationsNumber; iteration++ )
+    bench->FilterFrames( bench->framesList, bench->windowFramesList, bench->thresholdsList, bench->framesWidth, bench->windowLength, BENCH_LENGTH );
+  benchmarkSink = bench->framesList[ 0 ];
+}
+
+int main( int argc, char* argv[] )
+{
+  const size_t FRAMES_WIDTHS_LIST[] = { 1, 8, 16 };
+  const size_t WINDOW_LENGTHS_LIST[] = { 3, 9, 15 };
+  static BenchmarkData bench;
+  
+  Test_FillRandom( bench.windowFramesList, sizeof(bench.windowFramesList) / sizeof(double) );
+  
+  printf( "ns per frame (speedup over naive)       naive" );
+  for( int variant = 0; variant < KERNELS_VARIANTS_NUMBER; variant++ )
+    printf( "%16s", VARIANT_NAMES[ variant ] );
+  printf( "\n" );
+  
+  for( size_t hasHampel = 0; hasHampel < 2; hasHampel++ )
+  {
+    for( size_t lane = 0; lane < MAX_WIDTH; lane++ )
+      bench.thresholdsList[ lane ] = hasHampel ? 3.0 : 0.0;
+    for( size_t widthIndex = 0; widthIndex < sizeof(FRAMES_WIDTHS_LIST) / sizeof(size_t); widthIndex++ )
+    {
+      for( size_t windowIndex = 0; windowIndex < sizeof(WINDOW_LENGTHS_LIST) / sizeof(size_t); windowIndex++ )
+      {
+        bench.framesWidth = FRAMES_WIDTHS_LIST[ widthIndex ];
+        bench.windowLength = WINDOW_LENGTHS_LIST[ windowIndex ];
+        printf( "%-7s %2zu channels, %2zu taps", hasHampel ? "Hampel" : "median", bench.framesWidth, bench.windowLength );
+        
+        bench.FilterFrames = FilterFrames_Reference;
+        double naiveFrameTime = Benchmark_GetCallTime( RunFilterFrames, &bench ) / BENCH_LENGTH;
+        printf( "%15.1f", naiveFrameTime );
+        for( int variant = 0; variant < KERNELS_VARIANTS_NUMBER; variant++ )
+        {
+          Kernels_Bind( variant );
+          if( Kernels.variant != variant )
+          {
+            printf( "%16s", "n/a" );
+            continue;
+          }
+          bench.FilterFrames = Kernels.FilterFrames;
+          double frameTime = Benchmark_GetCallTime( RunFilterFrames, &bench ) / BENCH_LENGTH;
+          printf( "%8.1f (%4.1fx)", frameTime, naiveFrameTime / frameTime );
+        }
+        printf( "\n" );
+      }
+    }
+  }
+  
+  return 0;
+}
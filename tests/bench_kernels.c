@@ -0,0 +1,153 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2019 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of Signal-IO-NIDAQmx.                                   //
+//                                                                            //
+//  Signal-IO-NIDAQmx is free software: you can redistribute it and/or modify //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  Signal-IO-NIDAQmx is distributed in the hope that it will be useful,      //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with Signal-IO-NIDAQmx. If not, see <http://www.gnu.org/licenses/>. //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+// Per call time of each kernel variant supported here, and its speedup over the scalar one, 
+// for the plugin usual sizes: 8 channels, KERNEL_BLOCK_LENGTH frames blocks and RESAMPLER_TAPS_NUMBER (16) taps
+
+#include "signal_kernels.h"
+
+#include "test_utils.h"
+
+#define BENCH_WIDTH 8
+#define BENCH_LENGTH KERNEL_BLOCK_LENGTH
+#define BENCH_TAPS 16
+#define BENCH_WINDOW 9
+#define BENCH_SWEEP_LENGTH 1000
+
+static const char* VARIANT_NAMES[ KERNELS_VARIANTS_NUMBER ] = { "scalar", "SSE2", "AVX2", "AVX-512" };
+
+typedef struct _BenchmarkData
+{
+  double aList[ BENCH_SWEEP_LENGTH ], bList[ BENCH_SWEEP_LENGTH ], cList[ BENCH_SWEEP_LENGTH ];
+  double framesList[ ( BENCH_LENGTH + KERNEL_FILTER_MAX_WINDOW ) * BENCH_WIDTH ], outputList[ BENCH_LENGTH * BENCH_WIDTH ];
+  double termsList[ BENCH_LENGTH * KERNEL_TERMS_NUMBER * BENCH_WIDTH ], sumsList[ KERNEL_TERMS_NUMBER * BENCH_WIDTH ];
+  double thresholdsList[ BENCH_WIDTH ], lastFramesList[ 2 * BENCH_WIDTH ];
+  double knotsTable[ KERNEL_KNOTS_NUMBER ][ BENCH_WIDTH ], weightsTable[ BENCH_LENGTH * KERNEL_KNOTS_NUMBER ];
+}
+BenchmarkData;
+
+static void RunDotProduct( void* data, size_t iterationsNumber )
+{
+  BenchmarkData* bench = (BenchmarkData*) data;
+  double sum = 0.0;
+  for( size_t iteration = 0; iteration < iterationsNumber; iteration++ )
+    sum += Kernels.DotProduct( bench->aList + iteration % 8, bench->bList, BENCH_TAPS );
+  benchmarkSink = sum;
+}
+
+static void RunDeinterleave( void* data, size_t iterationsNumber )
+{
+  BenchmarkData* bench = (BenchmarkData*) data;
+  for( size_t iteration = 0; iteration < iterationsNumber; iteration++ )
+  {
+    for( size_t column = 0; column < BENCH_WIDTH; column++ )
+      Kernels.Deinterleave( bench->outputList + column * BENCH_LENGTH, bench->framesList + column, BENCH_WIDTH, BENCH_LENGTH );
+  }
+  benchmarkSink = bench->outputList[ 0 ];
+}
+
+static void RunFilterFrames( void* data, size_t iterationsNumber )
+{
+  BenchmarkData* bench = (BenchmarkData*) data;
+  for( size_t iteration = 0; iteration < iterationsNumber; iteration++ )
+    Kernels.FilterFrames( bench->outputList, bench->framesList, bench->thresholdsList, BENCH_WIDTH, BENCH_WINDOW, BENCH_LENGTH );
+  benchmarkSink = bench->outputList[ 0 ];
+}
+
+static void RunAccumulateTerms( void* data, size_t iterationsNumber )
+{
+  BenchmarkData* bench = (BenchmarkData*) data;
+  for( size_t iteration = 0; iteration < iterationsNumber; iteration++ )
+    Kernels.AccumulateTerms( bench->sumsList, bench->termsList, bench->lastFramesList, bench->framesList, BENCH_WIDTH, BENCH_LENGTH, 0.1 );
+  benchmarkSink = bench->sumsList[ 0 ];
+}
+
+static void RunUpdateMeans( void* data, size_t iterationsNumber )
+{
+  BenchmarkData* bench = (BenchmarkData*) data;
+  for( size_t iteration = 0; iteration < iterationsNumber; iteration++ )
+    Kernels.UpdateMeans( bench->aList, bench->bList, bench->cList, BENCH_SWEEP_LENGTH, (double) ( iteration % 100 + 1 ) );
+  benchmarkSink = bench->aList[ 0 ];
+}
+
+static void RunCalibrateFrames( void* data, size_t iterationsNumber )
+{
+  BenchmarkData* bench = (BenchmarkData*) data;
+  for( size_t iteration = 0; iteration < iterationsNumber; iteration++ )
+    Kernels.CalibrateFrames( bench->framesList, bench->sumsList, bench->thresholdsList, BENCH_WIDTH, BENCH_LENGTH );
+  benchmarkSink = bench->sumsList[ 0 ];
+}
+
+static void RunInterpolateFrames( void* data, size_t iterationsNumber )
+{
+  BenchmarkData* bench = (BenchmarkData*) data;
+  const double* knotFramesList[ KERNEL_KNOTS_NUMBER ] = { bench->knotsTable[ 0 ], bench->knotsTable[ 1 ], bench->knotsTable[ 2 ], bench->knotsTable[ 3 ] };
+  for( size_t iteration = 0; iteration < iterationsNumber; iteration++ )
+    Kernels.InterpolateFrames( bench->outputList, knotFramesList, bench->weightsTable, BENCH_WIDTH, BENCH_LENGTH );
+  benchmarkSink = bench->outputList[ 0 ];
+}
+
+static const struct { const char* name; BenchmarkFunction Run; } BENCHMARKS_LIST[] = 
+{
+  { "DotProduct (16 taps)", RunDotProduct },
+  { "Deinterleave (8x10 frames)", RunDeinterleave },
+  { "FilterFrames (8x10, 9 taps Hampel)", RunFilterFrames },
+  { "AccumulateTerms (8x10 frames)", RunAccumulateTerms },
+  { "UpdateMeans (1000 samples)", RunUpdateMeans },
+  { "CalibrateFrames (8x10 frames)", RunCalibrateFrames },
+  { "InterpolateFrames (8x10 frames)", RunInterpolateFrames }
+};
+
+int main( int argc, char* argv[] )
+{
+  static BenchmarkData bench;
+  Test_FillRandom( (double*) &bench, sizeof(BenchmarkData) / sizeof(double) );
+  for( size_t lane = 0; lane < BENCH_WIDTH; lane++ )
+    bench.thresholdsList[ lane ] = 3.0;
+  
+  printf( "%-36s", "ns per call (speedup over scalar)" );
+  for( int variant = 0; variant < KERNELS_VARIANTS_NUMBER; variant++ )
+    printf( "%18s", VARIANT_NAMES[ variant ] );
+  printf( "\n" );
+  
+  for( size_t benchmarkIndex = 0; benchmarkIndex < sizeof(BENCHMARKS_LIST) / sizeof(BENCHMARKS_LIST[ 0 ]); benchmarkIndex++ )
+  {
+    printf( "%-36s", BENCHMARKS_LIST[ benchmarkIndex ].name );
+    double scalarCallTime = 0.0;
+    for( int variant = 0; variant < KERNELS_VARIANTS_NUMBER; variant++ )
+    {
+      Kernels_Bind( variant );
+      if( Kernels.variant != variant )
+      {
+        printf( "%18s", "n/a" );
+        continue;
+      }
+      double callTime = Benchmark_GetCallTime( BENCHMARKS_LIST[ benchmarkIndex ].Run, &bench );
+      if( variant == KERNELS_SCALAR ) scalarCallTime = callTime;
+      printf( "%10.1f (%4.2fx)", callTime, scalarCallTime / callTime );
+    }
+    printf( "\n" );
+  }
+  
+  return 0;
+}
@@ -0,0 +1,107 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2019 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of Signal-IO-NIDAQmx.                                   //
+//                                                                            //
+//  Signal-IO-NIDAQmx is free software: you can redistribute it and/or modify //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  Signal-IO-NIDAQmx is distributed in the hope that it will be useful,      //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with Signal-IO-NIDAQmx. If not, see <http://www.gnu.org/licenses/>. //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+// Gain of the specialized block kernels (fixed width and KERNEL_BLOCK_LENGTH) over the generic ones: transposes against
+// deinterleaving each column, and calibrations against the bound vector kernel. Rows are strided as in the channels history
+
+#include "signal_kernels.h"
+
+#include "test_utils.h"
+
+#define MAX_WIDTH 16
+#define ROWS_STRIDE 4096
+
+static const char* VARIANT_NAMES[ KERNELS_VARIANTS_NUMBER ] = { "scalar", "SSE2", "AVX2", "AVX-512" };
+
+typedef struct _BenchmarkData
+{
+  TransposeFramesFunction Transpose;
+  CalibrateFramesFunction Calibrate;
+  size_t framesWidth;
+  unsigned int rowsList[ MAX_WIDTH ];
+  double framesList[ KERNEL_BLOCK_LENGTH * MAX_WIDTH ];
+  double offsetsList[ MAX_WIDTH ];
+  double sumsList[ MAX_WIDTH ];
+  double rowsTable[ MAX_WIDTH * ROWS_STRIDE ];
+}
+BenchmarkData;
+
+static void RunTranspose( void* data, size_t iterationsNumber )
+{
+  BenchmarkData* bench = (BenchmarkData*) data;
+  for( size_t iteration = 0; iteration < iterationsNumber; iteration++ )
+  {
+    // Moving along the rows, as acquisition does
+    size_t offset = ( iteration * KERNEL_BLOCK_LENGTH ) % ( ROWS_STRIDE - KERNEL_BLOCK_LENGTH );
+    bench->Transpose( bench->framesWidth, bench->rowsTable + offset, bench->rowsList, ROWS_STRIDE, bench->framesList, KERNEL_BLOCK_LENGTH );
+  }
+  benchmarkSink = bench->rowsTable[ 0 ];
+}
+
+static void RunCalibrate( void* data, size_t iterationsNumber )
+{
+  BenchmarkData* bench = (BenchmarkData*) data;
+  for( size_t iteration = 0; iteration < iterationsNumber; iteration++ )
+    bench->Calibrate( bench->framesList, bench->sumsList, bench->offsetsList, bench->framesWidth, KERNEL_BLOCK_LENGTH );
+  benchmarkSink = bench->sumsList[ 0 ];
+}
+
+int main( int argc, char* argv[] )
+{
+  const size_t FRAMES_WIDTHS_LIST[] = { 1, 2, 4, 6, 8, 16 };
+  static BenchmarkData bench;
+  
+  Kernels_Bind( -1 );
+  Test_FillRandom( bench.framesList, sizeof(bench.framesList) / sizeof(double) );
+  Test_FillRandom( bench.offsetsList, MAX_WIDTH );
+  for( size_t column = 0; column < MAX_WIDTH; column++ )
+    bench.rowsList[ column ] = (unsigned int) column;
+  
+  printf( "ns per %zu frames block (%-7s kernels)   generic  specialized  gain\n", (size_t) KERNEL_BLOCK_LENGTH, VARIANT_NAMES[ Kernels.variant ] );
+  for( size_t widthIndex = 0; widthIndex < sizeof(FRAMES_WIDTHS_LIST) / sizeof(size_t); widthIndex++ )
+  {
+    bench.framesWidth = FRAMES_WIDTHS_LIST[ widthIndex ];
+    
+    bench.Transpose = TransposeFrames_Generic;
+    double genericCallTime = Benchmark_GetCallTime( RunTranspose, &bench );
+    bench.Transpose = Kernels_GetTransposeBlock( bench.framesWidth );
+    double specializedCallTime = Benchmark_GetCallTime( RunTranspose, &bench );
+    printf( "transpose %2zu channels %20s%10.1f %12.1f %5.2fx\n", bench.framesWidth, "", genericCallTime, specializedCallTime, 
+            genericCallTime / specializedCallTime );
+  }
+  for( size_t widthIndex = 0; widthIndex < sizeof(FRAMES_WIDTHS_LIST) / sizeof(size_t); widthIndex++ )
+  {
+    bench.framesWidth = FRAMES_WIDTHS_LIST[ widthIndex ];
+    
+    // Selection keeps vector kernels where they fill whole vectors
+    bench.Calibrate = Kernels.CalibrateFrames;
+    double genericCallTime = Benchmark_GetCallTime( RunCalibrate, &bench );
+    bench.Calibrate = Kernels_GetCalibrateBlock( bench.framesWidth );
+    double specializedCallTime = Benchmark_GetCallTime( RunCalibrate, &bench );
+    printf( "calibrate %2zu channels %-20s%10.1f %12.1f %5.2fx\n", bench.framesWidth, 
+            ( bench.Calibrate == Kernels.CalibrateFrames ) ? " (vector kept)" : "", genericCallTime, specializedCallTime, 
+            genericCallTime / specializedCallTime );
+  }
+  
+  return 0;
+}
@@ -0,0 +1,64 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2019 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of Signal-IO-NIDAQmx.                                   //
+//                                                                            //
+//  Signal-IO-NIDAQmx is free software: you can redistribute it and/or modify //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  Signal-IO-NIDAQmx is distributed in the hope that it will be useful,      //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with Signal-IO-NIDAQmx. If not, see <http://www.gnu.org/licenses/>. //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+
+/// @file plugin_utils.h
+/// @brief Signals and waits shared by the tests of the plugin over the simulated driver (included after the plugin source)
+
+#ifndef PLUGIN_UTILS_H
+#define PLUGIN_UTILS_H
+
+#include "daqmx_simulator.h"
+#include "test_utils.h"
+
+#define INPUT_SAMPLING_RATE 1000.0
+#define INPUT_CHANNELS_NUMBER 2
+#define WAIT_TIMEOUT 2.0
+
+/// Channel c ramps at c + 1 units per sample
+static double GetRampSignal( unsigned int channel, uint64_t sampleIndex )
+{
+  return (double) ( channel + 1 ) * sampleIndex;
+}
+
+/// Reads channel until some samples come, or timeout
+static size_t WaitRead( long int taskID, unsigned int channel, double* samplesList )
+{
+  double timeoutTime = Test_GetTime() + WAIT_TIMEOUT;
+  size_t samplesNumber = 0;
+  while( ( samplesNumber = Read( taskID, channel, samplesList ) ) == 0 && Test_GetTime() < timeoutTime )
+    Test_Sleep( 0.001 );
+  return samplesNumber;
+}
+
+/// Waits until task has published given number of samples, or timeout
+static bool WaitSamples( long int taskID, uint64_t samplesCount )
+{
+  SignalIOTask task = GetTask( taskID );
+  double timeoutTime = Test_GetTime() + WAIT_TIMEOUT;
+  while( atomic_load( &(task->samplesCount) ) < samplesCount && Test_GetTime() < timeoutTime )
+    Test_Sleep( 0.001 );
+  return ( atomic_load( &(task->samplesCount) ) >= samplesCount );
+}
+
+#endif // PLUGIN_UTILS_H
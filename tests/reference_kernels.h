@@ -0,0 +1,72 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2019 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of Signal-IO-NIDAQmx.                                   //
+//                                                                            //
+//  Signal-IO-NIDAQmx is free software: you can redistribute it and/or modify //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  Signal-IO-NIDAQmx is distributed in the hope that it will be useful,      //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with Signal-IO-NIDAQmx. If not, see <http://www.gnu.org/licenses/>. //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+/// @file reference_kernels.h
+/// @brief Straightforward (per channel, sort based) versions of kernels, as correctness and speed references
+
+#ifndef REFERENCE_KERNELS_H
+#define REFERENCE_KERNELS_H
+
+#include "signal_kernels.h"
+
+static void SortValues_Reference( double* valuesList, size_t valuesNumber )
+{
+  for( size_t index = 1; index < valuesNumber; index++ )
+  {
+    double value = valuesList[ index ];
+    size_t position = index;
+    for( ; position > 0 && valuesList[ position - 1 ] > value; position-- )
+      valuesList[ position ] = valuesList[ position - 1 ];
+    valuesList[ position ] = value;
+  }
+}
+
+/// Same interface and results as the FilterFrames kernels, with each channel window sorted on its own
+static void FilterFrames_Reference( double* framesList, const double* windowFramesList, const double* thresholdsList, 
+                                    size_t framesWidth, size_t windowLength, size_t length )
+{
+  bool hasHampel = HasHampelThresholds( thresholdsList, framesWidth );
+  double valuesList[ KERNEL_FILTER_MAX_WINDOW ];
+  for( size_t frame = 0; frame < length; frame++ )
+  {
+    for( size_t channel = 0; channel < framesWidth; channel++ )
+    {
+      for( size_t index = 0; index < windowLength; index++ )
+        valuesList[ index ] = windowFramesList[ ( frame + index ) * framesWidth + channel ];
+      double currentValue = valuesList[ windowLength - 1 ];
+      SortValues_Reference( valuesList, windowLength );
+      double median = valuesList[ windowLength / 2 ];
+      double limit = thresholdsList[ channel ];
+      if( hasHampel )
+      {
+        for( size_t index = 0; index < windowLength; index++ )
+          valuesList[ index ] = fabs( valuesList[ index ] - median );
+        SortValues_Reference( valuesList, windowLength );
+        limit = thresholdsList[ channel ] * valuesList[ windowLength / 2 ];
+      }
+      framesList[ frame * framesWidth + channel ] = ( fabs( currentValue - median ) > limit ) ? median : currentValue;
+    }
+  }
+}
+
+#endif // REFERENCE_KERNELS_H
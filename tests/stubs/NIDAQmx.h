@@ -0,0 +1,106 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2019 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of Signal-IO-NIDAQmx.                                   //
+//                                                                            //
+//  Signal-IO-NIDAQmx is free software: you can redistribute it and/or modify //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  Signal-IO-NIDAQmx is distributed in the hope that it will be useful,      //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with Signal-IO-NIDAQmx. If not, see <http://www.gnu.org/licenses/>. //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+/// @file NIDAQmx.h
+/// @brief Subset of the NI-DAQmx C API used by the plugin, implemented by the tests driver simulator (daqmx_simulator.h)
+
+#ifndef NIDAQMX_H
+#define NIDAQMX_H
+
+#include <stdint.h>
+
+typedef void* TaskHandle;
+typedef signed char int8;
+typedef unsigned char uInt8;
+typedef signed short int16;
+typedef unsigned short uInt16;
+typedef signed int int32;
+typedef unsigned int uInt32;
+typedef signed long long int64;
+typedef unsigned long long uInt64;
+typedef float float32;
+typedef double float64;
+typedef uInt32 bool32;
+
+#define DAQmx_Task_NumChans 0x2181
+#define DAQmx_Read_NumChans 0x217B
+
+#define DAQmx_Val_WaitInfinitely -1.0
+#define DAQmx_Val_GroupByChannel 0
+#define DAQmx_Val_GroupByScanNumber 1
+#define DAQmx_Val_Task_Commit 3
+#define DAQmx_Val_Rising 10280
+#define DAQmx_Val_AI 10100
+#define DAQmx_Val_AO 10102
+#define DAQmx_Val_DI 10151
+#define DAQmx_Val_CO 10132
+#define DAQmx_Val_SampClk 10388
+#define DAQmx_Val_OnDemand 10390
+#define DAQmx_Val_ChangeDetection 12504
+#define DAQmx_Val_AllowRegen 10097
+#define DAQmx_Val_DoNotAllowRegen 10158
+
+#define DAQmxErrorInvalidTask (-200088)
+#define DAQmxErrorInvalidAttributeValue (-200077)
+#define DAQmxErrorTaskNotInDataNeighborhood (-200005)
+#define DAQmxErrorSamplesNotYetAvailable (-200284)
+#define DAQmxErrorNoMoreSpace (-200293)
+
+int32 DAQmxLoadTask( const char* taskName, TaskHandle* taskHandle );
+int32 DAQmxClearTask( TaskHandle taskHandle );
+int32 DAQmxStartTask( TaskHandle taskHandle );
+int32 DAQmxStopTask( TaskHandle taskHandle );
+int32 DAQmxTaskControl( TaskHandle taskHandle, int32 action );
+
+int32 DAQmxGetTaskAttribute( TaskHandle taskHandle, int32 attribute, void* value, ... );
+int32 DAQmxGetReadAttribute( TaskHandle taskHandle, int32 attribute, void* value, ... );
+int32 DAQmxGetNthTaskChannel( TaskHandle taskHandle, uInt32 index, char buffer[], int32 bufferSize );
+int32 DAQmxGetNthTaskDevice( TaskHandle taskHandle, uInt32 index, char buffer[], int32 bufferSize );
+int32 DAQmxGetChanType( TaskHandle taskHandle, const char channel[], int32* data );
+int32 DAQmxGetErrorString( int32 errorCode, char errorString[], uInt32 bufferSize );
+
+int32 DAQmxGetSampClkRate( TaskHandle taskHandle, float64* data );
+int32 DAQmxGetSampTimingType( TaskHandle taskHandle, int32* data );
+int32 DAQmxGetSampClkSrc( TaskHandle taskHandle, char* data, uInt32 bufferSize );
+int32 DAQmxSetSampClkSrc( TaskHandle taskHandle, const char* data );
+int32 DAQmxCfgDigEdgeStartTrig( TaskHandle taskHandle, const char triggerSource[], int32 triggerEdge );
+int32 DAQmxDisableStartTrig( TaskHandle taskHandle );
+
+int32 DAQmxSetReadChannelsToRead( TaskHandle taskHandle, const char* data );
+int32 DAQmxGetReadAvailSampPerChan( TaskHandle taskHandle, uInt32* data );
+int32 DAQmxGetReadDigitalLinesBytesPerChan( TaskHandle taskHandle, uInt32* data );
+int32 DAQmxReadAnalogF64( TaskHandle taskHandle, int32 numSampsPerChan, float64 timeout, bool32 fillMode, float64 readArray[], 
+                          uInt32 arraySizeInSamps, int32* sampsPerChanRead, bool32* reserved );
+int32 DAQmxReadDigitalLines( TaskHandle taskHandle, int32 numSampsPerChan, float64 timeout, bool32 fillMode, uInt8 readArray[], 
+                             uInt32 arraySizeInBytes, int32* sampsPerChanRead, int32* numBytesPerSamp, bool32* reserved );
+
+int32 DAQmxCfgOutputBuffer( TaskHandle taskHandle, uInt32 numSampsPerChan );
+int32 DAQmxSetWriteRegenMode( TaskHandle taskHandle, int32 data );
+int32 DAQmxWriteAnalogF64( TaskHandle taskHandle, int32 numSampsPerChan, bool32 autoStart, float64 timeout, bool32 dataLayout, 
+                           const float64 writeArray[], int32* sampsPerChanWritten, bool32* reserved );
+int32 DAQmxWriteCtrFreq( TaskHandle taskHandle, int32 numSampsPerChan, bool32 autoStart, float64 timeout, bool32 dataLayout, 
+                         const float64 frequency[], const float64 dutyCycle[], int32* numSampsPerChanWritten, bool32* reserved );
+int32 DAQmxGetCOPulseFreq( TaskHandle taskHandle, const char channel[], float64* data );
+int32 DAQmxGetCOPulseDutyCyc( TaskHandle taskHandle, const char channel[], float64* data );
+
+#endif // NIDAQMX_H
@@ -0,0 +1,563 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2019 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of Signal-IO-NIDAQmx.                                   //
+//                                                                            //
+//  Signal-IO-NIDAQmx is free software: you can redistribute it and/or modify //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  Signal-IO-NIDAQmx is distributed in the hope that it will be useful,      //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with Signal-IO-NIDAQmx. If not, see <http://www.gnu.org/licenses/>. //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+// NI-DAQmx driver simulator: implements the NIDAQmx.h subset used by the plugin, for tests only
+
+#include "daqmx_simulator.h"
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#define SIM_TASKS_MAX_NUMBER 32
+#define SIM_NAME_MAX_LENGTH 256
+#define SIM_CHANNELS_MAX_NUMBER 64
+#define SIM_COUNTER_FREQUENCY_DEFAULT 1000.0
+#define SIM_COUNTER_DUTY_CYCLE_DEFAULT 0.5
+
+typedef struct _SimTaskData
+{
+  char name[ SIM_NAME_MAX_LENGTH ];
+  int type;
+  uInt32 channelsNumber;
+  double samplingRate;
+  SimSignalFunction signalFunction;
+  int32 startError;
+  atomic_ullong startsCount;
+  atomic_ullong updatesCount;
+  pthread_mutex_t valuesLock;
+  double lastValuesList[ 2 * SIM_CHANNELS_MAX_NUMBER ];
+  // Driver (loaded task) state
+  bool isLoaded;
+  bool isRunning;
+  double startTime;
+  uint64_t readSamplesCount;
+  unsigned int readChannelsList[ SIM_CHANNELS_MAX_NUMBER ];
+  uInt32 readChannelsNumber;
+  uint64_t writtenSamplesCount;
+  uInt32 bufferLength;
+  int32 regenMode;
+  char clockSource[ SIM_NAME_MAX_LENGTH ];
+}
+SimTaskData;
+
+typedef SimTaskData* SimTask;
+
+static SimTaskData tasksList[ SIM_TASKS_MAX_NUMBER ];
+static size_t tasksNumber = 0;
+
+static double GetSimTime( void )
+{
+  struct timespec currentTime;
+  clock_gettime( CLOCK_MONOTONIC, &currentTime );
+  return currentTime.tv_sec + currentTime.tv_nsec / 1e9;
+}
+
+static void WaitSimTime( double time )
+{
+  double delay = time - GetSimTime();
+  if( delay <= 0.0 ) return;
+  struct timespec delayTime = { (time_t) delay, (long) ( fmod( delay, 1.0 ) * 1e9 ) };
+  nanosleep( &delayTime, NULL );
+}
+
+static SimTask FindTask( const char* name )
+{
+  for( size_t taskIndex = 0; taskIndex < tasksNumber; taskIndex++ )
+  {
+    if( strcmp( tasksList[ taskIndex ].name, name ) == 0 ) return &(tasksList[ taskIndex ]);
+  }
+  
+  return NULL;
+}
+
+static bool IsInputTask( SimTask task )
+{
+  return ( task->type == SIM_TASK_ANALOG_INPUT || task->type == SIM_TASK_CHANGE_DETECTION );
+}
+
+static double GetDefaultSignal( unsigned int channel, uint64_t sampleIndex )
+{
+  return (double) channel;
+}
+
+// Samples generated since start (input) or written samples already generated (clocked output)
+static uint64_t GetGeneratedSamplesCount( SimTask task )
+{
+  if( !task->isRunning || task->samplingRate <= 0.0 ) return 0;
+  
+  return (uint64_t) floor( ( GetSimTime() - task->startTime ) * task->samplingRate );
+}
+
+static void GetChannelName( SimTask task, uInt32 channel, char* buffer, size_t bufferSize )
+{
+  const char* prefixesList[ SIM_TASK_TYPES_NUMBER ] = { "ai", "ao", "ctr", "port0/line" };
+  snprintf( buffer, bufferSize, "%s/%s%u", task->name, prefixesList[ task->type ], channel );
+}
+
+static void StoreLastValues( SimTask task, const double* valuesList, size_t valuesNumber )
+{
+  if( valuesNumber > 2 * SIM_CHANNELS_MAX_NUMBER ) valuesNumber = 2 * SIM_CHANNELS_MAX_NUMBER;
+  pthread_mutex_lock( &(task->valuesLock) );
+  memcpy( task->lastValuesList, valuesList, valuesNumber * sizeof(double) );
+  pthread_mutex_unlock( &(task->valuesLock) );
+  atomic_fetch_add( &(task->updatesCount), 1 );
+}
+
+bool SimDAQmx_AddTask( const char* name, int type, uInt32 channelsNumber, double samplingRate )
+{
+  if( tasksNumber >= SIM_TASKS_MAX_NUMBER || FindTask( name ) != NULL ) return false;
+  if( type < 0 || type >= SIM_TASK_TYPES_NUMBER || channelsNumber == 0 || channelsNumber > SIM_CHANNELS_MAX_NUMBER ) return false;
+  
+  SimTask newTask = &(tasksList[ tasksNumber++ ]);
+  memset( newTask, 0, sizeof(SimTaskData) );
+  snprintf( newTask->name, SIM_NAME_MAX_LENGTH, "%s", name );
+  newTask->type = type;
+  newTask->channelsNumber = channelsNumber;
+  newTask->samplingRate = ( type == SIM_TASK_COUNTER_OUTPUT ) ? 0.0 : samplingRate;
+  newTask->signalFunction = GetDefaultSignal;
+  atomic_init( &(newTask->startsCount), 0 );
+  atomic_init( &(newTask->updatesCount), 0 );
+  pthread_mutex_init( &(newTask->valuesLock), NULL );
+  
+  return true;
+}
+
+void SimDAQmx_SetSignal( const char* name, SimSignalFunction signalFunction )
+{
+  SimTask task = FindTask( name );
+  if( task != NULL ) task->signalFunction = ( signalFunction != NULL ) ? signalFunction : GetDefaultSignal;
+}
+
+void SimDAQmx_SetStartError( const char* name, int32 errorCode )
+{
+  SimTask task = FindTask( name );
+  if( task != NULL ) task->startError = errorCode;
+}
+
+uint64_t SimDAQmx_GetStartsCount( const char* name )
+{
+  SimTask task = FindTask( name );
+  return ( task != NULL ) ? atomic_load( &(task->startsCount) ) : 0;
+}
+
+uint64_t SimDAQmx_GetUpdatesCount( const char* name )
+{
+  SimTask task = FindTask( name );
+  return ( task != NULL ) ? atomic_load( &(task->updatesCount) ) : 0;
+}
+
+bool SimDAQmx_GetLastValues( const char* name, double* valuesList )
+{
+  SimTask task = FindTask( name );
+  if( task == NULL || IsInputTask( task ) ) return false;
+  
+  size_t valuesNumber = ( task->type == SIM_TASK_COUNTER_OUTPUT ) ? 2 * task->channelsNumber : task->channelsNumber;
+  pthread_mutex_lock( &(task->valuesLock) );
+  memcpy( valuesList, task->lastValuesList, valuesNumber * sizeof(double) );
+  pthread_mutex_unlock( &(task->valuesLock) );
+  
+  return true;
+}
+
+void SimDAQmx_RemoveTasks( void )
+{
+  for( size_t taskIndex = 0; taskIndex < tasksNumber; taskIndex++ )
+    pthread_mutex_destroy( &(tasksList[ taskIndex ].valuesLock) );
+  tasksNumber = 0;
+}
+
+int32 DAQmxLoadTask( const char* taskName, TaskHandle* taskHandle )
+{
+  SimTask task = FindTask( taskName );
+  if( task == NULL || task->isLoaded ) return DAQmxErrorInvalidTask;
+  
+  task->isLoaded = true;
+  task->isRunning = false;
+  task->readChannelsNumber = task->channelsNumber;
+  for( uInt32 channel = 0; channel < task->channelsNumber; channel++ )
+    task->readChannelsList[ channel ] = channel;
+  task->bufferLength = 0;
+  task->regenMode = DAQmx_Val_AllowRegen;
+  snprintf( task->clockSource, SIM_NAME_MAX_LENGTH, "OnboardClock" );
+  
+  *taskHandle = (TaskHandle) task;
+  
+  return 0;
+}
+
+int32 DAQmxClearTask( TaskHandle taskHandle )
+{
+  SimTask task = (SimTask) taskHandle;
+  if( task == NULL || !task->isLoaded ) return DAQmxErrorInvalidTask;
+  
+  task->isRunning = false;
+  task->isLoaded = false;
+  
+  return 0;
+}
+
+int32 DAQmxStartTask( TaskHandle taskHandle )
+{
+  SimTask task = (SimTask) taskHandle;
+  if( task == NULL || !task->isLoaded ) return DAQmxErrorInvalidTask;
+  if( task->startError < 0 ) return task->startError;
+  
+  task->isRunning = true;
+  task->startTime = GetSimTime();
+  task->readSamplesCount = 0;
+  atomic_fetch_add( &(task->startsCount), 1 );
+  
+  return 0;
+}
+
+int32 DAQmxStopTask( TaskHandle taskHandle )
+{
+  SimTask task = (SimTask) taskHandle;
+  if( task == NULL || !task->isLoaded ) return DAQmxErrorInvalidTask;
+  
+  // Pending (not yet generated) output samples are discarded
+  task->isRunning = false;
+  task->writtenSamplesCount = 0;
+  
+  return 0;
+}
+
+int32 DAQmxTaskControl( TaskHandle taskHandle, int32 action )
+{
+  SimTask task = (SimTask) taskHandle;
+  return ( task != NULL && task->isLoaded ) ? 0 : DAQmxErrorInvalidTask;
+}
+
+int32 DAQmxGetTaskAttribute( TaskHandle taskHandle, int32 attribute, void* value, ... )
+{
+  SimTask task = (SimTask) taskHandle;
+  if( task == NULL || attribute != DAQmx_Task_NumChans ) return DAQmxErrorInvalidAttributeValue;
+  
+  *((uInt32*) value) = task->channelsNumber;
+  
+  return 0;
+}
+
+int32 DAQmxGetReadAttribute( TaskHandle taskHandle, int32 attribute, void* value, ... )
+{
+  SimTask task = (SimTask) taskHandle;
+  if( task == NULL || attribute != DAQmx_Read_NumChans ) return DAQmxErrorInvalidAttributeValue;
+  
+  *((uInt32*) value) = IsInputTask( task ) ? task->readChannelsNumber : 0;
+  
+  return 0;
+}
+
+int32 DAQmxGetNthTaskChannel( TaskHandle taskHandle, uInt32 index, char buffer[], int32 bufferSize )
+{
+  SimTask task = (SimTask) taskHandle;
+  if( task == NULL || index == 0 || index > task->channelsNumber ) return DAQmxErrorInvalidAttributeValue;
+  
+  GetChannelName( task, index - 1, buffer, (size_t) bufferSize );
+  
+  return 0;
+}
+
+int32 DAQmxGetNthTaskDevice( TaskHandle taskHandle, uInt32 index, char buffer[], int32 bufferSize )
+{
+  SimTask task = (SimTask) taskHandle;
+  if( task == NULL || index != 1 ) return DAQmxErrorInvalidAttributeValue;
+  
+  snprintf( buffer, (size_t) bufferSize, "%s", task->name );
+  
+  return 0;
+}
+
+int32 DAQmxGetChanType( TaskHandle taskHandle, const char channel[], int32* data )
+{
+  SimTask task = (SimTask) taskHandle;
+  if( task == NULL ) return DAQmxErrorInvalidTask;
+  
+  const int32 channelTypesList[ SIM_TASK_TYPES_NUMBER ] = { DAQmx_Val_AI, DAQmx_Val_AO, DAQmx_Val_CO, DAQmx_Val_DI };
+  *data = channelTypesList[ task->type ];
+  
+  return 0;
+}
+
+int32 DAQmxGetErrorString( int32 errorCode, char errorString[], uInt32 bufferSize )
+{
+  snprintf( errorString, bufferSize, "simulated driver error %d", (int) errorCode );
+  
+  return 0;
+}
+
+int32 DAQmxGetSampClkRate( TaskHandle taskHandle, float64* data )
+{
+  SimTask task = (SimTask) taskHandle;
+  if( task == NULL || task->samplingRate <= 0.0 || task->type == SIM_TASK_CHANGE_DETECTION ) return DAQmxErrorInvalidAttributeValue;
+  
+  *data = task->samplingRate;
+  
+  return 0;
+}
+
+int32 DAQmxGetSampTimingType( TaskHandle taskHandle, int32* data )
+{
+  SimTask task = (SimTask) taskHandle;
+  if( task == NULL ) return DAQmxErrorInvalidTask;
+  
+  if( task->type == SIM_TASK_CHANGE_DETECTION ) *data = DAQmx_Val_ChangeDetection;
+  else *data = ( task->samplingRate > 0.0 ) ? DAQmx_Val_SampClk : DAQmx_Val_OnDemand;
+  
+  return 0;
+}
+
+int32 DAQmxGetSampClkSrc( TaskHandle taskHandle, char* data, uInt32 bufferSize )
+{
+  SimTask task = (SimTask) taskHandle;
+  if( task == NULL ) return DAQmxErrorInvalidTask;
+  
+  snprintf( data, bufferSize, "%s", task->clockSource );
+  
+  return 0;
+}
+
+int32 DAQmxSetSampClkSrc( TaskHandle taskHandle, const char* data )
+{
+  SimTask task = (SimTask) taskHandle;
+  if( task == NULL ) return DAQmxErrorInvalidTask;
+  
+  snprintf( task->clockSource, SIM_NAME_MAX_LENGTH, "%s", data );
+  
+  return 0;
+}
+
+int32 DAQmxCfgDigEdgeStartTrig( TaskHandle taskHandle, const char triggerSource[], int32 triggerEdge )
+{
+  return ( taskHandle != NULL ) ? 0 : DAQmxErrorInvalidTask;
+}
+
+int32 DAQmxDisableStartTrig( TaskHandle taskHandle )
+{
+  return ( taskHandle != NULL ) ? 0 : DAQmxErrorInvalidTask;
+}
+
+// Channels are given as a comma separated list of the names returned by DAQmxGetNthTaskChannel
+int32 DAQmxSetReadChannelsToRead( TaskHandle taskHandle, const char* data )
+{
+  SimTask task = (SimTask) taskHandle;
+  if( task == NULL || !IsInputTask( task ) ) return DAQmxErrorInvalidTask;
+  
+  uInt32 readChannelsNumber = 0;
+  char channelName[ SIM_NAME_MAX_LENGTH ];
+  while( *data != '\0' )
+  {
+    size_t nameLength = strcspn( data, "," );
+    uInt32 channel = 0;
+    for( ; channel < task->channelsNumber; channel++ )
+    {
+      GetChannelName( task, channel, channelName, SIM_NAME_MAX_LENGTH );
+      if( strlen( channelName ) == nameLength && strncmp( channelName, data, nameLength ) == 0 ) break;
+    }
+    if( channel == task->channelsNumber ) return DAQmxErrorInvalidAttributeValue;
+    task->readChannelsList[ readChannelsNumber++ ] = channel;
+    data += nameLength;
+    if( *data == ',' ) data++;
+  }
+  task->readChannelsNumber = readChannelsNumber;
+  
+  return 0;
+}
+
+int32 DAQmxGetReadAvailSampPerChan( TaskHandle taskHandle, uInt32* data )
+{
+  SimTask task = (SimTask) taskHandle;
+  if( task == NULL || !IsInputTask( task ) ) return DAQmxErrorInvalidTask;
+  
+  *data = (uInt32) ( GetGeneratedSamplesCount( task ) - task->readSamplesCount );
+  
+  return 0;
+}
+
+int32 DAQmxGetReadDigitalLinesBytesPerChan( TaskHandle taskHandle, uInt32* data )
+{
+  SimTask task = (SimTask) taskHandle;
+  if( task == NULL || task->type != SIM_TASK_CHANGE_DETECTION ) return DAQmxErrorInvalidTask;
+  
+  *data = 1;
+  
+  return 0;
+}
+
+// Reads block until the requested samples are due (infinite timeouts included: tests stop tasks from the reading thread)
+int32 DAQmxReadAnalogF64( TaskHandle taskHandle, int32 numSampsPerChan, float64 timeout, bool32 fillMode, float64 readArray[], 
+                          uInt32 arraySizeInSamps, int32* sampsPerChanRead, bool32* reserved )
+{
+  SimTask task = (SimTask) taskHandle;
+  *sampsPerChanRead = 0;
+  if( task == NULL || task->type != SIM_TASK_ANALOG_INPUT || !task->isRunning ) return DAQmxErrorInvalidTask;
+  if( numSampsPerChan <= 0 || (uInt32) numSampsPerChan * task->readChannelsNumber > arraySizeInSamps ) return DAQmxErrorInvalidAttributeValue;
+  
+  WaitSimTime( task->startTime + ( task->readSamplesCount + numSampsPerChan ) / task->samplingRate );
+  
+  for( int32 sample = 0; sample < numSampsPerChan; sample++ )
+  {
+    for( uInt32 channelIndex = 0; channelIndex < task->readChannelsNumber; channelIndex++ )
+    {
+      double value = task->signalFunction( task->readChannelsList[ channelIndex ], task->readSamplesCount + sample );
+      if( fillMode == DAQmx_Val_GroupByScanNumber ) readArray[ sample * task->readChannelsNumber + channelIndex ] = value;
+      else readArray[ channelIndex * numSampsPerChan + sample ] = value;
+    }
+  }
+  task->readSamplesCount += numSampsPerChan;
+  *sampsPerChanRead = numSampsPerChan;
+  
+  return 0;
+}
+
+// Change detection samples are taken at the task rate, and only the ones with some line changed are returned
+int32 DAQmxReadDigitalLines( TaskHandle taskHandle, int32 numSampsPerChan, float64 timeout, bool32 fillMode, uInt8 readArray[], 
+                             uInt32 arraySizeInBytes, int32* sampsPerChanRead, int32* numBytesPerSamp, bool32* reserved )
+{
+  SimTask task = (SimTask) taskHandle;
+  *sampsPerChanRead = 0;
+  *numBytesPerSamp = 1;
+  if( task == NULL || task->type != SIM_TASK_CHANGE_DETECTION || !task->isRunning ) return DAQmxErrorInvalidTask;
+  
+  double timeoutTime = GetSimTime() + timeout;
+  while( *sampsPerChanRead < numSampsPerChan )
+  {
+    uint64_t samplesCount = GetGeneratedSamplesCount( task );
+    for( ; task->readSamplesCount < samplesCount && *sampsPerChanRead < numSampsPerChan; task->readSamplesCount++ )
+    {
+      bool isChanged = ( task->readSamplesCount == 0 );
+      uInt8* linesList = readArray + *sampsPerChanRead * task->readChannelsNumber;
+      for( uInt32 channelIndex = 0; channelIndex < task->readChannelsNumber; channelIndex++ )
+      {
+        unsigned int channel = task->readChannelsList[ channelIndex ];
+        linesList[ channelIndex ] = ( task->signalFunction( channel, task->readSamplesCount ) >= 0.5 ) ? 1 : 0;
+        if( task->readSamplesCount > 0 && ( task->signalFunction( channel, task->readSamplesCount - 1 ) >= 0.5 ) != linesList[ channelIndex ] ) isChanged = true;
+      }
+      if( isChanged ) (*sampsPerChanRead)++;
+    }
+    if( *sampsPerChanRead > 0 || GetSimTime() >= timeoutTime ) break;
+    WaitSimTime( task->startTime + ( task->readSamplesCount + 1 ) / task->samplingRate );
+  }
+  
+  return ( *sampsPerChanRead > 0 ) ? 0 : DAQmxErrorSamplesNotYetAvailable;
+}
+
+int32 DAQmxCfgOutputBuffer( TaskHandle taskHandle, uInt32 numSampsPerChan )
+{
+  SimTask task = (SimTask) taskHandle;
+  if( task == NULL || IsInputTask( task ) ) return DAQmxErrorInvalidTask;
+  
+  task->bufferLength = numSampsPerChan;
+  
+  return 0;
+}
+
+int32 DAQmxSetWriteRegenMode( TaskHandle taskHandle, int32 data )
+{
+  SimTask task = (SimTask) taskHandle;
+  if( task == NULL || IsInputTask( task ) ) return DAQmxErrorInvalidTask;
+  
+  task->regenMode = data;
+  
+  return 0;
+}
+
+// Clocked writes block until the buffer has room for them (the device generates written samples at the task rate). 
+// Last values are the ones of the last written frame
+int32 DAQmxWriteAnalogF64( TaskHandle taskHandle, int32 numSampsPerChan, bool32 autoStart, float64 timeout, bool32 dataLayout, 
+                           const float64 writeArray[], int32* sampsPerChanWritten, bool32* reserved )
+{
+  SimTask task = (SimTask) taskHandle;
+  *sampsPerChanWritten = 0;
+  if( task == NULL || task->type != SIM_TASK_ANALOG_OUTPUT || numSampsPerChan <= 0 ) return DAQmxErrorInvalidTask;
+  
+  double lastFrame[ SIM_CHANNELS_MAX_NUMBER ];
+  for( uInt32 channel = 0; channel < task->channelsNumber; channel++ )
+  {
+    if( dataLayout == DAQmx_Val_GroupByScanNumber ) lastFrame[ channel ] = writeArray[ ( numSampsPerChan - 1 ) * task->channelsNumber + channel ];
+    else lastFrame[ channel ] = writeArray[ channel * numSampsPerChan + numSampsPerChan - 1 ];
+  }
+  
+  if( task->samplingRate > 0.0 && task->regenMode == DAQmx_Val_DoNotAllowRegen )
+  {
+    uInt32 bufferLength = ( task->bufferLength > 0 ) ? task->bufferLength : (uInt32) numSampsPerChan;
+    if( (uInt32) numSampsPerChan > bufferLength ) return DAQmxErrorNoMoreSpace;
+    if( !task->isRunning && task->writtenSamplesCount + numSampsPerChan > bufferLength ) return DAQmxErrorNoMoreSpace;
+    if( task->isRunning ) 
+      WaitSimTime( task->startTime + ( (double) ( task->writtenSamplesCount + numSampsPerChan ) - bufferLength ) / task->samplingRate );
+    task->writtenSamplesCount += numSampsPerChan;
+  }
+  
+  StoreLastValues( task, lastFrame, task->channelsNumber );
+  *sampsPerChanWritten = numSampsPerChan;
+  
+  return 0;
+}
+
+int32 DAQmxWriteCtrFreq( TaskHandle taskHandle, int32 numSampsPerChan, bool32 autoStart, float64 timeout, bool32 dataLayout, 
+                         const float64 frequency[], const float64 dutyCycle[], int32* numSampsPerChanWritten, bool32* reserved )
+{
+  SimTask task = (SimTask) taskHandle;
+  *numSampsPerChanWritten = 0;
+  if( task == NULL || task->type != SIM_TASK_COUNTER_OUTPUT || numSampsPerChan != 1 ) return DAQmxErrorInvalidTask;
+  
+  // Stored as the plugin channels: (duty cycle, frequency) per counter
+  double valuesList[ 2 * SIM_CHANNELS_MAX_NUMBER ];
+  for( uInt32 counter = 0; counter < task->channelsNumber; counter++ )
+  {
+    if( dutyCycle[ counter ] <= 0.0 || dutyCycle[ counter ] >= 1.0 || frequency[ counter ] <= 0.0 ) return DAQmxErrorInvalidAttributeValue;
+    valuesList[ 2 * counter ] = dutyCycle[ counter ];
+    valuesList[ 2 * counter + 1 ] = frequency[ counter ];
+  }
+  
+  StoreLastValues( task, valuesList, 2 * task->channelsNumber );
+  *numSampsPerChanWritten = 1;
+  
+  return 0;
+}
+
+int32 DAQmxGetCOPulseFreq( TaskHandle taskHandle, const char channel[], float64* data )
+{
+  SimTask task = (SimTask) taskHandle;
+  if( task == NULL || task->type != SIM_TASK_COUNTER_OUTPUT ) return DAQmxErrorInvalidTask;
+  
+  *data = SIM_COUNTER_FREQUENCY_DEFAULT;
+  
+  return 0;
+}
+
+int32 DAQmxGetCOPulseDutyCyc( TaskHandle taskHandle, const char channel[], float64* data )
+{
+  SimTask task = (SimTask) taskHandle;
+  if( task == NULL || task->type != SIM_TASK_COUNTER_OUTPUT ) return DAQmxErrorInvalidTask;
+  
+  *data = SIM_COUNTER_DUTY_CYCLE_DEFAULT;
+  
+  return 0;
+}
@@ -0,0 +1,51 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2019 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of Signal-IO-NIDAQmx.                                   //
+//                                                                            //
+//  Signal-IO-NIDAQmx is free software: you can redistribute it and/or modify //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  Signal-IO-NIDAQmx is distributed in the hope that it will be useful,      //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with Signal-IO-NIDAQmx. If not, see <http://www.gnu.org/licenses/>. //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+/// @file daqmx_simulator.h
+/// @brief Control of the NI-DAQmx driver simulator the plugin tests link against (see NIDAQmx.h)
+///
+/// Tasks are defined by name before the plugin loads them. Clocked input tasks produce samples of a signal function
+/// in real time (reads block until the requested samples are due), and output tasks keep the count and last values of their updates
+
+#ifndef DAQMX_SIMULATOR_H
+#define DAQMX_SIMULATOR_H
+
+#include <NIDAQmx.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+enum { SIM_TASK_ANALOG_INPUT, SIM_TASK_ANALOG_OUTPUT, SIM_TASK_COUNTER_OUTPUT, SIM_TASK_CHANGE_DETECTION, SIM_TASK_TYPES_NUMBER };
+
+typedef double (*SimSignalFunction)( unsigned int channel, uint64_t sampleIndex );   ///< Input channel value at given sample
+
+bool SimDAQmx_AddTask( const char* name, int type, uInt32 channelsNumber, double samplingRate );
+void SimDAQmx_SetSignal( const char* name, SimSignalFunction signalFunction );
+void SimDAQmx_SetStartError( const char* name, int32 errorCode );
+uint64_t SimDAQmx_GetStartsCount( const char* name );
+uint64_t SimDAQmx_GetUpdatesCount( const char* name );
+bool SimDAQmx_GetLastValues( const char* name, double* valuesList );
+void SimDAQmx_RemoveTasks( void );
+
+#endif // DAQMX_SIMULATOR_H
@@ -0,0 +1,113 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2019 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of Signal-IO-NIDAQmx.                                   //
+//                                                                            //
+//  Signal-IO-NIDAQmx is free software: you can redistribute it and/or modify //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  Signal-IO-NIDAQmx is distributed in the hope that it will be useful,      //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with Signal-IO-NIDAQmx. If not, see <http://www.gnu.org/licenses/>. //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+/// @file threads/khash.h
+/// @brief Minimal stand-in for the khash integer keyed maps (and string hash) used by the plugin (tests only)
+///
+/// Open addressing with linear probing. Only the khash macros the plugin calls are provided
+
+#ifndef KHASH_H
+#define KHASH_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+typedef uint32_t khint_t;
+
+enum { KH_SLOT_EMPTY, KH_SLOT_USED, KH_SLOT_DELETED };
+
+static inline khint_t kh_str_hash_func( const char* key )
+{
+  khint_t hash = (khint_t) *key;
+  if( hash != 0 ) for( ++key ; *key != '\0'; ++key ) hash = ( hash << 5 ) - hash + (khint_t) *key;
+  return hash;
+}
+
+#define KHASH_MAP_INIT_INT( name, khval_t ) \
+  typedef struct { khint_t n_buckets, size, used; uint8_t* flags; int32_t* keys; khval_t* vals; } kh_##name##_t; \
+  static inline kh_##name##_t* kh_init_##name( void ) { return (kh_##name##_t*) calloc( 1, sizeof(kh_##name##_t) ); } \
+  static inline void kh_destroy_##name( kh_##name##_t* h ) \
+  { \
+    if( h == NULL ) return; \
+    free( h->flags ); free( h->keys ); free( h->vals ); free( h ); \
+  } \
+  static inline khint_t kh_get_##name( const kh_##name##_t* h, int32_t key ) \
+  { \
+    if( h->n_buckets == 0 ) return 0; \
+    khint_t index = (khint_t) key % h->n_buckets; \
+    for( khint_t step = 0; step < h->n_buckets; step++, index = ( index + 1 ) % h->n_buckets ) \
+    { \
+      if( h->flags[ index ] == KH_SLOT_EMPTY ) break; \
+      if( h->flags[ index ] == KH_SLOT_USED && h->keys[ index ] == key ) return index; \
+    } \
+    return h->n_buckets; \
+  } \
+  static inline void kh_resize_##name( kh_##name##_t* h, khint_t n_buckets ) \
+  { \
+    kh_##name##_t old = *h; \
+    h->n_buckets = n_buckets; h->size = h->used = 0; \
+    h->flags = (uint8_t*) calloc( n_buckets, sizeof(uint8_t) ); \
+    h->keys = (int32_t*) calloc( n_buckets, sizeof(int32_t) ); \
+    h->vals = (khval_t*) calloc( n_buckets, sizeof(khval_t) ); \
+    for( khint_t index = 0; index < old.n_buckets; index++ ) \
+    { \
+      if( old.flags[ index ] != KH_SLOT_USED ) continue; \
+      khint_t newIndex = (khint_t) old.keys[ index ] % n_buckets; \
+      while( h->flags[ newIndex ] == KH_SLOT_USED ) newIndex = ( newIndex + 1 ) % n_buckets; \
+      h->flags[ newIndex ] = KH_SLOT_USED; h->keys[ newIndex ] = old.keys[ index ]; h->vals[ newIndex ] = old.vals[ index ]; \
+      h->size++; h->used++; \
+    } \
+    free( old.flags ); free( old.keys ); free( old.vals ); \
+  } \
+  static inline khint_t kh_put_##name( kh_##name##_t* h, int32_t key, int* ref_status ) \
+  { \
+    if( 2 * ( h->used + 1 ) > h->n_buckets ) kh_resize_##name( h, ( h->n_buckets < 8 ) ? 16 : 2 * h->n_buckets ); \
+    khint_t index = kh_get_##name( h, key ); \
+    if( index != h->n_buckets ) { *ref_status = 0; return index; } \
+    index = (khint_t) key % h->n_buckets; \
+    while( h->flags[ index ] == KH_SLOT_USED ) index = ( index + 1 ) % h->n_buckets; \
+    if( h->flags[ index ] == KH_SLOT_EMPTY ) h->used++; \
+    h->flags[ index ] = KH_SLOT_USED; h->keys[ index ] = key; h->size++; \
+    *ref_status = 1; \
+    return index; \
+  } \
+  static inline void kh_del_##name( kh_##name##_t* h, khint_t index ) \
+  { \
+    if( index >= h->n_buckets || h->flags[ index ] != KH_SLOT_USED ) return; \
+    h->flags[ index ] = KH_SLOT_DELETED; h->size--; \
+  }
+
+#define khash_t( name ) kh_##name##_t
+#define kh_init( name ) kh_init_##name()
+#define kh_destroy( name, h ) kh_destroy_##name( h )
+#define kh_put( name, h, k, r ) kh_put_##name( h, k, r )
+#define kh_get( name, h, k ) kh_get_##name( h, k )
+#define kh_del( name, h, k ) kh_del_##name( h, k )
+#define kh_exist( h, x ) ( (h)->flags[ x ] == KH_SLOT_USED )
+#define kh_key( h, x ) ( (h)->keys[ x ] )
+#define kh_value( h, x ) ( (h)->vals[ x ] )
+#define kh_begin( h ) (khint_t) ( 0 )
+#define kh_end( h ) ( (h)->n_buckets )
+#define kh_size( h ) ( (h)->size )
+
+#endif // KHASH_H
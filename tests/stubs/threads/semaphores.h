@@ -0,0 +1,41 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2019 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of Signal-IO-NIDAQmx.                                   //
+//                                                                            //
+//  Signal-IO-NIDAQmx is free software: you can redistribute it and/or modify //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  Signal-IO-NIDAQmx is distributed in the hope that it will be useful,      //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with Signal-IO-NIDAQmx. If not, see <http://www.gnu.org/licenses/>. //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+/// @file threads/semaphores.h
+/// @brief Minimal POSIX stand-in for the semaphores submodule API used by the plugin (tests only)
+
+#ifndef SEMAPHORES_H
+#define SEMAPHORES_H
+
+#include <stddef.h>
+
+typedef struct _SemaphoreData* Semaphore;   ///< Opaque counting semaphore handle
+
+Semaphore Sem_Create( size_t, size_t );
+void Sem_Discard( Semaphore );
+void Sem_Increment( Semaphore );
+void Sem_Decrement( Semaphore );
+size_t Sem_GetCount( Semaphore );
+void Sem_SetCount( Semaphore, size_t );
+
+#endif // SEMAPHORES_H
@@ -0,0 +1,42 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2019 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of Signal-IO-NIDAQmx.                                   //
+//                                                                            //
+//  Signal-IO-NIDAQmx is free software: you can redistribute it and/or modify //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  Signal-IO-NIDAQmx is distributed in the hope that it will be useful,      //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with Signal-IO-NIDAQmx. If not, see <http://www.gnu.org/licenses/>. //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+/// @file threads/threads.h
+/// @brief Minimal POSIX stand-in for the threads submodule API used by the plugin (tests only)
+
+#ifndef THREADS_H
+#define THREADS_H
+
+#include <stdint.h>
+
+#define THREAD_DETACHED 0               ///< Thread resources are released on exit
+#define THREAD_JOINABLE 1               ///< Thread resources are released when waited for
+
+#define THREAD_INVALID_HANDLE NULL      ///< Handle of threads not (successfully) started
+
+typedef void* Thread;                   ///< Opaque thread handle
+
+Thread Thread_Start( void* (*)( void* ), void*, int );
+uint32_t Thread_WaitExit( Thread, unsigned int );
+
+#endif // THREADS_H
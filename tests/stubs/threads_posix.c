@@ -0,0 +1,129 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2019 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of Signal-IO-NIDAQmx.                                   //
+//                                                                            //
+//  Signal-IO-NIDAQmx is free software: you can redistribute it and/or modify //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  Signal-IO-NIDAQmx is distributed in the hope that it will be useful,      //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with Signal-IO-NIDAQmx. If not, see <http://www.gnu.org/licenses/>. //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+// Minimal POSIX implementation of the threads submodule API used by the plugin (tests only)
+
+#include "threads/threads.h"
+#include "threads/semaphores.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+typedef struct _ThreadData
+{
+  pthread_t handle;
+  void* (*function)( void* );
+  void* args;
+}
+ThreadData;
+
+struct _SemaphoreData
+{
+  pthread_mutex_t mutex;
+  pthread_cond_t condition;
+  size_t count;
+  size_t maxCount;
+};
+
+Thread Thread_Start( void* (*function)( void* ), void* args, int mode )
+{
+  ThreadData* thread = (ThreadData*) malloc( sizeof(ThreadData) );
+  thread->function = function;
+  thread->args = args;
+  if( pthread_create( &(thread->handle), NULL, function, args ) != 0 )
+  {
+    free( thread );
+    return THREAD_INVALID_HANDLE;
+  }
+  
+  if( mode == THREAD_JOINABLE ) return (Thread) thread;
+  
+  pthread_detach( thread->handle );
+  free( thread );
+  return THREAD_INVALID_HANDLE;
+}
+
+// Joins with no timeout: tests would rather hang than leave threads using freed task data
+uint32_t Thread_WaitExit( Thread thread, unsigned int milliseconds )
+{
+  if( thread == THREAD_INVALID_HANDLE ) return 0;
+  
+  pthread_join( ((ThreadData*) thread)->handle, NULL );
+  free( thread );
+  
+  return 0;
+}
+
+Semaphore Sem_Create( size_t startCount, size_t maxCount )
+{
+  Semaphore semaphore = (Semaphore) malloc( sizeof(struct _SemaphoreData) );
+  pthread_mutex_init( &(semaphore->mutex), NULL );
+  pthread_cond_init( &(semaphore->condition), NULL );
+  semaphore->count = startCount;
+  semaphore->maxCount = maxCount;
+  
+  return semaphore;
+}
+
+void Sem_Discard( Semaphore semaphore )
+{
+  if( semaphore == NULL ) return;
+  
+  pthread_cond_destroy( &(semaphore->condition) );
+  pthread_mutex_destroy( &(semaphore->mutex) );
+  free( semaphore );
+}
+
+void Sem_Increment( Semaphore semaphore )
+{
+  pthread_mutex_lock( &(semaphore->mutex) );
+  if( semaphore->count < semaphore->maxCount ) semaphore->count++;
+  pthread_cond_signal( &(semaphore->condition) );
+  pthread_mutex_unlock( &(semaphore->mutex) );
+}
+
+void Sem_Decrement( Semaphore semaphore )
+{
+  pthread_mutex_lock( &(semaphore->mutex) );
+  while( semaphore->count == 0 ) pthread_cond_wait( &(semaphore->condition), &(semaphore->mutex) );
+  semaphore->count--;
+  pthread_mutex_unlock( &(semaphore->mutex) );
+}
+
+size_t Sem_GetCount( Semaphore semaphore )
+{
+  pthread_mutex_lock( &(semaphore->mutex) );
+  size_t count = semaphore->count;
+  pthread_mutex_unlock( &(semaphore->mutex) );
+  
+  return count;
+}
+
+void Sem_SetCount( Semaphore semaphore, size_t count )
+{
+  pthread_mutex_lock( &(semaphore->mutex) );
+  semaphore->count = ( count < semaphore->maxCount ) ? count : semaphore->maxCount;
+  pthread_cond_broadcast( &(semaphore->condition) );
+  pthread_mutex_unlock( &(semaphore->mutex) );
+}
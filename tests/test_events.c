@@ -0,0 +1,194 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2019 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of Signal-IO-NIDAQmx.                                   //
+//                                                                            //
+//  Signal-IO-NIDAQmx is free software: you can redistribute it and/or modify //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  Signal-IO-NIDAQmx is distributed in the hope that it will be useful,      //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with Signal-IO-NIDAQmx. If not, see <http://www.gnu.org/licenses/>. //
+//                                                                            //
+
+
+// Sample stream events over the simulated driver: client markers and line edges of change detection tasks
+
+#include "../ni_daqmx.c"
+
+#include "plugin_utils.h"
+
+#include <stdlib.h>
+#include <pthread.h>
+
+#define EDGES_HALF_PERIOD 20
+#define THREAD_MARKERS_NUMBER 200
+
+/// Line c toggles every EDGES_HALF_PERIOD * ( c + 1 ) samples
+static double GetSquareSignal( unsigned int channel, uint64_t sampleIndex )
+{
+  return (double) ( ( sampleIndex / ( EDGES_HALF_PERIOD * ( channel + 1 ) ) ) % 2 );
+}
+
+static int CompareTimes( const void* a, const void* b )
+{
+  double difference = *((const double*) a) - *((const double*) b);
+  return ( difference > 0.0 ) - ( difference < 0.0 );
+}
+
+typedef struct { SignalIOTaskHandle task; unsigned int code; } MarkerThreadData;
+
+// Places markers with given code and consecutive payloads, as fast as possible
+static void* MarkContinuously( void* data )
+{
+  MarkerThreadData* threadData = (MarkerThreadData*) data;
+  for( size_t markerIndex = 0; markerIndex < THREAD_MARKERS_NUMBER; markerIndex++ )
+    (void) Task_Mark( threadData->task, threadData->code, (double) markerIndex );
+  return NULL;
+}
+
+static void TestMarkers( void )
+{
+  SimDAQmx_AddTask( "SimMarked", SIM_TASK_ANALOG_INPUT, INPUT_CHANNELS_NUMBER, INPUT_SAMPLING_RATE );
+  SimDAQmx_SetSignal( "SimMarked", GetRampSignal );
+  
+  SignalIOTaskHandle task = Task_Open( "SimMarked" );
+  TEST_CHECK( task != NULL, "marked task not loaded" );
+  if( task == NULL ) return;
+  
+  TEST_CHECK( CheckInputChannel( task->taskID, 0 ), "input channel not acquired" );
+  TEST_CHECK( WaitSamples( task->taskID, 100 ), "no samples aquired" );
+  
+  // Markers take the sample position of the moment they are placed
+  uint64_t firstSamplesCount = atomic_load( &(task->samplesCount) );
+  TEST_CHECK( Task_Mark( task, 1, 0.5 ), "marker not placed" );
+  uint64_t lastSamplesCount = atomic_load( &(task->samplesCount) );
+  SignalIOMarker markersList[ 64 ];
+  uint64_t markersCursor = 0;
+  size_t markersNumber = ReadMarkers( task->taskID, &markersCursor, markersList, 64 );
+  TEST_CHECK( markersNumber == 1 && markersCursor == 1, "%zu markers read", markersNumber );
+  if( markersNumber == 1 )
+  {
+    TEST_CHECK( markersList[ 0 ].code == 1 && markersList[ 0 ].payload == 0.5, "marker read as %u (%g)", markersList[ 0 ].code, markersList[ 0 ].payload );
+    TEST_CHECK( markersList[ 0 ].sampleIndex >= firstSamplesCount && markersList[ 0 ].sampleIndex <= lastSamplesCount,
+                "marker placed at sample %lu, between %lu and %lu", (unsigned long) markersList[ 0 ].sampleIndex, 
+                (unsigned long) firstSamplesCount, (unsigned long) lastSamplesCount );
+  }
+  
+  // Readers only get the markers placed after their acquisition
+  SignalIOReaderHandle reader = Task_AcquireReader( task, 1, SIGNAL_IO_READER_DROP_OLDEST );
+  TEST_CHECK( reader != NULL, "reader not acquired" );
+  TEST_CHECK( Reader_ReadMarkers( reader, markersList, 64 ) == 0, "markers from before reader acquisition read" );
+  
+  // Markers placed concurrently are all read once, in order for each thread
+  MarkerThreadData threadsDataList[ 2 ] = { { task, 2 }, { task, 3 } };
+  pthread_t markerThreadsList[ 2 ];
+  for( size_t threadIndex = 0; threadIndex < 2; threadIndex++ )
+    pthread_create( &(markerThreadsList[ threadIndex ]), NULL, MarkContinuously, &(threadsDataList[ threadIndex ]) );
+  for( size_t threadIndex = 0; threadIndex < 2; threadIndex++ )
+    pthread_join( markerThreadsList[ threadIndex ], NULL );
+  
+  size_t threadMarkersCountsList[ 2 ] = { 0 }, wrongMarkersCount = 0;
+  uint64_t lastSampleIndexesList[ 2 ] = { 0 };
+  while( ( markersNumber = ReadMarkers( task->taskID, &markersCursor, markersList, 64 ) ) > 0 )
+  {
+    for( size_t markerIndex = 0; markerIndex < markersNumber; markerIndex++ )
+    {
+      SignalIOMarker* marker = &(markersList[ markerIndex ]);
+      size_t threadIndex = marker->code - 2;
+      if( threadIndex >= 2 )
+      {
+        wrongMarkersCount++;
+        continue;
+      }
+      if( marker->payload != (double) threadMarkersCountsList[ threadIndex ] || marker->sampleIndex < lastSampleIndexesList[ threadIndex ] ) wrongMarkersCount++;
+      lastSampleIndexesList[ threadIndex ] = marker->sampleIndex;
+      threadMarkersCountsList[ threadIndex ]++;
+    }
+  }
+  TEST_CHECK( threadMarkersCountsList[ 0 ] == THREAD_MARKERS_NUMBER && threadMarkersCountsList[ 1 ] == THREAD_MARKERS_NUMBER && wrongMarkersCount == 0, 
+              "%zu and %zu concurrent markers read, %zu wrong", threadMarkersCountsList[ 0 ], threadMarkersCountsList[ 1 ], wrongMarkersCount );
+  
+  size_t readerMarkersCount = 0;
+  while( ( markersNumber = Reader_ReadMarkers( reader, markersList, 64 ) ) > 0 )
+    readerMarkersCount += markersNumber;
+  TEST_CHECK( readerMarkersCount == 2 * THREAD_MARKERS_NUMBER, "%zu markers read by reader", readerMarkersCount );
+  
+  // Markers overwritten before being read are skipped, keeping the newest ones
+  for( size_t markerIndex = 0; markerIndex < RECORDER_MARKERS_NUMBER + 10; markerIndex++ )
+    (void) Task_Mark( task, 4, (double) markerIndex );
+  markersNumber = ReadMarkers( task->taskID, &markersCursor, markersList, 1 );
+  TEST_CHECK( markersNumber == 1 && markersList[ 0 ].code == 4 && markersList[ 0 ].payload == 10.0, "overwritten markers not skipped" );
+  
+  Reader_Release( reader );
+  ReleaseInputChannel( task->taskID, 0 );
+  Task_Close( task );
+}
+
+static void TestEdges( void )
+{
+  SimDAQmx_AddTask( "SimEdges", SIM_TASK_CHANGE_DETECTION, INPUT_CHANNELS_NUMBER, INPUT_SAMPLING_RATE );
+  SimDAQmx_SetSignal( "SimEdges", GetSquareSignal );
+  
+  SignalIOTaskHandle task = Task_Open( "SimEdges" );
+  TEST_CHECK( task != NULL, "change detection task not loaded" );
+  if( task == NULL ) return;
+  
+  TEST_CHECK( CheckInputChannel( task->taskID, 0 ) && CheckInputChannel( task->taskID, 1 ), "lines not acquired" );
+  
+  // Edges are read as they come, so their times follow the line period (and not the reads)
+  SignalIOEdge edgesList[ 64 ];
+  double intervalsList[ 64 ];
+  size_t edgesNumber = 0, intervalsNumber = 0, lateEdgesCount = 0, wrongEdgesCount = 0;
+  uint64_t edgesCursor = 0;
+  double timeoutTime = Test_GetTime() + WAIT_TIMEOUT;
+  while( edgesNumber < 16 && Test_GetTime() < timeoutTime )
+  {
+    size_t newEdgesNumber = ReadEdges( task->taskID, &edgesCursor, edgesList + edgesNumber, 16 - edgesNumber );
+    double readTime = GetMonotonicTime();
+    for( size_t edgeIndex = edgesNumber; edgeIndex < edgesNumber + newEdgesNumber; edgeIndex++ )
+    {
+      SignalIOEdge* edge = &(edgesList[ edgeIndex ]);
+      if( edge->time > readTime ) lateEdgesCount++;
+      if( edge->channel >= INPUT_CHANNELS_NUMBER ) wrongEdgesCount++;
+      for( size_t lastIndex = edgeIndex; lastIndex-- > 0; )
+      {
+        if( edgesList[ lastIndex ].channel != edge->channel ) continue;
+        if( edgesList[ lastIndex ].isRising == edge->isRising || edgesList[ lastIndex ].sampleIndex >= edge->sampleIndex ) wrongEdgesCount++;
+        if( edge->channel == 0 ) intervalsList[ intervalsNumber++ ] = edge->time - edgesList[ lastIndex ].time;
+        break;
+      }
+    }
+    edgesNumber += newEdgesNumber;
+    Test_Sleep( 0.001 );
+  }
+  TEST_CHECK( edgesNumber == 16 && wrongEdgesCount == 0, "%zu edges read, %zu wrong", edgesNumber, wrongEdgesCount );
+  TEST_CHECK( lateEdgesCount == 0, "%zu edges timed after being read", lateEdgesCount );
+  
+  // Median is taken, as the simulated driver runs on a shared CPU
+  qsort( intervalsList, intervalsNumber, sizeof(double), CompareTimes );
+  double period = EDGES_HALF_PERIOD / INPUT_SAMPLING_RATE;
+  double medianInterval = ( intervalsNumber > 0 ) ? intervalsList[ intervalsNumber / 2 ] : 0.0;
+  TEST_CHECK( fabs( medianInterval - period ) < period / 4, "edges %g s apart (lines toggle every %g s)", medianInterval, period );
+  
+  ReleaseInputChannel( task->taskID, 0 );
+  ReleaseInputChannel( task->taskID, 1 );
+  Task_Close( task );
+}
+
+int main( int argc, char* argv[] )
+{
+  TestMarkers();
+  TestEdges();
+  
+  SimDAQmx_RemoveTasks();
+  
+  return Test_End( "test_events" );
+}
@@ -0,0 +1,147 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2019 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of Signal-IO-NIDAQmx.                                   //
+//                                                                            //
+//  Signal-IO-NIDAQmx is free software: you can redistribute it and/or modify //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  Signal-IO-NIDAQmx is distributed in the hope that it will be useful,      //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with Signal-IO-NIDAQmx. If not, see <http://www.gnu.org/licenses/>. //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+// Virtual channel expressions: results against direct computation, constant folding and rejection of invalid expressions
+
+#include "signal_expressions.h"
+
+#include "test_utils.h"
+
+#include <math.h>
+
+#define CHANNELS_NUMBER 4
+#define ROWS_STRIDE 300
+#define SAMPLES_NUMBER 150    // More than 2 evaluation chunks, with a partial last one
+
+static double GetReferenceValue( size_t caseIndex, const double* c )
+{
+  switch( caseIndex )
+  {
+    case 0: return c[ 0 ];
+    case 1: return ( c[ 0 ] - c[ 1 ] ) * 0.5;
+    case 2: return c[ 0 ] + c[ 1 ] * c[ 2 ] - c[ 3 ] / 4.0;
+    case 3: return -( c[ 2 ] - -c[ 1 ] );
+    case 4: return 2.0 * 3.0 + c[ 3 ];
+    case 5: return 6.0 / ( 1.0 + 2.0 ) * c[ 0 ] * c[ 0 ];
+    case 6: return ( ( c[ 0 ] + 1.0 ) * ( c[ 1 ] - 1.0 ) ) / ( c[ 2 ] * c[ 2 ] + 1.0 );
+    case 7: return 1e-3 * c[ 3 ] - 2.5e2;
+    case 8: return -( 1.0 + 2.0 );
+    default: return c[ 0 ] - c[ 1 ] - c[ 2 ] - c[ 3 ];
+  }
+}
+
+static const struct { const char* text; size_t instructionsNumber; } VALID_CASES_LIST[] =
+{
+  { "[0]", 1 },
+  { "([0] - [1]) * 0.5", 5 },
+  { " [0]+[1]*[2] - [3]/4 ", 9 },
+  { "-([2] - -[1])", 5 },
+  { "2 * 3 + [3]", 3 },                         // Folded to 6 + [3]
+  { "6 / (1 + 2) * [0] * [0]", 5 },            // Folded to 2 * [0] * [0]
+  { "(([0] + 1) * ([1] - 1)) / ([2] * [2] + 1)", 13 },
+  { "1e-3 * [3] - 2.5e2", 5 },
+  { "-(1 + 2)", 1 },
+  { "[0] - [1] - [2] - [3]", 7 }                // Left associative
+};
+
+static void TestValidExpressions( void )
+{
+  static double rowsTable[ CHANNELS_NUMBER * ROWS_STRIDE ];
+  Test_FillRandom( rowsTable, CHANNELS_NUMBER * ROWS_STRIDE );
+  
+  double resultsList[ SAMPLES_NUMBER ];
+  double channelValuesList[ CHANNELS_NUMBER ];
+  const size_t START = 7;
+  for( size_t caseIndex = 0; caseIndex < sizeof(VALID_CASES_LIST) / sizeof(VALID_CASES_LIST[ 0 ]); caseIndex++ )
+  {
+    const char* text = VALID_CASES_LIST[ caseIndex ].text;
+    SignalExpression expression;
+    if( !Expression_Compile( text, strlen( text ), CHANNELS_NUMBER, &expression ) )
+    {
+      TEST_CHECK( false, "valid expression \"%s\" rejected", text );
+      continue;
+    }
+    TEST_CHECK( expression.instructionsNumber == VALID_CASES_LIST[ caseIndex ].instructionsNumber, "\"%s\" compiled to %zu instructions", 
+                text, expression.instructionsNumber );
+    
+    Expression_Evaluate( &expression, rowsTable, ROWS_STRIDE, START, SAMPLES_NUMBER, resultsList );
+    size_t mismatchesCount = 0;
+    for( size_t sampleIndex = 0; sampleIndex < SAMPLES_NUMBER; sampleIndex++ )
+    {
+      for( size_t channel = 0; channel < CHANNELS_NUMBER; channel++ )
+        channelValuesList[ channel ] = rowsTable[ channel * ROWS_STRIDE + START + sampleIndex ];
+      double referenceValue = GetReferenceValue( caseIndex, channelValuesList );
+      if( fabs( resultsList[ sampleIndex ] - referenceValue ) > 1e-12 * ( 1.0 + fabs( referenceValue ) ) ) mismatchesCount++;
+    }
+    TEST_CHECK( mismatchesCount == 0, "\"%s\": %zu wrong results", text, mismatchesCount );
+  }
+  
+  // Results may go to a channel row that is not an operand (as virtual channels do)
+  SignalExpression expression;
+  TEST_CHECK( Expression_Compile( "[0] * 2", 7, 3, &expression ), "valid expression rejected" );
+  Expression_Evaluate( &expression, rowsTable, ROWS_STRIDE, 0, SAMPLES_NUMBER, rowsTable + 3 * ROWS_STRIDE );
+  TEST_CHECK( rowsTable[ 3 * ROWS_STRIDE + SAMPLES_NUMBER - 1 ] == 2.0 * rowsTable[ SAMPLES_NUMBER - 1 ], "in place results" );
+  
+  TEST_CHECK( Expression_UsesChannel( &expression, 0 ) && !Expression_UsesChannel( &expression, 1 ), "used channels" );
+}
+
+static void TestInvalidExpressions( void )
+{
+  const char* INVALID_TEXTS_LIST[] = { "", " ", "[", "[]", "[0", "[4]", "[-1]", "[0.5]", "[0]+", "+", "*[0]", "([0]", "[0])", "()", 
+                                       "[0] [1]", "[0]*/2", "abc", "[0] + x", "2 ** [0]", "[0]|[1]" };
+  SignalExpression expression;
+  for( size_t textIndex = 0; textIndex < sizeof(INVALID_TEXTS_LIST) / sizeof(const char*); textIndex++ )
+  {
+    const char* text = INVALID_TEXTS_LIST[ textIndex ];
+    TEST_CHECK( !Expression_Compile( text, strlen( text ), CHANNELS_NUMBER, &expression ), "invalid expression \"%s\" accepted", text );
+  }
+  
+  // Only the given length is compiled, as expressions are taken from "|" separated task configurations
+  TEST_CHECK( Expression_Compile( "[1]|[2]", 3, CHANNELS_NUMBER, &expression ) && Expression_UsesChannel( &expression, 1 ) 
+              && !Expression_UsesChannel( &expression, 2 ), "expression length" );
+  TEST_CHECK( !Expression_Compile( "[1]|[2]", 2, CHANNELS_NUMBER, &expression ), "truncated expression accepted" );
+  
+  // Operands stack deeper than EXPRESSION_STACK_MAX_LENGTH (right nested sums)
+  char text[ 1024 ] = "";
+  for( size_t depth = 0; depth <= EXPRESSION_STACK_MAX_LENGTH; depth++ )
+    strcat( text, "[0]+(" );
+  strcat( text, "[1]" );
+  for( size_t depth = 0; depth <= EXPRESSION_STACK_MAX_LENGTH; depth++ )
+    strcat( text, ")" );
+  TEST_CHECK( !Expression_Compile( text, strlen( text ), CHANNELS_NUMBER, &expression ), "too deep expression accepted" );
+  
+  // More than EXPRESSION_MAX_INSTRUCTIONS instructions
+  strcpy( text, "[0]" );
+  for( size_t operation = 0; operation < EXPRESSION_MAX_INSTRUCTIONS / 2; operation++ )
+    strcat( text, "+[1]" );
+  TEST_CHECK( !Expression_Compile( text, strlen( text ), CHANNELS_NUMBER, &expression ), "too long expression accepted" );
+  TEST_CHECK( expression.instructionsNumber <= EXPRESSION_MAX_INSTRUCTIONS, "instructions overflow" );
+}
+
+int main( int argc, char* argv[] )
+{
+  TestValidExpressions();
+  TestInvalidExpressions();
+  
+  return Test_End( "test_expressions" );
+}
@@ -0,0 +1,288 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2019 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of Signal-IO-NIDAQmx.                                   //
+//                                                                            //
+//  Signal-IO-NIDAQmx is free software: you can redistribute it and/or modify //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  Signal-IO-NIDAQmx is distributed in the hope that it will be useful,      //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with Signal-IO-NIDAQmx. If not, see <http://www.gnu.org/licenses/>. //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+// Checks that every vectorized kernel variant supported here returns results bit-identical to the scalar one,
+// for all widths and lengths around the vector widths and unrolled blocks (tails and partial lanes included)
+
+#include "signal_kernels.h"
+
+#include "reference_kernels.h"
+#include "test_utils.h"
+
+#define MAX_WIDTH 19
+#define MAX_LENGTH 37
+#define MAX_FRAMES ( MAX_LENGTH + KERNEL_FILTER_MAX_WINDOW )
+
+static const char* VARIANT_NAMES[ KERNELS_VARIANTS_NUMBER ] = { "scalar", "SSE2", "AVX2", "AVX-512" };
+
+static SignalKernels scalarKernels;
+
+static void CheckDotProduct( SignalKernels* kernels )
+{
+  double aList[ 4 * MAX_LENGTH ], bList[ 4 * MAX_LENGTH ];
+  for( size_t length = 0; length <= 4 * MAX_LENGTH; length++ )
+  {
+    Test_FillRandom( aList, length );
+    Test_FillRandom( bList, length );
+    double scalarResult = scalarKernels.DotProduct( aList, bList, length );
+    double variantResult = kernels->DotProduct( aList, bList, length );
+    TEST_CHECK( Test_IsBitIdentical( &scalarResult, &variantResult, 1 ), "DotProduct length %zu: %.17g != %.17g", length, variantResult, scalarResult );
+  }
+}
+
+static void CheckDeinterleave( SignalKernels* kernels )
+{
+  double framesList[ MAX_FRAMES * MAX_WIDTH ], scalarRowList[ MAX_LENGTH ], variantRowList[ MAX_LENGTH ];
+  for( size_t framesStride = 1; framesStride <= MAX_WIDTH; framesStride++ )
+  {
+    for( size_t length = 0; length <= MAX_LENGTH; length++ )
+    {
+      Test_FillRandom( framesList, length * framesStride );
+      scalarKernels.Deinterleave( scalarRowList, framesList, framesStride, length );
+      kernels->Deinterleave( variantRowList, framesList, framesStride, length );
+      TEST_CHECK( Test_IsBitIdentical( scalarRowList, variantRowList, length ), "Deinterleave stride %zu length %zu", framesStride, length );
+    }
+  }
+}
+
+static void CheckFilterFrames( SignalKernels* kernels )
+{
+  double windowFramesList[ MAX_FRAMES * MAX_WIDTH ], thresholdsList[ MAX_WIDTH ];
+  double scalarFramesList[ MAX_LENGTH * MAX_WIDTH ], variantFramesList[ MAX_LENGTH * MAX_WIDTH ];
+  const double THRESHOLDS_LIST[] = { 0.0, 3.0, INFINITY, 1.0 };
+  for( size_t framesWidth = 1; framesWidth <= MAX_WIDTH; framesWidth++ )
+  {
+    for( size_t windowLength = 1; windowLength <= KERNEL_FILTER_MAX_WINDOW; windowLength++ )
+    {
+      for( size_t length = 1; length <= MAX_LENGTH; length += 3 )
+      {
+        // Median only filters (no Hampel thresholds) take a different path than mixed ones
+        bool isMedianOnly = ( length % 2 == 1 );
+        for( size_t lane = 0; lane < framesWidth; lane++ )
+          thresholdsList[ lane ] = isMedianOnly ? 0.0 : THRESHOLDS_LIST[ ( lane + length ) % 4 ];
+        Test_FillRandom( windowFramesList, ( length + windowLength - 1 ) * framesWidth );
+        scalarKernels.FilterFrames( scalarFramesList, windowFramesList, thresholdsList, framesWidth, windowLength, length );
+        kernels->FilterFrames( variantFramesList, windowFramesList, thresholdsList, framesWidth, windowLength, length );
+        TEST_CHECK( Test_IsBitIdentical( scalarFramesList, variantFramesList, length * framesWidth ), 
+                    "FilterFrames width %zu window %zu length %zu", framesWidth, windowLength, length );
+      }
+    }
+  }
+}
+
+static void CheckAccumulateTerms( SignalKernels* kernels )
+{
+  double framesList[ MAX_LENGTH * MAX_WIDTH ];
+  double scalarSumsList[ KERNEL_TERMS_NUMBER * MAX_WIDTH ], variantSumsList[ KERNEL_TERMS_NUMBER * MAX_WIDTH ];
+  double scalarTermsList[ MAX_LENGTH * KERNEL_TERMS_NUMBER * MAX_WIDTH ], variantTermsList[ MAX_LENGTH * KERNEL_TERMS_NUMBER * MAX_WIDTH ];
+  double scalarLastFramesList[ 2 * MAX_WIDTH ], variantLastFramesList[ 2 * MAX_WIDTH ];
+  for( size_t framesWidth = 1; framesWidth <= MAX_WIDTH; framesWidth++ )
+  {
+    for( size_t length = 1; length <= MAX_LENGTH; length += 2 )
+    {
+      double threshold = ( length % 3 == 0 ) ? 0.0 : 0.1;
+      size_t termsNumber = length * KERNEL_TERMS_NUMBER * framesWidth;
+      Test_FillRandom( framesList, length * framesWidth );
+      Test_FillRandom( scalarSumsList, KERNEL_TERMS_NUMBER * framesWidth );
+      Test_FillRandom( scalarTermsList, termsNumber );
+      Test_FillRandom( scalarLastFramesList, 2 * framesWidth );
+      memcpy( variantSumsList, scalarSumsList, sizeof(variantSumsList) );
+      memcpy( variantTermsList, scalarTermsList, sizeof(variantTermsList) );
+      memcpy( variantLastFramesList, scalarLastFramesList, sizeof(variantLastFramesList) );
+      scalarKernels.AccumulateTerms( scalarSumsList, scalarTermsList, scalarLastFramesList, framesList, framesWidth, length, threshold );
+      kernels->AccumulateTerms( variantSumsList, variantTermsList, variantLastFramesList, framesList, framesWidth, length, threshold );
+      TEST_CHECK( Test_IsBitIdentical( scalarSumsList, variantSumsList, KERNEL_TERMS_NUMBER * framesWidth ) 
+                  && Test_IsBitIdentical( scalarTermsList, variantTermsList, termsNumber )
+                  && Test_IsBitIdentical( scalarLastFramesList, variantLastFramesList, 2 * framesWidth ),
+                  "AccumulateTerms width %zu length %zu", framesWidth, length );
+    }
+  }
+}
+
+static void CheckUpdateMeans( SignalKernels* kernels )
+{
+  double valuesList[ 4 * MAX_LENGTH ];
+  double scalarMeansList[ 4 * MAX_LENGTH ], variantMeansList[ 4 * MAX_LENGTH ];
+  double scalarDeviationsList[ 4 * MAX_LENGTH ], variantDeviationsList[ 4 * MAX_LENGTH ];
+  for( size_t length = 0; length <= 4 * MAX_LENGTH; length++ )
+  {
+    Test_FillRandom( scalarMeansList, length );
+    Test_FillRandom( scalarDeviationsList, length );
+    memcpy( variantMeansList, scalarMeansList, length * sizeof(double) );
+    memcpy( variantDeviationsList, scalarDeviationsList, length * sizeof(double) );
+    for( double count = 1.0; count <= 7.0; count += 1.0 )
+    {
+      Test_FillRandom( valuesList, length );
+      scalarKernels.UpdateMeans( scalarMeansList, scalarDeviationsList, valuesList, length, count );
+      kernels->UpdateMeans( variantMeansList, variantDeviationsList, valuesList, length, count );
+    }
+    TEST_CHECK( Test_IsBitIdentical( scalarMeansList, variantMeansList, length ) 
+                && Test_IsBitIdentical( scalarDeviationsList, variantDeviationsList, length ), "UpdateMeans length %zu", length );
+  }
+}
+
+static void CheckCalibrateFrames( SignalKernels* kernels )
+{
+  double offsetsList[ MAX_WIDTH ];
+  double scalarFramesList[ MAX_LENGTH * MAX_WIDTH ], variantFramesList[ MAX_LENGTH * MAX_WIDTH ];
+  double scalarSumsList[ MAX_WIDTH ], variantSumsList[ MAX_WIDTH ];
+  for( size_t framesWidth = 1; framesWidth <= MAX_WIDTH; framesWidth++ )
+  {
+    for( size_t length = 0; length <= MAX_LENGTH; length++ )
+    {
+      Test_FillRandom( offsetsList, framesWidth );
+      Test_FillRandom( scalarSumsList, framesWidth );
+      Test_FillRandom( scalarFramesList, length * framesWidth );
+      memcpy( variantSumsList, scalarSumsList, framesWidth * sizeof(double) );
+      memcpy( variantFramesList, scalarFramesList, length * framesWidth * sizeof(double) );
+      scalarKernels.CalibrateFrames( scalarFramesList, scalarSumsList, offsetsList, framesWidth, length );
+      kernels->CalibrateFrames( variantFramesList, variantSumsList, offsetsList, framesWidth, length );
+      TEST_CHECK( Test_IsBitIdentical( scalarFramesList, variantFramesList, length * framesWidth ) 
+                  && Test_IsBitIdentical( scalarSumsList, variantSumsList, framesWidth ), "CalibrateFrames width %zu length %zu", framesWidth, length );
+    }
+  }
+}
+
+static void CheckInterpolateFrames( SignalKernels* kernels )
+{
+  double knotsTable[ KERNEL_KNOTS_NUMBER ][ MAX_WIDTH ], weightsTable[ MAX_LENGTH * KERNEL_KNOTS_NUMBER ];
+  double scalarFramesList[ MAX_LENGTH * MAX_WIDTH ], variantFramesList[ MAX_LENGTH * MAX_WIDTH ];
+  const double* knotFramesList[ KERNEL_KNOTS_NUMBER ] = { knotsTable[ 0 ], knotsTable[ 1 ], knotsTable[ 2 ], knotsTable[ 3 ] };
+  for( size_t framesWidth = 1; framesWidth <= MAX_WIDTH; framesWidth++ )
+  {
+    for( size_t length = 0; length <= MAX_LENGTH; length++ )
+    {
+      for( size_t knot = 0; knot < KERNEL_KNOTS_NUMBER; knot++ )
+        Test_FillRandom( knotsTable[ knot ], framesWidth );
+      Test_FillRandom( weightsTable, length * KERNEL_KNOTS_NUMBER );
+      scalarKernels.InterpolateFrames( scalarFramesList, knotFramesList, weightsTable, framesWidth, length );
+      kernels->InterpolateFrames( variantFramesList, knotFramesList, weightsTable, framesWidth, length );
+      TEST_CHECK( Test_IsBitIdentical( scalarFramesList, variantFramesList, length * framesWidth ), 
+                  "InterpolateFrames width %zu length %zu", framesWidth, length );
+    }
+  }
+}
+
+// Sorting network medians and MADs against sorted windows, so that scalar results (and then all variants) are the filter ones
+static void CheckFilterFramesReference( void )
+{
+  double windowFramesList[ MAX_FRAMES * MAX_WIDTH ], thresholdsList[ MAX_WIDTH ];
+  double referenceFramesList[ MAX_LENGTH * MAX_WIDTH ], scalarFramesList[ MAX_LENGTH * MAX_WIDTH ];
+  const double THRESHOLDS_LIST[] = { 0.0, 3.0, INFINITY, 1.0 };
+  const size_t LENGTH = 16;
+  for( size_t framesWidth = 1; framesWidth <= MAX_WIDTH; framesWidth++ )
+  {
+    for( size_t windowLength = 1; windowLength <= KERNEL_FILTER_MAX_WINDOW; windowLength++ )
+    {
+      for( size_t thresholdsMode = 0; thresholdsMode < 3; thresholdsMode++ )
+      {
+        // Median only, mixed Hampel and pass through filters
+        for( size_t lane = 0; lane < framesWidth; lane++ )
+          thresholdsList[ lane ] = ( thresholdsMode == 0 ) ? 0.0 : ( thresholdsMode == 1 ) ? THRESHOLDS_LIST[ lane % 4 ] : INFINITY;
+        Test_FillRandom( windowFramesList, ( LENGTH + windowLength - 1 ) * framesWidth );
+        FilterFrames_Reference( referenceFramesList, windowFramesList, thresholdsList, framesWidth, windowLength, LENGTH );
+        scalarKernels.FilterFrames( scalarFramesList, windowFramesList, thresholdsList, framesWidth, windowLength, LENGTH );
+        TEST_CHECK( Test_IsBitIdentical( referenceFramesList, scalarFramesList, LENGTH * framesWidth ), 
+                    "FilterFrames reference width %zu window %zu thresholds mode %zu", framesWidth, windowLength, thresholdsMode );
+      }
+    }
+  }
+}
+
+// Specialized block kernels have no variants: they are checked against the generic ones (with scalar kernels bound)
+static void CheckBlockKernels( void )
+{
+  const size_t FRAMES_WIDTHS_LIST[] = { 1, 2, 4, 6, 8, 16 };
+  const size_t ROWS_STRIDE = KERNEL_BLOCK_LENGTH + 3;
+  double framesList[ KERNEL_BLOCK_LENGTH * 16 ], genericRowsTable[ 16 * ( KERNEL_BLOCK_LENGTH + 3 ) ], specializedRowsTable[ 16 * ( KERNEL_BLOCK_LENGTH + 3 ) ];
+  double genericFramesList[ KERNEL_BLOCK_LENGTH * 16 ], genericSumsList[ 16 ], specializedSumsList[ 16 ], offsetsList[ 16 ];
+  unsigned int rowsList[ 16 ];
+  Kernels_Bind( KERNELS_SCALAR );
+  for( size_t widthIndex = 0; widthIndex < sizeof(FRAMES_WIDTHS_LIST) / sizeof(size_t); widthIndex++ )
+  {
+    size_t framesWidth = FRAMES_WIDTHS_LIST[ widthIndex ];
+    TransposeFramesFunction TransposeBlock = Kernels_GetTransposeBlock( framesWidth );
+    CalibrateFramesFunction CalibrateBlock = Kernels_GetCalibrateBlock( framesWidth );
+    TEST_CHECK( TransposeBlock != TransposeFrames_Generic && CalibrateBlock != Kernels.CalibrateFrames, "no specialized kernels for width %zu", framesWidth );
+    
+    // Rows in reverse order, as channels read from the task do not have to follow the history rows order
+    for( size_t column = 0; column < framesWidth; column++ )
+      rowsList[ column ] = (unsigned int) ( framesWidth - 1 - column );
+    Test_FillRandom( framesList, KERNEL_BLOCK_LENGTH * framesWidth );
+    Test_FillRandom( genericRowsTable, framesWidth * ROWS_STRIDE );
+    memcpy( specializedRowsTable, genericRowsTable, framesWidth * ROWS_STRIDE * sizeof(double) );
+    TransposeFrames_Generic( framesWidth, genericRowsTable, rowsList, ROWS_STRIDE, framesList, KERNEL_BLOCK_LENGTH );
+    TransposeBlock( framesWidth, specializedRowsTable, rowsList, ROWS_STRIDE, framesList, KERNEL_BLOCK_LENGTH );
+    TEST_CHECK( Test_IsBitIdentical( genericRowsTable, specializedRowsTable, framesWidth * ROWS_STRIDE ), "TransposeBlock width %zu", framesWidth );
+    
+    Test_FillRandom( offsetsList, framesWidth );
+    Test_FillRandom( genericSumsList, framesWidth );
+    memcpy( specializedSumsList, genericSumsList, framesWidth * sizeof(double) );
+    memcpy( genericFramesList, framesList, KERNEL_BLOCK_LENGTH * framesWidth * sizeof(double) );
+    Kernels.CalibrateFrames( genericFramesList, genericSumsList, offsetsList, framesWidth, KERNEL_BLOCK_LENGTH );
+    CalibrateBlock( framesList, specializedSumsList, offsetsList, framesWidth, KERNEL_BLOCK_LENGTH );
+    TEST_CHECK( Test_IsBitIdentical( genericFramesList, framesList, KERNEL_BLOCK_LENGTH * framesWidth ) 
+                && Test_IsBitIdentical( genericSumsList, specializedSumsList, framesWidth ), "CalibrateBlock width %zu", framesWidth );
+  }
+  
+  TEST_CHECK( Kernels_GetTransposeBlock( 3 ) == TransposeFrames_Generic && Kernels_GetCalibrateBlock( 3 ) == Kernels.CalibrateFrames, 
+              "specialized kernels for width 3" );
+  
+  // Vector kernels filling whole vectors are kept
+  Kernels_Bind( -1 );
+  if( Kernels.variant == KERNELS_AVX512 ) 
+    TEST_CHECK( Kernels_GetCalibrateBlock( 16 ) == Kernels.CalibrateFrames && Kernels_GetCalibrateBlock( 6 ) != Kernels.CalibrateFrames, "AVX-512 calibration blocks" );
+}
+
+int main( int argc, char* argv[] )
+{
+  Kernels_Bind( KERNELS_SCALAR );
+  scalarKernels = Kernels;
+  
+  for( int variant = KERNELS_SSE2; variant < KERNELS_VARIANTS_NUMBER; variant++ )
+  {
+    Kernels_Bind( variant );
+    if( Kernels.variant != variant )
+    {
+      printf( "%s kernels not supported here: skipped\n", VARIANT_NAMES[ variant ] );
+      continue;
+    }
+    
+    Test_SeedRandom( (uint64_t) variant );
+    size_t failuresCount = testFailuresCount;
+    SignalKernels variantKernels = Kernels;
+    CheckDotProduct( &variantKernels );
+    CheckDeinterleave( &variantKernels );
+    CheckFilterFrames( &variantKernels );
+    CheckAccumulateTerms( &variantKernels );
+    CheckUpdateMeans( &variantKernels );
+    CheckCalibrateFrames( &variantKernels );
+    CheckInterpolateFrames( &variantKernels );
+    printf( "%s kernels: %s\n", VARIANT_NAMES[ variant ], ( testFailuresCount == failuresCount ) ? "bit-identical to scalar" : "MISMATCH" );
+  }
+  
+  CheckFilterFramesReference();
+  CheckBlockKernels();
+  
+  return Test_End( "test_kernels" );
+}
@@ -0,0 +1,158 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2019 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of Signal-IO-NIDAQmx.                                   //
+//                                                                            //
+//  Signal-IO-NIDAQmx is free software: you can redistribute it and/or modify //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  Signal-IO-NIDAQmx is distributed in the hope that it will be useful,      //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with Signal-IO-NIDAQmx. If not, see <http://www.gnu.org/licenses/>. //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+// Command mailbox: claims by priority, owner-only writes, sequence locked reads under concurrent writes, and clients in other processes
+
+#include "signal_mailbox.h"
+
+#include "test_utils.h"
+
+#include <pthread.h>
+#include <sys/wait.h>
+
+#define STRESS_WRITES_NUMBER 500000
+
+static char taskName[ MAILBOX_NAME_MAX_LENGTH ];
+
+static void TestOwnership( SignalMailbox server, SignalMailbox client )
+{
+  double value;
+  uint64_t sequence;
+  TEST_CHECK( Mailbox_Read( server, 0, &value, &sequence ) == 0, "read of free channel" );
+  TEST_CHECK( !Mailbox_Claim( client, 0, 1, 0 ), "claim with null priority" );
+  TEST_CHECK( !Mailbox_Claim( client, 4, 1, 1 ), "claim of missing channel" );
+  TEST_CHECK( !Mailbox_Write( client, 0, 1, 1.0 ), "write to free channel" );
+  
+  TEST_CHECK( Mailbox_Claim( client, 0, 1, 1 ), "claim of free channel" );
+  TEST_CHECK( Mailbox_Read( server, 0, &value, &sequence ) == 0, "read of claimed channel not written yet" );
+  TEST_CHECK( !Mailbox_Write( client, 0, 2, 2.0 ), "write by non owner" );
+  TEST_CHECK( Mailbox_Write( client, 0, 1, 1.5 ), "write by owner" );
+  TEST_CHECK( Mailbox_Read( server, 0, &value, &sequence ) == 1 && value == 1.5 && sequence == 2, "read of written value" );
+  
+  TEST_CHECK( !Mailbox_Claim( client, 0, 2, 1 ), "takeover with same priority" );
+  TEST_CHECK( Mailbox_Claim( client, 0, 2, 2 ), "takeover with higher priority" );
+  TEST_CHECK( Mailbox_Read( server, 0, &value, &sequence ) == 1 && value == 1.5, "value kept on takeover" );
+  TEST_CHECK( !Mailbox_Write( client, 0, 1, 3.0 ), "write by previous owner" );
+  TEST_CHECK( !Mailbox_Claim( client, 0, 1, 1 ), "claim back with lower priority" );
+  TEST_CHECK( Mailbox_Claim( client, 0, 2, 1 ), "priority change by owner" );
+  TEST_CHECK( Mailbox_Write( client, 0, 2, 2.5 ), "write by new owner" );
+  TEST_CHECK( Mailbox_Read( server, 0, &value, &sequence ) == 1 && value == 2.5 && sequence == 4, "read of new owner value" );
+  
+  Mailbox_Release( client, 0, 1 );
+  TEST_CHECK( Mailbox_Read( server, 0, &value, &sequence ) == 1, "release by previous owner" );
+  Mailbox_Release( client, 0, 2 );
+  TEST_CHECK( Mailbox_Read( server, 0, &value, &sequence ) == 0, "read of released channel" );
+  
+  // Odd sequence: value being written by some (possibly crashed) writer
+  TEST_CHECK( Mailbox_Claim( client, 1, 1, 1 ), "claim of free channel" );
+  atomic_store( &(client->slotsList[ 1 ].sequence), 1 );
+  TEST_CHECK( Mailbox_Read( server, 1, &value, &sequence ) == -1, "read while being written" );
+  TEST_CHECK( !Mailbox_Write( client, 1, 1, 1.0 ), "write while being written" );
+  atomic_store( &(client->slotsList[ 1 ].sequence), 0 );
+  Mailbox_Release( client, 1, 1 );
+}
+
+static void* WriteValues( void* data )
+{
+  SignalMailbox client = (SignalMailbox) data;
+  // k-th write (sequence 2k) is value k, so that reads pairing values with other writes sequences are detectable
+  for( uint64_t writesCount = 1; writesCount <= STRESS_WRITES_NUMBER; writesCount++ )
+  {
+    while( !Mailbox_Write( client, 2, 7, (double) writesCount ) ) sched_yield();
+    if( writesCount % 128 == 0 ) sched_yield();
+  }
+  return NULL;
+}
+
+static void TestConcurrentWrites( SignalMailbox server, SignalMailbox client )
+{
+  TEST_CHECK( Mailbox_Claim( client, 2, 7, 1 ), "claim of free channel" );
+  
+  pthread_t writerThread;
+  pthread_create( &writerThread, NULL, WriteValues, client );
+  
+  size_t readsCount = 0, mismatchesCount = 0, reversalsCount = 0;
+  uint64_t lastSequence = 0;
+  double value;
+  uint64_t sequence;
+  while( lastSequence < 2 * STRESS_WRITES_NUMBER )
+  {
+    if( Mailbox_Read( server, 2, &value, &sequence ) != 1 ) continue;
+    readsCount++;
+    if( value != (double) ( sequence / 2 ) ) mismatchesCount++;
+    if( sequence < lastSequence ) reversalsCount++;
+    lastSequence = sequence;
+  }
+  pthread_join( writerThread, NULL );
+  
+  TEST_CHECK( mismatchesCount == 0 && reversalsCount == 0, "%zu torn and %zu out of order reads (of %zu)", mismatchesCount, reversalsCount, readsCount );
+  
+  Mailbox_Release( client, 2, 7 );
+}
+
+static void TestClientProcess( SignalMailbox server )
+{
+  pid_t clientProcess = fork();
+  if( clientProcess == 0 )
+  {
+    SignalMailbox client = Mailbox_Open( taskName, 0, false );
+    bool isWritten = ( client != NULL && Mailbox_Claim( client, 3, 42, 5 ) && Mailbox_Write( client, 3, 42, -4.25 ) );
+    Mailbox_Close( client );
+    _exit( isWritten ? 0 : 1 );
+  }
+  
+  int clientStatus = -1;
+  TEST_CHECK( clientProcess > 0 && waitpid( clientProcess, &clientStatus, 0 ) == clientProcess, "client process run" );
+  TEST_CHECK( WIFEXITED( clientStatus ) && WEXITSTATUS( clientStatus ) == 0, "client process write" );
+  
+  double value;
+  uint64_t sequence;
+  TEST_CHECK( Mailbox_Read( server, 3, &value, &sequence ) == 1 && value == -4.25, "read of other process value" );
+  TEST_CHECK( (uint32_t) atomic_load( &(server->slotsList[ 3 ].owner) ) == 42, "channel owned by other process client" );
+}
+
+int main( int argc, char* argv[] )
+{
+  snprintf( taskName, MAILBOX_NAME_MAX_LENGTH, "test_mailbox_%d", (int) getpid() );
+  
+  TEST_CHECK( Mailbox_Open( taskName, 0, false ) == NULL, "client attached to missing mailbox" );
+  
+  SignalMailbox server = Mailbox_Open( taskName, 4, true );
+  TEST_CHECK( server != NULL, "server mailbox created" );
+  if( server == NULL ) return Test_End( "test_mailbox" );
+  SignalMailbox client = Mailbox_Open( taskName, 0, false );
+  TEST_CHECK( client != NULL && client->header->channelsNumber == 4, "client mailbox attached" );
+  
+  if( client != NULL )
+  {
+    TestOwnership( server, client );
+    TestConcurrentWrites( server, client );
+    TestClientProcess( server );
+    Mailbox_Close( client );
+  }
+  
+  Mailbox_Close( server );
+  TEST_CHECK( Mailbox_Open( taskName, 0, false ) == NULL, "client attached to removed mailbox" );
+  
+  return Test_End( "test_mailbox" );
+}
@@ -0,0 +1,339 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2019 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of Signal-IO-NIDAQmx.                                   //
+//                                                                            //
+//  Signal-IO-NIDAQmx is free software: you can redistribute it and/or modify //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  Signal-IO-NIDAQmx is distributed in the hope that it will be useful,      //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with Signal-IO-NIDAQmx. If not, see <http://www.gnu.org/licenses/>. //
+//                                                                            //
+
+
+// Output tasks over the simulated driver, checked on the last values written to the driver: commands interpolation, 
+// regenerated waveforms, synchronized group commits and interlocks with input tasks
+
+#include "../ni_daqmx.c"
+
+#include "plugin_utils.h"
+
+#include <pthread.h>
+
+#define OUTPUT_SAMPLING_RATE 1000.0
+#define OUTPUT_CHANNELS_NUMBER 2
+#define WAVEFORM_PERIOD_LENGTH 100
+
+/// Waits until the last values written to given simulated task are the expected ones, or timeout
+static bool WaitOutputValues( const char* taskName, const double* valuesList )
+{
+  double lastValuesList[ OUTPUT_CHANNELS_NUMBER ];
+  double timeoutTime = Test_GetTime() + WAIT_TIMEOUT;
+  while( Test_GetTime() < timeoutTime )
+  {
+    if( SimDAQmx_GetLastValues( taskName, lastValuesList ) && memcmp( lastValuesList, valuesList, sizeof(lastValuesList) ) == 0 ) return true;
+    Test_Sleep( 0.001 );
+  }
+  return false;
+}
+
+// Counts generated values of the first channel strictly between the ones of 2 commands, written some time apart
+static size_t CountInterpolatedValues( long int taskID, double firstValue, double lastValue, double interval )
+{
+  Write( taskID, 0, firstValue );
+  Test_Sleep( 0.2 );
+  Write( taskID, 0, lastValue );
+  
+  size_t interpolatedValuesCount = 0;
+  double lastValuesList[ OUTPUT_CHANNELS_NUMBER ];
+  double endTime = Test_GetTime() + 4 * interval;
+  while( Test_GetTime() < endTime )
+  {
+    if( SimDAQmx_GetLastValues( "SimInterpolated", lastValuesList ) && lastValuesList[ 0 ] > firstValue && lastValuesList[ 0 ] < lastValue ) 
+      interpolatedValuesCount++;
+    Test_Sleep( 0.0005 );
+  }
+  return interpolatedValuesCount;
+}
+
+static void TestInterpolation( void )
+{
+  SimDAQmx_AddTask( "SimInterpolated", SIM_TASK_ANALOG_OUTPUT, OUTPUT_CHANNELS_NUMBER, OUTPUT_SAMPLING_RATE );
+  
+  long int taskID = InitDevice( "SimInterpolated" );
+  TEST_CHECK( taskID != SIGNAL_IO_TASK_INVALID_ID, "interpolated task not loaded" );
+  if( taskID == SIGNAL_IO_TASK_INVALID_ID ) return;
+  
+  TEST_CHECK( AcquireOutputChannel( taskID, 0 ), "output channel not acquired" );
+  TEST_CHECK( !SetOutputInterpolation( taskID, 2, 0.1 ), "invalid interpolation set" );
+  
+  // Held commands step from one value to the next, while interpolated ones ramp over the delay
+  TEST_CHECK( SetOutputInterpolation( taskID, SIGNAL_IO_INTERPOLATION_HOLD, 0.1 ), "hold not set" );
+  size_t heldValuesCount = CountInterpolatedValues( taskID, 0.0, 50.0, 0.1 );
+  TEST_CHECK( heldValuesCount == 0, "%zu values between held commands", heldValuesCount );
+  
+  TEST_CHECK( SetOutputInterpolation( taskID, SIGNAL_IO_INTERPOLATION_LINEAR, 0.1 ), "linear interpolation not set" );
+  size_t linearValuesCount = CountInterpolatedValues( taskID, 100.0, 150.0, 0.1 );
+  TEST_CHECK( linearValuesCount > 20, "%zu values between linearly interpolated commands", linearValuesCount );
+  
+  ReleaseOutputChannel( taskID, 0 );
+  EndDevice( taskID );
+}
+
+// Fills waveform period with channels ramping at opposite slopes of given value per sample
+static void FillWaveform( double* samplesTable, double slope )
+{
+  for( size_t sampleIndex = 0; sampleIndex < WAVEFORM_PERIOD_LENGTH; sampleIndex++ )
+  {
+    samplesTable[ sampleIndex ] = slope * sampleIndex;
+    samplesTable[ WAVEFORM_PERIOD_LENGTH + sampleIndex ] = -slope * sampleIndex;
+  }
+}
+
+static void TestRegeneration( void )
+{
+  SimDAQmx_AddTask( "SimWaveform", SIM_TASK_ANALOG_OUTPUT, OUTPUT_CHANNELS_NUMBER, OUTPUT_SAMPLING_RATE );
+  
+  long int taskID = InitDevice( "SimWaveform" );
+  TEST_CHECK( taskID != SIGNAL_IO_TASK_INVALID_ID, "waveform task not loaded" );
+  if( taskID == SIGNAL_IO_TASK_INVALID_ID ) return;
+  
+  for( unsigned int channel = 0; channel < OUTPUT_CHANNELS_NUMBER; channel++ )
+    TEST_CHECK( AcquireOutputChannel( taskID, channel ), "output channel not acquired" );
+  
+  double samplesTable[ OUTPUT_CHANNELS_NUMBER * WAVEFORM_PERIOD_LENGTH ];
+  FillWaveform( samplesTable, 1.0 );
+  TEST_CHECK( !SetOutputWaveform( taskID, samplesTable, 1 ) && !SetOutputWaveform( taskID, NULL, WAVEFORM_PERIOD_LENGTH ), "invalid waveform set" );
+  
+  // Device loops the written period on its own, with no further writes (or Write() commands applied)
+  TEST_CHECK( SetOutputWaveform( taskID, samplesTable, WAVEFORM_PERIOD_LENGTH ), "waveform not set" );
+  double lastValuesList[ OUTPUT_CHANNELS_NUMBER ] = { WAVEFORM_PERIOD_LENGTH - 1, 1 - WAVEFORM_PERIOD_LENGTH };
+  TEST_CHECK( WaitOutputValues( "SimWaveform", lastValuesList ), "waveform not written" );
+  Test_Sleep( 0.05 );
+  uint64_t updatesCount = SimDAQmx_GetUpdatesCount( "SimWaveform" );
+  (void) Write( taskID, 0, 5.0 );
+  Test_Sleep( 0.2 );
+  TEST_CHECK( SimDAQmx_GetUpdatesCount( "SimWaveform" ) == updatesCount, "%lu driver writes while regenerating", 
+              (unsigned long) ( SimDAQmx_GetUpdatesCount( "SimWaveform" ) - updatesCount ) );
+  TEST_CHECK( WaitOutputValues( "SimWaveform", lastValuesList ), "command written while regenerating" );
+  
+  // Waveforms with the same period are swapped with a single write
+  FillWaveform( samplesTable, 2.0 );
+  TEST_CHECK( SetOutputWaveform( taskID, samplesTable, WAVEFORM_PERIOD_LENGTH ), "waveform not swapped" );
+  lastValuesList[ 0 ] *= 2.0;
+  lastValuesList[ 1 ] *= 2.0;
+  TEST_CHECK( WaitOutputValues( "SimWaveform", lastValuesList ), "swapped waveform not written" );
+  Test_Sleep( 0.1 );
+  uint64_t swapUpdatesCount = SimDAQmx_GetUpdatesCount( "SimWaveform" ) - updatesCount;
+  TEST_CHECK( swapUpdatesCount == 1, "%lu driver writes for swapped waveform", (unsigned long) swapUpdatesCount );
+  
+  // Clearing the waveform goes back to Write() commands
+  TEST_CHECK( SetOutputWaveform( taskID, NULL, 0 ), "waveform not cleared" );
+  lastValuesList[ 0 ] = 5.0;
+  lastValuesList[ 1 ] = 6.0;
+  (void) Write( taskID, 0, 5.0 );
+  (void) Write( taskID, 1, 6.0 );
+  TEST_CHECK( WaitOutputValues( "SimWaveform", lastValuesList ), "commands not written after waveform" );
+  
+  for( unsigned int channel = 0; channel < OUTPUT_CHANNELS_NUMBER; channel++ )
+    ReleaseOutputChannel( taskID, channel );
+  EndDevice( taskID );
+}
+
+static atomic_bool isWriting;
+
+// Keeps writing the second channel of given task, while the group commits frames
+static void* WriteContinuously( void* data )
+{
+  long int taskID = *((long int*) data);
+  while( atomic_load( &isWriting ) )
+  {
+    (void) Write( taskID, 1, -1.0 );
+    Test_Sleep( 0.0001 );
+  }
+  return NULL;
+}
+
+static void TestGroupCommits( void )
+{
+  SimDAQmx_AddTask( "SimGroupA", SIM_TASK_ANALOG_OUTPUT, OUTPUT_CHANNELS_NUMBER, OUTPUT_SAMPLING_RATE );
+  SimDAQmx_AddTask( "SimGroupB", SIM_TASK_ANALOG_OUTPUT, OUTPUT_CHANNELS_NUMBER, OUTPUT_SAMPLING_RATE );
+  
+  long int taskIDsList[ 2 ] = { InitDevice( "SimGroupA" ), InitDevice( "SimGroupB" ) };
+  TEST_CHECK( taskIDsList[ 0 ] != SIGNAL_IO_TASK_INVALID_ID && taskIDsList[ 1 ] != SIGNAL_IO_TASK_INVALID_ID, "group tasks not loaded" );
+  if( taskIDsList[ 0 ] == SIGNAL_IO_TASK_INVALID_ID || taskIDsList[ 1 ] == SIGNAL_IO_TASK_INVALID_ID ) return;
+  
+  long int groupID = CreateOutputGroup( taskIDsList, 2 );
+  TEST_CHECK( groupID >= 0, "output group not created" );
+  TEST_CHECK( CreateOutputGroup( taskIDsList, 2 ) < 0, "tasks grouped twice" );
+  if( groupID < 0 ) return;
+  
+  for( size_t taskIndex = 0; taskIndex < 2; taskIndex++ )
+  {
+    for( unsigned int channel = 0; channel < OUTPUT_CHANNELS_NUMBER; channel++ )
+      TEST_CHECK( AcquireOutputChannel( taskIDsList[ taskIndex ], channel ), "output channel not acquired" );
+  }
+  
+  // Commits fail until all members generate samples
+  double framesList[ 2 * OUTPUT_CHANNELS_NUMBER ] = { 1.0, 1.0, 2.0, 2.0 };
+  double timeoutTime = Test_GetTime() + WAIT_TIMEOUT;
+  bool isCommitted = false;
+  while( !( isCommitted = CommitOutputGroup( groupID, framesList ) ) && Test_GetTime() < timeoutTime )
+    Test_Sleep( 0.001 );
+  TEST_CHECK( isCommitted, "frame not committed" );
+  TEST_CHECK( WaitOutputValues( "SimGroupA", framesList ) && WaitOutputValues( "SimGroupB", framesList + OUTPUT_CHANNELS_NUMBER ), 
+              "committed frame not generated" );
+  
+  // Frames committed along concurrent writes are generated whole by the other member
+  atomic_store( &isWriting, true );
+  pthread_t writerThread;
+  pthread_create( &writerThread, NULL, WriteContinuously, &(taskIDsList[ 0 ]) );
+  size_t tornFramesCount = 0;
+  for( size_t commitIndex = 0; commitIndex < 50; commitIndex++ )
+  {
+    for( size_t valueIndex = 0; valueIndex < 2 * OUTPUT_CHANNELS_NUMBER; valueIndex++ )
+      framesList[ valueIndex ] = 10.0 + commitIndex;
+    (void) CommitOutputGroup( groupID, framesList );
+    double lastValuesList[ OUTPUT_CHANNELS_NUMBER ];
+    if( SimDAQmx_GetLastValues( "SimGroupB", lastValuesList ) && lastValuesList[ 0 ] != lastValuesList[ 1 ] ) tornFramesCount++;
+    Test_Sleep( 0.002 );
+  }
+  atomic_store( &isWriting, false );
+  pthread_join( writerThread, NULL );
+  TEST_CHECK( tornFramesCount == 0, "%zu torn frames generated", tornFramesCount );
+  
+  // Writes after the last committed frame is due change it, not the values from before it
+  TEST_CHECK( CommitOutputGroup( groupID, framesList ), "last frame not committed" );
+  TEST_CHECK( !Write( taskIDsList[ 0 ], 1, 100.0 ), "write accepted before committed frame" );
+  TEST_CHECK( WaitOutputValues( "SimGroupA", framesList ), "last committed frame not generated" );
+  // Frames are written to the driver ahead of their command time
+  timeoutTime = Test_GetTime() + WAIT_TIMEOUT;
+  bool isWritten = false;
+  while( !( isWritten = Write( taskIDsList[ 0 ], 1, 100.0 ) ) && Test_GetTime() < timeoutTime )
+    Test_Sleep( 0.001 );
+  TEST_CHECK( isWritten, "write rejected after committed frame" );
+  double expectedValuesList[ OUTPUT_CHANNELS_NUMBER ] = { framesList[ 0 ], 100.0 };
+  TEST_CHECK( WaitOutputValues( "SimGroupA", expectedValuesList ), "write not applied over committed frame" );
+  
+  for( size_t taskIndex = 0; taskIndex < 2; taskIndex++ )
+  {
+    for( unsigned int channel = 0; channel < OUTPUT_CHANNELS_NUMBER; channel++ )
+      ReleaseOutputChannel( taskIDsList[ taskIndex ], channel );
+  }
+  ReleaseOutputGroup( groupID );
+  EndDevice( taskIDsList[ 0 ] );
+  EndDevice( taskIDsList[ 1 ] );
+}
+
+static atomic_int monitoredLevel;
+
+// Monitored input channels hold the level set by the test
+static double GetMonitoredSignal( unsigned int channel, uint64_t sampleIndex )
+{
+  return (double) atomic_load( &monitoredLevel );
+}
+
+static void TestInterlocks( void )
+{
+  atomic_store( &monitoredLevel, 0 );
+  SimDAQmx_AddTask( "SimMonitored", SIM_TASK_ANALOG_INPUT, INPUT_CHANNELS_NUMBER, INPUT_SAMPLING_RATE );
+  SimDAQmx_SetSignal( "SimMonitored", GetMonitoredSignal );
+  SimDAQmx_AddTask( "SimInterlocked", SIM_TASK_ANALOG_OUTPUT, OUTPUT_CHANNELS_NUMBER, OUTPUT_SAMPLING_RATE );
+  
+  long int inputTaskID = InitDevice( "SimMonitored" );
+  long int outputTaskID = InitDevice( "SimInterlocked" );
+  TEST_CHECK( inputTaskID != SIGNAL_IO_TASK_INVALID_ID && outputTaskID != SIGNAL_IO_TASK_INVALID_ID, "interlock tasks not loaded" );
+  if( inputTaskID == SIGNAL_IO_TASK_INVALID_ID || outputTaskID == SIGNAL_IO_TASK_INVALID_ID ) return;
+  
+  double writtenValuesList[ OUTPUT_CHANNELS_NUMBER ] = { 5.0, 5.0 };
+  double safeValuesList[ OUTPUT_CHANNELS_NUMBER ] = { 0.0, 0.0 };
+  for( unsigned int channel = 0; channel < OUTPUT_CHANNELS_NUMBER; channel++ )
+  {
+    TEST_CHECK( AcquireOutputChannel( outputTaskID, channel ), "output channel not acquired" );
+    (void) Write( outputTaskID, channel, writtenValuesList[ channel ] );
+  }
+  TEST_CHECK( WaitOutputValues( "SimInterlocked", writtenValuesList ), "written values not generated" );
+  
+  TEST_CHECK( AddInterlock( inputTaskID, 0, 2, 1.0, outputTaskID ) < 0 && AddInterlock( outputTaskID, 0, SIGNAL_IO_INTERLOCK_ABOVE, 1.0, inputTaskID ) < 0, 
+              "invalid interlock added" );
+  long int interlockID = AddInterlock( inputTaskID, 0, SIGNAL_IO_INTERLOCK_ABOVE, 1.0, outputTaskID );
+  TEST_CHECK( interlockID >= 0, "interlock not added" );
+  if( interlockID < 0 ) return;
+  
+  // Rules hold while their condition does not
+  Test_Sleep( 0.1 );
+  TEST_CHECK( !( WaitEvents( outputTaskID, false ) & SIGNAL_IO_EVENT_INTERLOCK ), "interlock tripped below threshold" );
+  
+  // Trips force safe values over later writes, and stay latched until reset
+  atomic_store( &monitoredLevel, 2 );
+  TEST_CHECK( WaitOutputValues( "SimInterlocked", safeValuesList ), "safe values not generated on trip" );
+  double timeoutTime = Test_GetTime() + WAIT_TIMEOUT;
+  unsigned int events = 0;
+  while( !( events & SIGNAL_IO_EVENT_INTERLOCK ) && Test_GetTime() < timeoutTime )
+  {
+    events |= WaitEvents( outputTaskID, false );
+    Test_Sleep( 0.001 );
+  }
+  TEST_CHECK( events & SIGNAL_IO_EVENT_INTERLOCK, "trip not signaled" );
+  double maxLatency = 0.0;
+  double latency = GetInterlockLatency( outputTaskID, &maxLatency );
+  TEST_CHECK( latency > 0.0 && latency <= maxLatency && maxLatency < 0.5, "trip latency %g s (max %g s)", latency, maxLatency );
+  
+  (void) Write( outputTaskID, 0, 3.0 );
+  atomic_store( &monitoredLevel, 0 );
+  Test_Sleep( 0.1 );
+  double lastValuesList[ OUTPUT_CHANNELS_NUMBER ];
+  TEST_CHECK( SimDAQmx_GetLastValues( "SimInterlocked", lastValuesList ) && memcmp( lastValuesList, safeValuesList, sizeof(lastValuesList) ) == 0, 
+              "trip cleared with no reset" );
+  
+  // Reset outputs get back to their last written values, unless the condition still holds
+  atomic_store( &monitoredLevel, 2 );
+  Reset( outputTaskID );
+  Test_Sleep( 0.1 );
+  TEST_CHECK( SimDAQmx_GetLastValues( "SimInterlocked", lastValuesList ) && memcmp( lastValuesList, safeValuesList, sizeof(lastValuesList) ) == 0, 
+              "trip cleared on reset with its condition holding" );
+  atomic_store( &monitoredLevel, 0 );
+  Test_Sleep( 0.1 );
+  Reset( outputTaskID );
+  writtenValuesList[ 0 ] = 3.0;
+  TEST_CHECK( WaitOutputValues( "SimInterlocked", writtenValuesList ), "written values not restored on reset" );
+  
+  // Removed rules no longer trip
+  RemoveInterlock( interlockID );
+  atomic_store( &monitoredLevel, 2 );
+  Test_Sleep( 0.1 );
+  TEST_CHECK( SimDAQmx_GetLastValues( "SimInterlocked", lastValuesList ) && memcmp( lastValuesList, writtenValuesList, sizeof(lastValuesList) ) == 0, 
+              "removed interlock tripped" );
+  
+  // Trips dump the output recording in background
+  SignalIOTask outputTask = GetTask( outputTaskID );
+  timeoutTime = Test_GetTime() + WAIT_TIMEOUT;
+  while( atomic_load( &(outputTask->isDumping) ) && Test_GetTime() < timeoutTime )
+    Test_Sleep( 0.001 );
+  remove( "SimInterlocked_interlock.sigrec" );
+  
+  for( unsigned int channel = 0; channel < OUTPUT_CHANNELS_NUMBER; channel++ )
+    ReleaseOutputChannel( outputTaskID, channel );
+  EndDevice( outputTaskID );
+  EndDevice( inputTaskID );
+}
+
+int main( int argc, char* argv[] )
+{
+  TestInterpolation();
+  TestRegeneration();
+  TestGroupCommits();
+  TestInterlocks();
+  
+  SimDAQmx_RemoveTasks();
+  
+  return Test_End( "test_outputs" );
+}
@@ -0,0 +1,364 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2019 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of Signal-IO-NIDAQmx.                                   //
+//                                                                            //
+//  Signal-IO-NIDAQmx is free software: you can redistribute it and/or modify //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  Signal-IO-NIDAQmx is distributed in the hope that it will be useful,      //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with Signal-IO-NIDAQmx. If not, see <http://www.gnu.org/licenses/>. //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+// Plugin interface over the simulated NI-DAQmx driver (stubs/daqmx_simulator.h), with the plugin source included 
+// so that task internals could also be checked
+
+#include "../ni_daqmx.c"
+
+#include "plugin_utils.h"
+
+#include <time.h>
+
+// Channel c is a 5 Hz sine, with phase c * 90 degrees (well within the resampler passband at the tested rates)
+static double GetSineSignal( unsigned int channel, uint64_t sampleIndex )
+{
+  return sin( 2 * M_PI * 5.0 * sampleIndex / INPUT_SAMPLING_RATE + channel * M_PI / 2 );
+}
+
+static void TestVirtualChannels( void )
+{
+  SimDAQmx_AddTask( "SimAI", SIM_TASK_ANALOG_INPUT, INPUT_CHANNELS_NUMBER, INPUT_SAMPLING_RATE );
+  SimDAQmx_SetSignal( "SimAI", GetRampSignal );
+  
+  // Invalid expressions fail task loading cleanly, leaving the driver task free for a later valid configuration
+  const char* INVALID_CONFIGS_LIST[] = { "SimAI|[0]+", "SimAI|[0]-[2]", "SimAI|[1]|(", "SimAI|", "SimAI||[0]" };
+  for( size_t configIndex = 0; configIndex < sizeof(INVALID_CONFIGS_LIST) / sizeof(const char*); configIndex++ )
+  {
+    long int taskID = InitDevice( INVALID_CONFIGS_LIST[ configIndex ] );
+    TEST_CHECK( taskID == SIGNAL_IO_TASK_INVALID_ID, "task loaded with \"%s\"", INVALID_CONFIGS_LIST[ configIndex ] );
+    if( taskID != SIGNAL_IO_TASK_INVALID_ID ) EndDevice( taskID );
+  }
+  TEST_CHECK( tasksList == NULL || kh_size( tasksList ) == 0, "tasks left by failed loads" );
+  
+  long int taskID = InitDevice( "SimAI|[1] - [0]|[0] * -2" );
+  TEST_CHECK( taskID != SIGNAL_IO_TASK_INVALID_ID, "task with valid virtual channels not loaded" );
+  if( taskID == SIGNAL_IO_TASK_INVALID_ID ) return;
+  
+  TEST_CHECK( !CheckInputChannel( taskID, INPUT_CHANNELS_NUMBER + 2 ), "missing channel acquired" );
+  TEST_CHECK( CheckInputChannel( taskID, INPUT_CHANNELS_NUMBER ), "virtual channel acquired" );
+  TEST_CHECK( CheckInputChannel( taskID, INPUT_CHANNELS_NUMBER + 1 ), "virtual channel acquired" );
+  
+  double samplesList[ AQUISITION_BUFFER_MAX_LENGTH ], doubledSamplesList[ AQUISITION_BUFFER_MAX_LENGTH ];
+  size_t samplesNumber = WaitRead( taskID, INPUT_CHANNELS_NUMBER, samplesList );
+  TEST_CHECK( samplesNumber > 0, "no virtual channel samples" );
+  // [1] - [0] is the sample index, so read samples are consecutive integers
+  for( size_t sampleIndex = 1; sampleIndex < samplesNumber; sampleIndex++ )
+    TEST_CHECK( samplesList[ sampleIndex ] == samplesList[ sampleIndex - 1 ] + 1.0, "virtual channel sample %zu: %g", sampleIndex, samplesList[ sampleIndex ] );
+  
+  samplesNumber = WaitRead( taskID, INPUT_CHANNELS_NUMBER + 1, doubledSamplesList );
+  TEST_CHECK( samplesNumber > 0 && doubledSamplesList[ 0 ] <= 0.0 && fmod( doubledSamplesList[ 0 ], 2.0 ) == 0.0, "second virtual channel samples" );
+  
+  ReleaseInputChannel( taskID, INPUT_CHANNELS_NUMBER );
+  ReleaseInputChannel( taskID, INPUT_CHANNELS_NUMBER + 1 );
+  EndDevice( taskID );
+  TEST_CHECK( tasksList == NULL, "task left after EndDevice" );
+}
+
+// Resampled reads are checked against the sine at each output grid position, with the grid index followed across calls
+// from the first one: samples repeated or missed between calls would not match
+static void CheckResampledReads( long int taskID, double outputRate, size_t requestLength )
+{
+  long int readerID = AcquireResampledInput( taskID, outputRate );
+  TEST_CHECK( readerID != SIGNAL_IO_TASK_INVALID_ID, "resampled reader at %g Hz not acquired", outputRate );
+  if( readerID == SIGNAL_IO_TASK_INVALID_ID ) return;
+  
+  SignalIOReader reader = kh_value( readersList, kh_get( ReaderInt, readersList, (khint_t) readerID ) );
+  uint64_t outputIndex = 0;
+  double samplesStep = INPUT_SAMPLING_RATE / outputRate;
+  
+  TEST_CHECK( ReadResampled( readerID, 0, NULL, NULL ) == 0, "empty read" );
+  
+  double samplesTable[ INPUT_CHANNELS_NUMBER * 64 ];
+  size_t callsCount = 0, samplesCount = 0, oversizedReadsCount = 0, mismatchesCount = 0;
+  double maxError = 0.0, lastTimestamp = 0.0, maxTimestampError = 0.0;
+  double endTime = Test_GetTime() + 0.5;
+  while( Test_GetTime() < endTime )
+  {
+    double timestamp;
+    size_t samplesNumber = ReadResampled( readerID, requestLength, samplesTable, &timestamp );
+    if( samplesNumber == 0 )
+    {
+      Test_Sleep( 0.003 );
+      continue;
+    }
+    
+    if( samplesNumber > requestLength ) oversizedReadsCount++;
+    if( callsCount == 0 ) outputIndex = reader->outputCursor - samplesNumber;
+    for( size_t sampleIndex = 0; sampleIndex < samplesNumber; sampleIndex++ )
+    {
+      for( unsigned int channel = 0; channel < INPUT_CHANNELS_NUMBER; channel++ )
+      {
+        double position = ( outputIndex + sampleIndex ) * samplesStep;
+        double expectedValue = sin( 2 * M_PI * 5.0 * position / INPUT_SAMPLING_RATE + channel * M_PI / 2 );
+        double error = fabs( samplesTable[ channel * requestLength + sampleIndex ] - expectedValue );
+        if( error > maxError ) maxError = error;
+        if( error > 2e-3 ) mismatchesCount++;
+      }
+    }
+    // Timestamps advance by the read samples period (allowing for the clock fit moving to less delayed blocks, by up to
+    // the scheduling delays of the first ones)
+    if( callsCount > 0 )
+    {
+      double timestampError = fabs( timestamp - lastTimestamp - samplesNumber / outputRate );
+      if( timestampError > maxTimestampError ) maxTimestampError = timestampError;
+    }
+    lastTimestamp = timestamp;
+    outputIndex += samplesNumber;
+    samplesCount += samplesNumber;
+    callsCount++;
+  }
+  
+  TEST_CHECK( oversizedReadsCount == 0, "%zu reads over the requested length", oversizedReadsCount );
+  TEST_CHECK( callsCount > 10 && samplesCount > 0.3 * outputRate, "%zu samples read in %zu calls at %g Hz", samplesCount, callsCount, outputRate );
+  TEST_CHECK( mismatchesCount == 0, "%zu resampled values off (max error %g) at %g Hz", mismatchesCount, maxError, outputRate );
+  TEST_CHECK( maxTimestampError < 1e-2, "timestamps off by %g s at %g Hz", maxTimestampError, outputRate );
+  TEST_CHECK( reader->outputCursor == outputIndex && atomic_load( &(reader->droppedSamplesCount) ) == 0, "reader cursor or drops" );
+  
+  ReleaseResampledInput( readerID );
+}
+
+static void TestResampledInput( void )
+{
+  SimDAQmx_AddTask( "SimResampled", SIM_TASK_ANALOG_INPUT, INPUT_CHANNELS_NUMBER, INPUT_SAMPLING_RATE );
+  SimDAQmx_SetSignal( "SimResampled", GetSineSignal );
+  
+  long int taskID = InitDevice( "SimResampled" );
+  TEST_CHECK( taskID != SIGNAL_IO_TASK_INVALID_ID, "resampled input task not loaded" );
+  if( taskID == SIGNAL_IO_TASK_INVALID_ID ) return;
+  
+  TEST_CHECK( AcquireResampledInput( taskID, 0.0 ) == SIGNAL_IO_TASK_INVALID_ID, "reader with null rate acquired" );
+  
+  // Down (non integer ratio) and up sampling, with requests shorter and longer than the samples available per call
+  CheckResampledReads( taskID, 300.0, 7 );
+  CheckResampledReads( taskID, 2500.0, 64 );
+  
+  // With the task already running for another channel, the reader channels activate mid stream
+  TEST_CHECK( CheckInputChannel( taskID, 0 ), "input channel acquired" );
+  Test_Sleep( 0.2 );
+  CheckResampledReads( taskID, 300.0, 7 );
+  ReleaseInputChannel( taskID, 0 );
+  
+  EndDevice( taskID );
+  TEST_CHECK( tasksList == NULL, "task left after EndDevice" );
+}
+
+// Counts history samples of channel in [firstSample,lastSample) holding their signal values
+static size_t CountHistorySamples( SignalIOTask task, unsigned int channel, uint64_t firstSample, uint64_t lastSample )
+{
+  size_t samplesCount = 0;
+  const double* channelHistoryList = task->historySamplesList + channel * task->historyLength;
+  for( uint64_t sampleIndex = firstSample; sampleIndex < lastSample; sampleIndex++ )
+    samplesCount += ( channelHistoryList[ sampleIndex % task->historyLength ] == GetRampSignal( channel, sampleIndex ) ) ? 1 : 0;
+  return samplesCount;
+}
+
+// Only channels with readers are aquired and copied to history, from the first block after their acquisition
+static void TestChannelMasks( void )
+{
+  SimDAQmx_AddTask( "SimMask", SIM_TASK_ANALOG_INPUT, INPUT_CHANNELS_NUMBER, INPUT_SAMPLING_RATE );
+  SimDAQmx_SetSignal( "SimMask", GetRampSignal );
+  
+  long int taskID = InitDevice( "SimMask|1" );
+  TEST_CHECK( taskID != SIGNAL_IO_TASK_INVALID_ID, "mask task not loaded" );
+  if( taskID == SIGNAL_IO_TASK_INVALID_ID ) return;
+  SignalIOTask task = GetTask( taskID );
+  
+  TEST_CHECK( CheckInputChannel( taskID, 1 ), "input channel not acquired" );
+  TEST_CHECK( WaitSamples( taskID, 200 ), "no samples aquired" );
+  uint64_t samplesCount = atomic_load( &(task->samplesCount) );
+  TEST_CHECK( task->readChannelsNumber == 1 && task->readChannelsList[ 0 ] == 1, "%u channels read", (unsigned int) task->readChannelsNumber );
+  TEST_CHECK( atomic_load( &(task->channelStartsList[ 0 ]) ) == CHANNEL_INACTIVE, "unused channel active" );
+  TEST_CHECK( CountHistorySamples( task, 0, 1, samplesCount ) == 0, "unused channel copied to history" );
+  
+  double samplesList[ AQUISITION_BUFFER_MAX_LENGTH ];
+  TEST_CHECK( CheckInputChannel( taskID, 0 ), "second input channel not acquired" );
+  size_t samplesNumber = WaitRead( taskID, 0, samplesList );
+  uint64_t channelStart = atomic_load( &(task->channelStartsList[ 0 ]) );
+  TEST_CHECK( samplesNumber > 0 && channelStart != CHANNEL_INACTIVE && channelStart >= samplesCount, "acquired channel not read from its activation" );
+  TEST_CHECK( WaitSamples( taskID, channelStart + 100 ), "no samples aquired after activation" );
+  TEST_CHECK( CountHistorySamples( task, 0, channelStart, channelStart + 100 ) == 100, "acquired channel history" );
+  
+  // Released channels stop being copied from the next block, without pausing the task
+  ReleaseInputChannel( taskID, 1 );
+  double timeoutTime = Test_GetTime() + WAIT_TIMEOUT;
+  while( atomic_load( &(task->channelStartsList[ 1 ]) ) != CHANNEL_INACTIVE && Test_GetTime() < timeoutTime )
+    Test_Sleep( 0.001 );
+  samplesCount = atomic_load( &(task->samplesCount) );
+  TEST_CHECK( atomic_load( &(task->channelStartsList[ 1 ]) ) == CHANNEL_INACTIVE, "released channel active" );
+  TEST_CHECK( WaitSamples( taskID, samplesCount + 200 ), "no samples aquired after release" );
+  TEST_CHECK( CountHistorySamples( task, 1, samplesCount + AQUISITION_BUFFER_MAX_LENGTH, samplesCount + 200 ) == 0, "released channel copied to history" );
+  
+  // Threads of running tasks with no device channels to read (only constant virtual ones) block instead of polling
+  TEST_CHECK( CheckInputChannel( taskID, INPUT_CHANNELS_NUMBER ), "constant virtual channel not acquired" );
+  ReleaseInputChannel( taskID, 0 );
+  Test_Sleep( 0.05 );
+  TEST_CHECK( atomic_load( &(task->state) ) == TASK_RUNNING && task->readChannelsNumber == 0, "task with no device channels read" );
+  clock_t firstClock = clock();
+  Test_Sleep( 0.2 );
+  double idleTime = (double) ( clock() - firstClock ) / CLOCKS_PER_SEC;
+  TEST_CHECK( idleTime < 0.05, "%g s of CPU time with no channels to read", idleTime );
+  ReleaseInputChannel( taskID, INPUT_CHANNELS_NUMBER );
+  
+  EndDevice( taskID );
+  TEST_CHECK( tasksList == NULL, "task left after EndDevice" );
+}
+
+// Resume latency spans from channel (re)acquisition to the first block published after it, so it is bound by the time blocks take to come
+// (the second one is waited for, as latency is only stored after the first one is published)
+static void TestResumeLatency( void )
+{
+  SimDAQmx_AddTask( "SimResume", SIM_TASK_ANALOG_INPUT, INPUT_CHANNELS_NUMBER, INPUT_SAMPLING_RATE );
+  SimDAQmx_SetSignal( "SimResume", GetRampSignal );
+  
+  long int taskID = InitDevice( "SimResume" );
+  TEST_CHECK( taskID != SIGNAL_IO_TASK_INVALID_ID, "resume latency task not loaded" );
+  if( taskID == SIGNAL_IO_TASK_INVALID_ID ) return;
+  
+  SignalIOTask task = GetTask( taskID );
+  double maxLatency = -1.0;
+  TEST_CHECK( GetResumeLatency( taskID, &maxLatency ) == 0.0 && maxLatency == 0.0, "latency before first start" );
+  
+  double samplesList[ AQUISITION_BUFFER_MAX_LENGTH ];
+  double lastMaxLatency = 0.0;
+  for( size_t resumeIndex = 0; resumeIndex < 3; resumeIndex++ )
+  {
+    uint64_t blocksCount = atomic_load( &(task->blocksCount) );
+    double acquireTime = Test_GetTime();
+    TEST_CHECK( CheckInputChannel( taskID, 0 ), "input channel acquired" );
+    double timeoutTime = acquireTime + WAIT_TIMEOUT;
+    while( atomic_load( &(task->blocksCount) ) < blocksCount + 2 && Test_GetTime() < timeoutTime )
+      Test_Sleep( 0.0005 );
+    double blocksDelay = Test_GetTime() - acquireTime;
+    TEST_CHECK( atomic_load( &(task->blocksCount) ) >= blocksCount + 2, "no blocks after resume %zu", resumeIndex );
+    TEST_CHECK( WaitRead( taskID, 0, samplesList ) > 0, "no samples after resume %zu", resumeIndex );
+    
+    double latency = GetResumeLatency( taskID, &maxLatency );
+    TEST_CHECK( latency > 0.0 && latency <= blocksDelay, "resume %zu latency %g s (blocks seen after %g s)", resumeIndex, latency, blocksDelay );
+    TEST_CHECK( maxLatency >= latency && maxLatency >= lastMaxLatency, "max latency %g s below %g s", maxLatency, latency );
+    lastMaxLatency = maxLatency;
+    
+    // Releasing the last channel pauses the task until the next acquisition
+    ReleaseInputChannel( taskID, 0 );
+    Test_Sleep( 0.1 );
+    TEST_CHECK( atomic_load( &(task->state) ) == TASK_PAUSED, "task not paused after release" );
+  }
+  
+  EndDevice( taskID );
+  TEST_CHECK( tasksList == NULL, "task left after EndDevice" );
+}
+
+// Version 2 table: size and entries of the plugin build, and the handle based read path
+static void TestInterfaceV2( void )
+{
+  const SignalIOInterfaceV2* interface = GetInterfaceV2();
+  TEST_CHECK( interface->version == GetInterfaceVersion() && interface->size == sizeof(SignalIOInterfaceV2), "table version and size" );
+  TEST_CHECK( interface->capabilities == GetCapabilities() && ( interface->capabilities & SIGNAL_IO_CAP_READER_POLICIES ), "capabilities" );
+  TEST_CHECK( SIGNAL_IO_V2_HAS( interface, GetTaskID ) && SIGNAL_IO_V2_HAS( interface, ReleaseOutputGroup ), "last entries in table" );
+  SignalIOInterfaceV2 olderInterface = *interface;
+  olderInterface.size = offsetof( SignalIOInterfaceV2, GetTaskID );
+  TEST_CHECK( SIGNAL_IO_V2_HAS( &olderInterface, GetReaderTiming ) && !SIGNAL_IO_V2_HAS( &olderInterface, GetTaskID ), "entries past older table" );
+  
+  SimDAQmx_AddTask( "SimV2", SIM_TASK_ANALOG_INPUT, INPUT_CHANNELS_NUMBER, INPUT_SAMPLING_RATE );
+  SimDAQmx_SetSignal( "SimV2", GetRampSignal );
+  
+  SignalIOTaskHandle task = interface->OpenTask( "SimV2" );
+  TEST_CHECK( task != NULL && GetTask( interface->GetTaskID( task ) ) == task, "task handle and identifier" );
+  if( task == NULL ) return;
+  
+  SignalIOReaderHandle reader = interface->AcquireReader( task, 1, SIGNAL_IO_READER_DROP_OLDEST );
+  TEST_CHECK( reader != NULL && interface->AcquireReader( task, INPUT_CHANNELS_NUMBER, 0 ) == NULL, "reader handles" );
+  double samplesList[ AQUISITION_BUFFER_MAX_LENGTH ];
+  size_t samplesNumber = 0, discontinuitiesCount = 0;
+  double lastSample = NAN, timestamp = 0.0;
+  double endTime = Test_GetTime() + 0.2;
+  while( reader != NULL && Test_GetTime() < endTime )
+  {
+    size_t readSamplesNumber = interface->Read( reader, samplesList, &timestamp );
+    for( size_t sampleIndex = 0; sampleIndex < readSamplesNumber; sampleIndex++ )
+    {
+      if( !isnan( lastSample ) && samplesList[ sampleIndex ] != lastSample + 2.0 ) discontinuitiesCount++;
+      lastSample = samplesList[ sampleIndex ];
+    }
+    samplesNumber += readSamplesNumber;
+    Test_Sleep( 0.005 );
+  }
+  TEST_CHECK( samplesNumber > 100 && discontinuitiesCount == 0, "%zu samples read through handle, %zu gaps", samplesNumber, discontinuitiesCount );
+  TEST_CHECK( timestamp > 0.0 && timestamp <= Test_GetTime(), "read timestamp" );
+  
+  interface->ReleaseReader( reader );
+  interface->CloseTask( task );
+  TEST_CHECK( tasksList == NULL, "task left after CloseTask" );
+}
+
+static void TestViews( void )
+{
+  SimDAQmx_AddTask( "SimViewed", SIM_TASK_ANALOG_INPUT, INPUT_CHANNELS_NUMBER, INPUT_SAMPLING_RATE );
+  SimDAQmx_SetSignal( "SimViewed", GetRampSignal );
+  long int physicalTaskID = (int) kh_str_hash_func( "SimViewed" );
+  
+  // Invalid views leave no task loaded for them
+  TEST_CHECK( InitDevice( "SimViewed:0,5" ) == SIGNAL_IO_TASK_INVALID_ID && GetTask( physicalTaskID ) == NULL, "invalid view loaded" );
+  
+  // Views load their physical task when missing, and views over (named) views map to its channels
+  long int namedViewID = InitDevice( "Swapped=SimViewed:1,0" );
+  long int viewID = InitDevice( "Swapped:0" );
+  TEST_CHECK( namedViewID != SIGNAL_IO_TASK_INVALID_ID && viewID != SIGNAL_IO_TASK_INVALID_ID, "views not loaded" );
+  if( namedViewID == SIGNAL_IO_TASK_INVALID_ID || viewID == SIGNAL_IO_TASK_INVALID_ID ) return;
+  TEST_CHECK( GetTask( physicalTaskID ) != NULL && GetTask( viewID )->parentTask == GetTask( physicalTaskID ), "physical task not shared" );
+  TEST_CHECK( InitDevice( "Swapped" ) == SIGNAL_IO_TASK_INVALID_ID, "task loaded with a view name" );
+  TEST_CHECK( GetMaxInputSamplesNumber( viewID ) == AQUISITION_BUFFER_LENGTH, "view block length" );
+  
+  TEST_CHECK( CheckInputChannel( viewID, 0 ) && !CheckInputChannel( viewID, 1 ), "view channels" );
+  double samplesList[ AQUISITION_BUFFER_MAX_LENGTH ];
+  size_t samplesNumber = WaitRead( viewID, 0, samplesList );
+  TEST_CHECK( samplesNumber > 1 && samplesList[ 1 ] - samplesList[ 0 ] == GetRampSignal( 1, 1 ), "view channel not mapped to physical channel 1" );
+  ReleaseInputChannel( viewID, 0 );
+  
+  // Physical task ends with the last view over it, unless loaded by the client too
+  EndDevice( viewID );
+  TEST_CHECK( GetTask( physicalTaskID ) != NULL, "physical task ended with views left" );
+  EndDevice( namedViewID );
+  TEST_CHECK( GetTask( physicalTaskID ) == NULL, "physical task left after its views" );
+  
+  namedViewID = InitDevice( "Swapped=SimViewed:1,0" );
+  TEST_CHECK( InitDevice( "SimViewed" ) == physicalTaskID, "physical task not loaded by client" );
+  EndDevice( namedViewID );
+  TEST_CHECK( GetTask( physicalTaskID ) != NULL, "client loaded task ended with its view" );
+  EndDevice( physicalTaskID );
+  TEST_CHECK( tasksList == NULL || kh_size( tasksList ) == 0, "tasks left by views" );
+}
+
+int main( int argc, char* argv[] )
+{
+  TestInterfaceV2();
+  TestVirtualChannels();
+  TestViews();
+  TestChannelMasks();
+  TestResampledInput();
+  TestResumeLatency();
+  
+  SimDAQmx_RemoveTasks();
+  
+  return Test_End( "test_plugin" );
+}
@@ -0,0 +1,299 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2019 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of Signal-IO-NIDAQmx.                                   //
+//                                                                            //
+//  Signal-IO-NIDAQmx is free software: you can redistribute it and/or modify //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  Signal-IO-NIDAQmx is distributed in the hope that it will be useful,      //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with Signal-IO-NIDAQmx. If not, see <http://www.gnu.org/licenses/>. //
+//                                                                            //
+
+
+
+
+// Input processing stages over the simulated driver (filters, EMG features, tare, ensembles), checked on the channels history 
+// and on what clients read from it
+
+#include "../ni_daqmx.c"
+
+#include "plugin_utils.h"
+
+#define SPIKE_PERIOD 50
+#define SPIKE_VALUE 1e6
+#define PULSE_PERIOD 100
+
+// Ramp signal with a single sample spike every SPIKE_PERIOD samples
+static double GetSpikedRampSignal( unsigned int channel, uint64_t sampleIndex )
+{
+  return ( sampleIndex % SPIKE_PERIOD == SPIKE_PERIOD / 2 ) ? SPIKE_VALUE : GetRampSignal( channel, sampleIndex );
+}
+
+// Signal alternating between -1 and 1 on every sample
+static double GetAlternatingSignal( unsigned int channel, uint64_t sampleIndex )
+{
+  return ( sampleIndex % 2 == 0 ) ? -1.0 : 1.0;
+}
+
+// Signal alternating around an offset of 5 units per channel number (plus one)
+static double GetOffsetSignal( unsigned int channel, uint64_t sampleIndex )
+{
+  return 5.0 * ( channel + 1 ) + GetAlternatingSignal( channel, sampleIndex );
+}
+
+// Pulse on the first channel every PULSE_PERIOD samples, with the second one ramping from 0 on each pulse
+static double GetPulsedSignal( unsigned int channel, uint64_t sampleIndex )
+{
+  if( channel == 0 ) return ( sampleIndex % PULSE_PERIOD < 10 ) ? 1.0 : 0.0;
+  return (double) ( sampleIndex % PULSE_PERIOD );
+}
+
+// Waits until given ensemble averages some number of sweeps, or timeout
+static size_t WaitSweeps( long int ensembleID, size_t sweepsNumber, double* meansTable, double* variancesTable )
+{
+  double timeoutTime = Test_GetTime() + WAIT_TIMEOUT;
+  size_t sweepsCount = 0;
+  while( ( sweepsCount = ReadEnsembleAverage( ensembleID, meansTable, variancesTable ) ) < sweepsNumber && Test_GetTime() < timeoutTime )
+    Test_Sleep( 0.005 );
+  return sweepsCount;
+}
+
+// Waits until tare estimation completes for given task, or timeout
+static bool WaitTareDone( long int taskID )
+{
+  double timeoutTime = Test_GetTime() + WAIT_TIMEOUT;
+  unsigned int events = 0;
+  while( !( events & SIGNAL_IO_EVENT_TARE_DONE ) && Test_GetTime() < timeoutTime )
+  {
+    events |= WaitEvents( taskID, false );
+    Test_Sleep( 0.001 );
+  }
+  return ( events & SIGNAL_IO_EVENT_TARE_DONE );
+}
+
+// Counts history samples of channel in [firstSample,lastSample) above given value
+static size_t CountHistoryPeaks( SignalIOTask task, unsigned int channel, uint64_t firstSample, uint64_t lastSample, double value )
+{
+  size_t peaksCount = 0;
+  const double* channelHistoryList = task->historySamplesList + channel * task->historyLength;
+  for( uint64_t sampleIndex = firstSample; sampleIndex < lastSample; sampleIndex++ )
+    peaksCount += ( channelHistoryList[ sampleIndex % task->historyLength ] >= value ) ? 1 : 0;
+  return peaksCount;
+}
+
+static void TestInputFilter( void )
+{
+  SimDAQmx_AddTask( "SimFilter", SIM_TASK_ANALOG_INPUT, INPUT_CHANNELS_NUMBER, INPUT_SAMPLING_RATE );
+  SimDAQmx_SetSignal( "SimFilter", GetSpikedRampSignal );
+  
+  long int taskID = InitDevice( "SimFilter" );
+  TEST_CHECK( taskID != SIGNAL_IO_TASK_INVALID_ID, "filter task not loaded" );
+  if( taskID == SIGNAL_IO_TASK_INVALID_ID ) return;
+  SignalIOTask task = GetTask( taskID );
+  
+  TEST_CHECK( CheckInputChannel( taskID, 0 ) && CheckInputChannel( taskID, 1 ), "input channels acquired" );
+  TEST_CHECK( !SetInputFilter( taskID, 0, 4, 3.0 ) && !SetInputFilter( taskID, 0, KERNEL_FILTER_MAX_WINDOW + 2, 3.0 ), "invalid windows set" );
+  TEST_CHECK( SetInputFilter( taskID, 0, 5, 3.0 ), "Hampel filter not set" );
+  // Filtered channels share their window length
+  TEST_CHECK( !SetInputFilter( taskID, 1, 7, 0.0 ) && SetInputFilter( taskID, 1, 5, 0.0 ), "median filter window" );
+  
+  // Settings are applied once set returns (and the aquisition thread copied them): the block being aquired is skipped
+  uint64_t filterStart = atomic_load( &(task->samplesCount) ) + AQUISITION_BUFFER_MAX_LENGTH;
+  TEST_CHECK( WaitSamples( taskID, filterStart + 4 * SPIKE_PERIOD ), "no filtered samples aquired" );
+  uint64_t filterEnd = atomic_load( &(task->samplesCount) );
+  TEST_CHECK( CountHistoryPeaks( task, 0, filterStart, filterEnd, SPIKE_VALUE ) == 0, "spikes left by Hampel filter" );
+  TEST_CHECK( CountHistoryPeaks( task, 1, filterStart, filterEnd, SPIKE_VALUE ) == 0, "spikes left by median filter" );
+  
+  // Disabled filters pass spikes through again
+  TEST_CHECK( SetInputFilter( taskID, 0, 0, 0.0 ) && SetInputFilter( taskID, 1, 0, 0.0 ), "filters not disabled" );
+  TEST_CHECK( SetInputFilter( taskID, 1, 7, 0.0 ) && SetInputFilter( taskID, 1, 0, 0.0 ), "window not changed with no filtered channels" );
+  uint64_t passStart = atomic_load( &(task->samplesCount) ) + AQUISITION_BUFFER_MAX_LENGTH;
+  TEST_CHECK( WaitSamples( taskID, passStart + 4 * SPIKE_PERIOD ), "no unfiltered samples aquired" );
+  TEST_CHECK( CountHistoryPeaks( task, 0, passStart, atomic_load( &(task->samplesCount) ), SPIKE_VALUE ) >= 3, "spikes filtered after disabling" );
+  
+  ReleaseInputChannel( taskID, 0 );
+  ReleaseInputChannel( taskID, 1 );
+  EndDevice( taskID );
+}
+
+// Reads feature windows published after given cursor, for some time. Returns number of windows with features of channel 0 
+// not matching the alternating signal (with given zero crossings count) or timestamps not spaced by the given increment
+static size_t CheckFeatureWindows( long int taskID, uint64_t* ref_cursor, size_t windowLength, double increment, double zeroCrossingsCount, 
+                                   size_t* ref_windowsCount )
+{
+  double featuresTable[ 16 * INPUT_CHANNELS_NUMBER * SIGNAL_IO_EMG_FEATURES_NUMBER ];
+  double timestampsList[ 16 ];
+  double lastTimestamp = NAN;
+  size_t wrongWindowsCount = 0;
+  *ref_windowsCount = 0;
+  double timeoutTime = Test_GetTime() + 0.5;
+  while( Test_GetTime() < timeoutTime )
+  {
+    size_t windowsNumber = ReadEMGFeatures( taskID, ref_cursor, featuresTable, timestampsList, 16 );
+    for( size_t windowIndex = 0; windowIndex < windowsNumber; windowIndex++ )
+    {
+      const double* featuresList = featuresTable + windowIndex * INPUT_CHANNELS_NUMBER * SIGNAL_IO_EMG_FEATURES_NUMBER;
+      if( fabs( featuresList[ SIGNAL_IO_EMG_MAV ] - 1.0 ) > 1e-9 || fabs( featuresList[ SIGNAL_IO_EMG_RMS ] - 1.0 ) > 1e-9 ) wrongWindowsCount++;
+      else if( fabs( featuresList[ SIGNAL_IO_EMG_ZC ] - zeroCrossingsCount ) > 1.0 ) wrongWindowsCount++;
+      else if( fabs( featuresList[ SIGNAL_IO_EMG_WL ] - 2.0 * windowLength ) > 2.0 ) wrongWindowsCount++;
+      else if( !isnan( lastTimestamp ) && fabs( timestampsList[ windowIndex ] - lastTimestamp - increment ) > 1e-3 ) wrongWindowsCount++;
+      lastTimestamp = timestampsList[ windowIndex ];
+    }
+    *ref_windowsCount += windowsNumber;
+    Test_Sleep( 0.01 );
+  }
+  return wrongWindowsCount;
+}
+
+static void TestEMGFeatures( void )
+{
+  SimDAQmx_AddTask( "SimEMG", SIM_TASK_ANALOG_INPUT, INPUT_CHANNELS_NUMBER, INPUT_SAMPLING_RATE );
+  SimDAQmx_SetSignal( "SimEMG", GetAlternatingSignal );
+  
+  long int taskID = InitDevice( "SimEMG" );
+  TEST_CHECK( taskID != SIGNAL_IO_TASK_INVALID_ID, "EMG task not loaded" );
+  if( taskID == SIGNAL_IO_TASK_INVALID_ID ) return;
+  SignalIOTask task = GetTask( taskID );
+  
+  TEST_CHECK( CheckInputChannel( taskID, 0 ), "input channel acquired" );
+  TEST_CHECK( !SetEMGFeatures( taskID, 0.001, 0.01, 0.0 ) && !SetEMGFeatures( taskID, 0.1, 0.0, 0.0 ), "invalid windows set" );
+  
+  // Windows following each configuration only use its settings: every zero crossing counts under the first threshold, none under the second
+  size_t windowsCount;
+  TEST_CHECK( SetEMGFeatures( taskID, 0.1, 0.05, 1.0 ), "features not set" );
+  uint64_t windowsCursor = atomic_load( &(task->featureWindowsCount) );
+  size_t wrongWindowsCount = CheckFeatureWindows( taskID, &windowsCursor, 100, 0.05, 100.0, &windowsCount );
+  TEST_CHECK( windowsCount >= 5 && wrongWindowsCount == 0, "%zu wrong of %zu first windows", wrongWindowsCount, windowsCount );
+  
+  TEST_CHECK( SetEMGFeatures( taskID, 0.04, 0.02, 5.0 ), "features not changed" );
+  windowsCursor = atomic_load( &(task->featureWindowsCount) );
+  wrongWindowsCount = CheckFeatureWindows( taskID, &windowsCursor, 40, 0.02, 0.0, &windowsCount );
+  TEST_CHECK( windowsCount >= 15 && wrongWindowsCount == 0, "%zu wrong of %zu changed windows", wrongWindowsCount, windowsCount );
+  
+  TEST_CHECK( SetEMGFeatures( taskID, 0.0, 0.0, 0.0 ), "features not disabled" );
+  uint64_t windowsCountEnd = atomic_load( &(task->featureWindowsCount) );
+  Test_Sleep( 0.1 );
+  TEST_CHECK( atomic_load( &(task->featureWindowsCount) ) == windowsCountEnd, "windows published after disabling" );
+  
+  ReleaseInputChannel( taskID, 0 );
+  EndDevice( taskID );
+}
+
+static void TestTare( void )
+{
+  SimDAQmx_AddTask( "SimTare", SIM_TASK_ANALOG_INPUT, INPUT_CHANNELS_NUMBER, INPUT_SAMPLING_RATE );
+  SimDAQmx_SetSignal( "SimTare", GetOffsetSignal );
+  
+  long int taskID = InitDevice( "SimTare" );
+  TEST_CHECK( taskID != SIGNAL_IO_TASK_INVALID_ID, "tare task not loaded" );
+  if( taskID == SIGNAL_IO_TASK_INVALID_ID ) return;
+  
+  TEST_CHECK( CheckInputChannel( taskID, 0 ), "input channel not acquired" );
+  TEST_CHECK( !Tare( taskID, 0x1, 0.0 ) && !Tare( taskID, 0x0, 0.1 ), "invalid tare started" );
+  
+  // Only one estimation runs at a time, and channels with no readers are kept in aquisition for it
+  (void) WaitEvents( taskID, false );
+  TEST_CHECK( Tare( taskID, 0x3, 0.1 ), "tare not started" );
+  TEST_CHECK( !Tare( taskID, 0x1, 0.1 ), "tare started during another one" );
+  TEST_CHECK( WaitTareDone( taskID ), "tare not completed" );
+  
+  // Offsets apply from the block after the estimation on, also to channels acquired later
+  TEST_CHECK( CheckInputChannel( taskID, 1 ), "tared channel not acquired" );
+  double samplesList[ AQUISITION_BUFFER_MAX_LENGTH ];
+  size_t samplesNumber = 0;
+  for( unsigned int channel = 0; channel < INPUT_CHANNELS_NUMBER; channel++ )
+  {
+    double maxValue = HUGE_VAL;
+    double timeoutTime = Test_GetTime() + WAIT_TIMEOUT;
+    while( maxValue > 1.1 && Test_GetTime() < timeoutTime )
+    {
+      samplesNumber = WaitRead( taskID, channel, samplesList );
+      maxValue = 0.0;
+      for( size_t sampleIndex = 0; sampleIndex < samplesNumber; sampleIndex++ )
+        maxValue = fmax( maxValue, fabs( samplesList[ sampleIndex ] ) );
+    }
+    TEST_CHECK( samplesNumber > 0 && maxValue <= 1.1, "channel %u tared samples up to %g", channel, maxValue );
+  }
+  // Tasks stay loaded while their channels are kept for taring
+  TEST_CHECK( Tare( taskID, 0x1, 0.01 ), "tare not restarted after completion" );
+  TEST_CHECK( WaitTareDone( taskID ), "restarted tare not completed" );
+  
+  ReleaseInputChannel( taskID, 0 );
+  ReleaseInputChannel( taskID, 1 );
+  EndDevice( taskID );
+}
+
+static void TestEnsembles( void )
+{
+  SimDAQmx_AddTask( "SimEnsemble", SIM_TASK_ANALOG_INPUT, INPUT_CHANNELS_NUMBER, INPUT_SAMPLING_RATE );
+  SimDAQmx_SetSignal( "SimEnsemble", GetPulsedSignal );
+  
+  long int taskID = InitDevice( "SimEnsemble" );
+  TEST_CHECK( taskID != SIGNAL_IO_TASK_INVALID_ID, "ensemble task not loaded" );
+  if( taskID == SIGNAL_IO_TASK_INVALID_ID ) return;
+  
+  unsigned int channel = 1;
+  TEST_CHECK( AcquireEnsembleAverage( taskID, &channel, 1, 0.0, 0.0 ) < 0 && AcquireEnsembleAverage( taskID, &channel, 1, 0.0, 1e3 ) < 0, 
+              "invalid sweeps length accepted" );
+  long int ensembleID = AcquireEnsembleAverage( taskID, &channel, 1, 0.01, 0.04 );
+  TEST_CHECK( ensembleID >= 0, "ensemble not acquired" );
+  if( ensembleID < 0 ) return;
+  
+  TEST_CHECK( !SetEnsembleTrigger( ensembleID, 3, taskID, 0, 0.5 ), "invalid trigger source set" );
+  TEST_CHECK( ReadEnsembleAverage( ensembleID, NULL, NULL ) == 0, "sweeps averaged with no trigger" );
+  
+  // Sweeps around the rising pulse edges all hold the same values, from 10 samples before each pulse
+  double meansList[ 50 ], variancesList[ 50 ];
+  TEST_CHECK( SetEnsembleTrigger( ensembleID, SIGNAL_IO_TRIGGER_INPUT_LEVEL, taskID, 0, 0.5 ), "input trigger not set" );
+  size_t sweepsCount = WaitSweeps( ensembleID, 5, meansList, variancesList );
+  TEST_CHECK( sweepsCount >= 5, "%zu sweeps averaged on pulses", sweepsCount );
+  size_t wrongValuesCount = 0;
+  for( size_t sampleIndex = 0; sampleIndex < 50; sampleIndex++ )
+  {
+    double expectedValue = (double) ( ( sampleIndex + PULSE_PERIOD - 10 ) % PULSE_PERIOD );
+    if( fabs( meansList[ sampleIndex ] - expectedValue ) > 1e-9 || fabs( variancesList[ sampleIndex ] ) > 1e-9 ) wrongValuesCount++;
+  }
+  TEST_CHECK( wrongValuesCount == 0, "%zu averaged values off", wrongValuesCount );
+  
+  // Changing the trigger keeps the averages, and marker triggers start one sweep each
+  TEST_CHECK( SetEnsembleTrigger( ensembleID, SIGNAL_IO_TRIGGER_MARKER, taskID, 7, 0.0 ), "marker trigger not set" );
+  Test_Sleep( 0.1 );
+  size_t markedSweepsCount = ReadEnsembleAverage( ensembleID, NULL, NULL );
+  TEST_CHECK( markedSweepsCount >= sweepsCount, "averages reset on trigger change" );
+  SignalIOTaskHandle task = Task_Open( "SimEnsemble" );
+  for( size_t markerIndex = 0; markerIndex < 3; markerIndex++ )
+  {
+    (void) Task_Mark( task, 6, 0.0 );
+    (void) Task_Mark( task, 7, 0.0 );
+    Test_Sleep( 0.02 );
+  }
+  sweepsCount = WaitSweeps( ensembleID, markedSweepsCount + 3, NULL, NULL );
+  Test_Sleep( 0.1 );
+  TEST_CHECK( ReadEnsembleAverage( ensembleID, NULL, NULL ) == markedSweepsCount + 3, "%zu sweeps averaged on 3 markers", sweepsCount - markedSweepsCount );
+  Task_Close( task );
+  
+  ReleaseEnsembleAverage( ensembleID );
+  TEST_CHECK( ReadEnsembleAverage( ensembleID, NULL, NULL ) == 0, "released ensemble read" );
+  EndDevice( taskID );
+}
+
+int main( int argc, char* argv[] )
+{
+  TestInputFilter();
+  TestEMGFeatures();
+  TestTare();
+  TestEnsembles();
+  
+  SimDAQmx_RemoveTasks();
+  
+  return Test_End( "test_processing" );
+}
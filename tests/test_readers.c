@@ -0,0 +1,322 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2019 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of Signal-IO-NIDAQmx.                                   //
+//                                                                            //
+//  Signal-IO-NIDAQmx is free software: you can redistribute it and/or modify //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  Signal-IO-NIDAQmx is distributed in the hope that it will be useful,      //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with Signal-IO-NIDAQmx. If not, see <http://www.gnu.org/licenses/>. //
+//                                                                            //
+
+
+
+
+// Reader backpressure policies over the simulated driver: samples returned and dropped by readers that fall behind 
+// the acquisition, and their reported status. Also late readers detection, adaptive block lengths and interpolated reads 
+// of the recent history at given times
+
+#include "../ni_daqmx.c"
+
+#include "plugin_utils.h"
+
+// Sets reader position some samples behind the newest aquired one, as if it had not been read meanwhile
+static uint64_t SetReaderLag( SignalIOReader reader, uint64_t lag )
+{
+  uint64_t samplesCount = atomic_load( &(reader->task->samplesCount) );
+  atomic_store( &(reader->samplesCursor), samplesCount - lag );
+  return samplesCount;
+}
+
+static void TestDecimatingReader( void )
+{
+  SimDAQmx_AddTask( "SimDecimate", SIM_TASK_ANALOG_INPUT, INPUT_CHANNELS_NUMBER, INPUT_SAMPLING_RATE );
+  SimDAQmx_SetSignal( "SimDecimate", GetRampSignal );
+  
+  SignalIOTaskHandle task = Task_Open( "SimDecimate" );
+  TEST_CHECK( task != NULL, "decimation task not loaded" );
+  if( task == NULL ) return;
+  
+  SignalIOReaderHandle reader = Task_AcquireReader( task, 1, SIGNAL_IO_READER_DECIMATE_ON_LAG );
+  TEST_CHECK( reader != NULL, "decimating reader not acquired" );
+  TEST_CHECK( WaitSamples( task->taskID, 200 ), "no samples aquired" );
+  
+  double samplesList[ AQUISITION_BUFFER_MAX_LENGTH ];
+  size_t maxSamplesNumber = Task_GetMaxInputSamplesNumber( task );
+  // Lag not multiple of the decimation step: leading remainder is dropped, not the newest samples
+  for( uint64_t lag = 3 * maxSamplesNumber + 1; lag < 10 * maxSamplesNumber; lag += 2 * maxSamplesNumber + 3 )
+  {
+    uint64_t droppedSamplesCount = 0, lastDroppedSamplesCount = 0, readerLag = 0;
+    Reader_GetStatus( reader, NULL, &lastDroppedSamplesCount );
+    uint64_t samplesCount = SetReaderLag( reader, lag );
+    uint64_t firstSample = samplesCount - lag;
+    size_t samplesNumber = Reader_Read( reader, samplesList, NULL );
+    uint64_t samplesCursor = atomic_load( &(reader->samplesCursor) );
+    TEST_CHECK( samplesNumber > 1 && samplesNumber <= maxSamplesNumber, "%zu samples read with lag %lu", samplesNumber, (unsigned long) lag );
+    if( samplesNumber <= 1 ) continue;
+    
+    uint64_t newestSample = (uint64_t) ( samplesList[ samplesNumber - 1 ] / GetRampSignal( 1, 1 ) );
+    TEST_CHECK( newestSample + 1 == samplesCursor && newestSample + 1 >= samplesCount, "newest read sample %lu, aquired %lu", 
+                (unsigned long) newestSample, (unsigned long) samplesCount );
+    size_t stepsCount = 0;
+    double samplesStep = samplesList[ 1 ] - samplesList[ 0 ];
+    for( size_t sampleIndex = 1; sampleIndex < samplesNumber; sampleIndex++ )
+      stepsCount += ( samplesList[ sampleIndex ] - samplesList[ sampleIndex - 1 ] == samplesStep ) ? 1 : 0;
+    TEST_CHECK( stepsCount == samplesNumber - 1 && samplesStep > GetRampSignal( 1, 1 ), "uneven decimation" );
+    
+    Reader_GetStatus( reader, &readerLag, &droppedSamplesCount );
+    TEST_CHECK( droppedSamplesCount - lastDroppedSamplesCount == samplesCursor - firstSample - samplesNumber, 
+                "%lu dropped samples for %zu read from %lu", (unsigned long) ( droppedSamplesCount - lastDroppedSamplesCount ), 
+                samplesNumber, (unsigned long) ( samplesCursor - firstSample ) );
+  }
+  
+  Reader_Release( reader );
+  Task_Close( task );
+}
+
+static void TestDropOldestReader( void )
+{
+  SimDAQmx_AddTask( "SimDropOldest", SIM_TASK_ANALOG_INPUT, INPUT_CHANNELS_NUMBER, INPUT_SAMPLING_RATE );
+  SimDAQmx_SetSignal( "SimDropOldest", GetRampSignal );
+  
+  SignalIOTaskHandle task = Task_Open( "SimDropOldest" );
+  TEST_CHECK( task != NULL, "drop oldest task not loaded" );
+  if( task == NULL ) return;
+  
+  SignalIOReaderHandle reader = Task_AcquireReader( task, 0, SIGNAL_IO_READER_DROP_OLDEST );
+  TEST_CHECK( reader != NULL, "drop oldest reader not acquired" );
+  TEST_CHECK( WaitSamples( task->taskID, 200 ), "no samples aquired" );
+  
+  // Lagging reader gets the oldest pending samples first, in full reads, until it catches up
+  double samplesList[ AQUISITION_BUFFER_MAX_LENGTH ];
+  size_t maxSamplesNumber = Task_GetMaxInputSamplesNumber( task );
+  uint64_t firstSample = SetReaderLag( reader, 5 * maxSamplesNumber ) - 5 * maxSamplesNumber;
+  size_t discontinuitiesCount = 0, readsCount = 0;
+  for( ; readsCount < 5; readsCount++ )
+  {
+    size_t samplesNumber = Reader_Read( reader, samplesList, NULL );
+    if( samplesNumber != maxSamplesNumber ) break;
+    for( size_t sampleIndex = 0; sampleIndex < samplesNumber; sampleIndex++ )
+      discontinuitiesCount += ( samplesList[ sampleIndex ] != GetRampSignal( 0, firstSample++ ) ) ? 1 : 0;
+  }
+  TEST_CHECK( readsCount == 5 && discontinuitiesCount == 0, "%zu full reads, %zu gaps", readsCount, discontinuitiesCount );
+  
+  uint64_t droppedSamplesCount = 0;
+  TEST_CHECK( Reader_GetStatus( reader, NULL, &droppedSamplesCount ) && droppedSamplesCount == 0, "samples dropped with history available" );
+  
+  Reader_Release( reader );
+  Task_Close( task );
+}
+
+static void TestLatestReader( void )
+{
+  SimDAQmx_AddTask( "SimLatest", SIM_TASK_ANALOG_INPUT, INPUT_CHANNELS_NUMBER, INPUT_SAMPLING_RATE );
+  SimDAQmx_SetSignal( "SimLatest", GetRampSignal );
+  
+  SignalIOTaskHandle task = Task_Open( "SimLatest" );
+  TEST_CHECK( task != NULL, "latest only task not loaded" );
+  if( task == NULL ) return;
+  
+  SignalIOReaderHandle reader = Task_AcquireReader( task, 0, SIGNAL_IO_READER_LATEST );
+  TEST_CHECK( reader != NULL, "latest only reader not acquired" );
+  TEST_CHECK( WaitSamples( task->taskID, 200 ), "no samples aquired" );
+  Test_Sleep( 0.1 );
+  
+  // Lagging reader gets the last aquired block, with the whole blocks skipped before it dropped
+  uint64_t readerLag = 0, droppedSamplesCount = 0;
+  TEST_CHECK( Reader_GetStatus( reader, &readerLag, NULL ) && readerLag > 0, "no reader lag" );
+  uint64_t firstSample = atomic_load( &(reader->samplesCursor) );
+  double samplesList[ AQUISITION_BUFFER_MAX_LENGTH ];
+  size_t samplesNumber = Reader_Read( reader, samplesList, NULL );
+  uint64_t samplesCursor = atomic_load( &(reader->samplesCursor) );
+  TEST_CHECK( samplesNumber > 0 && samplesList[ samplesNumber - 1 ] == GetRampSignal( 0, samplesCursor - 1 ), "%zu samples read up to %g, cursor %lu", 
+              samplesNumber, ( samplesNumber > 0 ) ? samplesList[ samplesNumber - 1 ] : NAN, (unsigned long) samplesCursor );
+  Reader_GetStatus( reader, NULL, &droppedSamplesCount );
+  TEST_CHECK( droppedSamplesCount > 0 && droppedSamplesCount + samplesNumber == samplesCursor - firstSample, 
+              "%lu dropped samples for %zu read from %lu", (unsigned long) droppedSamplesCount, samplesNumber, (unsigned long) ( samplesCursor - firstSample ) );
+  
+  // Reads keeping up with the aquisition drop nothing
+  uint64_t lastDroppedSamplesCount = droppedSamplesCount;
+  (void) Reader_Read( reader, samplesList, NULL );
+  Reader_GetStatus( reader, NULL, &droppedSamplesCount );
+  TEST_CHECK( droppedSamplesCount == lastDroppedSamplesCount, "%lu samples dropped by following read", 
+              (unsigned long) ( droppedSamplesCount - lastDroppedSamplesCount ) );
+  
+  Reader_Release( reader );
+  Task_Close( task );
+}
+
+static void TestReaderDeadlines( void )
+{
+  SimDAQmx_AddTask( "SimDeadline", SIM_TASK_ANALOG_INPUT, INPUT_CHANNELS_NUMBER, INPUT_SAMPLING_RATE );
+  SimDAQmx_SetSignal( "SimDeadline", GetRampSignal );
+  
+  SignalIOTaskHandle task = Task_Open( "SimDeadline" );
+  TEST_CHECK( task != NULL, "deadline task not loaded" );
+  if( task == NULL ) return;
+  
+  SignalIOReaderHandle reader = Task_AcquireReader( task, 0, SIGNAL_IO_READER_DROP_OLDEST );
+  TEST_CHECK( reader != NULL, "deadline reader not acquired" );
+  TEST_CHECK( WaitSamples( task->taskID, 100 ), "no samples aquired" );
+  
+  SignalIOReaderTiming timing;
+  TEST_CHECK( !Reader_GetTiming( reader, &timing ), "timing of reader with no deadline" );
+  TEST_CHECK( !Reader_SetDeadline( reader, -1.0, 0.0 ), "invalid deadline set" );
+  TEST_CHECK( Reader_SetDeadline( reader, 0.1, 0.5 ), "deadline not set" );
+  (void) WaitEvents( task->taskID, false );
+  
+  // Readers keeping up with their declared period are never late
+  double samplesList[ AQUISITION_BUFFER_MAX_LENGTH ];
+  double endTime = Test_GetTime() + 0.3;
+  while( Test_GetTime() < endTime )
+  {
+    (void) Reader_Read( reader, samplesList, NULL );
+    Test_Sleep( 0.01 );
+  }
+  TEST_CHECK( Reader_GetTiming( reader, &timing ), "reader timing not available" );
+  uint64_t intervalsCount = 0, agesCount = 0;
+  for( size_t binIndex = 0; binIndex < SIGNAL_IO_READER_HISTOGRAM_BINS; binIndex++ )
+  {
+    intervalsCount += timing.readIntervalsHistogram[ binIndex ];
+    agesCount += timing.dataAgesHistogram[ binIndex ];
+  }
+  TEST_CHECK( timing.readsCount > 10 && intervalsCount == timing.readsCount - 1 && agesCount > 0 && agesCount <= timing.readsCount, 
+              "%lu reads, with %lu intervals and %lu data ages", (unsigned long) timing.readsCount, (unsigned long) intervalsCount, (unsigned long) agesCount );
+  TEST_CHECK( timing.lateReadsCount == 0 && !timing.isLate, "punctual reader late %lu times", (unsigned long) timing.lateReadsCount );
+  TEST_CHECK( timing.maxReadInterval > 0.0 && timing.maxReadInterval < 0.1 * READER_PERIOD_TOLERANCE && timing.maxDataAge > 0.0, 
+              "max read interval %g s, data age %g s", timing.maxReadInterval, timing.maxDataAge );
+  TEST_CHECK( !( WaitEvents( task->taskID, false ) & SIGNAL_IO_EVENT_LATE_READER ), "punctual reader signaled late" );
+  
+  // Stalled readers are signaled before their next read, which is then counted as late
+  double timeoutTime = Test_GetTime() + WAIT_TIMEOUT;
+  unsigned int events = 0;
+  while( !( events & SIGNAL_IO_EVENT_LATE_READER ) && Test_GetTime() < timeoutTime )
+  {
+    events |= WaitEvents( task->taskID, false );
+    Test_Sleep( 0.001 );
+  }
+  TEST_CHECK( events & SIGNAL_IO_EVENT_LATE_READER, "stalled reader not signaled" );
+  TEST_CHECK( Reader_GetTiming( reader, &timing ) && timing.isLate && timing.lateReadsCount == 0, "stalled reader timing" );
+  (void) Reader_Read( reader, samplesList, NULL );
+  TEST_CHECK( Reader_GetTiming( reader, &timing ) && timing.isLate && timing.lateReadsCount == 1, "late read not counted" );
+  TEST_CHECK( Reader_GetTiming( reader, &timing ) && !timing.isLate, "late flag not cleared on query" );
+  
+  TEST_CHECK( Reader_SetDeadline( reader, 0.0, 0.0 ) && !Reader_GetTiming( reader, &timing ), "monitoring not stopped" );
+  
+  Reader_Release( reader );
+  Task_Close( task );
+}
+
+static void TestReadAtTime( void )
+{
+  SimDAQmx_AddTask( "SimReadAtTime", SIM_TASK_ANALOG_INPUT, INPUT_CHANNELS_NUMBER, INPUT_SAMPLING_RATE );
+  SimDAQmx_SetSignal( "SimReadAtTime", GetRampSignal );
+  
+  SignalIOTaskHandle task = Task_Open( "SimReadAtTime" );
+  TEST_CHECK( task != NULL, "time query task not loaded" );
+  if( task == NULL ) return;
+  
+  SignalIOReaderHandle readersList[ INPUT_CHANNELS_NUMBER ];
+  for( unsigned int channel = 0; channel < INPUT_CHANNELS_NUMBER; channel++ )
+    readersList[ channel ] = Task_AcquireReader( task, channel, SIGNAL_IO_READER_DROP_OLDEST );
+  TEST_CHECK( WaitSamples( task->taskID, 500 ), "no samples aquired" );
+  
+  // Ramps are reproduced exactly by both interpolations, at fractional positions of more than a timestamps chunk. 
+  // The last timestamp is still to be aquired
+  const size_t TIMESTAMPS_NUMBER = READ_TIMES_CHUNK_LENGTH + 11;
+  const unsigned int CHANNELS_LIST[] = { 1, 0, INPUT_CHANNELS_NUMBER };
+  double positionsList[ TIMESTAMPS_NUMBER ], timestampsList[ TIMESTAMPS_NUMBER ];
+  double valuesTable[ 3 * TIMESTAMPS_NUMBER ];
+  int interpolationsList[] = { SIGNAL_IO_INTERPOLATION_LINEAR, SIGNAL_IO_INTERPOLATION_CUBIC };
+  for( size_t interpolationIndex = 0; interpolationIndex < 2; interpolationIndex++ )
+  {
+    double lastPosition = (double) atomic_load( &(task->samplesCount) ) - 3.0;
+    for( size_t timestampIndex = 0; timestampIndex < TIMESTAMPS_NUMBER; timestampIndex++ )
+    {
+      positionsList[ timestampIndex ] = lastPosition - 200.0 + 2.7 * timestampIndex;
+      timestampsList[ timestampIndex ] = GetSampleTime( task, positionsList[ timestampIndex ] );
+    }
+    timestampsList[ TIMESTAMPS_NUMBER - 1 ] = GetSampleTime( task, lastPosition + 1000.0 );
+    
+    size_t validTimestampsNumber = ReadAtTime( task->taskID, CHANNELS_LIST, 3, timestampsList, TIMESTAMPS_NUMBER, 
+                                               interpolationsList[ interpolationIndex ], valuesTable );
+    TEST_CHECK( validTimestampsNumber == TIMESTAMPS_NUMBER - 1, "%zu valid timestamps", validTimestampsNumber );
+    
+    size_t errorsCount = 0;
+    for( size_t timestampIndex = 0; timestampIndex < TIMESTAMPS_NUMBER - 1; timestampIndex++ )
+    {
+      for( size_t channelIndex = 0; channelIndex < 2; channelIndex++ )
+      {
+        double value = valuesTable[ channelIndex * TIMESTAMPS_NUMBER + timestampIndex ];
+        double expectedValue = ( CHANNELS_LIST[ channelIndex ] + 1 ) * positionsList[ timestampIndex ];
+        if( !( fabs( value - expectedValue ) < 1e-3 * positionsList[ timestampIndex ] ) ) errorsCount++;
+      }
+      if( !isnan( valuesTable[ 2 * TIMESTAMPS_NUMBER + timestampIndex ] ) ) errorsCount++;
+    }
+    for( size_t channelIndex = 0; channelIndex < 3; channelIndex++ )
+      errorsCount += isnan( valuesTable[ channelIndex * TIMESTAMPS_NUMBER + TIMESTAMPS_NUMBER - 1 ] ) ? 0 : 1;
+    TEST_CHECK( errorsCount == 0, "%zu wrong values with interpolation %d", errorsCount, interpolationsList[ interpolationIndex ] );
+  }
+  
+  for( unsigned int channel = 0; channel < INPUT_CHANNELS_NUMBER; channel++ )
+    Reader_Release( readersList[ channel ] );
+  Task_Close( task );
+}
+
+static void TestAdaptiveBlocks( void )
+{
+  SimDAQmx_AddTask( "SimAdaptive", SIM_TASK_ANALOG_INPUT, INPUT_CHANNELS_NUMBER, INPUT_SAMPLING_RATE );
+  SimDAQmx_SetSignal( "SimAdaptive", GetRampSignal );
+  
+  SignalIOTaskHandle task = Task_Open( "SimAdaptive" );
+  TEST_CHECK( task != NULL, "adaptive task not loaded" );
+  if( task == NULL ) return;
+  
+  // Read buffers follow the max block length, and the history keeps many blocks of the longest one allowed
+  TEST_CHECK( !SetAdaptiveInput( task->taskID, AQUISITION_BUFFER_MAX_LENGTH + 1 ), "too long blocks accepted" );
+  TEST_CHECK( SetAdaptiveInput( task->taskID, 100 ) && Task_GetMaxInputSamplesNumber( task ) == 100, "max block length not taken" );
+  TEST_CHECK( task->historyLength >= 16 * AQUISITION_BUFFER_MAX_LENGTH, "history of %zu samples", task->historyLength );
+  
+  SignalIOReaderHandle reader = Task_AcquireReader( task, 1, SIGNAL_IO_READER_DROP_OLDEST );
+  TEST_CHECK( WaitSamples( task->taskID, 1000 ), "no samples aquired" );
+  
+  // Blocks shrink back with no driver backlog, and lagging readers still get every sample
+  double samplesList[ AQUISITION_BUFFER_MAX_LENGTH ];
+  uint64_t firstSample = SetReaderLag( reader, 800 ) - 800;
+  size_t readSamplesCount = 0, discontinuitiesCount = 0, samplesNumber;
+  while( ( samplesNumber = Reader_Read( reader, samplesList, NULL ) ) > 0 && readSamplesCount < 800 )
+  {
+    TEST_CHECK( samplesNumber <= 100, "%zu samples read", samplesNumber );
+    for( size_t sampleIndex = 0; sampleIndex < samplesNumber && sampleIndex < 100; sampleIndex++ )
+      discontinuitiesCount += ( samplesList[ sampleIndex ] != GetRampSignal( 1, firstSample++ ) ) ? 1 : 0;
+    readSamplesCount += samplesNumber;
+  }
+  TEST_CHECK( readSamplesCount >= 800 && discontinuitiesCount == 0, "%zu samples read, %zu gaps", readSamplesCount, discontinuitiesCount );
+  TEST_CHECK( GetInputBlockLength( task->taskID, NULL ) < 100, "blocks not shrunk" );
+  
+  Reader_Release( reader );
+  Task_Close( task );
+}
+
+int main( int argc, char* argv[] )
+{
+  TestDecimatingReader();
+  TestDropOldestReader();
+  TestLatestReader();
+  TestReaderDeadlines();
+  TestReadAtTime();
+  TestAdaptiveBlocks();
+  
+  SimDAQmx_RemoveTasks();
+  
+  return Test_End( "test_readers" );
+}
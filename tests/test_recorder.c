@@ -0,0 +1,344 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2019 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of Signal-IO-NIDAQmx.                                   //
+//                                                                            //
+//  Signal-IO-NIDAQmx is free software: you can redistribute it and/or modify //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  Signal-IO-NIDAQmx is distributed in the hope that it will be useful,      //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with Signal-IO-NIDAQmx. If not, see <http://www.gnu.org/licenses/>. //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+// Recorder rings: marker slot sequences (seqlock) under concurrent writers, snapshot bounds with writes in progress 
+// crash recovery of still active regions, and regions left untouched while their owner is alive
+
+#include "signal_recorder.h"
+
+#include "test_utils.h"
+
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define WRITERS_NUMBER 3
+#define WRITER_MARKERS_NUMBER 50000
+#define STRESS_FRAMES_NUMBER 200000
+
+static char regionName[ RECORDER_NAME_MAX_LENGTH ];
+
+static const char* GetRegionName( const char* suffix )
+{
+  snprintf( regionName, RECORDER_NAME_MAX_LENGTH, "test_recorder_%d_%s", (int) getpid(), suffix );
+  return regionName;
+}
+
+// Markers carry their writer and sequence number, so that mixed (torn) contents are detectable
+static SignalRecorderMarker GetTestMarker( uint32_t writer, uint64_t number )
+{
+  SignalRecorderMarker marker = { number, (double) number, writer, 0, (double) number * ( writer + 1 ) };
+  return marker;
+}
+
+static bool IsTestMarker( const SignalRecorderMarker* marker )
+{
+  return ( marker->time == (double) marker->sampleIndex && marker->payload == (double) marker->sampleIndex * ( marker->code + 1 ) 
+           && marker->code < WRITERS_NUMBER && marker->reserved == 0 );
+}
+
+static void TestMarkersRing( void )
+{
+  bool wasActive;
+  SignalRecorder recorder = Recorder_Open( GetRegionName( "markers" ), 1, 0, 0, 0, 4, 0.0, &wasActive );
+  TEST_CHECK( recorder != NULL && !wasActive, "new region" );
+  Recorder_Reset( recorder, 0 );
+  
+  SignalRecorderMarker marker;
+  TEST_CHECK( Recorder_ReadMarker( recorder, 0, &marker ) == 0, "marker read before written" );
+  for( uint64_t number = 0; number < 6; number++ )
+  {
+    SignalRecorderMarker newMarker = GetTestMarker( 0, number );
+    Recorder_WriteMarker( recorder, &newMarker );
+  }
+  
+  TEST_CHECK( Recorder_ReadMarker( recorder, 1, &marker ) == -1, "overwritten marker read" );
+  for( uint64_t markerIndex = 2; markerIndex < 6; markerIndex++ )
+  {
+    int readStatus = Recorder_ReadMarker( recorder, markerIndex, &marker );
+    TEST_CHECK( readStatus == 1 && marker.sampleIndex == markerIndex && IsTestMarker( &marker ), "marker %lu read %d", (unsigned long) markerIndex, readStatus );
+  }
+  TEST_CHECK( Recorder_ReadMarker( recorder, 6, &marker ) == 0, "marker read before written" );
+  
+  // Slot of marker 6 taken by a writer (odd sequence), but not completely written yet
+  atomic_store( &(recorder->markersList[ 6 % 4 ].sequence), 2 * 6 + 1 );
+  TEST_CHECK( Recorder_ReadMarker( recorder, 6, &marker ) == 0, "marker read while being written" );
+  TEST_CHECK( Recorder_ReadMarker( recorder, 2, &marker ) == -1, "marker read while being overwritten" );
+  
+  Recorder_Close( recorder );
+}
+
+typedef struct _MarkersStressData
+{
+  SignalRecorder recorder;
+  uint32_t writer;
+  atomic_bool* isWriting;
+}
+MarkersStressData;
+
+static void* WriteMarkers( void* data )
+{
+  MarkersStressData* stress = (MarkersStressData*) data;
+  for( uint64_t number = 0; number < WRITER_MARKERS_NUMBER; number++ )
+  {
+    SignalRecorderMarker marker = GetTestMarker( stress->writer, number );
+    Recorder_WriteMarker( stress->recorder, &marker );
+    if( number % 64 == 0 ) sched_yield();
+  }
+  return NULL;
+}
+
+static void TestMarkersConcurrency( void )
+{
+  bool wasActive;
+  SignalRecorder recorder = Recorder_Open( GetRegionName( "markers_stress" ), 1, 0, 0, 0, 8, 0.0, &wasActive );
+  Recorder_Reset( recorder, 0 );
+  
+  pthread_t writerThreadsList[ WRITERS_NUMBER ];
+  MarkersStressData stressDataList[ WRITERS_NUMBER ];
+  for( uint32_t writer = 0; writer < WRITERS_NUMBER; writer++ )
+  {
+    stressDataList[ writer ] = (MarkersStressData) { recorder, writer, NULL };
+    pthread_create( &(writerThreadsList[ writer ]), NULL, WriteMarkers, &(stressDataList[ writer ]) );
+  }
+  
+  // Reads racing with writers must either fail or return whole markers
+  const uint64_t MARKERS_NUMBER = WRITERS_NUMBER * WRITER_MARKERS_NUMBER;
+  size_t readsCount = 0, tornReadsCount = 0;
+  uint64_t markersCount;
+  while( ( markersCount = atomic_load( &(recorder->header->markersCount) ) ) < MARKERS_NUMBER )
+  {
+    SignalRecorderMarker marker;
+    for( uint64_t markerIndex = ( markersCount > 8 ) ? markersCount - 8 : 0; markerIndex <= markersCount; markerIndex++ )
+    {
+      if( Recorder_ReadMarker( recorder, markerIndex, &marker ) != 1 ) continue;
+      readsCount++;
+      if( !IsTestMarker( &marker ) ) tornReadsCount++;
+    }
+  }
+  
+  for( uint32_t writer = 0; writer < WRITERS_NUMBER; writer++ )
+    pthread_join( writerThreadsList[ writer ], NULL );
+  
+  TEST_CHECK( tornReadsCount == 0, "%zu torn marker reads (of %zu)", tornReadsCount, readsCount );
+  
+  // Once writers are done, the whole ring is readable
+  for( uint64_t markerIndex = MARKERS_NUMBER - 8; markerIndex < MARKERS_NUMBER; markerIndex++ )
+  {
+    SignalRecorderMarker marker;
+    TEST_CHECK( Recorder_ReadMarker( recorder, markerIndex, &marker ) == 1 && IsTestMarker( &marker ), "marker %lu", (unsigned long) markerIndex );
+  }
+  
+  Recorder_Close( recorder );
+}
+
+static void WriteTestFrame( SignalRecorder recorder, uint64_t frameIndex )
+{
+  double valuesList[ 2 ] = { (double) frameIndex, -(double) frameIndex };
+  Recorder_WriteFrame( recorder, (double) frameIndex, valuesList );
+}
+
+static bool IsTestFrame( const SignalRecording* snapshot, uint64_t frameIndex )
+{
+  const double* frame = snapshot->data.framesList + ( frameIndex % snapshot->data.header->framesNumber ) * snapshot->data.header->framesWidth;
+  return ( frame[ 0 ] == (double) frameIndex && frame[ 1 ] == (double) frameIndex && frame[ 2 ] == -(double) frameIndex );
+}
+
+// Writes samples block (first channel values equal to their indexes) as the plugin aquisition does: history first, then block info
+static void WriteTestBlock( SignalRecorder recorder, uint64_t blockIndex, uint64_t blockLength, bool isPublished )
+{
+  SignalRecorderHeader* header = recorder->header;
+  for( uint64_t sampleIndex = blockIndex * blockLength; sampleIndex < ( blockIndex + 1 ) * blockLength; sampleIndex++ )
+    recorder->samplesList[ sampleIndex % header->historyLength ] = isPublished ? (double) sampleIndex : NAN;
+  if( !isPublished ) return;
+  SignalIOBlockData* block = &(recorder->blocksList[ blockIndex % header->blocksNumber ]);
+  block->samplesEnd = ( blockIndex + 1 ) * blockLength;
+  block->samplesNumber = blockLength;
+  block->time = (double) blockIndex;
+}
+
+static void TestSnapshotBounds( void )
+{
+  const uint64_t BLOCK_LENGTH = 4;
+  bool wasActive;
+  SignalRecorder recorder = Recorder_Open( GetRegionName( "snapshot" ), 2, 4, 16, 8, 4, 1000.0, &wasActive );
+  Recorder_Reset( recorder, 0 );
+  
+  for( uint64_t frameIndex = 0; frameIndex < 20; frameIndex++ )
+    WriteTestFrame( recorder, frameIndex );
+  for( uint64_t blockIndex = 0; blockIndex < 6; blockIndex++ )
+    WriteTestBlock( recorder, blockIndex, BLOCK_LENGTH, true );
+  // Frame 20 and block 6 half written (overwriting frame 12 and samples 8 to 11), as if the snapshot was taken during writes
+  double* frame = recorder->framesList + ( 20 % 8 ) * recorder->header->framesWidth;
+  frame[ 0 ] = 20.0;
+  WriteTestBlock( recorder, 6, BLOCK_LENGTH, false );
+  
+  SignalRecording* snapshot = Recorder_TakeSnapshot( recorder, BLOCK_LENGTH );
+  TEST_CHECK( snapshot != NULL, "snapshot taken" );
+  TEST_CHECK( snapshot->framesStart == 13 && snapshot->framesEnd == 20, "frames range %lu-%lu", 
+              (unsigned long) snapshot->framesStart, (unsigned long) snapshot->framesEnd );
+  for( uint64_t frameIndex = snapshot->framesStart; frameIndex < snapshot->framesEnd; frameIndex++ )
+    TEST_CHECK( IsTestFrame( snapshot, frameIndex ), "frame %lu", (unsigned long) frameIndex );
+  TEST_CHECK( snapshot->samplesStart == 12 && snapshot->samplesEnd == 24, "samples range %lu-%lu", 
+              (unsigned long) snapshot->samplesStart, (unsigned long) snapshot->samplesEnd );
+  for( uint64_t sampleIndex = snapshot->samplesStart; sampleIndex < snapshot->samplesEnd; sampleIndex++ )
+  {
+    double sample = snapshot->data.samplesList[ sampleIndex % 16 ];
+    TEST_CHECK( sample == (double) sampleIndex, "sample %lu: %g", (unsigned long) sampleIndex, sample );
+  }
+  
+  Recorder_DiscardSnapshot( snapshot );
+  Recorder_Close( recorder );
+}
+
+static void* WriteFrames( void* data )
+{
+  SignalRecorder recorder = (SignalRecorder) data;
+  for( uint64_t frameIndex = 0; frameIndex < STRESS_FRAMES_NUMBER; frameIndex++ )
+  {
+    WriteTestFrame( recorder, frameIndex );
+    if( frameIndex % 256 == 0 ) sched_yield();
+  }
+  return NULL;
+}
+
+static void TestSnapshotConcurrency( void )
+{
+  bool wasActive;
+  SignalRecorder recorder = Recorder_Open( GetRegionName( "snapshot_stress" ), 2, 0, 0, 64, 4, 0.0, &wasActive );
+  Recorder_Reset( recorder, 0 );
+  
+  pthread_t writerThread;
+  pthread_create( &writerThread, NULL, WriteFrames, recorder );
+  
+  size_t snapshotsCount = 0, tornFramesCount = 0;
+  while( atomic_load( &(recorder->header->framesCount) ) < STRESS_FRAMES_NUMBER )
+  {
+    SignalRecording* snapshot = Recorder_TakeSnapshot( recorder, 0 );
+    for( uint64_t frameIndex = snapshot->framesStart; frameIndex < snapshot->framesEnd; frameIndex++ )
+      if( !IsTestFrame( snapshot, frameIndex ) ) tornFramesCount++;
+    Recorder_DiscardSnapshot( snapshot );
+    snapshotsCount++;
+  }
+  pthread_join( writerThread, NULL );
+  
+  TEST_CHECK( tornFramesCount == 0, "%zu torn frames (in %zu snapshots)", tornFramesCount, snapshotsCount );
+  
+  Recorder_Close( recorder );
+}
+
+static void TestCrashRecovery( void )
+{
+  char dumpFilePath[ RECORDER_NAME_MAX_LENGTH ];
+  snprintf( dumpFilePath, RECORDER_NAME_MAX_LENGTH, "test_recorder_%d.sigrec", (int) getpid() );
+  
+  // Session of a process exiting without closing its region (as on crashes)
+  bool wasActive;
+  const char* name = GetRegionName( "crash" );
+  pid_t crashedProcess = fork();
+  if( crashedProcess == 0 )
+  {
+    SignalRecorder crashedRecorder = Recorder_Open( name, 2, 0, 0, 8, 4, 0.0, &wasActive );
+    if( crashedRecorder == NULL || crashedRecorder->name[ 0 ] == '\0' ) _exit( 1 );
+    Recorder_Reset( crashedRecorder, 0 );
+    for( uint64_t frameIndex = 0; frameIndex < 5; frameIndex++ )
+      WriteTestFrame( crashedRecorder, frameIndex );
+    SignalRecorderMarker marker = GetTestMarker( 1, 7 );
+    Recorder_WriteMarker( crashedRecorder, &marker );
+    _exit( 0 );
+  }
+  int crashedStatus = -1;
+  TEST_CHECK( crashedProcess > 0 && waitpid( crashedProcess, &crashedStatus, 0 ) == crashedProcess && crashedStatus == 0, "crashed session run" );
+  
+  // Region of the crashed session (never closed, with no owner left) is found active by the next one
+  SignalRecorder recorder = Recorder_Open( name, 2, 0, 0, 8, 4, 0.0, &wasActive );
+  TEST_CHECK( recorder != NULL && recorder->name[ 0 ] != '\0', "shared memory region mapped" );
+  TEST_CHECK( wasActive, "crashed region found active" );
+  
+  SignalRecording* snapshot = Recorder_TakeSnapshot( recorder, 0 );
+  TEST_CHECK( snapshot->framesStart == 0 && snapshot->framesEnd == 5, "crash frames range" );
+  TEST_CHECK( Recorder_Dump( snapshot, dumpFilePath ), "crash dump written" );
+  Recorder_DiscardSnapshot( snapshot );
+  
+  FILE* recordingFile = fopen( dumpFilePath, "rb" );
+  SignalRecordingHeader recordingHeader = { 0 };
+  TEST_CHECK( recordingFile != NULL && fread( &recordingHeader, sizeof(SignalRecordingHeader), 1, recordingFile ) == 1, "dump read" );
+  TEST_CHECK( memcmp( recordingHeader.magic, RECORDER_MAGIC, 8 ) == 0 && recordingHeader.channelsNumber == 2 
+              && recordingHeader.framesNumber == 5 && recordingHeader.markersNumber == 1, "dump header" );
+  double frame[ 3 ];
+  for( uint64_t frameIndex = 0; frameIndex < recordingHeader.framesNumber; frameIndex++ )
+  {
+    TEST_CHECK( fread( frame, sizeof(double), 3, recordingFile ) == 3 && frame[ 0 ] == (double) frameIndex && frame[ 2 ] == -(double) frameIndex, 
+                "dumped frame %lu", (unsigned long) frameIndex );
+  }
+  SignalRecorderMarker marker;
+  TEST_CHECK( fread( &marker, sizeof(SignalRecorderMarker), 1, recordingFile ) == 1 && IsTestMarker( &marker ) && marker.sampleIndex == 7, "dumped marker" );
+  if( recordingFile != NULL ) fclose( recordingFile );
+  remove( dumpFilePath );
+  
+  Recorder_Close( recorder );
+}
+
+// Other loaders of a region in use (same or other process), with the same layout or not, get private regions
+static void TestLiveOwner( void )
+{
+  bool wasActive;
+  SignalRecorder recorder = Recorder_Open( GetRegionName( "owned" ), 2, 0, 0, 8, 4, 0.0, &wasActive );
+  TEST_CHECK( recorder != NULL && recorder->name[ 0 ] != '\0', "shared memory region mapped" );
+  Recorder_Reset( recorder, 0 );
+  for( uint64_t frameIndex = 0; frameIndex < 5; frameIndex++ )
+    WriteTestFrame( recorder, frameIndex );
+  
+  const uint64_t FRAMES_NUMBERS_LIST[] = { 16, 8 };
+  for( size_t loaderIndex = 0; loaderIndex < 2; loaderIndex++ )
+  {
+    SignalRecorder otherRecorder = Recorder_Open( GetRegionName( "owned" ), 2, 0, 0, FRAMES_NUMBERS_LIST[ loaderIndex ], 4, 0.0, &wasActive );
+    TEST_CHECK( otherRecorder != NULL && otherRecorder->name[ 0 ] == '\0', "private region for %lu frames", (unsigned long) FRAMES_NUMBERS_LIST[ loaderIndex ] );
+    TEST_CHECK( !wasActive, "region in use taken as crashed" );
+    if( otherRecorder == NULL ) continue;
+    Recorder_Reset( otherRecorder, 0 );
+    WriteTestFrame( otherRecorder, 100 );
+    Recorder_Close( otherRecorder );
+  }
+  
+  // Owner region (still mapped with its size) keeps its contents
+  TEST_CHECK( recorder->header->isActive && atomic_load( &(recorder->header->framesCount) ) == 5, "owner region reset" );
+  bool isIntact = true;
+  for( uint64_t frameIndex = 0; frameIndex < 5; frameIndex++ )
+    isIntact = isIntact && recorder->framesList[ frameIndex * recorder->header->framesWidth ] == (double) frameIndex;
+  TEST_CHECK( isIntact, "owner frames overwritten" );
+  
+  Recorder_Close( recorder );
+}
+
+int main( int argc, char* argv[] )
+{
+  TestMarkersRing();
+  TestMarkersConcurrency();
+  TestSnapshotBounds();
+  TestSnapshotConcurrency();
+  TestCrashRecovery();
+  TestLiveOwner();
+  
+  return Test_End( "test_recorder" );
+}
@@ -0,0 +1,158 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2019 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of Signal-IO-NIDAQmx.                                   //
+//                                                                            //
+//  Signal-IO-NIDAQmx is free software: you can redistribute it and/or modify //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  Signal-IO-NIDAQmx is distributed in the hope that it will be useful,      //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with Signal-IO-NIDAQmx. If not, see <http://www.gnu.org/licenses/>. //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+
+// Task recordings over the simulated driver: dumps requested by clients (written in background, up to the request 
+// position) and dumps of sessions left active by crashed processes, found when the task is loaded again
+
+#include "../ni_daqmx.c"
+
+#include "plugin_utils.h"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+static bool WaitDumpEnd( long int taskID )
+{
+  SignalIOTask task = GetTask( taskID );
+  double timeoutTime = Test_GetTime() + WAIT_TIMEOUT;
+  while( atomic_load( &(task->isDumping) ) && Test_GetTime() < timeoutTime )
+    Test_Sleep( 0.001 );
+  return !atomic_load( &(task->isDumping) );
+}
+
+// Checks recording file header and its input samples (ramp signal, NaN on channels with no readers)
+static void CheckInputRecording( const char* filePath, uint64_t minSamplesEnd, uint64_t maxSamplesEnd, const bool* activeChannelsList )
+{
+  FILE* recordingFile = fopen( filePath, "rb" );
+  TEST_CHECK( recordingFile != NULL, "recording %s not written", filePath );
+  if( recordingFile == NULL ) return;
+  
+  SignalRecordingHeader recordingHeader;
+  TEST_CHECK( fread( &recordingHeader, sizeof(SignalRecordingHeader), 1, recordingFile ) == 1, "recording header read" );
+  TEST_CHECK( memcmp( recordingHeader.magic, RECORDER_MAGIC, 8 ) == 0 && recordingHeader.channelsNumber == INPUT_CHANNELS_NUMBER 
+              && recordingHeader.samplingRate == INPUT_SAMPLING_RATE, "recording header" );
+  uint64_t samplesEnd = recordingHeader.firstSample + recordingHeader.samplesNumber;
+  TEST_CHECK( recordingHeader.samplesNumber > 0 && samplesEnd >= minSamplesEnd && samplesEnd <= maxSamplesEnd, 
+              "recorded samples [%lu,%lu) out of [%lu,%lu]", (unsigned long) recordingHeader.firstSample, (unsigned long) samplesEnd, 
+              (unsigned long) minSamplesEnd, (unsigned long) maxSamplesEnd );
+  
+  // Recorded blocks are the ones with all of their samples kept, oldest first
+  uint64_t lastBlockEnd = recordingHeader.firstSample;
+  for( uint64_t blockIndex = 0; blockIndex < recordingHeader.blocksNumber; blockIndex++ )
+  {
+    SignalIOBlockData block;
+    TEST_CHECK( fread( &block, sizeof(SignalIOBlockData), 1, recordingFile ) == 1, "recorded block read" );
+    TEST_CHECK( block.samplesEnd - block.samplesNumber >= lastBlockEnd && block.samplesEnd <= samplesEnd, "recorded block %lu", (unsigned long) blockIndex );
+    lastBlockEnd = block.samplesEnd;
+  }
+  
+  // Active channels may start (with their reader) after the first recorded sample
+  size_t mismatchesCount = 0;
+  for( unsigned int channel = 0; channel < INPUT_CHANNELS_NUMBER; channel++ )
+  {
+    bool isChannelStarted = false;
+    for( uint64_t sampleIndex = recordingHeader.firstSample; sampleIndex < samplesEnd; sampleIndex++ )
+    {
+      double sample;
+      if( fread( &sample, sizeof(double), 1, recordingFile ) != 1 ) mismatchesCount++;
+      else if( isnan( sample ) ) mismatchesCount += isChannelStarted ? 1 : 0;
+      else if( !activeChannelsList[ channel ] || sample != GetRampSignal( channel, sampleIndex ) ) mismatchesCount++;
+      else isChannelStarted = true;
+    }
+    if( activeChannelsList[ channel ] && !isChannelStarted ) mismatchesCount++;
+  }
+  TEST_CHECK( mismatchesCount == 0, "%zu recorded samples off", mismatchesCount );
+  
+  fclose( recordingFile );
+}
+
+static void TestTaskDump( void )
+{
+  SimDAQmx_AddTask( "SimDump", SIM_TASK_ANALOG_INPUT, INPUT_CHANNELS_NUMBER, INPUT_SAMPLING_RATE );
+  SimDAQmx_SetSignal( "SimDump", GetRampSignal );
+  
+  long int taskID = InitDevice( "SimDump" );
+  TEST_CHECK( taskID != SIGNAL_IO_TASK_INVALID_ID, "dump task not loaded" );
+  if( taskID == SIGNAL_IO_TASK_INVALID_ID ) return;
+  SignalIOTask task = GetTask( taskID );
+  
+  char filePath[ RECORDER_NAME_MAX_LENGTH ];
+  snprintf( filePath, RECORDER_NAME_MAX_LENGTH, "test_recording_%d.sigrec", (int) getpid() );
+  
+  TEST_CHECK( CheckInputChannel( taskID, 0 ) && CheckInputChannel( taskID, 1 ), "input channels acquired" );
+  TEST_CHECK( WaitSamples( taskID, 200 ), "no samples aquired" );
+  
+  // Recording ends where it was requested, even if written later
+  uint64_t requestSamplesCount = atomic_load( &(task->samplesCount) );
+  TEST_CHECK( DumpRecording( taskID, filePath ), "dump not started" );
+  uint64_t requestedSamplesCount = atomic_load( &(task->samplesCount) );
+  TEST_CHECK( WaitDumpEnd( taskID ), "dump not finished" );
+  bool activeChannelsList[ INPUT_CHANNELS_NUMBER ] = { true, true };
+  CheckInputRecording( filePath, requestSamplesCount, requestedSamplesCount, activeChannelsList );
+  remove( filePath );
+  
+  ReleaseInputChannel( taskID, 0 );
+  ReleaseInputChannel( taskID, 1 );
+  EndDevice( taskID );
+}
+
+static void TestCrashDump( void )
+{
+  SimDAQmx_AddTask( "SimCrash", SIM_TASK_ANALOG_INPUT, INPUT_CHANNELS_NUMBER, INPUT_SAMPLING_RATE );
+  SimDAQmx_SetSignal( "SimCrash", GetRampSignal );
+  remove( "SimCrash_crash.sigrec" );
+  
+  // Process exiting with its task running, never ended
+  pid_t crashedProcess = fork();
+  if( crashedProcess == 0 )
+  {
+    long int taskID = InitDevice( "SimCrash" );
+    if( taskID == SIGNAL_IO_TASK_INVALID_ID || !CheckInputChannel( taskID, 0 ) || !WaitSamples( taskID, 200 ) ) _exit( 1 );
+    _exit( 0 );
+  }
+  int crashedStatus = -1;
+  TEST_CHECK( crashedProcess > 0 && waitpid( crashedProcess, &crashedStatus, 0 ) == crashedProcess && crashedStatus == 0, "crashed session run" );
+  
+  long int taskID = InitDevice( "SimCrash" );
+  TEST_CHECK( taskID != SIGNAL_IO_TASK_INVALID_ID, "crashed task not loaded again" );
+  if( taskID == SIGNAL_IO_TASK_INVALID_ID ) return;
+  
+  // Crashed session samples are all still in history
+  TEST_CHECK( WaitDumpEnd( taskID ), "crash dump not finished" );
+  bool activeChannelsList[ INPUT_CHANNELS_NUMBER ] = { true, false };
+  CheckInputRecording( "SimCrash_crash.sigrec", 200, GetTask( taskID )->historyLength, activeChannelsList );
+  remove( "SimCrash_crash.sigrec" );
+  
+  EndDevice( taskID );
+}
+
+int main( int argc, char* argv[] )
+{
+  TestTaskDump();
+  TestCrashDump();
+  
+  SimDAQmx_RemoveTasks();
+  
+  return Test_End( "test_recording" );
+}
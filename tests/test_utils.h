@@ -0,0 +1,131 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (c) 2016-2019 Leonardo Consoni <leonardojc@protonmail.com>      //
+//                                                                            //
+//  This file is part of Signal-IO-NIDAQmx.                                   //
+//                                                                            //
+//  Signal-IO-NIDAQmx is free software: you can redistribute it and/or modify //
+//  it under the terms of the GNU Lesser General Public License as published  //
+//  by the Free Software Foundation, either version 3 of the License, or      //
+//  (at your option) any later version.                                       //
+//                                                                            //
+//  Signal-IO-NIDAQmx is distributed in the hope that it will be useful,      //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of            //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the              //
+//  GNU Lesser General Public License for more details.                       //
+//                                                                            //
+//  You should have received a copy of the GNU Lesser General Public License  //
+//  along with Signal-IO-NIDAQmx. If not, see <http://www.gnu.org/licenses/>. //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+/// @file test_utils.h
+/// @brief Minimal checks, deterministic random values and timing shared by tests and benchmarks
+
+#ifndef TEST_UTILS_H
+#define TEST_UTILS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+static size_t testFailuresCount = 0;
+
+/// Reports failed condition (with printf style details) and keeps going, so that every failure of a run shows up
+#define TEST_CHECK( condition, ... ) \
+  do { if( !(condition) ) { \
+    testFailuresCount++; \
+    fprintf( stderr, "%s:%d: check failed: %s: ", __FILE__, __LINE__, #condition ); \
+    fprintf( stderr, __VA_ARGS__ ); fprintf( stderr, "\n" ); \
+  } } while( 0 )
+
+/// Prints test program result and gets its exit code
+static int Test_End( const char* testName )
+{
+  if( testFailuresCount > 0 ) fprintf( stderr, "%s: FAILED (%zu checks)\n", testName, testFailuresCount );
+  else printf( "%s: passed\n", testName );
+  return ( testFailuresCount > 0 ) ? 1 : 0;
+}
+
+static uint64_t testRandomState = 0x9E3779B97F4A7C15ULL;
+
+static void Test_SeedRandom( uint64_t seed ) { testRandomState = ( seed != 0 ) ? seed : 0x9E3779B97F4A7C15ULL; }
+
+// xorshift64*: same sequence on every platform, so failures are reproducible
+static uint64_t Test_GetRandom( void )
+{
+  testRandomState ^= testRandomState >> 12;
+  testRandomState ^= testRandomState << 25;
+  testRandomState ^= testRandomState >> 27;
+  return testRandomState * 0x2545F4914F6CDD1DULL;
+}
+
+/// Random value in [ -1.0, 1.0 ), with some exact zeros and repeated values to reach comparison edge cases
+static double Test_GetRandomValue( void )
+{
+  uint64_t randomValue = Test_GetRandom();
+  if( randomValue % 16 == 0 ) return 0.0;
+  if( randomValue % 16 == 1 ) return 0.5;
+  return ( randomValue >> 11 ) * ( 2.0 / 9007199254740992.0 ) - 1.0;
+}
+
+static void Test_FillRandom( double* valuesList, size_t valuesNumber )
+{
+  for( size_t index = 0; index < valuesNumber; index++ )
+    valuesList[ index ] = Test_GetRandomValue();
+}
+
+/// Bitwise comparison (tells -0.0 from 0.0 and compares NaNs by payload)
+static bool Test_IsBitIdentical( const double* aList, const double* bList, size_t valuesNumber )
+{
+  return ( memcmp( aList, bList, valuesNumber * sizeof(double) ) == 0 );
+}
+
+static double Test_GetTime( void )
+{
+  struct timespec currentTime;
+  clock_gettime( CLOCK_MONOTONIC, &currentTime );
+  return currentTime.tv_sec + currentTime.tv_nsec / 1e9;
+}
+
+static void Test_Sleep( double duration )
+{
+  struct timespec delayTime = { (time_t) duration, (long) ( ( duration - (time_t) duration ) * 1e9 ) };
+  nanosleep( &delayTime, NULL );
+}
+
+/// Keeps benchmark results alive, so that measured calls are not optimized out
+static volatile double benchmarkSink;
+
+typedef void (*BenchmarkFunction)( void* data, size_t iterationsNumber );
+
+/// Measures average call time (in nanoseconds) of given benchmark, as the best of 5 runs of at least 20 ms each
+static double Benchmark_GetCallTime( BenchmarkFunction Run, void* data )
+{
+  size_t iterationsNumber = 16;
+  double elapsedTime = 0.0;
+  while( elapsedTime < 0.02 )
+  {
+    iterationsNumber *= 2;
+    double startTime = Test_GetTime();
+    Run( data, iterationsNumber );
+    elapsedTime = Test_GetTime() - startTime;
+  }
+  
+  double bestCallTime = elapsedTime / iterationsNumber;
+  for( size_t run = 1; run < 5; run++ )
+  {
+    double startTime = Test_GetTime();
+    Run( data, iterationsNumber );
+    double callTime = ( Test_GetTime() - startTime ) / iterationsNumber;
+    if( callTime < bestCallTime ) bestCallTime = callTime;
+  }
+  
+  return bestCallTime * 1e9;
+}
+
+#endif // TEST_UTILS_H